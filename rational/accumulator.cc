@@ -0,0 +1,255 @@
+/*
+ accumulator.cc
+
+ Contains the implementation of the BasicRationalAccumulator class template
+ defined in accumulator.hh.  The template is instantiated here for 32, 64 and
+ 128-bit integers.
+*/
+
+#include "accumulator.hh"
+#include "common.hh"
+
+using namespace std;
+
+/*
+ group
+
+ Finds the group of terms over the argued denominator, creating it if there
+ is none.
+
+ Arguments:     denom (IntT) - Positive denominator
+
+ Returns:       (size_t) - Index of the group in m_groups.
+
+ Global Impact: May add a group, and folds all groups first if there are
+                already MAX_GROUPS of them.
+*/
+template <typename IntT>
+size_t BasicRationalAccumulator<IntT>::group(IntT denom) {
+    if (m_last < m_groups.size() && m_groups[m_last].denom == denom)
+        return m_last;
+
+    typename unordered_map<IntT, size_t, DenomHash>::iterator it =
+        m_index.find(denom);
+    if (it != m_index.end())
+        return m_last = it->second;
+
+    if (m_groups.size() >= MAX_GROUPS)
+        fold();
+
+    Group g = { denom, 0 };
+    m_index[denom] = m_groups.size();
+    m_groups.push_back(g);
+    return m_last = m_groups.size() - 1;
+}
+
+/*
+ addTo
+
+ Adds a numerator to a group's sum.  If the sum would overflow the wide type,
+ what the group holds so far is moved into the total first.
+
+ Arguments:     i (size_t) - Index of the group
+                n (Wide) - Numerator to add
+
+ Returns:       None.
+
+ Global Impact: Updates the group, and m_total if it had to be folded.
+*/
+template <typename IntT>
+void BasicRationalAccumulator<IntT>::addTo(size_t i, Wide n) {
+    Group& g = m_groups[i];
+    Wide sum;
+    if (__builtin_add_overflow(g.sum, n, &sum)) {
+        m_total += value(g);
+        sum = n;
+    }
+    g.sum = sum;
+
+    return;
+}
+
+/*
+ fold
+
+ Adds every group to the total and removes them.
+
+ Arguments:     None.
+
+ Returns:       None.
+
+ Global Impact: Updates m_total and empties m_groups and m_index.  Throws
+                overflow_error if the total does not fit IntT.
+*/
+template <typename IntT>
+void BasicRationalAccumulator<IntT>::fold() {
+    for (size_t i = 0; i < m_groups.size(); i++)
+        m_total += value(m_groups[i]);
+    m_groups.clear();
+    m_index.clear();
+    m_last = 0;
+
+    return;
+}
+
+/*
+ value
+
+ Reduces a group's numerator sum over its denominator.
+
+ Arguments:     g (Group&) - Group to reduce
+
+ Returns:       (Value) - The sum of the group's terms in simplest form.
+
+ Global Impact: Throws overflow_error if that does not fit IntT.
+*/
+template <typename IntT>
+typename BasicRationalAccumulator<IntT>::Value
+BasicRationalAccumulator<IntT>::value(const Group& g) {
+    Value out;
+    out.simplify(g.sum, (Wide) g.denom);
+    return out;
+}
+
+/******************************
+ CONSTRUCTORS
+ ******************************/
+template <typename IntT>
+BasicRationalAccumulator<IntT>::BasicRationalAccumulator() : m_last(0) {}
+
+/******************************
+ ACCUMULATION
+ ******************************/
+/*
+ add
+
+ Adds a term to the sum.
+
+ Arguments:     r (Rational&) - Term to add
+
+ Returns:       None.
+
+ Global Impact: Updates the groups.
+*/
+template <typename IntT>
+void BasicRationalAccumulator<IntT>::add(const Value& r) {
+    addTo(group(r.denom()), (Wide) r.num());
+
+    return;
+}
+
+/*
+ addBatch
+
+ Adds an array of terms to the sum.
+
+ Arguments:     terms (Rational*) - Terms to add
+                n (size_t) - Number of terms
+
+ Returns:       None.
+
+ Global Impact: Updates the groups.
+*/
+template <typename IntT>
+void BasicRationalAccumulator<IntT>::addBatch(const Value *terms, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        addTo(group(terms[i].denom()), (Wide) terms[i].num());
+
+    return;
+}
+
+/*
+ merge
+
+ Adds everything summed by another accumulator to this one, group by group,
+ so that partial sums taken separately combine without reducing.
+
+ Arguments:     a (RationalAccumulator&) - Accumulator to add
+
+ Returns:       None.
+
+ Global Impact: Updates the groups and the total.
+*/
+template <typename IntT>
+void BasicRationalAccumulator<IntT>::merge(
+    const BasicRationalAccumulator<IntT>& a) {
+    // Adding groups to itself could fold them away mid loop
+    if (&a == this) {
+        BasicRationalAccumulator copy(a);
+        merge(copy);
+        return;
+    }
+
+    for (size_t i = 0; i < a.m_groups.size(); i++)
+        addTo(group(a.m_groups[i].denom), a.m_groups[i].sum);
+    m_total += a.m_total;
+
+    return;
+}
+
+/*
+ clear
+
+ Resets the sum to 0.
+
+ Arguments:     None.
+
+ Returns:       None.
+
+ Global Impact: Empties the groups and the total.
+*/
+template <typename IntT>
+void BasicRationalAccumulator<IntT>::clear() {
+    m_groups.clear();
+    m_index.clear();
+    m_last = 0;
+    m_total = Value();
+
+    return;
+}
+
+/******************************
+ ACCESSORS
+ ******************************/
+/*
+ result
+
+ Returns the sum of every term added so far.  The groups are not folded, so
+ more terms can still be added cheaply afterwards.
+
+ Arguments:     None.
+
+ Returns:       (Rational) - The exact sum in simplest form.
+
+ Global Impact: Throws overflow_error if the sum does not fit IntT.
+*/
+template <typename IntT>
+typename BasicRationalAccumulator<IntT>::Value
+BasicRationalAccumulator<IntT>::result() const {
+    Value out = m_total;
+    for (size_t i = 0; i < m_groups.size(); i++)
+        out += value(m_groups[i]);
+
+    return out;
+}
+
+/*
+ groups
+
+ Returns the number of denominators whose terms are still grouped.
+
+ Arguments:     None.
+
+ Returns:       (size_t) - Number of groups.
+*/
+template <typename IntT>
+size_t BasicRationalAccumulator<IntT>::groups() const {
+    return m_groups.size();
+}
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+template class BasicRationalAccumulator<int32_t>;
+template class BasicRationalAccumulator<int64_t>;
+template class BasicRationalAccumulator<int128_t>;
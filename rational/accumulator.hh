@@ -0,0 +1,112 @@
+/*
+ accumulator.hh
+
+ Contains the BasicRationalAccumulator class template definition, which sums
+ many rationals exactly without reducing after every term.
+*/
+
+#ifndef ACCUMULATOR
+#define ACCUMULATOR
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include "common.hh"
+#include "rational.hh"
+
+/*
+ BasicRationalAccumulator Class
+
+ Sums BasicRationals exactly.  Adding them with operator+= costs a GCD and
+ a few multiplies per term, where real data such as ledger amounts uses only
+ a handful of denominators.  So terms are grouped by denominator and only
+ their numerators are added, in the wide type of RationalTraits<IntT>.  A
+ group is turned back into a fraction and added to the running total only
+ when its numerator sum would overflow, when there are more than MAX_GROUPS
+ groups, or when the result is asked for.
+
+ The last group added to is remembered, so runs of one denominator don't even
+ look it up.  Accumulators can be merged, so partial sums can be taken in
+ parallel.  Like BasicRational, overflow_error is thrown if the total, or a
+ partial total folded along the way, does not fit IntT.
+*/
+template <typename IntT>
+class BasicRationalAccumulator {
+public:
+    typedef typename RationalTraits<IntT>::Wide Wide;
+    typedef BasicRational<IntT> Value;
+
+    /* Groups are folded into the total past this many denominators. */
+    static const size_t MAX_GROUPS = 1024;
+
+private:
+    /* Sum of the numerators of all terms over one denominator. */
+    struct Group {
+        IntT denom;
+        Wide sum;
+    };
+
+    /* Hashes a denominator, folding the high half of 128-bit ones in. */
+    struct DenomHash {
+        static size_t mix(uint64_t x) {
+            return (size_t) ((x ^ (x >> 29)) * 0x9E3779B97F4A7C15ull);
+        }
+        size_t operator()(int32_t d) const { return mix((uint64_t) d); }
+        size_t operator()(int64_t d) const { return mix((uint64_t) d); }
+        size_t operator()(int128_t d) const {
+            return mix((uint64_t) d ^ (uint64_t) (d >> 64));
+        }
+    };
+
+    /******************************
+     MEMBERS
+     ******************************/
+    std::vector<Group> m_groups;            // Groups in order of creation
+    std::unordered_map<IntT, size_t,
+                       DenomHash> m_index;  // Denominator to group index
+    size_t m_last;                          // Group last added to
+    Value m_total;                          // Groups folded so far
+
+    /******************************
+     PRIVATE METHODS
+     ******************************/
+    size_t group(IntT denom);               // Index of denom's group
+    void addTo(size_t i, Wide n);           // Adds n to group i
+    void fold();                            // Adds the groups to m_total
+    static Value value(const Group& g);     // Group sum in simplest form
+
+public:
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+    BasicRationalAccumulator();             // Initializes to 0
+
+    /******************************
+     ACCUMULATION
+     ******************************/
+    void add(const Value& r);                        // Adds one term
+    void addBatch(const Value *terms, size_t n);     // Adds n terms
+    void merge(const BasicRationalAccumulator& a);   // Adds a's terms
+    void clear();                                    // Resets to 0
+
+    /******************************
+     ACCESSORS
+     ******************************/
+    Value result() const;                   // Sum of all terms
+    size_t groups() const;                  // Denominators not folded yet
+};
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+typedef BasicRationalAccumulator<int32_t>  RationalAccumulator;
+typedef BasicRationalAccumulator<int64_t>  RationalAccumulator64;
+typedef BasicRationalAccumulator<int128_t> RationalAccumulator128;
+
+/* Defined in accumulator.cc for these three types only. */
+extern template class BasicRationalAccumulator<int32_t>;
+extern template class BasicRationalAccumulator<int64_t>;
+extern template class BasicRationalAccumulator<int128_t>;
+
+#endif // ifndef ACCUMULATOR
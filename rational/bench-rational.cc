@@ -0,0 +1,1126 @@
+#include "rational.hh"
+#include "lazyrational.hh"
+#include "accumulator.hh"
+#include "parallel.hh"
+#include "rationalarray.hh"
+#include "rationalchars.hh"
+#include "decimalexpansion.hh"
+#include "rationalmatrix.hh"
+#include "linearprogram.hh"
+#include "rationalpolynomial.hh"
+#include "rationalinterval.hh"
+#include "saferational.hh"
+#include "../vector/hashmap.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+
+using namespace std;
+
+
+/*===========================================================================
+ * HELPERS
+ */
+
+
+/* Milliseconds taken to run f once. */
+template <typename F>
+double timeMs(F f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    auto stop = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(stop - start).count();
+}
+
+/* Random rationals with numerators in [-maxNum, maxNum] and denominators in
+   [1, maxDenom]. */
+template <typename R>
+vector<R> randomRationals(size_t n, int maxNum, int maxDenom) {
+    vector<R> out;
+    for (size_t i = 0; i < n; i++)
+        out.push_back(R(rand() % (2 * maxNum + 1) - maxNum,
+                        1 + rand() % maxDenom));
+    return out;
+}
+
+/* Random 64-bit value. */
+uint64_t random64() {
+    return ((uint64_t) rand() << 42) ^ ((uint64_t) rand() << 21) ^ rand();
+}
+
+/* Random rationals whose nonzero numerators and denominators have up to bits
+   bits, so that sums and products of two fit in twice that. */
+template <typename R>
+vector<R> randomOperands(size_t n, int bits) {
+    vector<R> out;
+    for (size_t i = 0; i < n; i++) {
+        int64_t num = 1 + (int64_t) (random64() >> (65 - bits));
+        int64_t den = 1 + (int64_t) (random64() >> (65 - bits));
+        out.push_back(R(rand() % 2 ? num : -num, den));
+    }
+    return out;
+}
+
+void row(const string &name, size_t ops, double ms) {
+    cout << setw(24) << left << name << setw(12) << right << ops
+         << setw(12) << fixed << setprecision(1) << ms
+         << setw(12) << setprecision(1) << (ops / ms / 1000.0) << endl;
+}
+
+
+/*===========================================================================
+ * BENCHMARKS
+ */
+
+
+/* Chains of CHAIN operations over random small rationals, small enough that
+   even the 32-bit backend never overflows: sums with denominators up to 16
+   and products of factors up to 8. */
+template <typename R>
+void bench_width(const char *type, size_t n) {
+    const size_t CHAIN = 8;
+    vector<R> sums = randomRationals<R>(n + CHAIN, 100, 16);
+    vector<R> facs = randomRationals<R>(n + CHAIN, 8, 8);
+    long sink = 0;
+
+    row(string(type) + " add chain", n * CHAIN, timeMs([&]() {
+        for (size_t i = 0; i < n; i++) {
+            R acc = sums[i];
+            for (size_t j = 1; j <= CHAIN; j++)
+                acc += sums[i + j];
+            sink += (int64_t) acc.denom();
+        }
+    }));
+
+    row(string(type) + " mul chain", n * CHAIN, timeMs([&]() {
+        for (size_t i = 0; i < n; i++) {
+            R acc = facs[i];
+            for (size_t j = 1; j <= CHAIN; j++)
+                acc *= facs[i + j];
+            sink += (int64_t) acc.denom();
+        }
+    }));
+
+    row(string(type) + " compare", n * CHAIN, timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 1; j <= CHAIN; j++)
+                sink += sums[i] < sums[i + j];
+    }));
+
+    if (sink == 42)
+        cout << "";
+}
+
+
+/* Nanoseconds per +, -, * and / on random pairs of operands. */
+template <typename R>
+void bench_ops(const char *type, size_t n, int bits) {
+    vector<R> a = randomOperands<R>(n, bits);
+    vector<R> b = randomOperands<R>(n, bits);
+    const char *names[4] = { "+", "-", "*", "/" };
+    double ns[4];
+    int64_t sink = 0;
+
+    ns[0] = timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            sink += (int64_t) (a[i] + b[i]).denom();
+    });
+    ns[1] = timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            sink += (int64_t) (a[i] - b[i]).denom();
+    });
+    ns[2] = timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            sink += (int64_t) (a[i] * b[i]).denom();
+    });
+    ns[3] = timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            sink += (int64_t) (a[i] / b[i]).denom();
+    });
+
+    cout << setw(10) << left << type << setw(6) << right << bits;
+    for (int op = 0; op < 4; op++)
+        cout << setw(6) << names[op] << setw(8) << fixed << setprecision(1)
+             << ns[op] * 1e6 / n;
+    cout << (sink == 42 ? " " : "") << endl;
+}
+
+
+/* Adding and multiplying n random rationals by small integers, passed as
+   built in integers and as Rationals of the same value, and incrementing. */
+template <typename R>
+void bench_int_ops(const char *type, size_t n, int bits) {
+    vector<R> a = randomOperands<R>(n, bits);
+    vector<int> k(n);
+    for (size_t i = 0; i < n; i++)
+        k[i] = 1 + rand() % 100;
+    int64_t sink = 0;
+
+    row(string(type) + " + int", n, timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            sink += (int64_t) (a[i] + k[i]).num();
+    }));
+    row(string(type) + " + R(int)", n, timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            sink += (int64_t) (a[i] + R(k[i])).num();
+    }));
+    row(string(type) + " * int", n, timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            sink += (int64_t) (k[i] * a[i]).num();
+    }));
+    row(string(type) + " * R(int)", n, timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            sink += (int64_t) (R(k[i]) * a[i]).num();
+    }));
+    row(string(type) + " ++", n, timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            sink += (int64_t) (++a[i]).num();
+    }));
+
+    if (sink == 42)
+        cout << "";
+}
+
+
+/* Sorting a vector of random rationals with operator<. */
+template <typename R>
+void bench_sort(const char *type, size_t n, int bits) {
+    vector<R> v = randomOperands<R>(n, bits);
+    row(string(type) + " sort", n,
+        timeMs([&]() { std::sort(v.begin(), v.end()); }));
+}
+
+
+/* Harmonic style sums of n terms, reduced after every term by R and only
+   when about to overflow by L: the telescoping sum of 1/(k(k+1)), and 1/k
+   over a repeating period of k = 1..12 so that the reduced denominator stays
+   at most lcm(1..12). */
+template <typename R, typename L>
+void bench_lazy(const char *type, size_t n) {
+    R eager;
+    L lazy;
+
+    row(string(type) + " telescope", n, timeMs([&]() {
+        for (size_t k = 1; k <= n; k++)
+            eager += R(1, (int64_t) k * (int64_t) (k + 1));
+    }));
+    row(string(type) + " telescope lazy", n, timeMs([&]() {
+        for (size_t k = 1; k <= n; k++)
+            lazy += L(1, (int64_t) k * (int64_t) (k + 1));
+    }));
+    if (lazy.normalized() != eager)
+        cout << "lazy telescoping sum differs" << endl;
+
+    eager = R();
+    lazy = L();
+    row(string(type) + " harmonic", n, timeMs([&]() {
+        for (size_t k = 0; k < n; k++)
+            eager += R(1, 1 + k % 12);
+    }));
+    row(string(type) + " harmonic lazy", n, timeMs([&]() {
+        for (size_t k = 0; k < n; k++)
+            lazy += L(1, 1 + k % 12);
+    }));
+    if (lazy.normalized() != eager)
+        cout << "lazy harmonic sum differs" << endl;
+}
+
+
+/* Ledger totals of n amounts in cents, thousandths and thirds, summed with
+   operator+= and with an accumulator. */
+template <typename R, typename A>
+void bench_accumulate(const char *type, size_t n) {
+    const int denoms[4] = { 100, 1000, 3, 1 };
+    vector<R> terms;
+    for (size_t i = 0; i < n; i++)
+        terms.push_back(R(rand() % 2000001 - 1000000, denoms[rand() % 4]));
+
+    R eager;
+    row(string(type) + " ledger +=", n, timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            eager += terms[i];
+    }));
+
+    A acc;
+    R total;
+    row(string(type) + " ledger add", n, timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            acc.add(terms[i]);
+        total = acc.result();
+    }));
+    if (total != eager)
+        cout << "accumulated ledger differs" << endl;
+
+    A batch;
+    row(string(type) + " ledger batch", n, timeMs([&]() {
+        batch.addBatch(terms.data(), n);
+        total = batch.result();
+    }));
+    if (total != eager)
+        cout << "batched ledger differs" << endl;
+}
+
+
+/* Parallel sums of n random ledger amounts of up to 100 and products of the
+   n fractions (k + 1)/k, on 1, 2, 4, ... threads up to the hardware's. */
+template <typename R>
+void bench_parallel(const char *type, size_t n) {
+    const int denoms[4] = { 100, 1000, 4, 1 };
+    vector<R> terms, ratios;
+    terms.reserve(n);
+    ratios.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        terms.push_back(R(rand() % 201 - 100, denoms[rand() % 4]));
+        ratios.push_back(R(i + 2, i + 1));
+    }
+
+    vector<unsigned> counts;
+    unsigned cores = thread::hardware_concurrency();
+    for (unsigned t = 1; t < cores; t *= 2)
+        counts.push_back(t);
+    counts.push_back(cores > 1 ? cores : 1);
+
+    for (size_t c = 0; c < counts.size(); c++) {
+        unsigned t = counts[c];
+        R sum, product;
+        row(string(type) + " sum " + to_string(t) + "T", n, timeMs([&]() {
+            sum = parallelSum(terms.data(), n, t);
+        }));
+        row(string(type) + " product " + to_string(t) + "T", n, timeMs([&]() {
+            product = parallelProduct(ratios.data(), n, t);
+        }));
+        if (product != R(n + 1))
+            cout << "parallel product differs" << endl;
+    }
+}
+
+
+/* Elementwise +, -, *, / and compare over n pairs of random fractions with
+   14-bit parts, with Rational's operators one by one and with RationalArray
+   batches. */
+void bench_array(size_t n) {
+    vector<Rational> a = randomOperands<Rational>(n, 14);
+    vector<Rational> b = randomOperands<Rational>(n, 14);
+    vector<Rational> r(n);
+    RationalArray va(a), vb(b), vr;
+    vector<int> cmp(n);
+    const char *names[5] = { "+", "-", "*", "/", "compare" };
+
+    for (int op = 0; op < 5; op++) {
+        double scalar = timeMs([&]() {
+            for (size_t i = 0; i < n; i++) {
+                switch (op) {
+                case 0: r[i] = a[i] + b[i]; break;
+                case 1: r[i] = a[i] - b[i]; break;
+                case 2: r[i] = a[i] * b[i]; break;
+                case 3: r[i] = a[i] / b[i]; break;
+                default: cmp[i] = a[i].compare(b[i]); break;
+                }
+            }
+        });
+        double batch = timeMs([&]() {
+            switch (op) {
+            case 0: vr.add(va, vb); break;
+            case 1: vr.sub(va, vb); break;
+            case 2: vr.mul(va, vb); break;
+            case 3: vr.div(va, vb); break;
+            default: RationalArray::compare(va, vb, cmp.data()); break;
+            }
+        });
+        if (op < 4 && vr.get(n / 2) != r[n / 2])
+            cout << "batch result differs" << endl;
+
+        row(string("int32 ") + names[op] + " scalar", n, scalar);
+        row(string("int32 ") + names[op] +
+            (RationalArray::vectorized() ? " avx2" : " batch"), n, batch);
+    }
+}
+
+/* Formats and parses n comma separated fields, a mix of fractions and
+   integers, with iostreams and with toChars and RationalReader.  The ops
+   are bytes of text, so the rate is in MB/s. */
+void bench_chars(size_t n) {
+    vector<Rational64> values;
+    for (size_t i = 0; i < n; i++)
+        values.push_back(Rational64(rand() % 2000001 - 1000000,
+                                    rand() % 4 ? 1 + rand() % 1000000 : 1));
+
+    ostringstream text;
+    double streamOut = timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            text << values[i] << (i % 16 == 15 ? '\n' : ',');
+    });
+    string s = text.str();
+
+    string buffer(n * (RATIONAL_CHARS_MAX + 1), ' ');
+    char *end = &buffer[0];
+    double charsOut = timeMs([&]() {
+        char *last = &buffer[0] + buffer.size();
+        for (size_t i = 0; i < n; i++) {
+            end = toChars(end, last, values[i]).ptr;
+            *end++ = i % 16 == 15 ? '\n' : ',';
+        }
+    });
+    if (string(&buffer[0], end) != s)
+        cout << "toChars output differs" << endl;
+
+    vector<Rational64> parsed(n);
+    double streamIn = timeMs([&]() {
+        istringstream in(s);
+        int64_t num, den;
+        for (size_t i = 0; i < n && in >> num; i++) {
+            den = 1;
+            if (in.peek() == '/') {
+                in.get();
+                in >> den;
+            }
+            parsed[i] = Rational64(num, den);
+            in.get();
+        }
+    });
+    if (parsed != values)
+        cout << "istream result differs" << endl;
+
+    fill(parsed.begin(), parsed.end(), Rational64());
+    double readerIn = timeMs([&]() {
+        istringstream in(s);
+        RationalReader64 reader(in);
+        reader.read(parsed.data(), n);
+    });
+    if (parsed != values)
+        cout << "RationalReader result differs" << endl;
+
+    row("int64 ostream <<", s.size(), streamOut);
+    row("int64 toChars", s.size(), charsOut);
+    row("int64 istream >>", s.size(), streamIn);
+    row("int64 RationalReader", s.size(), readerIn);
+}
+
+
+/* n random values written rounded to 4 places in a column of 16 character
+   fields: through double with an ostream and snprintf, which both round the
+   double rather than the value, and exactly with toFixedColumn, which takes
+   one division per value for int64 and streams digits for int128. */
+void bench_decimal(size_t n) {
+    const size_t WIDTH = 16, PLACES = 4;
+    vector<Rational64> values;
+    vector<Rational128> wide;
+    for (size_t i = 0; i < n; i++) {
+        values.push_back(Rational64(rand() % 2000001 - 1000000,
+                                    1 + rand() % 1000000));
+        wide.push_back(Rational128(values[i].num(), values[i].denom()));
+    }
+
+    ostringstream text;
+    double streamOut = timeMs([&]() {
+        text << fixed << setprecision(PLACES);
+        for (size_t i = 0; i < n; i++)
+            text << setw(WIDTH) << (double) values[i];
+    });
+
+    string buffer(n * WIDTH + 1, ' ');
+    double printfOut = timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            snprintf(&buffer[i * WIDTH], WIDTH + 1, "%16.4f",
+                     (double) values[i]);
+    });
+
+    string column(n * WIDTH, ' ');
+    double columnOut = timeMs([&]() {
+        toFixedColumn(&column[0], WIDTH, values.data(), n, PLACES);
+    });
+
+    string wideColumn(n * WIDTH, ' ');
+    double wideOut = timeMs([&]() {
+        toFixedColumn(&wideColumn[0], WIDTH, wide.data(), n, PLACES);
+    });
+    if (wideColumn != column)
+        cout << "toFixedColumn widths differ" << endl;
+
+    char exact[64];
+    size_t chars = 0;
+    double exactOut = timeMs([&]() {
+        for (size_t i = 0; i < n; i++) {
+            ToCharsResult res = toDecimalChars(exact, exact + sizeof(exact),
+                                               values[i]);
+            chars += res.ec == errc() ? res.ptr - exact : 0;
+        }
+    });
+
+    row("int64 ostream fixed", n, streamOut);
+    row("int64 snprintf %f", n, printfOut);
+    row("int64 toFixedColumn", n, columnOut);
+    row("int128 toFixedColumn", n, wideOut);
+    row("int64 toDecimalChars", n, exactOut);
+}
+
+
+/* Best approximations of n random doubles with bounded denominators, with
+   approximate and with a search of every denominator in doubles, which is
+   run on n / 100 of them. */
+void bench_approximate(size_t n) {
+    vector<double> xs;
+    for (size_t i = 0; i < n; i++)
+        xs.push_back((rand() - RAND_MAX / 2) / (RAND_MAX / 2000.0));
+    vector<Rational> out(n);
+
+    const int maxDenoms[3] = { 1000, 1 << 20, INT32_MAX };
+    for (int b = 0; b < 3; b++) {
+        string bound = to_string(maxDenoms[b]);
+        row("int32 approx " + bound, n, timeMs([&]() {
+            Rational::approximate(xs.data(), n, maxDenoms[b], out.data());
+        }));
+    }
+
+    size_t searched = n / 100;
+    row("int32 search 1000", searched, timeMs([&]() {
+        for (size_t i = 0; i < searched; i++) {
+            double best = INFINITY;
+            for (int q = 1; q <= 1000; q++) {
+                double p = nearbyint(xs[i] * q);
+                double err = fabs(xs[i] - p / q);
+                if (err < best) {
+                    best = err;
+                    out[i] = Rational((int32_t) p, q);
+                }
+            }
+        }
+    }));
+}
+
+/* Times determinants of random n x n matrices of small fractions with
+   Bareiss elimination in BigRationalMatrix and with plain Gaussian
+   elimination in BigRationals, which reduces a fraction at every step, and
+   solves of n right hand sides.  Operations are the n^3 / 3 elimination
+   steps, and the bits of the largest fraction Gaussian elimination meets
+   are printed after each size. */
+void bench_matrix() {
+    const size_t sizes[3] = { 20, 40, 60 };
+    for (int s = 0; s < 3; s++) {
+        size_t n = sizes[s], steps = n * n * n / 3;
+        BigRationalMatrix a(n, n);
+        vector<vector<BigRational> > g(n, vector<BigRational>(n));
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++) {
+                a.set(i, j, BigRational(rand() % 199 - 99, 1 + rand() % 9));
+                g[i][j] = a.get(i, j);
+            }
+        string size = to_string(n);
+
+        BigRational det;
+        row("bigint bareiss det " + size, steps, timeMs([&]() {
+            det = a.determinant();
+        }));
+
+        size_t bits = 0;
+        BigRational gdet(1);
+        row("bigint gauss det " + size, steps, timeMs([&]() {
+            for (size_t c = 0; c < n; c++) {
+                size_t p = c;
+                while (g[p][c] == BigRational())
+                    p++;
+                swap(g[p], g[c]);
+                gdet *= p != c ? -g[c][c] : g[c][c];
+                for (size_t i = c + 1; i < n; i++) {
+                    BigRational f = g[i][c] / g[c][c];
+                    for (size_t j = c; j < n; j++) {
+                        g[i][j] -= f * g[c][j];
+                        bits = max(bits, g[i][j].num().bits() +
+                                         g[i][j].denom().bits());
+                    }
+                }
+            }
+        }));
+
+        BigRationalMatrix x;
+        row("bigint bareiss solve " + size, 2 * steps, timeMs([&]() {
+            x = a.solve(BigRationalMatrix::identity(n));
+        }));
+        cout << "  gauss entries up to " << bits << " bits, det "
+             << det.num().bits() + det.denom().bits() << " bits"
+             << (det == gdet ? "" : ", MISMATCH") << endl;
+    }
+}
+
+
+/* Evaluates a degree 20 polynomial of small fractions at n random points by
+   Horner's rule on the coefficients and by the scaled Horner evaluation, one
+   at a time and batched, then times products of degree 511 polynomials and
+   isolating the 21 roots of the product of x - k/7 for k = -10..10. */
+void bench_polynomial(size_t n) {
+    vector<BigRational> c = randomRationals<BigRational>(21, 99, 9);
+    BigRationalPolynomial p(c);
+    vector<BigRational> xs = randomRationals<BigRational>(n, 999, 999);
+    vector<BigRational> naive(n), scaled(n), batch;
+
+    row("bigint horner", n, timeMs([&]() {
+        for (size_t i = 0; i < n; i++) {
+            BigRational r = c[20];
+            for (size_t k = 20; k-- > 0;)
+                r = r * xs[i] + c[k];
+            naive[i] = r;
+        }
+    }));
+    row("bigint poly evaluate", n, timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            scaled[i] = p(xs[i]);
+    }));
+    row("bigint poly batch", n, timeMs([&]() { batch = p.evaluate(xs); }));
+    if (naive != scaled || scaled != batch)
+        cout << "polynomial values differ" << endl;
+
+    vector<Rational64> c64 = randomRationals<Rational64>(5, 99, 9);
+    RationalPolynomial64 p64(c64);
+    vector<Rational64> xs64 = randomRationals<Rational64>(n, 99, 99);
+    int64_t sink = 0;
+    row("int64 horner deg 4", n, timeMs([&]() {
+        for (size_t i = 0; i < n; i++) {
+            Rational64 r = c64[4];
+            for (size_t k = 4; k-- > 0;)
+                r = r * xs64[i] + c64[k];
+            sink += r.denom();
+        }
+    }));
+    row("int64 poly eval deg 4", n, timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            sink += p64(xs64[i]).denom();
+    }));
+
+    const size_t DEGREE = 511;
+    vector<BigRational> a = randomRationals<BigRational>(DEGREE + 1, 99, 9);
+    vector<BigRational> b = randomRationals<BigRational>(DEGREE + 1, 99, 9);
+    BigRationalPolynomial pa(a), pb(b), prod;
+    vector<BigRational> naiveProd(2 * DEGREE + 1);
+    row("bigint poly mul naive", (DEGREE + 1) * (DEGREE + 1), timeMs([&]() {
+        for (size_t i = 0; i <= DEGREE; i++)
+            for (size_t j = 0; j <= DEGREE; j++)
+                naiveProd[i + j] += a[i] * b[j];
+    }));
+    row("bigint poly mul", (DEGREE + 1) * (DEGREE + 1), timeMs([&]() {
+        prod = pa * pb;
+    }));
+    if (prod != BigRationalPolynomial(naiveProd))
+        cout << "polynomial products differ" << endl;
+
+    BigRationalPolynomial roots(BigRational(1));
+    for (int k = -10; k <= 10; k++)
+        roots = roots * BigRationalPolynomial(
+            vector<BigRational>{ BigRational(-k, 7), BigRational(1) });
+    size_t found = 0;
+    row("bigint isolate 21 roots", 21, timeMs([&]() {
+        found = roots.isolateRoots().size();
+    }));
+    cout << (found == 21 ? "" : "  wrong number of roots\n")
+         << (sink == 42 ? " " : "");
+}
+
+
+/* Times exact solves of sparse packing programs, maximize c x subject to
+   A x <= b, with m rows, m / 2 columns and four entries of 1 to 9 per row,
+   one of them in column i % n so that no column is unbounded.
+   Operations are the pivots taken in doubles, and the pivots taken exactly
+   and the support of the optimum are printed after each. */
+void bench_linear_program() {
+    const size_t sizes[3] = { 100, 300, 1000 };
+    for (int s = 0; s < 3; s++) {
+        size_t m = sizes[s], n = m / 2;
+        BigRationalMatrix a(m, n);
+        vector<BigRational> b(m), c(n);
+        for (size_t i = 0; i < m; i++) {
+            for (int k = 0; k < 4; k++)
+                a.set(i, k == 0 ? i % n : rand() % n,
+                      BigRational(1 + rand() % 9));
+            b[i] = BigRational(50 + rand() % 100);
+        }
+        for (size_t j = 0; j < n; j++)
+            c[j] = BigRational(1 + rand() % 20);
+
+        BigLinearProgram lp(a, b, c);
+        double ms = timeMs([&]() { lp.solve(); });
+        row("bigint lp " + to_string(m) + " rows", lp.floatPivots(), ms);
+
+        size_t support = 0;
+        for (size_t j = 0; j < lp.solution().size(); j++)
+            support += lp.solution()[j] != BigRational();
+        cout << "  " << lp.exactPivots() << " exact pivots, " << support
+             << " nonzero variables" << endl;
+    }
+}
+
+
+/* Iterative schemes bounded by intervals.  Explicit Euler for y' = 1/2 - y
+   with a step of 1/64 from y in [1, 2] runs steps steps as two BigRational
+   updates ordered by comparing doubles, as exact BigRationalIntervals, and
+   as bounded 64 and 128-bit intervals.  Newton's iteration x <- x/2 + 1/x
+   for the square root of 2 doubles the size of exact values each step, so
+   it runs 12 steps from 1, steps / 100 times over. */
+void bench_interval(size_t steps) {
+    typedef BigRationalInterval BI;
+    const int64_t BOUND64 = (int64_t) 1 << 30;
+    const int128_t BOUND128 = (int128_t) 1 << 62;
+
+    BigRational lo(1), hi(2);
+    BigRational decay(63, 64), drift(1, 128);
+    double pair = timeMs([&]() {
+        for (size_t i = 0; i < steps; i++) {
+            lo = lo * decay + drift;
+            hi = hi * decay + drift;
+            if ((double) hi < (double) lo)
+                swap(lo, hi);
+        }
+    });
+
+    BI big(BigRational(1), BigRational(2)), bigDecay(decay), bigDrift(drift);
+    double exact = timeMs([&]() {
+        for (size_t i = 0; i < steps; i++)
+            big = big * bigDecay + bigDrift;
+    });
+
+    RationalInterval64 y64(Rational64(1), Rational64(2), BOUND64);
+    RationalInterval64 decay64(Rational64(63, 64)), drift64(Rational64(1, 128));
+    double bounded64 = timeMs([&]() {
+        for (size_t i = 0; i < steps; i++)
+            y64 = y64 * decay64 + drift64;
+    });
+
+    RationalInterval128 y128(Rational128(1), Rational128(2), BOUND128);
+    RationalInterval128 decay128(Rational128(63, 64));
+    RationalInterval128 drift128(Rational128(1, 128));
+    double bounded128 = timeMs([&]() {
+        for (size_t i = 0; i < steps; i++)
+            y128 = y128 * decay128 + drift128;
+    });
+    BigRational lo64(y64.lower().num(), y64.lower().denom());
+    BigRational hi64(y64.upper().num(), y64.upper().denom());
+    if (big != BI(lo, hi) || big.lower() < lo64 || hi64 < big.upper())
+        cout << "Euler intervals differ" << endl;
+
+    row("euler BigRational pair", steps, pair);
+    row("euler bigint exact", steps, exact);
+    row("euler int64 bounded", steps, bounded64);
+    row("euler int128 bounded", steps, bounded128);
+
+    const size_t NEWTON = 12, runs = steps / 100;
+    double newtonExact = timeMs([&]() {
+        for (size_t run = 0; run < runs; run++) {
+            BI x(BigRational(1)), half(BigRational(1, 2));
+            for (size_t i = 0; i < NEWTON; i++)
+                x = x * half + BI(BigRational(1)) / x;
+        }
+    });
+
+    RationalInterval64 x64;
+    double newton64 = timeMs([&]() {
+        for (size_t run = 0; run < runs; run++) {
+            RationalInterval64 half(Rational64(1, 2));
+            x64 = RationalInterval64(Rational64(1), Rational64(1), BOUND64);
+            for (size_t i = 0; i < NEWTON; i++)
+                x64 = x64 * half + RationalInterval64(Rational64(1)) / x64;
+        }
+    });
+    if (!x64.square().contains(Rational64(2)))
+        cout << "Newton interval misses the root" << endl;
+
+    row("newton bigint exact", runs * NEWTON, newtonExact);
+    row("newton int64 bounded", runs * NEWTON, newton64);
+}
+
+
+/* Hashes n random int64 rationals with numerators up to 1000 and
+   denominators up to 1000, and removes their duplicates three ways: by
+   sorting, with std::unordered_set and with FlatHashMap. */
+void bench_dedup(size_t n) {
+    vector<Rational64> v = randomRationals<Rational64>(n, 1000, 1000);
+    size_t sink = 0, sorted = 0, hashed = 0, flat = 0;
+
+    row("int64 hash", n, timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            sink += v[i].hash();
+    }));
+
+    row("int64 dedup sort", n, timeMs([&]() {
+        vector<Rational64> s(v);
+        sort(s.begin(), s.end());
+        sorted = unique(s.begin(), s.end()) - s.begin();
+    }));
+
+    row("int64 dedup unordered", n, timeMs([&]() {
+        unordered_set<Rational64> set(v.begin(), v.end());
+        hashed = set.size();
+    }));
+
+    row("int64 dedup flat", n, timeMs([&]() {
+        FlatHashMap<Rational64, char> map;
+        for (size_t i = 0; i < n; i++)
+            map.insert(v[i], 0);
+        flat = map.size();
+    }));
+
+    cout << "  " << sorted << " distinct"
+         << (sorted == hashed && sorted == flat ? "" : ", MISMATCH")
+         << (sink == 42 ? " " : "") << endl;
+}
+
+
+
+
+/*===========================================================================
+ * MICRO BENCHMARKS
+ */
+
+
+/* Operations per micro benchmark run, rounds of runs taken of each, times
+   one that looks slower than its baseline is measured again, the relative
+   slowdown that counts as a regression and the ns per operation below which
+   a slowdown is loop overhead and timer noise, not a regression. */
+const size_t MICRO_OPS = (size_t) 1 << 16;
+const int MICRO_ROUNDS = 9;
+const int MICRO_RETRIES = 5;
+const double MICRO_TOLERANCE = 1.10;
+const double MICRO_NOISE_NS = 0.5;
+
+/* A named micro benchmark that does MICRO_OPS operations when run. */
+struct MicroKernel {
+    string name;
+    function<void()> run;
+};
+
+/* Where micro benchmarks put results so that they aren't optimized out. */
+int64_t microSink = 0;
+double microTotal = 0;
+
+/* Random nonzero value of up to bits bits, either sign. */
+int64_t randomNonzero(int bits) {
+    int64_t v = 1 + (int64_t) (random64() >> (64 - bits));
+    return rand() % 2 ? v : -v;
+}
+
+/* Operands of one distribution, shared by the kernels that use them. */
+template <typename IntT>
+struct MicroOperands {
+    vector<BasicRational<IntT> > a, b;
+    vector<IntT> num, den, scaledNum, scaledDen;
+};
+
+/* Adds kernels timing construction from reduced parts, construction from
+   parts with a common factor (simplify), +, -, *, /, <, ==, conversion to
+   double and stream output, on BasicRational<IntT> operands drawn from each
+   of
+
+    small   - numerators up to 100 and denominators up to 100
+    near    - parts of nearBits bits, so that results come close to the
+              limit of IntT
+    coprime - denominators that are distinct primes, so sums take no GCD
+    shared  - denominators with a common factor of 360, so sums do
+
+   named type/distribution/operation. */
+template <typename IntT>
+void addMicroKernels(const char *type, int nearBits,
+                     vector<MicroKernel>& out) {
+    typedef BasicRational<IntT> R;
+    typedef MicroOperands<IntT> Ops;
+    static const int PRIMES[16] = { 101, 103, 107, 109, 113, 127, 131, 137,
+                                    139, 149, 151, 157, 163, 167, 173, 179 };
+    const char *dists[4] = { "small", "near", "coprime", "shared" };
+    const size_t n = MICRO_OPS;
+
+    for (int dist = 0; dist < 4; dist++) {
+        shared_ptr<Ops> o(new Ops);
+        for (size_t i = 0; i < n; i++) {
+            int64_t p[4];
+            for (int k = 0; k < 4; k += 2) {
+                int prime = PRIMES[(i + k / 2) % 16];
+                p[k] = dist == 1 ? randomNonzero(nearBits)
+                                 : randomNonzero(dist == 0 ? 7 : 10);
+                p[k + 1] = dist == 0 ? 1 + rand() % 100
+                         : dist == 1 ? llabs(randomNonzero(nearBits))
+                         : dist == 2 ? prime : 360 * (1 + rand() % 12);
+            }
+            o->a.push_back(R(IntT(p[0]), IntT(p[1])));
+            o->b.push_back(R(IntT(p[2]), IntT(p[3])));
+            IntT k(1 + rand() % 1000);
+            if (dist == 1)
+                k = IntT(llabs(randomNonzero(nearBits)));
+            o->num.push_back(o->a.back().num());
+            o->den.push_back(o->a.back().denom());
+            o->scaledNum.push_back(o->num.back() * k);
+            o->scaledDen.push_back(o->den.back() * k);
+        }
+
+        string prefix = string(type) + "/" + dists[dist] + "/";
+        out.push_back(MicroKernel{ prefix + "construct", [o]() {
+            for (size_t i = 0; i < MICRO_OPS; i++)
+                microSink += (int64_t) R(o->num[i], o->den[i]).denom();
+        } });
+        out.push_back(MicroKernel{ prefix + "simplify", [o]() {
+            for (size_t i = 0; i < MICRO_OPS; i++)
+                microSink +=
+                    (int64_t) R(o->scaledNum[i], o->scaledDen[i]).denom();
+        } });
+        out.push_back(MicroKernel{ prefix + "add", [o]() {
+            for (size_t i = 0; i < MICRO_OPS; i++)
+                microSink += (int64_t) (o->a[i] + o->b[i]).denom();
+        } });
+        out.push_back(MicroKernel{ prefix + "sub", [o]() {
+            for (size_t i = 0; i < MICRO_OPS; i++)
+                microSink += (int64_t) (o->a[i] - o->b[i]).denom();
+        } });
+        out.push_back(MicroKernel{ prefix + "mul", [o]() {
+            for (size_t i = 0; i < MICRO_OPS; i++)
+                microSink += (int64_t) (o->a[i] * o->b[i]).denom();
+        } });
+        out.push_back(MicroKernel{ prefix + "div", [o]() {
+            for (size_t i = 0; i < MICRO_OPS; i++)
+                microSink += (int64_t) (o->a[i] / o->b[i]).denom();
+        } });
+        out.push_back(MicroKernel{ prefix + "less", [o]() {
+            for (size_t i = 0; i < MICRO_OPS; i++)
+                microSink += o->a[i] < o->b[i];
+        } });
+        out.push_back(MicroKernel{ prefix + "equal", [o]() {
+            for (size_t i = 0; i < MICRO_OPS; i++)
+                microSink += o->a[i] == o->b[(i + 1) % MICRO_OPS];
+        } });
+        out.push_back(MicroKernel{ prefix + "double", [o]() {
+            for (size_t i = 0; i < MICRO_OPS; i++)
+                microTotal += (double) o->a[i];
+        } });
+        out.push_back(MicroKernel{ prefix + "ostream", [o]() {
+            ostringstream ss;
+            for (size_t i = 0; i < MICRO_OPS; i++) {
+                ss.str("");
+                ss << o->a[i];
+                microSink += ss.tellp();
+            }
+        } });
+    }
+}
+
+/* A fixed workload of integer division, multiplication and small heap
+   allocations, none of it Rational code, that each kernel is timed against
+   so that how fast the machine happens to be running cancels out. */
+void referenceKernel() {
+    uint64_t x = 88172645463325252ULL;
+    for (size_t i = 0; i < MICRO_OPS; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        unique_ptr<uint64_t> p(new uint64_t(x % 1000003));
+        microSink += (int64_t) (x / (*p | 1) * 7);
+    }
+}
+
+/* Runs the kernels from first to last rounds times over, each right after
+   the reference kernel, so that a slow stretch of the machine slows both.
+   Sets ratio to the median ratio of each kernel's time to the reference's,
+   which unlike the least is not thrown by one lucky round, and returns the
+   median time of the reference in ns per operation. */
+double runMicroRounds(const vector<MicroKernel>& kernels, int rounds,
+                      vector<double>& ratio) {
+    vector<vector<double> > ratios(kernels.size());
+    vector<double> refs;
+    for (int r = 0; r < rounds; r++)
+        for (size_t k = 0; k < kernels.size(); k++) {
+            double ref = timeMs(referenceKernel);
+            ratios[k].push_back(timeMs(kernels[k].run) / ref);
+            refs.push_back(ref * 1e6 / MICRO_OPS);
+        }
+
+    ratio.resize(kernels.size());
+    for (size_t k = 0; k < kernels.size(); k++) {
+        sort(ratios[k].begin(), ratios[k].end());
+        ratio[k] = ratios[k][rounds / 2];
+    }
+    sort(refs.begin(), refs.end());
+    return refs[refs.size() / 2];
+}
+
+/* Reads the "name": ns pairs of a file written by benchJson, one per line,
+   the reference among them.  Lines without a number after the name, such
+   as the unit, are skipped. */
+map<string, double> readBaseline(const char *path) {
+    map<string, double> out;
+    ifstream in(path);
+    string line;
+    while (getline(in, line)) {
+        size_t open = line.find('"'), close = line.find('"', open + 1);
+        size_t colon = line.find(':', close);
+        if (open == string::npos || close == string::npos ||
+            colon == string::npos)
+            continue;
+        const char *start = line.c_str() + colon + 1;
+        char *end = NULL;
+        double ns = strtod(start, &end);
+        if (end != start)
+            out[line.substr(open + 1, close - open - 1)] = ns;
+    }
+    return out;
+}
+
+/* Runs the micro benchmarks and prints them as JSON, as ns per operation
+   scaled to the median time of the reference kernel, which is also printed.
+   Given a baseline file, each kernel's time relative to the reference is
+   compared with the baseline's, and one more than MICRO_TOLERANCE times
+   and MICRO_NOISE_NS slower is measured again, up to MICRO_RETRIES times,
+   before it is reported on cerr.  Returns 1 if any still is, or if the
+   baseline could not be read, and 0 otherwise. */
+int benchJson(const char *baselinePath) {
+    srand(13579L);
+    vector<MicroKernel> kernels;
+    addMicroKernels<int32_t>("int32", 14, kernels);
+    addMicroKernels<int64_t>("int64", 30, kernels);
+    addMicroKernels<BigInt>("bigint", 62, kernels);
+
+    vector<double> ratio;
+    double reference = runMicroRounds(kernels, MICRO_ROUNDS, ratio);
+
+    int regressions = 0;
+    map<string, double> baseline;
+    if (baselinePath != NULL) {
+        baseline = readBaseline(baselinePath);
+        if (baseline.count("reference") == 0) {
+            cerr << "No baseline results in " << baselinePath << endl;
+            return 1;
+        }
+    }
+    for (size_t k = 0; k < kernels.size(); k++) {
+        map<string, double>::const_iterator it =
+            baseline.find(kernels[k].name);
+        if (it == baseline.end())
+            continue;
+        double limit = max(it->second * MICRO_TOLERANCE,
+                           it->second + MICRO_NOISE_NS) / baseline["reference"];
+        vector<MicroKernel> one(1, kernels[k]);
+        for (int r = 0; r < MICRO_RETRIES && ratio[k] > limit; r++) {
+            vector<double> again;
+            runMicroRounds(one, MICRO_ROUNDS, again);
+            ratio[k] = again[0];
+        }
+        if (ratio[k] > limit) {
+            cerr << "REGRESSION " << kernels[k].name << ": " << fixed
+                 << setprecision(2) << ratio[k] * reference
+                 << " ns/op, was " << it->second << " against a reference of "
+                 << baseline["reference"] << ", now " << reference << endl;
+            regressions++;
+        }
+    }
+
+    cout << "{" << endl << "  \"unit\": \"ns/op\"," << endl
+         << "  \"reference\": " << fixed << setprecision(2) << reference
+         << "," << endl << "  \"results\": {" << endl;
+    for (size_t k = 0; k < kernels.size(); k++)
+        cout << "    \"" << kernels[k].name << "\": " << ratio[k] * reference
+             << (k + 1 < kernels.size() ? "," : "") << endl;
+    cout << "  }" << endl << "}" << endl;
+
+    if (baselinePath != NULL)
+        cerr << regressions << " of " << kernels.size()
+             << " micro benchmarks regressed more than "
+             << (int) round((MICRO_TOLERANCE - 1) * 100) << "%" << endl;
+    return regressions > 0;
+}
+
+
+/*! Times add, multiply and compare chains and single operations on each
+    integer width, integer operands, sorting, eager against lazy and
+    accumulated sums, batch operations on 10 times as many terms, parallel
+    sums and products of 100 times as many, formatting and parsing,
+    approximating doubles, hashing and removing duplicates, polynomials,
+    exact determinants and solves, and exact linear programs.  The number of
+    chains can be passed as argument.
+
+    With --json as argument, runs only the micro benchmarks and prints ns
+    per operation as JSON, and if a baseline file written that way follows,
+    exits with 1 when any is more than 10% slower than in it. */
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--json") == 0)
+        return benchJson(argc > 2 ? argv[2] : NULL);
+
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+
+    srand(654321L);
+
+    cout << "Benchmarking Rational widths on " << n << " chains." << endl
+         << endl;
+    cout << setw(24) << left << "kernel" << setw(12) << right << "ops"
+         << setw(12) << "ms" << setw(12) << "Mop/s" << endl;
+
+    bench_width<Rational>("int32", n);
+    bench_width<Rational64>("int64", n);
+    bench_width<Rational128>("int128", n);
+    bench_width<BigRational>("bigint", n);
+    bench_width<SafeRational>("safe", n);
+
+    cout << endl << "ns per operation on random operands of the given bits."
+         << endl;
+    bench_ops<Rational>("int32", n, 14);
+    bench_ops<Rational64>("int64", n, 30);
+    bench_ops<Rational128>("int128", n, 62);
+    bench_ops<BigRational>("bigint", n, 62);
+    bench_ops<SafeRational>("safe", n, 30);
+    bench_ops<SafeRational>("safe", n, 62);
+
+    cout << endl;
+    bench_int_ops<Rational64>("int64", n, 30);
+    bench_int_ops<BigRational>("bigint", n, 30);
+
+    cout << endl;
+    bench_sort<Rational>("int32", n, 30);
+    bench_sort<Rational64>("int64", n, 62);
+    bench_sort<Rational128>("int128", n, 62);
+
+    cout << endl;
+    bench_lazy<Rational64, LazyRational64>("int64", n);
+    bench_lazy<Rational128, LazyRational128>("int128", n);
+
+    cout << endl;
+    bench_accumulate<Rational64, RationalAccumulator64>("int64", n);
+    bench_accumulate<Rational128, RationalAccumulator128>("int128", n);
+
+    cout << endl;
+    bench_array(10 * n);
+
+    cout << endl;
+    bench_parallel<Rational>("int32", 100 * n);
+
+    cout << endl;
+    bench_chars(n);
+
+    cout << endl;
+    bench_decimal(n);
+
+    cout << endl;
+    bench_approximate(n);
+
+    cout << endl;
+    bench_dedup(n);
+
+    cout << endl;
+    bench_polynomial(n / 10);
+
+    cout << endl;
+    bench_interval(n / 1000);
+
+    cout << endl;
+    bench_matrix();
+
+    cout << endl;
+    bench_linear_program();
+
+    return 0;
+}
@@ -0,0 +1,927 @@
+/*
+ bigint.cc
+
+ Contains the implementation of the BigInt class defined in bigint.hh.  The
+ magnitude helpers at the top work on bare limb vectors; the class methods
+ below them take care of signs and of the inline representation.
+*/
+
+#include "bigint.hh"
+#include "common.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+
+typedef BigInt::Limbs Limbs;
+
+/******************************
+ MAGNITUDE HELPERS
+ ******************************/
+/*
+ trim
+
+ Removes the most significant zero limbs so that a magnitude has no leading
+ zeros, and zero is the empty vector.
+
+ Arguments:     a (Limbs&) - Magnitude to trim
+
+ Returns:       None.
+*/
+static void trim(Limbs& a) {
+    while (!a.empty() && a.back() == 0)
+        a.pop_back();
+}
+
+/*
+ cmpMag
+
+ Compares two trimmed magnitudes.
+
+ Arguments:     a (Limbs&) - First magnitude
+                b (Limbs&) - Second magnitude
+
+ Returns:       (int) - Negative, zero or positive as a is less than, equal to
+                        or greater than b.
+*/
+static int cmpMag(const Limbs& a, const Limbs& b) {
+    if (a.size() != b.size())
+        return a.size() < b.size() ? -1 : 1;
+    for (size_t i = a.size(); i-- > 0; )
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    return 0;
+}
+
+/*
+ addMag
+
+ Adds two magnitudes.
+
+ Arguments:     a (Limbs&) - First magnitude
+                b (Limbs&) - Second magnitude
+
+ Returns:       (Limbs) - a + b
+*/
+static Limbs addMag(const Limbs& a, const Limbs& b) {
+    const Limbs& lo = a.size() < b.size() ? a : b;
+    const Limbs& hi = a.size() < b.size() ? b : a;
+    Limbs out(hi.size() + 1);
+
+    uint64_t carry = 0;
+    for (size_t i = 0; i < hi.size(); i++) {
+        uint128_t s = (uint128_t) hi[i] + (i < lo.size() ? lo[i] : 0) + carry;
+        out[i] = (uint64_t) s;
+        carry = (uint64_t) (s >> 64);
+    }
+    out[hi.size()] = carry;
+
+    trim(out);
+    return out;
+}
+
+/*
+ subMagInPlace
+
+ Subtracts b from a in place.  a must be at least b.
+
+ Arguments:     a (Limbs&) - Magnitude subtracted from
+                b (Limbs&) - Magnitude subtracted
+
+ Returns:       None.
+*/
+static void subMagInPlace(Limbs& a, const Limbs& b) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        uint64_t x = a[i];
+        uint64_t y = i < b.size() ? b[i] : 0;
+        if (y == 0 && borrow == 0 && i >= b.size())
+            break;
+        uint64_t z = x - y - borrow;
+        borrow = (x < y) || (x - y < borrow);
+        a[i] = z;
+    }
+    trim(a);
+}
+
+/*
+ subMag
+
+ Subtracts two magnitudes.  a must be at least b.
+
+ Arguments:     a (Limbs&) - Magnitude subtracted from
+                b (Limbs&) - Magnitude subtracted
+
+ Returns:       (Limbs) - a - b
+*/
+static Limbs subMag(const Limbs& a, const Limbs& b) {
+    Limbs out(a);
+    subMagInPlace(out, b);
+    return out;
+}
+
+/*
+ addShiftedInPlace
+
+ Adds b, shifted up by the argued number of limbs, into a.  a must be long
+ enough to hold the sum.
+
+ Arguments:     a (Limbs&) - Magnitude added to
+                b (Limbs&) - Magnitude added
+                shift (size_t) - Limbs to shift b by
+
+ Returns:       None.
+*/
+static void addShiftedInPlace(Limbs& a, const Limbs& b, size_t shift) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < b.size(); i++) {
+        uint128_t s = (uint128_t) a[i + shift] + b[i] + carry;
+        a[i + shift] = (uint64_t) s;
+        carry = (uint64_t) (s >> 64);
+    }
+    for (; carry != 0; i++) {
+        uint128_t s = (uint128_t) a[i + shift] + carry;
+        a[i + shift] = (uint64_t) s;
+        carry = (uint64_t) (s >> 64);
+    }
+}
+
+/*
+ mulSchool
+
+ Multiplies two magnitudes the schoolbook way, in O(n * m) limb products.
+
+ Arguments:     a (Limbs&) - First magnitude
+                b (Limbs&) - Second magnitude
+
+ Returns:       (Limbs) - a * b
+*/
+static Limbs mulSchool(const Limbs& a, const Limbs& b) {
+    if (a.empty() || b.empty())
+        return Limbs();
+
+    Limbs out(a.size() + b.size());
+    for (size_t i = 0; i < a.size(); i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < b.size(); j++) {
+            uint128_t p = (uint128_t) a[i] * b[j] + out[i + j] + carry;
+            out[i + j] = (uint64_t) p;
+            carry = (uint64_t) (p >> 64);
+        }
+        out[i + b.size()] = carry;
+    }
+
+    trim(out);
+    return out;
+}
+
+/*
+ mulMag
+
+ Multiplies two magnitudes.  Once both are at least KARATSUBA_LIMBS long they
+ are split in halves at m limbs, a = a1 B^m + a0 and b = b1 B^m + b0, and the
+ product is assembled from three half size products:
+
+    a b = z2 B^2m + (z1 - z2 - z0) B^m + z0
+
+ where z0 = a0 b0, z2 = a1 b1 and z1 = (a0 + a1)(b0 + b1).
+
+ Arguments:     a (Limbs&) - First magnitude
+                b (Limbs&) - Second magnitude
+
+ Returns:       (Limbs) - a * b
+*/
+static Limbs mulMag(const Limbs& a, const Limbs& b) {
+    if (std::min(a.size(), b.size()) < BigInt::KARATSUBA_LIMBS)
+        return mulSchool(a, b);
+
+    size_t m = std::max(a.size(), b.size()) / 2;
+    Limbs a0(a.begin(), a.begin() + std::min(m, a.size()));
+    Limbs a1(a.begin() + std::min(m, a.size()), a.end());
+    Limbs b0(b.begin(), b.begin() + std::min(m, b.size()));
+    Limbs b1(b.begin() + std::min(m, b.size()), b.end());
+    trim(a0);
+    trim(b0);
+
+    Limbs z0 = mulMag(a0, b0);
+    Limbs z2 = mulMag(a1, b1);
+    Limbs z1 = mulMag(addMag(a0, a1), addMag(b0, b1));
+    subMagInPlace(z1, z0);
+    subMagInPlace(z1, z2);
+
+    Limbs out(a.size() + b.size() + 1);
+    addShiftedInPlace(out, z0, 0);
+    addShiftedInPlace(out, z1, m);
+    addShiftedInPlace(out, z2, 2 * m);
+
+    trim(out);
+    return out;
+}
+
+/*
+ shlMag, shrMagInPlace
+
+ Shift a magnitude up or down by the argued number of bits.
+
+ Arguments:     a (Limbs&) - Magnitude to shift
+                bits (size_t) - Bits to shift by
+
+ Returns:       (Limbs) - a << bits, for shlMag
+*/
+static Limbs shlMag(const Limbs& a, size_t bits) {
+    if (a.empty())
+        return Limbs();
+
+    size_t limbs = bits / 64, s = bits % 64;
+    Limbs out(a.size() + limbs + 1);
+    for (size_t i = 0; i < a.size(); i++) {
+        out[i + limbs] |= a[i] << s;
+        if (s != 0)
+            out[i + limbs + 1] = a[i] >> (64 - s);
+    }
+
+    trim(out);
+    return out;
+}
+
+static void shrMagInPlace(Limbs& a, size_t bits) {
+    size_t limbs = bits / 64, s = bits % 64;
+    if (limbs >= a.size()) {
+        a.clear();
+        return;
+    }
+
+    size_t n = a.size() - limbs;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t lo = a[i + limbs] >> s;
+        uint64_t hi = (s != 0 && i + limbs + 1 < a.size()) ?
+            a[i + limbs + 1] << (64 - s) : 0;
+        a[i] = lo | hi;
+    }
+    a.resize(n);
+    trim(a);
+}
+
+/*
+ divModSmall
+
+ Divides a magnitude by a single limb in place.
+
+ Arguments:     a (Limbs&) - Magnitude divided, replaced with the quotient
+                d (uint64_t) - Nonzero divisor
+
+ Returns:       (uint64_t) - The remainder.
+*/
+static uint64_t divModSmall(Limbs& a, uint64_t d) {
+    uint64_t rem = 0;
+    for (size_t i = a.size(); i-- > 0; ) {
+        uint128_t cur = ((uint128_t) rem << 64) | a[i];
+        a[i] = (uint64_t) (cur / d);
+        rem = (uint64_t) (cur % d);
+    }
+    trim(a);
+    return rem;
+}
+
+/*
+ divModMag
+
+ Divides two magnitudes with Knuth's algorithm D (TAOCP vol. 2, 4.3.1).  The
+ divisor is normalized so its top limb has its high bit set, which keeps each
+ estimated quotient limb at most two too large.
+
+ Arguments:     u (Limbs&) - Dividend
+                v (Limbs&) - Nonzero divisor
+                q (Limbs&) - Set to the quotient
+                r (Limbs&) - Set to the remainder
+
+ Returns:       None.
+*/
+static void divModMag(const Limbs& u, const Limbs& v, Limbs& q, Limbs& r) {
+    if (cmpMag(u, v) < 0) {
+        q.clear();
+        r = u;
+        return;
+    }
+    if (v.size() == 1) {
+        q = u;
+        uint64_t rem = divModSmall(q, v[0]);
+        r.assign(rem != 0 ? 1 : 0, rem);
+        return;
+    }
+
+    size_t n = v.size(), m = u.size() - n;
+    unsigned s = __builtin_clzll(v.back());
+    Limbs vn = shlMag(v, s);
+    Limbs un = shlMag(u, s);
+    un.resize(u.size() + 1);
+    q.assign(m + 1, 0);
+
+    for (size_t j = m + 1; j-- > 0; ) {
+        // Estimate the quotient limb from the top two limbs of the remainder
+        uint128_t num = ((uint128_t) un[j + n] << 64) | un[j + n - 1];
+        uint128_t qhat = num / vn[n - 1];
+        uint128_t rhat = num % vn[n - 1];
+        while (qhat >> 64 != 0 ||
+               qhat * vn[n - 2] > ((rhat << 64) | un[j + n - 2])) {
+            qhat--;
+            rhat += vn[n - 1];
+            if (rhat >> 64 != 0)
+                break;
+        }
+
+        // Multiply and subtract
+        uint64_t borrow = 0, carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint128_t p = qhat * vn[i] + carry;
+            carry = (uint64_t) (p >> 64);
+            uint64_t x = un[i + j], y = (uint64_t) p;
+            un[i + j] = x - y - borrow;
+            borrow = (x < y) || (x - y < borrow);
+        }
+        uint64_t x = un[j + n];
+        un[j + n] = x - carry - borrow;
+        bool negative = (x < carry) || (x - carry < borrow);
+
+        // The estimate was one too large, so add the divisor back
+        if (negative) {
+            qhat--;
+            uint64_t c = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint128_t t = (uint128_t) un[i + j] + vn[i] + c;
+                un[i + j] = (uint64_t) t;
+                c = (uint64_t) (t >> 64);
+            }
+            un[j + n] += c;
+        }
+        q[j] = (uint64_t) qhat;
+    }
+
+    trim(q);
+    un.resize(n);
+    shrMagInPlace(un, s);
+    r = un;
+}
+
+/*
+ ctzMag
+
+ Counts the trailing zero bits of a nonzero magnitude.
+
+ Arguments:     a (Limbs&) - Nonzero magnitude
+
+ Returns:       (size_t) - Number of trailing zero bits.
+*/
+static size_t ctzMag(const Limbs& a) {
+    size_t i = 0;
+    while (a[i] == 0)
+        i++;
+    return 64 * i + __builtin_ctzll(a[i]);
+}
+
+/*
+ gcd64
+
+ Binary GCD of two 64-bit magnitudes.
+
+ Arguments:     a (uint64_t) - First value
+                b (uint64_t) - Second value
+
+ Returns:       (uint64_t) - Greatest common divisor of a and b
+*/
+static uint64_t gcd64(uint64_t a, uint64_t b) {
+    if (a == 0)
+        return b;
+    if (b == 0)
+        return a;
+
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b != 0) {
+        b >>= __builtin_ctzll(b);
+        if (a > b)
+            std::swap(a, b);
+        b -= a;
+    }
+    return a << shift;
+}
+
+/******************************
+ PRIVATE METHODS
+ ******************************/
+/*
+ Magnitude constructor
+
+ Builds a BigInt from a sign and a magnitude, taking the magnitude's storage.
+ Values that fit in an int64_t are stored inline.
+
+ Arguments:     neg (bool) - True if the value is negative
+                mag (Limbs&) - Magnitude, swapped out
+
+ Returns:       None.
+*/
+BigInt::BigInt(bool neg, Limbs& mag) : m_small(0), m_neg(false) {
+    trim(mag);
+    if (mag.empty())
+        return;
+
+    const uint64_t MIN_MAG = (uint64_t) 1 << 63;
+    if (mag.size() == 1 && (mag[0] < MIN_MAG || (neg && mag[0] == MIN_MAG))) {
+        m_small = neg ? (int64_t) -mag[0] : (int64_t) mag[0];
+        return;
+    }
+
+    m_neg = neg;
+    m_limbs.swap(mag);
+}
+
+/*
+ magnitude
+
+ Returns the magnitude of this BigInt as limbs, whichever way it is stored.
+
+ Arguments:     None.
+
+ Returns:       (Limbs) - The magnitude.
+*/
+BigInt::Limbs BigInt::magnitude() const {
+    if (!m_limbs.empty())
+        return m_limbs;
+    if (m_small == 0)
+        return Limbs();
+    return Limbs(1, m_small < 0 ? -(uint64_t) m_small : (uint64_t) m_small);
+}
+
+/*
+ negative
+
+ Returns true if this BigInt is less than zero.
+
+ Arguments:     None.
+
+ Returns:       (bool) - True if negative.
+*/
+bool BigInt::negative() const {
+    return m_limbs.empty() ? m_small < 0 : m_neg;
+}
+
+/******************************
+ CONSTRUCTORS
+ ******************************/
+BigInt::BigInt() : m_small(0), m_neg(false) {}
+BigInt::BigInt(int64_t n) : m_small(n), m_neg(false) {}
+
+/*
+ String constructor
+
+ Parses an optionally signed string of decimal digits.
+
+ Arguments:     s (string&) - Digits to parse
+
+ Returns:       None.
+
+ Global Impact: Throws invalid_argument if s is not a decimal integer.
+*/
+BigInt::BigInt(const string& s) : m_small(0), m_neg(false) {
+    size_t i = (s.size() > 0 && (s[0] == '-' || s[0] == '+')) ? 1 : 0;
+    if (i == s.size())
+        throw invalid_argument("BigInt needs at least one digit.");
+
+    // Fold in up to 18 digits at a time
+    Limbs mag;
+    while (i < s.size()) {
+        uint64_t chunk = 0, scale = 1;
+        for (int k = 0; k < 18 && i < s.size(); k++, i++) {
+            if (s[i] < '0' || s[i] > '9')
+                throw invalid_argument("BigInt digits must be 0-9.");
+            chunk = 10 * chunk + (s[i] - '0');
+            scale *= 10;
+        }
+
+        uint64_t carry = chunk;
+        for (size_t j = 0; j < mag.size(); j++) {
+            uint128_t p = (uint128_t) mag[j] * scale + carry;
+            mag[j] = (uint64_t) p;
+            carry = (uint64_t) (p >> 64);
+        }
+        if (carry != 0)
+            mag.push_back(carry);
+    }
+
+    *this = BigInt(s[0] == '-', mag);
+}
+
+/******************************
+ ACCESSORS
+ ******************************/
+/*
+ isSmall
+
+ Returns true if this BigInt fits in an int64_t and so is stored inline.
+
+ Arguments:     None.
+
+ Returns:       (bool) - True if stored inline.
+*/
+bool BigInt::isSmall() const {
+    return m_limbs.empty();
+}
+
+/*
+ sign
+
+ Returns the sign of this BigInt.
+
+ Arguments:     None.
+
+ Returns:       (int) - 1 if positive, 0 if 0 and -1 if negative.
+*/
+int BigInt::sign() const {
+    if (m_limbs.empty())
+        return m_small > 0 ? 1 : (m_small < 0 ? -1 : 0);
+    return m_neg ? -1 : 1;
+}
+
+/*
+ bits
+
+ Returns the number of bits in the magnitude of this BigInt, which is 0 for 0.
+
+ Arguments:     None.
+
+ Returns:       (size_t) - Bit length of the magnitude.
+*/
+size_t BigInt::bits() const {
+    Limbs mag = magnitude();
+    if (mag.empty())
+        return 0;
+    return 64 * mag.size() - __builtin_clzll(mag.back());
+}
+
+/*
+ hash
+
+ Folds this BigInt into 64 bits for hashing.  Inline values fold to
+ themselves, as foldInt does for the built in integers, and the limbs of
+ larger ones are mixed in one at a time from the most significant.
+
+ Arguments:     None.
+
+ Returns:       (uint64_t) - The folded value.
+*/
+uint64_t BigInt::hash() const {
+    if (m_limbs.empty())
+        return (uint64_t) m_small;
+
+    uint64_t h = m_neg ? 1 : 0;
+    for (size_t i = m_limbs.size(); i-- > 0;)
+        h = mix64(h) ^ m_limbs[i];
+    return mix64(h);
+}
+
+/*
+ toString
+
+ Returns the decimal digits of this BigInt, with a leading '-' if negative.
+
+ Arguments:     None.
+
+ Returns:       (string) - The value in decimal.
+*/
+string BigInt::toString() const {
+    if (m_limbs.empty())
+        return to_string((long long) m_small);
+
+    // Peel off 19 digits at a time, least significant first
+    const uint64_t CHUNK = 10000000000000000000ull;
+    Limbs mag = m_limbs;
+    string out;
+    while (!mag.empty()) {
+        uint64_t rem = divModSmall(mag, CHUNK);
+        for (int k = 0; k < 19 && (rem != 0 || !mag.empty()); k++) {
+            out.push_back('0' + (char) (rem % 10));
+            rem /= 10;
+        }
+    }
+    if (m_neg)
+        out.push_back('-');
+
+    reverse(out.begin(), out.end());
+    return out;
+}
+
+/******************************
+ OPERATORS
+ ******************************/
+/*
+ unary negation
+
+ Returns the negation of this BigInt.
+
+ Arguments:     None.
+
+ Returns:       (BigInt) - -1 * this BigInt.
+*/
+const BigInt BigInt::operator-() const {
+    if (m_limbs.empty() && m_small != INT64_MIN)
+        return BigInt(-m_small);
+
+    Limbs mag = magnitude();
+    return BigInt(!negative(), mag);
+}
+
+/*
+ Add
+
+ Returns the sum of two BigInts.  If both are inline and the sum fits, no
+ limbs are touched.
+
+ Arguments:     a (BigInt&) - Left operand
+                b (BigInt&) - Right operand
+
+ Returns:       (BigInt) - a + b
+*/
+const BigInt operator+(const BigInt& a, const BigInt& b) {
+    int64_t sum;
+    if (a.isSmall() && b.isSmall() &&
+        !__builtin_add_overflow(a.m_small, b.m_small, &sum))
+        return BigInt(sum);
+
+    Limbs x = a.magnitude(), y = b.magnitude();
+    bool an = a.negative(), bn = b.negative();
+    Limbs out;
+    if (an == bn) {
+        out = addMag(x, y);
+        return BigInt(an, out);
+    }
+
+    // Signs differ, so subtract the smaller magnitude from the larger
+    if (cmpMag(x, y) >= 0) {
+        out = subMag(x, y);
+        return BigInt(an, out);
+    }
+    out = subMag(y, x);
+    return BigInt(bn, out);
+}
+
+/*
+ Subtract
+
+ Returns the difference of two BigInts.
+
+ Arguments:     a (BigInt&) - Left operand
+                b (BigInt&) - Right operand
+
+ Returns:       (BigInt) - a - b
+*/
+const BigInt operator-(const BigInt& a, const BigInt& b) {
+    int64_t diff;
+    if (a.isSmall() && b.isSmall() &&
+        !__builtin_sub_overflow(a.m_small, b.m_small, &diff))
+        return BigInt(diff);
+
+    return a + -b;
+}
+
+/*
+ Multiply
+
+ Returns the product of two BigInts.
+
+ Arguments:     a (BigInt&) - Left operand
+                b (BigInt&) - Right operand
+
+ Returns:       (BigInt) - a * b
+*/
+const BigInt operator*(const BigInt& a, const BigInt& b) {
+    int64_t prod;
+    if (a.isSmall() && b.isSmall() &&
+        !__builtin_mul_overflow(a.m_small, b.m_small, &prod))
+        return BigInt(prod);
+
+    Limbs out = mulMag(a.magnitude(), b.magnitude());
+    return BigInt(a.negative() != b.negative(), out);
+}
+
+/*
+ Divide
+
+ Returns the quotient of two BigInts, truncated toward zero.
+
+ Arguments:     a (BigInt&) - Dividend
+                b (BigInt&) - Divisor
+
+ Returns:       (BigInt) - a / b
+
+ Global Impact: Throws invalid_argument if b is 0.
+*/
+const BigInt operator/(const BigInt& a, const BigInt& b) {
+    if (b.sign() == 0)
+        throw invalid_argument("BigInt division by zero.");
+    if (a.isSmall() && b.isSmall() &&
+        !(a.m_small == INT64_MIN && b.m_small == -1))
+        return BigInt(a.m_small / b.m_small);
+
+    Limbs q, r;
+    divModMag(a.magnitude(), b.magnitude(), q, r);
+    return BigInt(a.negative() != b.negative(), q);
+}
+
+/*
+ Remainder
+
+ Returns the remainder of two BigInts, which takes the sign of the dividend.
+
+ Arguments:     a (BigInt&) - Dividend
+                b (BigInt&) - Divisor
+
+ Returns:       (BigInt) - a % b
+
+ Global Impact: Throws invalid_argument if b is 0.
+*/
+const BigInt operator%(const BigInt& a, const BigInt& b) {
+    if (b.sign() == 0)
+        throw invalid_argument("BigInt division by zero.");
+    if (a.isSmall() && b.isSmall())
+        return BigInt(b.m_small == -1 ? 0 : a.m_small % b.m_small);
+
+    Limbs q, r;
+    divModMag(a.magnitude(), b.magnitude(), q, r);
+    return BigInt(a.negative(), r);
+}
+
+BigInt& BigInt::operator+=(const BigInt& b) { return *this = *this + b; }
+BigInt& BigInt::operator-=(const BigInt& b) { return *this = *this - b; }
+BigInt& BigInt::operator*=(const BigInt& b) { return *this = *this * b; }
+BigInt& BigInt::operator/=(const BigInt& b) { return *this = *this / b; }
+BigInt& BigInt::operator%=(const BigInt& b) { return *this = *this % b; }
+
+/******************************
+ COMPARATORS
+ ******************************/
+/*
+ compare
+
+ Compares two BigInts.
+
+ Arguments:     a (BigInt&) - First value
+                b (BigInt&) - Second value
+
+ Returns:       (int) - Negative, zero or positive as a is less than, equal to
+                        or greater than b.
+*/
+int compare(const BigInt& a, const BigInt& b) {
+    if (a.isSmall() && b.isSmall())
+        return a.m_small < b.m_small ? -1 : (a.m_small > b.m_small ? 1 : 0);
+
+    // A large value is beyond every inline one, so signs decide first
+    int as = a.sign(), bs = b.sign();
+    if (as != bs)
+        return as < bs ? -1 : 1;
+    int mag = cmpMag(a.magnitude(), b.magnitude());
+    return as < 0 ? -mag : mag;
+}
+
+/******************************
+ EXPLICIT CASTING
+ ******************************/
+/*
+ double converter
+
+ Converts the BigInt into the nearest double, or infinity if it is too large.
+
+ Arguments:     None.
+
+ Returns:       (double) - The BigInt as a double.
+*/
+BigInt::operator double() const {
+    if (m_limbs.empty())
+        return (double) m_small;
+
+    // The top two limbs hold every bit a double can keep
+    size_t n = m_limbs.size();
+    if (n == 1)
+        return m_neg ? -(double) m_limbs[0] : (double) m_limbs[0];
+    double top = ldexp((double) m_limbs[n - 1], 64) + (double) m_limbs[n - 2];
+    double out = ldexp(top, 64 * (int) (n - 2));
+    return m_neg ? -out : out;
+}
+
+/*
+ int64_t converter
+
+ Converts the BigInt into an int64_t, keeping the low 64 bits in two's
+ complement if it does not fit.
+
+ Arguments:     None.
+
+ Returns:       (int64_t) - The BigInt as an int64_t.
+*/
+BigInt::operator int64_t() const {
+    if (m_limbs.empty())
+        return m_small;
+    return (int64_t) (m_neg ? -m_limbs[0] : m_limbs[0]);
+}
+
+/******************************
+ NUMBER THEORY
+ ******************************/
+/*
+ GCD
+
+ Computes the greatest common divisor of two BigInts.  While the magnitudes
+ differ in length by more than a limb, a Euclidean step shrinks the larger by
+ at least a limb at once.  Otherwise binary steps strip factors of two and
+ subtract, until both fit a single limb and the 64-bit binary GCD finishes.
+
+ Arguments:     a (BigInt&) - First value to find GCD of
+                b (BigInt&) - Second value to find GCD of
+
+ Returns:       GCD (BigInt) - Greatest common divisor of a and b, which is
+                               never negative.
+*/
+BigInt GCD(const BigInt& a, const BigInt& b) {
+    Limbs x = a.magnitude(), y = b.magnitude();
+    if (x.empty())
+        return BigInt(false, y);
+    if (y.empty())
+        return BigInt(false, x);
+
+    // Factors of two common to both come back at the end.  With x odd the
+    // rest of the GCD is odd, so twos can be stripped from y at will.
+    size_t shift = std::min(ctzMag(x), ctzMag(y));
+    shrMagInPlace(x, ctzMag(x));
+
+    while (!y.empty()) {
+        shrMagInPlace(y, ctzMag(y));
+        if (x.size() == 1 && y.size() == 1) {
+            x[0] = gcd64(x[0], y[0]);
+            break;
+        }
+
+        // Far apart in length, so reduce the longer modulo the shorter
+        if (x.size() > y.size() + 1 || y.size() > x.size() + 1) {
+            if (x.size() > y.size())
+                x.swap(y);
+            Limbs q, r;
+            divModMag(y, x, q, r);
+            y.swap(r);
+            continue;
+        }
+
+        // Both odd, so their difference is even and is stripped next time
+        if (cmpMag(x, y) > 0)
+            x.swap(y);
+        subMagInPlace(y, x);
+    }
+
+    Limbs g = shlMag(x, shift);
+    return BigInt(false, g);
+}
+
+/*
+ ratioToDouble
+
+ Computes n / d as a double without converting either to a double first, so
+ that quotients of values beyond the range of double are still finite.
+
+ Arguments:     n (BigInt&) - Numerator
+                d (BigInt&) - Nonzero denominator
+
+ Returns:       (double) - The nearest double to n / d.
+*/
+double ratioToDouble(const BigInt& n, const BigInt& d) {
+    if (n.isSmall() && d.isSmall())
+        return (double) n.m_small / (double) d.m_small;
+
+    // Keep the top 64 bits of each and scale the quotient back
+    Limbs x = n.magnitude(), y = d.magnitude();
+    long nb = (long) n.bits(), db = (long) d.bits();
+    long xs = std::max(nb - 64, 0L), ys = std::max(db - 64, 0L);
+    shrMagInPlace(x, xs);
+    shrMagInPlace(y, ys);
+
+    double q = (x.empty() ? 0.0 : (double) x[0]) / (double) y[0];
+    q = ldexp(q, (int) (xs - ys));
+    return n.negative() != d.negative() ? -q : q;
+}
+
+/******************************
+ STREAM OUTPUT
+ ******************************/
+/*
+ ostream operator
+
+ Outputs the BigInt onto ostream in decimal.
+
+ Arguments:     out (ostream&) - Stream to write to
+                val (BigInt&) - Value to write
+
+ Returns:       (ostream) - The ostream that the BigInt is output onto
+*/
+ostream& operator<<(ostream& out, const BigInt& val) {
+    return out << val.toString();
+}
@@ -0,0 +1,166 @@
+/*
+ bigint.hh
+
+ Contains the BigInt class definition, an arbitrary precision integer used as
+ the backend of BigRational.
+*/
+
+#ifndef BIGINT
+#define BIGINT
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/*
+ BigInt Class
+
+ Emulates integers of any size.  Values that fit in an int64_t are kept inline
+ in m_small and never touch the heap; anything larger is kept as a sign and a
+ magnitude of 64-bit limbs, least significant first.  Every result is
+ normalized back to the inline form when it fits, so that the inline fast path
+ is taken whenever it can be.
+
+ Multiplication is schoolbook below KARATSUBA_LIMBS limbs and Karatsuba above,
+ division is Knuth's algorithm D, and GCD is binary with a Euclidean step
+ whenever the operands differ in length by more than a limb.  Division and
+ remainder truncate toward zero like the built in integers.
+*/
+class BigInt {
+public:
+    typedef std::vector<uint64_t> Limbs;
+
+    /* Operands at least this many limbs long are multiplied by Karatsuba. */
+    static const size_t KARATSUBA_LIMBS = 32;
+
+private:
+    /******************************
+     MEMBERS
+     ******************************/
+    int64_t m_small;                        // Value when m_limbs is empty
+    bool m_neg;                             // Sign when m_limbs isn't empty
+    Limbs m_limbs;                          // Magnitude of large values
+
+    /******************************
+     PRIVATE METHODS
+     ******************************/
+    BigInt(bool neg, Limbs& mag);           // Takes over a magnitude
+    Limbs magnitude() const;                // Magnitude as limbs
+    bool negative() const;                  // True if less than 0
+
+public:
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+    BigInt();                               // Initializes to 0
+    BigInt(int64_t n);                      // Initializes to n
+    explicit BigInt(const std::string& s);  // Parses decimal digits
+
+    /******************************
+     ACCESSORS
+     ******************************/
+    bool isSmall() const;                   // True if stored inline
+    int sign() const;                       // -1, 0 or 1
+    size_t bits() const;                    // Bits in the magnitude
+    uint64_t hash() const;                  // Folded into 64 bits
+    std::string toString() const;           // Decimal digits
+
+    /******************************
+     OPERATORS
+     ******************************/
+    const BigInt operator-() const;                     // Unary negation
+    BigInt& operator+=(const BigInt& b);                // Add
+    BigInt& operator-=(const BigInt& b);                // Subtract
+    BigInt& operator*=(const BigInt& b);                // Multiply
+    BigInt& operator/=(const BigInt& b);                // Divide
+    BigInt& operator%=(const BigInt& b);                // Remainder
+
+    friend const BigInt operator+(const BigInt& a, const BigInt& b);
+    friend const BigInt operator-(const BigInt& a, const BigInt& b);
+    friend const BigInt operator*(const BigInt& a, const BigInt& b);
+    friend const BigInt operator/(const BigInt& a, const BigInt& b);
+    friend const BigInt operator%(const BigInt& a, const BigInt& b);
+
+    /******************************
+     COMPARATORS
+     ******************************/
+    friend int compare(const BigInt& a, const BigInt& b);
+
+    /******************************
+     EXPLICIT CASTING
+     ******************************/
+    explicit operator double() const;                   // Nearest double
+    explicit operator int64_t() const;                  // Low 64 bits
+
+    /******************************
+     NUMBER THEORY
+     ******************************/
+    friend BigInt GCD(const BigInt& a, const BigInt& b);
+    friend double ratioToDouble(const BigInt& n, const BigInt& d);
+};
+
+/******************************
+ COMPARATORS
+ ******************************/
+inline bool operator==(const BigInt& a, const BigInt& b) {
+    return compare(a, b) == 0;
+}
+inline bool operator!=(const BigInt& a, const BigInt& b) {
+    return compare(a, b) != 0;
+}
+inline bool operator<(const BigInt& a, const BigInt& b) {
+    return compare(a, b) < 0;
+}
+inline bool operator>(const BigInt& a, const BigInt& b) {
+    return compare(a, b) > 0;
+}
+inline bool operator<=(const BigInt& a, const BigInt& b) {
+    return compare(a, b) <= 0;
+}
+inline bool operator>=(const BigInt& a, const BigInt& b) {
+    return compare(a, b) >= 0;
+}
+
+/******************************
+ HASHING
+ ******************************/
+/* Folds a BigInt into 64 bits as foldInt in common.hh does the built in
+   integers, so that equal values that fit in an int64_t fold the same. */
+inline uint64_t foldInt(const BigInt& b) { return b.hash(); }
+
+/******************************
+ CHECKED ARITHMETIC
+ ******************************/
+/* BigInt never overflows, so the checked operations Rational uses on its
+   wide type are plain arithmetic. */
+inline BigInt checkedAdd(const BigInt& a, const BigInt& b) { return a + b; }
+inline BigInt checkedSub(const BigInt& a, const BigInt& b) { return a - b; }
+inline BigInt checkedMul(const BigInt& a, const BigInt& b) { return a * b; }
+
+/* Cross products of BigInts are always exact, but cost a multiplication each,
+   so opposite signs and equal denominators are decided without them, and
+   inline values multiply in 128 bits. */
+inline int compareCross(const BigInt& a, const BigInt& b, const BigInt& c,
+                        const BigInt& d) {
+    if (a.isSmall() && b.isSmall() && c.isSmall() && d.isSmall()) {
+        __extension__ typedef __int128 Wide;
+        Wide ad = (Wide) (int64_t) a * (int64_t) d;
+        Wide cb = (Wide) (int64_t) c * (int64_t) b;
+        return (cb < ad) - (ad < cb);
+    }
+
+    int sa = a.sign(), sc = c.sign();
+    if (sa != sc)
+        return sa < sc ? -1 : 1;
+    if (b == d)
+        return compare(a, c);
+    return compare(a * d, c * b);
+}
+
+/******************************
+ STREAM OUTPUT
+ ******************************/
+std::ostream& operator<<(std::ostream& out, const BigInt& val);
+
+#endif // ifndef BIGINT
@@ -10,18 +10,105 @@
 #ifndef COMMON
 #define COMMON
 
+#include <stdexcept>
+#include <stdint.h>
+
+/* 128-bit integers are a GCC extension. */
+__extension__ typedef __int128 int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+
+/*
+ UnsignedOf
+
+ Gives the unsigned type of the same width as each signed integer type, which
+ std::make_unsigned does not do for 128-bit integers outside of GNU mode.
+*/
+template <typename T> struct UnsignedOf;
+template <> struct UnsignedOf<int32_t>  { typedef uint32_t type; };
+template <> struct UnsignedOf<int64_t>  { typedef uint64_t type; };
+template <> struct UnsignedOf<int128_t> { typedef uint128_t type; };
+
+/*
+ ctz
+
+ Counts the trailing zero bits of a nonzero unsigned integer.
+
+ Arguments:     x (unsigned) - Nonzero value
+
+ Returns:       (int) - Number of trailing zero bits.
+*/
+static constexpr int ctz(uint32_t x) { return __builtin_ctz(x); }
+static constexpr int ctz(uint64_t x) { return __builtin_ctzll(x); }
+static constexpr int ctz(uint128_t x) {
+    uint64_t lo = (uint64_t) x;
+    return lo != 0 ? __builtin_ctzll(lo) : 64 + __builtin_ctzll(x >> 64);
+}
+
+/*
+ binaryGCD
+
+ Computes the greatest common divisor of two unsigned values with the binary
+ (Stein) algorithm.  Factors of two common to both are counted up front, and
+ then the smaller odd value is repeatedly subtracted from the larger, with the
+ trailing zeros of the difference shifted out using ctz.  No division is
+ needed.  128-bit values that fit in 64 bits take the 64-bit loop.
+
+ Arguments:     x (U) - First value to find GCD of
+                y (U) - Second value to find GCD of
+
+ Returns:       (U) - Greatest common divisor of x and y
+*/
+template <typename U>
+static constexpr U binaryGCD(U x, U y) {
+    if (x == 0)
+        return y;
+    if (y == 0)
+        return x;
+
+    int shift = ctz((U) (x | y));
+    x >>= ctz(x);
+    int yz = ctz(y);
+    for (;;) {
+        // The difference has the same trailing zeros whichever way round it
+        // is taken, so its ctz starts before the comparison is resolved, and
+        // the selects compile to conditional moves rather than branches
+        y >>= yz;
+        U diff = y - x;
+        if (diff == 0)
+            break;
+        yz = ctz(diff);
+        bool less = y < x;
+        U neg = x - y;
+        x = less ? y : x;
+        y = less ? neg : diff;
+    }
+
+    return x << shift;
+}
+
+static constexpr uint128_t binaryGCD(uint128_t x, uint128_t y) {
+    if ((x | y) >> 64 == 0)
+        return binaryGCD<uint64_t>((uint64_t) x, (uint64_t) y);
+    return binaryGCD<uint128_t>(x, y);
+}
+
 /*
  GCD
 
  Computes the greatest common divisor of the two inputs.
 
- Arguments:     a (int) - First value to find GCD of
-                b (int) - Second value to find GCD of
+ Arguments:     a (T) - First value to find GCD of
+                b (T) - Second value to find GCD of
 
- Returns:       GCD (int) - Greatest common divisor of a and b
+ Returns:       GCD (T) - Greatest common divisor of a and b, which is never
+                          negative.
 */
-static int GCD(int a, int b) {
-    return b == 0 ? a : GCD(b, a%b);
+template <typename T>
+static constexpr T GCD(T a, T b) {
+    typedef typename UnsignedOf<T>::type U;
+    U x = a < 0 ? -(U) a : (U) a;
+    U y = b < 0 ? -(U) b : (U) b;
+    return (T) binaryGCD(x, y);
 }
 
 /*
@@ -30,12 +117,204 @@ static int GCD(int a, int b) {
  Computes the sign of the argued integer.  It returns 1 if positive, 0 if 0
  and -1 otherwise.
 
- Arguments:     n (int) - The value to return the sign of.
+ Arguments:     n (T) - The value to return the sign of.
 
  Returns:       (int) - The sign of the argument.
 */
-static int sign(int n) {
+template <typename T>
+static constexpr int sign(T n) {
     return (n > 0 ? 1 : (n < 0 ? -1 : 0));
 }
 
+/*
+ checkedAdd, checkedSub, checkedMul
+
+ Add, subtract or multiply two integers, throwing overflow_error if the result
+ does not fit in their type.
+
+ Arguments:     a (T) - Left operand
+                b (T) - Right operand
+
+ Returns:       (T) - The exact result.
+*/
+template <typename T>
+static constexpr T checkedAdd(T a, T b) {
+    T out = 0;
+    if (__builtin_add_overflow(a, b, &out))
+        throw std::overflow_error("Integer overflow in Rational arithmetic.");
+    return out;
+}
+
+template <typename T>
+static constexpr T checkedSub(T a, T b) {
+    T out = 0;
+    if (__builtin_sub_overflow(a, b, &out))
+        throw std::overflow_error("Integer overflow in Rational arithmetic.");
+    return out;
+}
+
+template <typename T>
+static constexpr T checkedMul(T a, T b) {
+    T out = 0;
+    if (__builtin_mul_overflow(a, b, &out))
+        throw std::overflow_error("Integer overflow in Rational arithmetic.");
+    return out;
+}
+
+/*
+ compareCross
+
+ Compares a/b with c/d, where b and d are positive, exactly.  Opposite signs
+ and equal denominators are decided without multiplying.  Otherwise the cross
+ products a*d and c*b are compared when they fit T, and when they don't the
+ fractions are compared by their continued fraction expansions instead: equal
+ integer parts leave remainders r/b and s/d, which compare as d/s and b/r do.
+
+ Arguments:     a (T) - First numerator
+                b (T) - First denominator, positive
+                c (T) - Second numerator
+                d (T) - Second denominator, positive
+
+ Returns:       (int) - -1, 0 or 1 as a/b is less than, equal to or greater
+                        than c/d.
+*/
+template <typename T>
+static constexpr int compareCross(T a, T b, T c, T d) {
+    int sa = sign(a), sc = sign(c);
+    if (sa != sc)
+        return sa < sc ? -1 : 1;
+    if (b == d)
+        return (c < a) - (a < c);
+
+    T ad = 0, cb = 0;
+    if (!__builtin_mul_overflow(a, d, &ad) &&
+        !__builtin_mul_overflow(c, b, &cb))
+        return (cb < ad) - (ad < cb);
+
+    // Negative fractions compare as their magnitudes in reverse
+    int dir = sa;
+    typedef typename UnsignedOf<T>::type U;
+    U n1 = a < 0 ? -(U) a : (U) a, d1 = (U) b;
+    U n2 = c < 0 ? -(U) c : (U) c, d2 = (U) d;
+    for (;;) {
+        U q1 = n1 / d1, q2 = n2 / d2;
+        if (q1 != q2)
+            return q1 < q2 ? -dir : dir;
+
+        U r1 = n1 % d1, r2 = n2 % d2;
+        if (r1 == 0 || r2 == 0)
+            return r1 == r2 ? 0 : (r1 == 0 ? -dir : dir);
+
+        // r1/d1 < r2/d2 exactly when d2/r2 < d1/r1
+        U t = d1;
+        n1 = d2;
+        d1 = r2;
+        n2 = t;
+        d2 = r1;
+    }
+}
+
+/*
+ ratioToDouble
+
+ Computes n / d as a double.
+
+ Arguments:     n (T) - Numerator
+                d (T) - Nonzero denominator
+
+ Returns:       (double) - The quotient as a double.
+*/
+template <typename T>
+static constexpr double ratioToDouble(T n, T d) {
+    return (double) n / (double) d;
+}
+
+/*
+ mix64
+
+ Mixes the bits of a 64-bit word with the finalizer of MurmurHash3, a
+ bijection in which every input bit flips each output bit with probability
+ close to 1/2.
+
+ Arguments:     x (uint64_t) - Word to mix
+
+ Returns:       (uint64_t) - The mixed word.
+*/
+static constexpr uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+/*
+ foldInt
+
+ Folds an integer into 64 bits for hashing.  Values that fit in an int64_t
+ fold to themselves, so equal values of any width fold the same.
+
+ Arguments:     v (T) - Value to fold
+
+ Returns:       (uint64_t) - The folded value.
+*/
+static constexpr uint64_t foldInt(int32_t v) { return (uint64_t) (int64_t) v; }
+static constexpr uint64_t foldInt(int64_t v) { return (uint64_t) v; }
+static constexpr uint64_t foldInt(int128_t v) {
+    return (int64_t) v == v ? (uint64_t) (int64_t) v
+                            : mix64((uint64_t) (v >> 64)) ^ (uint64_t) v;
+}
+
+/*
+ writeMagnitude
+
+ Writes the decimal digits of an unsigned value backwards, ending just before
+ end.  128-bit values drop to the 64-bit loop once they fit.
+
+ Arguments:     end (char*) - Character after the last digit
+                mag (U) - Value to write
+
+ Returns:       (char*) - The first digit written.
+*/
+template <typename U>
+static char *writeMagnitude(char *end, U mag) {
+    do {
+        *--end = '0' + (char) (mag % 10);
+        mag /= 10;
+    } while (mag != 0);
+
+    return end;
+}
+
+static inline char *writeMagnitude(char *end, uint128_t mag) {
+    while (mag >> 64 != 0) {
+        *--end = '0' + (char) (mag % 10);
+        mag /= 10;
+    }
+
+    return writeMagnitude<uint64_t>(end, (uint64_t) mag);
+}
+
+/*
+ writeInt
+
+ Writes a signed value backwards, ending just before end.  It is written as
+ its magnitude so that the most negative value is handled.
+
+ Arguments:     end (char*) - Character after the last digit
+                n (IntT) - Value to write
+
+ Returns:       (char*) - The first character written.
+*/
+template <typename IntT>
+static char *writeInt(char *end, IntT n) {
+    typedef typename UnsignedOf<IntT>::type U;
+    char *p = writeMagnitude(end, n < 0 ? 0 - (U) n : (U) n);
+    if (n < 0)
+        *--p = '-';
+
+    return p;
+}
+
 #endif // ifndef COMMON
@@ -0,0 +1,543 @@
+/*
+ decimalexpansion.cc
+
+ Contains the implementation of the BasicDecimalExpansion class template,
+ toDecimalChars, toFixedChars and toFixedColumn declared in
+ decimalexpansion.hh, all instantiated for 32, 64 and 128-bit integers.
+*/
+
+#include "decimalexpansion.hh"
+#include "common.hh"
+
+#include <algorithm>
+#include <string.h>
+
+using namespace std;
+
+/******************************
+ CONSTRUCTORS
+ ******************************/
+
+/*
+ BasicDecimalExpansion constructor
+
+ Splits r into its integer part and the remainder the digits are divided
+ out of, and counts the factors of 2 and 5 of the denominator to find where
+ the digits start repeating and whether they terminate.
+
+ Arguments:     r (Rational&) - Value to expand
+
+ Returns:       None
+*/
+template <typename IntT>
+BasicDecimalExpansion<IntT>::BasicDecimalExpansion(const Value& r)
+    : m_int(r.num() / r.denom()),
+      m_rem(r.num() % r.denom()),
+      m_denom(r.denom()),
+      m_negative(r.num() < 0),
+      m_pos(0),
+      m_period(0) {
+    typedef typename UnsignedOf<IntT>::type U;
+    if (m_rem < 0)
+        m_rem = -m_rem;
+
+    U d = (U) m_denom;
+    size_t twos = ctz(d), fives = 0;
+    d >>= twos;
+    while (d % 5 == 0) {
+        d /= 5;
+        ++fives;
+    }
+    m_preperiod = max(twos, fives);
+    m_terminates = d == 1;
+    m_start = m_rem;
+}
+
+/******************************
+ ACCESSORS
+ ******************************/
+
+/*
+ negative
+
+ Returns whether the value is negative, which the integer part does not say
+ for values between -1 and 0.
+*/
+template <typename IntT>
+bool BasicDecimalExpansion<IntT>::negative() const {
+    return m_negative;
+}
+
+/*
+ integerPart
+
+ Returns the value truncated toward zero.
+*/
+template <typename IntT>
+IntT BasicDecimalExpansion<IntT>::integerPart() const {
+    return m_int;
+}
+
+/*
+ terminates
+
+ Returns whether the digits end, which is when the denominator has no prime
+ factors but 2 and 5.
+*/
+template <typename IntT>
+bool BasicDecimalExpansion<IntT>::terminates() const {
+    return m_terminates;
+}
+
+/*
+ preperiod
+
+ Returns the number of digits after the point before they start repeating,
+ or, if they terminate, the number of digits there are.
+*/
+template <typename IntT>
+size_t BasicDecimalExpansion<IntT>::preperiod() const {
+    return m_preperiod;
+}
+
+/*
+ period
+
+ Returns the number of digits that repeat, once a whole period of them has
+ been streamed, and 0 before that or if the digits terminate.
+*/
+template <typename IntT>
+size_t BasicDecimalExpansion<IntT>::period() const {
+    return m_period;
+}
+
+/*
+ position
+
+ Returns the number of digits streamed so far.
+*/
+template <typename IntT>
+size_t BasicDecimalExpansion<IntT>::position() const {
+    return m_pos;
+}
+
+/*
+ done
+
+ Returns whether the digits streamed so far are the exact value, so every
+ digit after them is 0.
+*/
+template <typename IntT>
+bool BasicDecimalExpansion<IntT>::done() const {
+    return m_rem == 0;
+}
+
+/*
+ compareRest
+
+ Compares the digits not yet streamed, read as a fraction 0.ddd..., with
+ 1/2, which is what rounding at the current position needs.  It is the
+ remainder against the denominator less the remainder, so nothing overflows.
+
+ Arguments:     None
+
+ Returns:       (int) - -1, 0 or 1 as the rest is less than, equal to or
+                        greater than 1/2.
+*/
+template <typename IntT>
+int BasicDecimalExpansion<IntT>::compareRest() const {
+    IntT other = m_denom - m_rem;
+    return (m_rem > other) - (m_rem < other);
+}
+
+/******************************
+ STREAMING
+ ******************************/
+
+/*
+ next
+
+ Streams the next digit after the point: ten times the remainder divided by
+ the denominator.  Where the wide type holds ten times any remainder that is
+ one division in it.  For 128-bit values ten times the remainder is built as
+ 2 (2 (2r) + r) in the unsigned type, reducing modulo the denominator after
+ each step, which never exceeds 2^128 and counts the digit as it goes.
+
+ Arguments:     None
+
+ Returns:       (int) - The digit, from 0 to 9.
+
+ Global Impact: Advances the position and notes the period when it ends.
+*/
+template <typename IntT>
+int BasicDecimalExpansion<IntT>::next() {
+    int digit = 0;
+    if (RationalTraits<IntT>::WIDER) {
+        Wide t = (Wide) m_rem * 10;
+        digit = (int) (t / m_denom);
+        m_rem = (IntT) (t % m_denom);
+    }
+    else {
+        typedef typename UnsignedOf<IntT>::type U;
+        U d = (U) m_denom, r = (U) m_rem, t = r;
+        for (int step = 0; step < 4; ++step) {
+            if (step == 2)
+                t += r;
+            else {
+                t <<= 1;
+                digit <<= 1;
+            }
+            if (t >= d) {
+                t -= d;
+                ++digit;
+            }
+        }
+        m_rem = (IntT) t;
+    }
+
+    ++m_pos;
+    if (m_pos == m_preperiod)
+        m_start = m_rem;
+    else if (m_pos > m_preperiod && m_period == 0 && !m_terminates &&
+             m_rem == m_start)
+        m_period = m_pos - m_preperiod;
+
+    return digit;
+}
+
+/******************************
+ FORMATTING
+ ******************************/
+
+/*
+ roundsAway
+
+ Decides whether a value cut off after some digit rounds away from zero,
+ that is, whether that digit is incremented.
+
+ Arguments:     mode (RoundingMode) - How to round
+                negative (bool) - Whether the value is negative
+                odd (bool) - Whether the last digit kept is odd
+                rest (int) - The digits cut off against 1/2, as compareRest
+                exact (bool) - Whether the digits cut off are all 0
+
+ Returns:       (bool) - True if the last digit kept is incremented.
+*/
+static bool roundsAway(RoundingMode mode, bool negative, bool odd, int rest,
+                       bool exact) {
+    switch (mode) {
+    case RoundingMode::Down:        return false;
+    case RoundingMode::Up:          return !exact;
+    case RoundingMode::Floor:       return negative && !exact;
+    case RoundingMode::Ceiling:     return !negative && !exact;
+    case RoundingMode::HalfDown:    return rest > 0;
+    case RoundingMode::HalfUp:      return rest >= 0;
+    case RoundingMode::HalfEven:    return rest > 0 || (rest == 0 && odd);
+    }
+
+    return false;
+}
+
+/*
+ tooLarge
+
+ Returns what the formatting functions do when the buffer is too short.
+*/
+static ToCharsResult tooLarge(char *last) {
+    ToCharsResult out = { last, errc::value_too_large };
+    return out;
+}
+
+/*
+ writeIntegerPart
+
+ Writes the integer part of an expansion at first, with a '-' if the
+ expansion is negative even when the integer part is 0.
+
+ Arguments:     first (char*) - First character to write
+                last (char*) - End of the range
+                e (DecimalExpansion&) - Expansion whose integer part it is
+
+ Returns:       (char*) - End of what was written, or NULL if it does not
+                          fit.
+*/
+template <typename IntT>
+static char *writeIntegerPart(char *first, char *last,
+                              const BasicDecimalExpansion<IntT>& e) {
+    char buf[48];
+    char *end = buf + sizeof(buf);
+    IntT n = e.integerPart();
+    char *p = writeInt(end, n);
+    if (e.negative() && n == 0)
+        *--p = '-';
+
+    size_t len = end - p;
+    if ((size_t) (last - first) < len)
+        return NULL;
+    memcpy(first, p, len);
+    return first + len;
+}
+
+/*
+ toDecimalChars
+
+ Writes a BasicRational as its exact decimal expansion, streaming the digits
+ before the period and then those of the period until it ends.
+
+ Arguments:     first (char*) - First character to write
+                last (char*) - End of the range
+                value (Rational&) - Value to write
+
+ Returns:       (ToCharsResult) - End of what was written and the error, if
+                                  any.
+*/
+template <typename IntT>
+ToCharsResult toDecimalChars(char *first, char *last,
+                             const BasicRational<IntT>& value) {
+    BasicDecimalExpansion<IntT> e(value);
+    char *p = writeIntegerPart(first, last, e);
+    if (p == NULL)
+        return tooLarge(last);
+
+    if (!e.done()) {
+        if (p == last)
+            return tooLarge(last);
+        *p++ = '.';
+        while (e.position() < e.preperiod()) {
+            if (p == last)
+                return tooLarge(last);
+            *p++ = '0' + (char) e.next();
+        }
+
+        if (!e.terminates()) {
+            if (p == last)
+                return tooLarge(last);
+            *p++ = '(';
+            do {
+                if (p == last)
+                    return tooLarge(last);
+                *p++ = '0' + (char) e.next();
+            } while (e.period() == 0);
+            if (p == last)
+                return tooLarge(last);
+            *p++ = ')';
+        }
+    }
+
+    ToCharsResult out = { p, errc() };
+    return out;
+}
+
+/*
+ toFixedWide
+
+ Formats as toFixedChars does with one division, for types whose wide type
+ holds the numerator times 10^digits: the quotient of that by the
+ denominator is the value's digits and the remainder decides the rounding.
+
+ Arguments:     first (char*) - First character to write
+                last (char*) - End of the range
+                value (Rational&) - Value to write
+                digits (size_t) - Digits after the point
+                mode (RoundingMode) - How to round
+                out (ToCharsResult*) - Set to the result
+
+ Returns:       (bool) - False, with nothing written, if the wide type does
+                         not hold the numerator times 10^digits.
+*/
+template <typename IntT>
+static bool toFixedWide(char *first, char *last,
+                        const BasicRational<IntT>& value, size_t digits,
+                        RoundingMode mode, ToCharsResult *out) {
+    typedef typename RationalTraits<IntT>::Wide Wide;
+    typedef typename UnsignedOf<Wide>::type UW;
+    if (!RationalTraits<IntT>::WIDER)
+        return false;
+
+    Wide scale = 1, scaled;
+    for (size_t i = 0; i < digits; ++i) {
+        if (__builtin_mul_overflow(scale, (Wide) 10, &scale))
+            return false;
+    }
+    if (__builtin_mul_overflow((Wide) value.num(), scale, &scaled))
+        return false;
+
+    Wide q = scaled / value.denom(), rem = scaled % value.denom();
+    bool negative = scaled < 0;
+    UW mag = negative ? 0 - (UW) q : (UW) q;
+    UW r = negative ? 0 - (UW) rem : (UW) rem, d = (UW) value.denom();
+    int rest = (r > d - r) - (r < d - r);
+    if (roundsAway(mode, negative, (mag & 1) != 0, rest, r == 0))
+        ++mag;
+
+    char buf[48];
+    char *end = buf + sizeof(buf);
+    char *p = writeMagnitude(end, mag);
+    while ((size_t) (end - p) <= digits)
+        *--p = '0';
+
+    bool sign = negative && mag != 0;
+    size_t intLen = end - p - digits;
+    size_t len = sign + intLen + (digits != 0) + digits;
+    if ((size_t) (last - first) < len) {
+        *out = tooLarge(last);
+        return true;
+    }
+
+    char *w = first;
+    if (sign)
+        *w++ = '-';
+    memcpy(w, p, intLen);
+    w += intLen;
+    if (digits != 0) {
+        *w++ = '.';
+        memcpy(w, p + intLen, digits);
+        w += digits;
+    }
+    out->ptr = w;
+    out->ec = errc();
+    return true;
+}
+
+/*
+ toFixedChars
+
+ Writes a BasicRational rounded to a number of digits after the point.  When
+ the wide type holds the numerator times 10^digits it takes one division.
+ Otherwise the digits are streamed from a BasicDecimalExpansion straight into
+ the range, the rest decides whether the last is incremented, and a carry
+ is propagated back through the text, shifting it right for a new leading 1.
+ A negative value that rounds to zero has its sign removed.
+
+ Arguments:     first (char*) - First character to write
+                last (char*) - End of the range
+                value (Rational&) - Value to write
+                digits (size_t) - Digits after the point
+                mode (RoundingMode) - How to round
+
+ Returns:       (ToCharsResult) - End of what was written and the error, if
+                                  any.
+*/
+template <typename IntT>
+ToCharsResult toFixedChars(char *first, char *last,
+                           const BasicRational<IntT>& value, size_t digits,
+                           RoundingMode mode) {
+    ToCharsResult out;
+    if (toFixedWide(first, last, value, digits, mode, &out))
+        return out;
+
+    BasicDecimalExpansion<IntT> e(value);
+    char *intStart = first + e.negative();
+    char *p = writeIntegerPart(first, last, e);
+    if (p == NULL || (size_t) (last - p) < (digits != 0) + digits)
+        return tooLarge(last);
+
+    if (digits != 0) {
+        *p++ = '.';
+        for (size_t i = 0; i < digits; ++i)
+            *p++ = '0' + (char) e.next();
+    }
+
+    bool odd = ((p[-1] - '0') & 1) != 0;
+    if (roundsAway(mode, e.negative(), odd, e.compareRest(), e.done())) {
+        char *c = p;
+        bool carry = true;
+        while (carry && c != intStart) {
+            --c;
+            if (*c == '.')
+                continue;
+            carry = *c == '9';
+            *c = carry ? '0' : *c + 1;
+        }
+        if (carry) {
+            if (p == last)
+                return tooLarge(last);
+            memmove(intStart + 1, intStart, p - intStart);
+            *intStart = '1';
+            ++p;
+        }
+    }
+
+    if (e.negative() &&
+        all_of(intStart, p, [](char c) { return c == '0' || c == '.'; })) {
+        memmove(first, intStart, p - intStart);
+        --p;
+    }
+
+    out.ptr = p;
+    out.ec = errc();
+    return out;
+}
+
+/*
+ toFixedColumn
+
+ Writes values as toFixedChars does into consecutive fields of a fixed
+ width.  Each is formatted at the start of its field and then moved to its
+ end, so no scratch memory is needed.
+
+ Arguments:     out (char*) - Start of n * width characters to write
+                width (size_t) - Characters in each field
+                values (Rational*) - Values to write
+                n (size_t) - Number of values
+                digits (size_t) - Digits after the point
+                mode (RoundingMode) - How to round
+
+ Returns:       (size_t) - Number of fields filled with '#'.
+*/
+template <typename IntT>
+size_t toFixedColumn(char *out, size_t width,
+                     const BasicRational<IntT> *values, size_t n,
+                     size_t digits, RoundingMode mode) {
+    size_t overflowed = 0;
+    for (size_t i = 0; i < n; ++i) {
+        char *field = out + i * width;
+        ToCharsResult res = toFixedChars(field, field + width, values[i],
+                                         digits, mode);
+        if (res.ec != errc()) {
+            memset(field, '#', width);
+            ++overflowed;
+            continue;
+        }
+
+        size_t len = res.ptr - field;
+        memmove(field + width - len, field, len);
+        memset(field, ' ', width - len);
+    }
+
+    return overflowed;
+}
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+template class BasicDecimalExpansion<int32_t>;
+template class BasicDecimalExpansion<int64_t>;
+template class BasicDecimalExpansion<int128_t>;
+
+template ToCharsResult toDecimalChars(char *first, char *last,
+                                      const Rational& value);
+template ToCharsResult toDecimalChars(char *first, char *last,
+                                      const Rational64& value);
+template ToCharsResult toDecimalChars(char *first, char *last,
+                                      const Rational128& value);
+
+template ToCharsResult toFixedChars(char *first, char *last,
+                                    const Rational& value, size_t digits,
+                                    RoundingMode mode);
+template ToCharsResult toFixedChars(char *first, char *last,
+                                    const Rational64& value, size_t digits,
+                                    RoundingMode mode);
+template ToCharsResult toFixedChars(char *first, char *last,
+                                    const Rational128& value, size_t digits,
+                                    RoundingMode mode);
+
+template size_t toFixedColumn(char *out, size_t width,
+                              const Rational *values, size_t n,
+                              size_t digits, RoundingMode mode);
+template size_t toFixedColumn(char *out, size_t width,
+                              const Rational64 *values, size_t n,
+                              size_t digits, RoundingMode mode);
+template size_t toFixedColumn(char *out, size_t width,
+                              const Rational128 *values, size_t n,
+                              size_t digits, RoundingMode mode);
@@ -0,0 +1,148 @@
+/*
+ decimalexpansion.hh
+
+ Contains the BasicDecimalExpansion class template, which streams the exact
+ decimal digits of a BasicRational, and toDecimalChars, toFixedChars and
+ toFixedColumn, which write exact and rounded decimals in caller buffers
+ without allocating.
+*/
+
+#ifndef DECIMALEXPANSION
+#define DECIMALEXPANSION
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rational.hh"
+#include "rationalchars.hh"
+
+/*
+ RoundingMode
+
+ How toFixedChars rounds to a number of digits, with the meanings of Java's
+ RoundingMode and Python's decimal module.
+
+    Down        Toward zero (truncate)
+    Up          Away from zero
+    Floor       Toward negative infinity
+    Ceiling     Toward positive infinity
+    HalfDown    To the nearest, ties toward zero
+    HalfUp      To the nearest, ties away from zero
+    HalfEven    To the nearest, ties to an even last digit
+*/
+enum class RoundingMode {
+    Down, Up, Floor, Ceiling, HalfDown, HalfUp, HalfEven
+};
+
+/*
+ BasicDecimalExpansion Class
+
+ Streams the digits after the decimal point of a BasicRational n/d by long
+ division, one remainder times ten at a time, so any number of them can be
+ had exactly with no allocation.
+
+ Writing d = 2^a 5^b d' with d' coprime to 10, the digits repeat from
+ position max(a, b) on, which the constructor finds up front, and they
+ terminate exactly when d' is 1.  Otherwise the period is found while
+ streaming, as the first time the remainder returns to what it was where the
+ repetition started.  1/7 is 0.(142857), with no digits before the period
+ and a period of 6, and 1/6 is 0.1(6).
+*/
+template <typename IntT>
+class BasicDecimalExpansion {
+public:
+    typedef BasicRational<IntT> Value;
+    typedef typename RationalTraits<IntT>::Wide Wide;
+
+private:
+    /******************************
+     MEMBERS
+     ******************************/
+    IntT m_int;                             // Integer part, toward zero
+    IntT m_rem;                             // Remainder, 0 <= m_rem < m_denom
+    IntT m_denom;                           // Denominator
+    IntT m_start;                           // Remainder where it repeats
+    bool m_negative;                        // Whether the value is negative
+    bool m_terminates;                      // Whether d' is 1
+    size_t m_pos;                           // Digits streamed so far
+    size_t m_preperiod;                     // Digits before it repeats
+    size_t m_period;                        // Period once seen, else 0
+
+public:
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+    explicit BasicDecimalExpansion(const Value& r);    // Expands r
+
+    /******************************
+     ACCESSORS
+     ******************************/
+    bool negative() const;                  // Whether r < 0
+    IntT integerPart() const;               // r truncated toward zero
+    bool terminates() const;                // Whether the digits end
+    size_t preperiod() const;               // Digits before the period
+    size_t period() const;                  // 0 until a period is streamed
+    size_t position() const;                // Digits streamed so far
+    bool done() const;                      // Whether only zeros are left
+    int compareRest() const;                // Rest of the digits against 1/2
+
+    /******************************
+     STREAMING
+     ******************************/
+    int next();                             // Next digit after the point
+};
+
+/*
+ toDecimalChars
+
+ Writes a BasicRational into [first, last) as its exact decimal expansion,
+ with the period in parentheses: "3", "-0.25", "0.(142857)" or "0.1(6)".
+ Periods can be far longer than any buffer (1/p has up to p - 1 digits), so
+ if it does not fit, ec is errc::value_too_large, ptr is last and the buffer
+ contents are unspecified.
+*/
+template <typename IntT>
+ToCharsResult toDecimalChars(char *first, char *last,
+                             const BasicRational<IntT>& value);
+
+/*
+ toFixedChars
+
+ Writes a BasicRational into [first, last) rounded to exactly digits places
+ after the point, as "-12.340", or with no point when digits is 0.  It is
+ rounded exactly, by mode, and a value that rounds to zero is written
+ without a sign.  If it does not fit, ec is errc::value_too_large, ptr is
+ last and the buffer contents are unspecified.
+*/
+template <typename IntT>
+ToCharsResult toFixedChars(char *first, char *last,
+                           const BasicRational<IntT>& value, size_t digits,
+                           RoundingMode mode = RoundingMode::HalfEven);
+
+/*
+ toFixedColumn
+
+ Writes n BasicRationals rounded as toFixedChars does into n fields of
+ exactly width characters at out, one after another, each right aligned and
+ padded with spaces.  A value too wide for its field fills it with '#'.
+ Nothing is allocated, so large batches cost only the formatting.  Returns
+ the number of fields filled with '#'.
+*/
+template <typename IntT>
+size_t toFixedColumn(char *out, size_t width,
+                     const BasicRational<IntT> *values, size_t n,
+                     size_t digits,
+                     RoundingMode mode = RoundingMode::HalfEven);
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+typedef BasicDecimalExpansion<int32_t>  DecimalExpansion;
+typedef BasicDecimalExpansion<int64_t>  DecimalExpansion64;
+typedef BasicDecimalExpansion<int128_t> DecimalExpansion128;
+
+/* Defined in decimalexpansion.cc for these three types only. */
+extern template class BasicDecimalExpansion<int32_t>;
+extern template class BasicDecimalExpansion<int64_t>;
+extern template class BasicDecimalExpansion<int128_t>;
+
+#endif // ifndef DECIMALEXPANSION
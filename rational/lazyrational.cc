@@ -0,0 +1,458 @@
+/*
+ lazyrational.cc
+
+ Contains the implementation of the BasicLazyRational class template defined
+ in lazyrational.hh.  Arithmetic keeps unreduced products while they fit and
+ falls back on BasicRational when they would not.  The template is
+ instantiated here for 32, 64 and 128-bit integers.
+*/
+
+#include "lazyrational.hh"
+#include "common.hh"
+
+#include <stdexcept>
+
+using namespace std;
+
+/*
+ reduce
+
+ Divides the GCD out of the numerator and denominator.  The denominator is
+ already positive, so this only ever makes both smaller.
+
+ Arguments:     None.
+
+ Returns:       None.
+
+ Global Impact: Updates m_num and m_denom, which does not change the value.
+*/
+template <typename IntT>
+void BasicLazyRational<IntT>::reduce() const {
+    IntT gcd = GCD(m_num, m_denom);
+    if (gcd != 1) {
+        m_num /= gcd;
+        m_denom /= gcd;
+    }
+
+    return;
+}
+
+/*
+ sum
+
+ Stores this + r, or this - r if subtract is set, without reducing, provided
+ that the unreduced result fits IntT.  Equal denominators, as in sums of terms
+ over the same denominator, only add the numerators.
+
+ Arguments:     r (LazyRational&) - Added to or subtracted from this
+                subtract (bool) - True to subtract rather than add
+
+ Returns:       (bool) - False if the result would overflow, in which case
+                         nothing is changed.
+
+ Global Impact: Updates m_num and m_denom on success.
+*/
+template <typename IntT>
+bool BasicLazyRational<IntT>::sum(const BasicLazyRational<IntT>& r,
+                                  bool subtract) {
+    IntT n, d, l, t;
+    if (m_denom == r.m_denom) {
+        if (subtract ? __builtin_sub_overflow(m_num, r.m_num, &n)
+                     : __builtin_add_overflow(m_num, r.m_num, &n))
+            return false;
+        m_num = n;
+        return true;
+    }
+
+    if (__builtin_mul_overflow(m_num, r.m_denom, &l) ||
+        __builtin_mul_overflow(r.m_num, m_denom, &t) ||
+        __builtin_mul_overflow(m_denom, r.m_denom, &d) ||
+        (subtract ? __builtin_sub_overflow(l, t, &n)
+                  : __builtin_add_overflow(l, t, &n)))
+        return false;
+
+    m_num = n;
+    m_denom = d;
+    return true;
+}
+
+/******************************
+ CONSTRUCTORS
+ ******************************/
+template <typename IntT>
+BasicLazyRational<IntT>::BasicLazyRational(IntT n, IntT d)
+    : m_num(n), m_denom(d) {
+    // Can't have a zero in the denominator of a rational number
+    if (d == 0)
+        throw invalid_argument("Denominator must be nonzero.");
+
+    // Only the sign is normalized up front, unless it can't be negated
+    if (d < 0) {
+        if (n == RationalTraits<IntT>::min() ||
+            d == RationalTraits<IntT>::min())
+            *this = BasicRational<IntT>(n, d);
+        else {
+            m_num = -n;
+            m_denom = -d;
+        }
+    }
+}
+template <typename IntT>
+BasicLazyRational<IntT>::BasicLazyRational(const BasicRational<IntT>& r)
+    : m_num(r.num()), m_denom(r.denom()) {}
+template <typename IntT>
+BasicLazyRational<IntT>::BasicLazyRational(IntT n) : m_num(n), m_denom(1) {}
+template <typename IntT>
+BasicLazyRational<IntT>::BasicLazyRational() : m_num(0), m_denom(1) {}
+
+/******************************
+ ACCESSORS
+ ******************************/
+/*
+ denom
+
+ Returns the denominator of this LazyRational in simplest form.
+
+ Arguments:     None.
+
+ Returns:       m_denom (IntT) - The reduced denominator.
+
+ Global Impact: Reduces this instance.
+*/
+template <typename IntT>
+IntT BasicLazyRational<IntT>::denom() const {
+    reduce();
+    return m_denom;
+}
+
+/*
+ num
+
+ Returns the numerator of this LazyRational in simplest form.
+
+ Arguments:     None.
+
+ Returns:       m_num (IntT) - The reduced numerator.
+
+ Global Impact: Reduces this instance.
+*/
+template <typename IntT>
+IntT BasicLazyRational<IntT>::num() const {
+    reduce();
+    return m_num;
+}
+
+/******************************
+ NORMALIZATION
+ ******************************/
+/*
+ normalize
+
+ Reduces this LazyRational to simplest form now.
+
+ Arguments:     None.
+
+ Returns:       (LazyRational&) - This instance.
+
+ Global Impact: Updates m_num and m_denom.
+*/
+template <typename IntT>
+const BasicLazyRational<IntT>& BasicLazyRational<IntT>::normalize() {
+    reduce();
+    return *this;
+}
+
+/*
+ normalized
+
+ Returns the value of this LazyRational as a BasicRational.
+
+ Arguments:     None.
+
+ Returns:       (Rational) - The same value in simplest form.
+
+ Global Impact: Reduces this instance.
+*/
+template <typename IntT>
+BasicRational<IntT> BasicLazyRational<IntT>::normalized() const {
+    reduce();
+
+    // Already simplest, so the parts are handed over without another GCD
+    BasicRational<IntT> out;
+    out.narrow(m_num, m_denom);
+    return out;
+}
+
+/******************************
+ OPERATORS
+ ******************************/
+/*
+ unary negation
+
+ Returns the unary negation of this LazyRational.
+
+ Arguments:     None.
+
+ Returns:       (LazyRational) - Unary negation of this instance.
+
+ Global Impact: None.
+*/
+template <typename IntT>
+const BasicLazyRational<IntT> BasicLazyRational<IntT>::operator-() const {
+    // The most negative numerator only has a negation once reduced
+    if (m_num == RationalTraits<IntT>::min())
+        return -normalized();
+
+    BasicLazyRational out(*this);
+    out.m_num = -m_num;
+    return out;
+}
+
+/*
+ Add, Subtract, Multiply, Divide
+
+ Return the sum, difference, product or quotient of this LazyRational and the
+ argued one, computed by the compound operators below.
+
+ Arguments:     r (LazyRational&) - Right operand
+
+ Returns:       (LazyRational) - The result, not necessarily reduced.
+
+ Global Impact: None.
+*/
+template <typename IntT>
+const BasicLazyRational<IntT> BasicLazyRational<IntT>::operator+(
+    const BasicLazyRational<IntT>& r) const {
+    BasicLazyRational out(*this);
+    return out += r;
+}
+template <typename IntT>
+const BasicLazyRational<IntT> BasicLazyRational<IntT>::operator-(
+    const BasicLazyRational<IntT>& r) const {
+    BasicLazyRational out(*this);
+    return out -= r;
+}
+template <typename IntT>
+const BasicLazyRational<IntT> BasicLazyRational<IntT>::operator*(
+    const BasicLazyRational<IntT>& r) const {
+    BasicLazyRational out(*this);
+    return out *= r;
+}
+template <typename IntT>
+const BasicLazyRational<IntT> BasicLazyRational<IntT>::operator/(
+    const BasicLazyRational<IntT>& r) const {
+    BasicLazyRational out(*this);
+    return out /= r;
+}
+
+/*
+ Add
+
+ Adds the argued LazyRational to this one, reducing only if the unreduced sum
+ would overflow.
+
+ Arguments:     r (LazyRational&) - Added to this instance
+
+ Returns:       (LazyRational&) - This instance.
+
+ Global Impact: This instance overwritten with result.  Throws overflow_error
+                if even the reduced sum does not fit IntT.
+*/
+template <typename IntT>
+const BasicLazyRational<IntT>& BasicLazyRational<IntT>::operator+=(
+    const BasicLazyRational<IntT>& r) {
+    if (!sum(r, false))
+        *this = normalized() + r.normalized();
+    return *this;
+}
+
+/*
+ Subtract
+
+ Subtracts the argued LazyRational from this one, reducing only if the
+ unreduced difference would overflow.
+
+ Arguments:     r (LazyRational&) - Subtracted from this instance
+
+ Returns:       (LazyRational&) - This instance.
+
+ Global Impact: This instance overwritten with result.  Throws overflow_error
+                if even the reduced difference does not fit IntT.
+*/
+template <typename IntT>
+const BasicLazyRational<IntT>& BasicLazyRational<IntT>::operator-=(
+    const BasicLazyRational<IntT>& r) {
+    if (!sum(r, true))
+        *this = normalized() - r.normalized();
+    return *this;
+}
+
+/*
+ Multiply
+
+ Multiplies this LazyRational by the argued one, reducing only if the
+ unreduced product would overflow.
+
+ Arguments:     r (LazyRational&) - Multiplied by this instance
+
+ Returns:       (LazyRational&) - This instance.
+
+ Global Impact: This instance overwritten with result.  Throws overflow_error
+                if even the reduced product does not fit IntT.
+*/
+template <typename IntT>
+const BasicLazyRational<IntT>& BasicLazyRational<IntT>::operator*=(
+    const BasicLazyRational<IntT>& r) {
+    IntT n, d;
+    if (__builtin_mul_overflow(m_num, r.m_num, &n) ||
+        __builtin_mul_overflow(m_denom, r.m_denom, &d))
+        *this = normalized() * r.normalized();
+    else {
+        m_num = n;
+        m_denom = d;
+    }
+    return *this;
+}
+
+/*
+ Divide
+
+ Divides this LazyRational by the argued one, reducing only if the unreduced
+ quotient would overflow.
+
+ Arguments:     r (LazyRational&) - This instance is divided by r
+
+ Returns:       (LazyRational&) - This instance.
+
+ Global Impact: This instance overwritten with result.  Throws
+                invalid_argument if r is 0 and overflow_error if even the
+                reduced quotient does not fit IntT.
+*/
+template <typename IntT>
+const BasicLazyRational<IntT>& BasicLazyRational<IntT>::operator/=(
+    const BasicLazyRational<IntT>& r) {
+    // Can't divide by zero
+    if (r.m_num == 0)
+        throw invalid_argument("Denominator must be nonzero.");
+
+    // Keep the denominator positive by moving the divisor's sign up top
+    IntT n, d, a = r.m_num < 0 ? -r.m_denom : r.m_denom;
+    if (r.m_num == RationalTraits<IntT>::min() ||
+        __builtin_mul_overflow(m_num, a, &n) ||
+        __builtin_mul_overflow(m_denom, r.m_num < 0 ? -r.m_num : r.m_num, &d))
+        *this = normalized() / r.normalized();
+    else {
+        m_num = n;
+        m_denom = d;
+    }
+    return *this;
+}
+
+/******************************
+ COMPARATORS
+ ******************************/
+/*
+ compare
+
+ Compares this LazyRational with the argued one exactly, reducing both first.
+
+ Arguments:     r (LazyRational&) - Instance this is compared to
+
+ Returns:       (int) - -1, 0 or 1 as this is less than, equal to or greater
+                        than r.
+*/
+template <typename IntT>
+int BasicLazyRational<IntT>::compare(const BasicLazyRational<IntT>& r) const {
+    return normalized().compare(r.normalized());
+}
+
+/*
+ Comparison operators
+
+ Return true if this LazyRational is less than, greater than, at most, at
+ least, equal to or not equal to the argued one, as compare finds them.
+
+ Arguments:     r (LazyRational&) - Instance this is compared to
+
+ Returns:       (bool) - The result of the comparison.
+*/
+template <typename IntT>
+bool BasicLazyRational<IntT>::operator<(
+    const BasicLazyRational<IntT>& r) const {
+    return compare(r) < 0;
+}
+template <typename IntT>
+bool BasicLazyRational<IntT>::operator>(
+    const BasicLazyRational<IntT>& r) const {
+    return compare(r) > 0;
+}
+template <typename IntT>
+bool BasicLazyRational<IntT>::operator<=(
+    const BasicLazyRational<IntT>& r) const {
+    return compare(r) <= 0;
+}
+template <typename IntT>
+bool BasicLazyRational<IntT>::operator>=(
+    const BasicLazyRational<IntT>& r) const {
+    return compare(r) >= 0;
+}
+template <typename IntT>
+bool BasicLazyRational<IntT>::operator==(
+    const BasicLazyRational<IntT>& r) const {
+    return normalized() == r.normalized();
+}
+template <typename IntT>
+bool BasicLazyRational<IntT>::operator!=(
+    const BasicLazyRational<IntT>& r) const {
+    return !(*this == r);
+}
+
+/******************************
+ EXPLICIT CASTING
+ ******************************/
+/*
+ double converter
+
+ Converts the LazyRational into a double, reducing it first so that large
+ unreduced parts don't lose precision.
+
+ Arguments:     None.
+
+ Returns:       (double) - The LazyRational as a double.
+*/
+template <typename IntT>
+BasicLazyRational<IntT>::operator double() const {
+    return (double) normalized();
+}
+
+/******************************
+ STREAM OUTPUT
+ ******************************/
+/*
+ ostream operator
+
+ Outputs the LazyRational onto ostream in simplest form, as a Rational is.
+
+ Arguments:     out (ostream&) - Stream to write to
+                r (LazyRational&) - Value to write
+
+ Returns:       (ostream) - The ostream that the LazyRational is output onto
+*/
+template <typename IntT>
+ostream& operator<<(ostream& out, const BasicLazyRational<IntT>& r) {
+    return out << r.normalized();
+}
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+template class BasicLazyRational<int32_t>;
+template class BasicLazyRational<int64_t>;
+template class BasicLazyRational<int128_t>;
+
+template ostream& operator<<(ostream& out,
+                             const BasicLazyRational<int32_t>& r);
+template ostream& operator<<(ostream& out,
+                             const BasicLazyRational<int64_t>& r);
+template ostream& operator<<(ostream& out,
+                             const BasicLazyRational<int128_t>& r);
@@ -0,0 +1,119 @@
+/*
+ lazyrational.hh
+
+ Contains the BasicLazyRational class template definition, a rational number
+ that is only reduced to simplest form when it has to be.
+*/
+
+#ifndef LAZYRATIONAL
+#define LAZYRATIONAL
+
+#include <iostream>
+#include <stdint.h>
+#include "common.hh"
+#include "rational.hh"
+
+/*
+ BasicLazyRational Class
+
+ A rational number for long chains of arithmetic where only the final value
+ matters.  BasicRational takes a GCD after every operation to stay in simplest
+ form; this type instead keeps the unreduced products, with a positive
+ denominator, for as long as they fit IntT.  It is reduced only when
+
+    - an operation would overflow IntT, in which case both operands are
+      reduced and the operation is redone exactly as BasicRational does it,
+      which throws overflow_error only if the reduced result doesn't fit,
+    - it is compared, read through num() or denom(), converted or output,
+    - normalize() is called.
+
+ Reducing on those does not change the value, so the members are mutable and
+ the reduced form is kept.  Only the fixed width backends are instantiated:
+ BigInt never approaches overflow, so unreduced BigInts would just grow.
+*/
+template <typename IntT>
+class BasicLazyRational {
+private:
+    /******************************
+     MEMBERS
+     ******************************/
+    mutable IntT m_num;                     // Numerator, maybe not reduced
+    mutable IntT m_denom;                   // Positive denominator
+
+    /******************************
+     PRIVATE METHODS
+     ******************************/
+    void reduce() const;                    // Divides out the GCD
+    bool sum(const BasicLazyRational& r,
+             bool subtract);                // False if it would overflow
+
+public:
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+    BasicLazyRational();                        // Initializes to 0/1
+    BasicLazyRational(IntT n);                  // Initializes to n/1
+    BasicLazyRational(IntT n, IntT d);          // Initializes to n/d
+    BasicLazyRational(const BasicRational<IntT>& r);  // Copies r
+
+    /******************************
+     ACCESSORS
+     ******************************/
+    IntT denom() const;                     // Reduced denominator
+    IntT num() const;                       // Reduced numerator
+
+    /******************************
+     NORMALIZATION
+     ******************************/
+    const BasicLazyRational& normalize();   // Reduces to simplest form
+    BasicRational<IntT> normalized() const; // Value as a BasicRational
+
+    /******************************
+     OPERATORS
+     ******************************/
+    const BasicLazyRational operator-() const;                      // Negate
+    const BasicLazyRational operator+(const BasicLazyRational& r) const;
+    const BasicLazyRational operator-(const BasicLazyRational& r) const;
+    const BasicLazyRational operator*(const BasicLazyRational& r) const;
+    const BasicLazyRational operator/(const BasicLazyRational& r) const;
+    const BasicLazyRational& operator+=(const BasicLazyRational& r);   // Add
+    const BasicLazyRational& operator-=(const BasicLazyRational& r);   // Sub
+    const BasicLazyRational& operator*=(const BasicLazyRational& r);   // Mul
+    const BasicLazyRational& operator/=(const BasicLazyRational& r);   // Div
+
+    /******************************
+     COMPARATORS
+     ******************************/
+    int compare(const BasicLazyRational& r) const;         // -1, 0 or 1
+    bool operator<(const BasicLazyRational& r) const;      // Less than
+    bool operator>(const BasicLazyRational& r) const;      // Greater than
+    bool operator<=(const BasicLazyRational& r) const;     // Less or equal
+    bool operator>=(const BasicLazyRational& r) const;     // Greater or equal
+    bool operator==(const BasicLazyRational& r) const;     // Equal to
+    bool operator!=(const BasicLazyRational& r) const;     // Not equal to
+
+    /******************************
+     EXPLICIT CASTING
+     ******************************/
+    explicit operator double() const;                      // Nearest double
+};
+
+/******************************
+ STREAM OUTPUT
+ ******************************/
+template <typename IntT>
+std::ostream& operator<<(std::ostream& out, const BasicLazyRational<IntT>& r);
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+typedef BasicLazyRational<int32_t>  LazyRational;
+typedef BasicLazyRational<int64_t>  LazyRational64;
+typedef BasicLazyRational<int128_t> LazyRational128;
+
+/* Defined in lazyrational.cc for these three types only. */
+extern template class BasicLazyRational<int32_t>;
+extern template class BasicLazyRational<int64_t>;
+extern template class BasicLazyRational<int128_t>;
+
+#endif // ifndef LAZYRATIONAL
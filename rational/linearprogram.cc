@@ -0,0 +1,838 @@
+/*
+ linearprogram.cc
+
+ Contains the implementation of the BasicLinearProgram class template
+ defined in linearprogram.hh.  The template is instantiated here for 32, 64
+ and 128-bit integers and for BigInt.
+*/
+
+#include "linearprogram.hh"
+#include "parallel.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+
+/* Tolerance of the floating point simplex. */
+static const double FLOAT_EPS = 1e-9;
+
+/* Loops over rows or columns are only spread over threads past this many
+   products, and then in at most this many chunks. */
+static const size_t PARALLEL_PRODUCTS = 4096;
+static const size_t MAX_CHUNKS = 64;
+
+/*
+ forEachIndex
+
+ Calls f with each index below count, spreading them over threads when each
+ costs about cost products and there are enough of them.
+
+ Arguments:     count (size_t) - Number of indices
+                cost (size_t) - Products per index
+                threads (unsigned) - Threads to use, 0 for all there are
+                f (function) - Called with each index
+
+ Returns:       None.
+
+ Global Impact: Rethrows what f throws for the lowest chunk.
+*/
+template <typename F>
+static void forEachIndex(size_t count, size_t cost, unsigned threads, F f) {
+    size_t chunks = count * cost < PARALLEL_PRODUCTS ? 1 :
+                    min(count, MAX_CHUNKS);
+    forEachChunk(chunks, threads, [&](size_t k) {
+        for (size_t i = count * k / chunks; i < count * (k + 1) / chunks; i++)
+            f(i);
+    });
+}
+
+/*
+ ExactBasis
+
+ A basis of the exact simplex and what follows from it.  Columns are
+ numbered with the n structural variables first, then the artificial
+ variable, which has a -1 in every row, and then the slack of each row.  The
+ core of the basis is made of its structural (and artificial) columns, s,
+ and its tight rows, t, those whose slacks are not basic; there are as many
+ of each, and the basis is singular exactly when the core is.
+*/
+template <typename IntT>
+struct ExactBasis {
+    typedef BasicRational<IntT> Value;
+    typedef BasicRationalMatrix<IntT> Matrix;
+
+    const Matrix& a;                        // Constraint coefficients
+    const vector<Value>& b;                 // Constraint bounds
+    size_t m;                               // Rows
+    size_t n;                               // Structural columns
+    unsigned threads;                       // Threads for the core solves
+    vector<bool> basic;                     // Whether each column is basic
+    vector<size_t> s;                       // Basic structural columns
+    vector<size_t> t;                       // Tight rows
+    vector<Value> xs;                       // Values of the columns in s
+    vector<Value> slack;                    // Slack of each row
+    vector<Value> y;                        // Dual of each row
+
+    ExactBasis(const Matrix& a, const vector<Value>& b, unsigned threads)
+        : a(a), b(b), m(a.rows()), n(a.cols()), threads(threads),
+          basic(a.rows() + a.cols() + 1, false) {}
+
+    /* Coefficient of structural or artificial column j in row i. */
+    Value entry(size_t i, size_t j) const {
+        return j < n ? a.get(i, j) : Value(-1);
+    }
+
+    /* Coefficient of any column j in row i. */
+    Value column(size_t i, size_t j) const {
+        return j <= n ? entry(i, j) : Value(j == n + 1 + i ? 1 : 0);
+    }
+
+    void partition();
+    vector<Value> solveCore(bool transpose, const vector<Value>& rhs) const;
+    bool primal();
+    void dual(const vector<Value>& cost);
+    Value reducedCost(const vector<Value>& cost, size_t j) const;
+    void direction(size_t e, vector<Value>& ws, vector<Value>& wl) const;
+};
+
+/*
+ partition
+
+ Collects the core of the basis, s and t, in increasing order.
+
+ Arguments:     None.
+
+ Returns:       None.
+
+ Global Impact: Sets s and t.
+*/
+template <typename IntT>
+void ExactBasis<IntT>::partition() {
+    s.clear();
+    t.clear();
+    for (size_t j = 0; j <= n; j++)
+        if (basic[j])
+            s.push_back(j);
+    for (size_t i = 0; i < m; i++)
+        if (!basic[n + 1 + i])
+            t.push_back(i);
+}
+
+/*
+ solveCore
+
+ Solves the core system K z = rhs, or K^T z = rhs, where K has row r and
+ column c equal to the coefficient of column s[c] in row t[r].
+
+ Cores of sparse programs are mostly triangular, so singletons are peeled
+ off first, as basis factorizations of revised simplex codes do.  A row with
+ one nonzero left gives its variable directly, in the order found, and a
+ column with one nonzero left is found from its row last, in reverse order.
+ Only the rows and columns left over, the bump, are solved together with
+ Bareiss elimination.
+
+ Arguments:     transpose (bool) - Whether to solve with K^T
+                rhs (vector&) - Right hand side, as long as s
+
+ Returns:       (vector) - The solution.
+
+ Global Impact: Throws invalid_argument if the core is singular and
+                overflow_error if an intermediate does not fit IntT.
+*/
+template <typename IntT>
+vector<BasicRational<IntT> > ExactBasis<IntT>::solveCore(
+    bool transpose, const vector<Value>& rhs) const {
+    size_t k = s.size();
+    vector<vector<pair<size_t, Value> > > rows(k);
+    vector<vector<size_t> > cols(k);
+    for (size_t i = 0; i < k; i++) {
+        for (size_t j = 0; j < k; j++) {
+            Value v = transpose ? entry(t[j], s[i]) : entry(t[i], s[j]);
+            if (v != Value()) {
+                rows[i].push_back(make_pair(j, v));
+                cols[j].push_back(i);
+            }
+        }
+    }
+
+    // Peel singletons, recording each as a (row, column) pair
+    vector<size_t> rowCount(k), colCount(k), rowStack, colStack;
+    vector<bool> rowLive(k, true), colLive(k, true);
+    for (size_t i = 0; i < k; i++) {
+        rowCount[i] = rows[i].size();
+        colCount[i] = cols[i].size();
+        if (rowCount[i] == 0 || colCount[i] == 0)
+            throw invalid_argument("Matrix is singular.");
+        if (rowCount[i] == 1)
+            rowStack.push_back(i);
+        if (colCount[i] == 1)
+            colStack.push_back(i);
+    }
+
+    vector<pair<size_t, size_t> > early, late;
+    auto remove = [&](size_t i, size_t j) {
+        rowLive[i] = false;
+        colLive[j] = false;
+        for (size_t c = 0; c < rows[i].size(); c++) {
+            size_t jj = rows[i][c].first;
+            if (colLive[jj] && --colCount[jj] <= 1) {
+                if (colCount[jj] == 0)
+                    throw invalid_argument("Matrix is singular.");
+                colStack.push_back(jj);
+            }
+        }
+        for (size_t ii : cols[j]) {
+            if (rowLive[ii] && --rowCount[ii] <= 1) {
+                if (rowCount[ii] == 0)
+                    throw invalid_argument("Matrix is singular.");
+                rowStack.push_back(ii);
+            }
+        }
+    };
+    while (!rowStack.empty() || !colStack.empty()) {
+        if (!rowStack.empty()) {
+            size_t i = rowStack.back();
+            rowStack.pop_back();
+            if (!rowLive[i])
+                continue;
+            size_t j = 0;
+            for (size_t c = 0; c < rows[i].size(); c++)
+                if (colLive[rows[i][c].first])
+                    j = rows[i][c].first;
+            early.push_back(make_pair(i, j));
+            remove(i, j);
+        }
+        else {
+            size_t j = colStack.back();
+            colStack.pop_back();
+            if (!colLive[j])
+                continue;
+            size_t i = 0;
+            for (size_t ii : cols[j])
+                if (rowLive[ii])
+                    i = ii;
+            late.push_back(make_pair(i, j));
+            remove(i, j);
+        }
+    }
+
+    // Row i less what its known variables contribute, over the coefficient
+    // of variable j
+    vector<Value> z(k);
+    vector<bool> known(k, false);
+    auto substitute = [&](size_t i, size_t j) {
+        Value v = rhs[i], d;
+        for (size_t c = 0; c < rows[i].size(); c++) {
+            if (rows[i][c].first == j)
+                d = rows[i][c].second;
+            else if (known[rows[i][c].first])
+                v -= rows[i][c].second * z[rows[i][c].first];
+        }
+        z[j] = v / d;
+        known[j] = true;
+    };
+    for (size_t p = 0; p < early.size(); p++)
+        substitute(early[p].first, early[p].second);
+
+    vector<size_t> bumpRows, bumpCols;
+    for (size_t i = 0; i < k; i++) {
+        if (rowLive[i])
+            bumpRows.push_back(i);
+        if (colLive[i])
+            bumpCols.push_back(i);
+    }
+    size_t kb = bumpRows.size();
+    if (kb > 0) {
+        vector<size_t> index(k);
+        for (size_t c = 0; c < kb; c++)
+            index[bumpCols[c]] = c;
+
+        Matrix bump(kb, kb), r(kb, 1);
+        for (size_t q = 0; q < kb; q++) {
+            size_t i = bumpRows[q];
+            Value v = rhs[i];
+            for (size_t c = 0; c < rows[i].size(); c++) {
+                size_t j = rows[i][c].first;
+                if (colLive[j])
+                    bump.set(q, index[j], rows[i][c].second);
+                else if (known[j])
+                    v -= rows[i][c].second * z[j];
+            }
+            r.set(q, 0, v);
+        }
+
+        Matrix x = bump.solve(r, threads);
+        for (size_t c = 0; c < kb; c++) {
+            z[bumpCols[c]] = x.get(c, 0);
+            known[bumpCols[c]] = true;
+        }
+    }
+
+    for (size_t p = late.size(); p-- > 0;)
+        substitute(late[p].first, late[p].second);
+
+    return z;
+}
+
+/*
+ primal
+
+ Finds the values of the basic variables.  The core gives those of s from
+ the tight rows, and every other row's slack is what its bound leaves.
+
+ Arguments:     None.
+
+ Returns:       (bool) - Whether every value is nonnegative.
+
+ Global Impact: Sets xs and slack.  Throws invalid_argument if the basis is
+                singular and overflow_error if an intermediate does not fit
+                IntT.
+*/
+template <typename IntT>
+bool ExactBasis<IntT>::primal() {
+    vector<Value> bt(t.size());
+    for (size_t r = 0; r < t.size(); r++)
+        bt[r] = b[t[r]];
+    xs = solveCore(false, bt);
+
+    slack.assign(m, Value());
+    forEachIndex(m, s.size(), threads, [&](size_t i) {
+        if (basic[n + 1 + i]) {
+            Value v = b[i];
+            for (size_t c = 0; c < s.size(); c++) {
+                Value aij = entry(i, s[c]);
+                if (aij != Value())
+                    v -= aij * xs[c];
+            }
+            slack[i] = v;
+        }
+    });
+
+    for (size_t c = 0; c < xs.size(); c++)
+        if (xs[c] < Value())
+            return false;
+    for (size_t i = 0; i < m; i++)
+        if (slack[i] < Value())
+            return false;
+    return true;
+}
+
+/*
+ dual
+
+ Finds the duals of the basis for the given costs.  The duals of tight rows
+ solve K^T y = the costs of s, and those of other rows are 0.
+
+ Arguments:     cost (vector&) - Costs of the structural and artificial
+                                 columns
+
+ Returns:       None.
+
+ Global Impact: Sets y.  Throws overflow_error if an intermediate does not
+                fit IntT.
+*/
+template <typename IntT>
+void ExactBasis<IntT>::dual(const vector<Value>& cost) {
+    vector<Value> cs(s.size());
+    for (size_t c = 0; c < s.size(); c++)
+        cs[c] = cost[s[c]];
+    vector<Value> yt = solveCore(true, cs);
+
+    y.assign(m, Value());
+    for (size_t r = 0; r < t.size(); r++)
+        y[t[r]] = yt[r];
+}
+
+/*
+ reducedCost
+
+ Computes the reduced cost of a nonbasic column, by how much the objective
+ grows per unit it enters the basis with.
+
+ Arguments:     cost (vector&) - Costs of the structural and artificial
+                                 columns
+                j (size_t) - Column
+
+ Returns:       (Value) - The reduced cost.
+
+ Global Impact: Throws overflow_error if an intermediate does not fit IntT.
+*/
+template <typename IntT>
+BasicRational<IntT> ExactBasis<IntT>::reducedCost(
+    const vector<Value>& cost, size_t j) const {
+    if (j > n)
+        return -y[j - n - 1];
+
+    Value d = cost[j];
+    for (size_t r = 0; r < t.size(); r++) {
+        Value aij = entry(t[r], j);
+        if (aij != Value() && y[t[r]] != Value())
+            d -= y[t[r]] * aij;
+    }
+    return d;
+}
+
+/*
+ direction
+
+ Finds how the basic variables change per unit of column e entering: B w =
+ the column of e, where the core gives w on s and the other rows follow.
+
+ Arguments:     e (size_t) - Entering column
+                ws (vector&) - Set to the change of each column in s
+                wl (vector&) - Set to the change of each row's slack, 0 for
+                               tight rows
+
+ Returns:       None.
+
+ Global Impact: Throws overflow_error if an intermediate does not fit IntT.
+*/
+template <typename IntT>
+void ExactBasis<IntT>::direction(size_t e, vector<Value>& ws,
+                                 vector<Value>& wl) const {
+    vector<Value> rhs(t.size());
+    for (size_t r = 0; r < t.size(); r++)
+        rhs[r] = column(t[r], e);
+    ws = solveCore(false, rhs);
+
+    wl.assign(m, Value());
+    forEachIndex(m, s.size(), threads, [&](size_t i) {
+        if (basic[n + 1 + i]) {
+            Value v = column(i, e);
+            for (size_t c = 0; c < s.size(); c++) {
+                Value aij = entry(i, s[c]);
+                if (aij != Value() && ws[c] != Value())
+                    v -= aij * ws[c];
+            }
+            wl[i] = v;
+        }
+    });
+}
+
+/*
+ exactSimplex
+
+ Runs the revised simplex from a feasible basis, maximizing the given costs.
+ Bland's rule picks the lowest numbered column with positive reduced cost to
+ enter, and the lowest numbered of those tied in the ratio test to leave, so
+ no basis repeats.
+
+ Arguments:     e (ExactBasis&) - Feasible basis, updated in place
+                cost (vector&) - Costs of the structural and artificial
+                                 columns; slacks cost 0
+                artificial (bool) - Whether the artificial column may enter
+                pivots (size_t&) - Incremented per pivot
+
+ Returns:       (LPStatus) - Optimal, with primal values and duals of the
+                             final basis set, or Unbounded.
+
+ Global Impact: Throws overflow_error if an intermediate does not fit IntT.
+*/
+template <typename IntT>
+static LPStatus exactSimplex(ExactBasis<IntT>& e,
+                             const vector<BasicRational<IntT> >& cost,
+                             bool artificial, size_t& pivots) {
+    typedef BasicRational<IntT> Value;
+    size_t n = e.n, m = e.m, columns = n + 1 + m;
+
+    for (;;) {
+        e.partition();
+        e.primal();
+        e.dual(cost);
+
+        // Reduced costs of the structural columns are found in parallel, and
+        // the first positive one wins
+        vector<char> improves(n + 1, 0);
+        forEachIndex(n + 1, e.t.size(), e.threads, [&](size_t j) {
+            if (!e.basic[j] && (j < n || artificial))
+                improves[j] = e.reducedCost(cost, j) > Value();
+        });
+        size_t enter = find(improves.begin(), improves.end(), 1) -
+                       improves.begin();
+        if (enter > n) {
+            // A slack improves when the dual of its row is negative
+            enter = columns;
+            for (size_t i = 0; enter == columns && i < m; i++)
+                if (!e.basic[n + 1 + i] && e.y[i] < Value())
+                    enter = n + 1 + i;
+        }
+        if (enter == columns)
+            return LPStatus::Optimal;
+
+        vector<Value> ws, wl;
+        e.direction(enter, ws, wl);
+
+        // Candidates are visited by increasing column, so ties keep the first
+        size_t leave = columns;
+        Value best;
+        for (size_t c = 0; c < e.s.size(); c++) {
+            if (ws[c] > Value()) {
+                Value ratio = e.xs[c] / ws[c];
+                if (leave == columns || ratio < best) {
+                    best = ratio;
+                    leave = e.s[c];
+                }
+            }
+        }
+        for (size_t i = 0; i < m; i++) {
+            if (wl[i] > Value()) {
+                Value ratio = e.slack[i] / wl[i];
+                if (leave == columns || ratio < best) {
+                    best = ratio;
+                    leave = n + 1 + i;
+                }
+            }
+        }
+        if (leave == columns)
+            return LPStatus::Unbounded;
+
+        e.basic[enter] = true;
+        e.basic[leave] = false;
+        pivots++;
+    }
+}
+
+/*
+ exactPhaseOne
+
+ Finds a feasible basis starting from the slack basis.  If some b_i is
+ negative, the artificial column enters in the row of the most negative,
+ which makes every slack nonnegative, and the simplex then drives the
+ artificial variable to 0.  If it stays basic at 0 it is pivoted out for any
+ column with a nonzero in its row of the inverse basis, which must exist.
+
+ Arguments:     e (ExactBasis&) - Set to a feasible basis
+                pivots (size_t&) - Incremented per pivot
+
+ Returns:       (bool) - Whether the program is feasible.
+
+ Global Impact: Throws overflow_error if an intermediate does not fit IntT.
+*/
+template <typename IntT>
+static bool exactPhaseOne(ExactBasis<IntT>& e, size_t& pivots) {
+    typedef BasicRational<IntT> Value;
+    size_t n = e.n, m = e.m;
+
+    fill(e.basic.begin(), e.basic.end(), false);
+    for (size_t i = 0; i < m; i++)
+        e.basic[n + 1 + i] = true;
+    size_t low = min_element(e.b.begin(), e.b.end()) - e.b.begin();
+    if (m == 0 || e.b[low] >= Value())
+        return true;
+
+    e.basic[n] = true;
+    e.basic[n + 1 + low] = false;
+    pivots++;
+
+    vector<Value> cost(n + 1);
+    cost[n] = Value(-1);
+    exactSimplex(e, cost, true, pivots);
+    if (!e.basic[n])
+        return true;
+
+    // The artificial column is the last of s
+    size_t p = e.s.size() - 1;
+    if (e.xs[p] > Value())
+        return false;
+
+    vector<Value> unit(e.s.size());
+    unit[p] = Value(1);
+    vector<Value> z = e.solveCore(true, unit);
+    size_t enter = n;
+    for (size_t j = 0; enter == n && j < n; j++) {
+        if (e.basic[j])
+            continue;
+        Value d;
+        for (size_t r = 0; r < e.t.size(); r++)
+            d += z[r] * e.entry(e.t[r], j);
+        if (d != Value())
+            enter = j;
+    }
+    for (size_t r = 0; enter == n && r < e.t.size(); r++)
+        if (z[r] != Value())
+            enter = n + 1 + e.t[r];
+
+    e.basic[enter] = true;
+    e.basic[n] = false;
+    pivots++;
+    return true;
+}
+
+/******************************
+ PRIVATE METHODS
+ ******************************/
+/*
+ floatBasis
+
+ Runs a dense tableau simplex in doubles, with the same columns and the same
+ artificial variable as the exact simplex, but with Dantzig's rule and a
+ tolerance.  It is cut off after a number of pivots in case it cycles.
+
+ Arguments:     None.
+
+ Returns:       (vector<bool>) - Whether each column is in the basis found,
+                                 the slack basis if none was.
+
+ Global Impact: Adds to m_floatPivots.
+*/
+template <typename IntT>
+vector<bool> BasicLinearProgram<IntT>::floatBasis() {
+    size_t m = m_a.rows(), n = m_a.cols(), columns = n + 1 + m;
+    size_t w = columns + 1, limit = 50 * (m + n) + 1000;
+
+    vector<double> tab(m * w), obj(w);
+    vector<size_t> head(m);
+    for (size_t i = 0; i < m; i++) {
+        double *row = &tab[i * w];
+        for (size_t j = 0; j < n; j++)
+            row[j] = (double) m_a.get(i, j);
+        row[n] = -1;
+        row[n + 1 + i] = 1;
+        row[columns] = (double) m_b[i];
+        head[i] = n + 1 + i;
+    }
+
+    vector<bool> slacks(columns, false);
+    for (size_t i = 0; i < m; i++)
+        slacks[n + 1 + i] = true;
+
+    // Sparse programs keep sparse pivot rows for a while, so only the
+    // pivot row's nonzeros are updated in the other rows
+    vector<size_t> nonzero;
+    auto pivot = [&](size_t r, size_t e) {
+        double *pr = &tab[r * w];
+        double inv = 1 / pr[e];
+        nonzero.clear();
+        for (size_t j = 0; j < w; j++) {
+            if (pr[j] != 0) {
+                pr[j] *= inv;
+                nonzero.push_back(j);
+            }
+        }
+        for (size_t i = 0; i < m; i++) {
+            double f = tab[i * w + e];
+            if (i != r && f != 0) {
+                double *row = &tab[i * w];
+                for (size_t j : nonzero)
+                    row[j] -= f * pr[j];
+            }
+        }
+        double f = obj[e];
+        for (size_t j : nonzero)
+            obj[j] -= f * pr[j];
+        head[r] = e;
+        m_floatPivots++;
+    };
+
+    // Reduced costs of the given costs in the current basis
+    auto price = [&](const vector<double>& cost) {
+        obj = cost;
+        for (size_t i = 0; i < m; i++) {
+            double f = obj[head[i]];
+            for (size_t j = 0; f != 0 && j < w; j++)
+                obj[j] -= f * tab[i * w + j];
+        }
+    };
+
+    // True once optimal, false if unbounded or cut off
+    auto run = [&](bool artificial) {
+        for (size_t it = 0; it < limit; it++) {
+            size_t e = columns;
+            for (size_t j = 0; j < columns; j++)
+                if ((j != n || artificial) && obj[j] > FLOAT_EPS &&
+                    (e == columns || obj[j] > obj[e]))
+                    e = j;
+            if (e == columns)
+                return true;
+
+            size_t r = m;
+            for (size_t i = 0; i < m; i++) {
+                double a = tab[i * w + e];
+                if (a > FLOAT_EPS && (r == m || tab[i * w + columns] *
+                    tab[r * w + e] < tab[r * w + columns] * a))
+                    r = i;
+            }
+            if (r == m)
+                return false;
+            pivot(r, e);
+        }
+        return false;
+    };
+
+    size_t low = 0;
+    for (size_t i = 1; i < m; i++)
+        if (tab[i * w + columns] < tab[low * w + columns])
+            low = i;
+    if (m > 0 && tab[low * w + columns] < 0) {
+        pivot(low, n);
+        vector<double> cost(w, 0);
+        cost[n] = -1;
+        price(cost);
+        if (!run(true))
+            return slacks;
+
+        size_t p = find(head.begin(), head.end(), n) - head.begin();
+        if (p < m) {
+            if (tab[p * w + columns] > FLOAT_EPS)
+                return slacks;
+            size_t e = columns;
+            for (size_t j = 0; j < columns; j++)
+                if (j != n && fabs(tab[p * w + j]) > FLOAT_EPS &&
+                    (e == columns || fabs(tab[p * w + j]) >
+                                     fabs(tab[p * w + e])))
+                    e = j;
+            if (e == columns)
+                return slacks;
+            pivot(p, e);
+        }
+    }
+
+    vector<double> cost(w, 0);
+    for (size_t j = 0; j < n; j++)
+        cost[j] = (double) m_c[j];
+    price(cost);
+    run(false);
+
+    vector<bool> basis(columns, false);
+    for (size_t i = 0; i < m; i++)
+        basis[head[i]] = true;
+    return basis;
+}
+
+/******************************
+ CONSTRUCTORS
+ ******************************/
+/*
+ BasicLinearProgram
+
+ Sets up the program maximize c x subject to A x <= b and x >= 0.
+
+ Arguments:     a (Matrix&) - Constraint coefficients, m x n
+                b (vector&) - Constraint bounds, m of them
+                c (vector&) - Objective coefficients, n of them
+
+ Returns:       None.
+
+ Global Impact: Throws invalid_argument if the sizes don't match.
+*/
+template <typename IntT>
+BasicLinearProgram<IntT>::BasicLinearProgram(const Matrix& a,
+                                             const vector<Value>& b,
+                                             const vector<Value>& c)
+    : m_a(a), m_b(b), m_c(c), m_status(LPStatus::Infeasible),
+      m_floatPivots(0), m_exactPivots(0) {
+    if (b.size() != a.rows() || c.size() != a.cols())
+        throw invalid_argument("Linear program sizes don't match.");
+}
+
+/******************************
+ SOLVING
+ ******************************/
+/*
+ solve
+
+ Solves the program.  The basis found in doubles is kept if it is
+ nonsingular and exactly feasible, and the exact simplex then continues from
+ it, usually with no pivots at all; otherwise the exact simplex starts over
+ with its own first phase.
+
+ Arguments:     threads (unsigned) - Threads to use, 0 for all there are
+
+ Returns:       (LPStatus) - Whether an optimum was found, or why not.
+
+ Global Impact: Sets the status, and the solution, duals and objective when
+                optimal.  Throws overflow_error if an intermediate does not
+                fit IntT.
+*/
+template <typename IntT>
+LPStatus BasicLinearProgram<IntT>::solve(unsigned threads) {
+    size_t n = m_a.cols();
+    m_floatPivots = 0;
+    m_exactPivots = 0;
+    m_x.clear();
+    m_y.clear();
+    m_objective = Value();
+
+    ExactBasis<IntT> e(m_a, m_b, threads);
+    e.basic = floatBasis();
+    e.partition();
+
+    bool feasible = false;
+    try {
+        feasible = e.primal();
+    }
+    catch (invalid_argument &err) {
+        // The warm start basis is singular
+    }
+    if (!feasible && !exactPhaseOne(e, m_exactPivots)) {
+        m_status = LPStatus::Infeasible;
+        return m_status;
+    }
+
+    vector<Value> cost(m_c);
+    cost.push_back(Value());
+    m_status = exactSimplex(e, cost, false, m_exactPivots);
+    if (m_status != LPStatus::Optimal)
+        return m_status;
+
+    m_x.assign(n, Value());
+    for (size_t c = 0; c < e.s.size(); c++)
+        m_x[e.s[c]] = e.xs[c];
+    m_y = e.y;
+    for (size_t j = 0; j < n; j++)
+        if (m_x[j] != Value())
+            m_objective += m_c[j] * m_x[j];
+
+    return m_status;
+}
+
+/******************************
+ ACCESSORS
+ ******************************/
+template <typename IntT>
+LPStatus BasicLinearProgram<IntT>::status() const {
+    return m_status;
+}
+
+/*
+ solution, duals, objective
+
+ Return the optimal x, the optimal duals y, with y >= 0, A^T y >= c and
+ b y = c x, and the optimal objective.  They are empty, or 0, unless the
+ last solve found an optimum.
+*/
+template <typename IntT>
+const vector<BasicRational<IntT> >&
+BasicLinearProgram<IntT>::solution() const {
+    return m_x;
+}
+
+template <typename IntT>
+const vector<BasicRational<IntT> >& BasicLinearProgram<IntT>::duals() const {
+    return m_y;
+}
+
+template <typename IntT>
+const BasicRational<IntT>& BasicLinearProgram<IntT>::objective() const {
+    return m_objective;
+}
+
+template <typename IntT>
+size_t BasicLinearProgram<IntT>::floatPivots() const {
+    return m_floatPivots;
+}
+
+template <typename IntT>
+size_t BasicLinearProgram<IntT>::exactPivots() const {
+    return m_exactPivots;
+}
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+template class BasicLinearProgram<int32_t>;
+template class BasicLinearProgram<int64_t>;
+template class BasicLinearProgram<int128_t>;
+template class BasicLinearProgram<BigInt>;
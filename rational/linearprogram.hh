@@ -0,0 +1,109 @@
+/*
+ linearprogram.hh
+
+ Contains the BasicLinearProgram class template definition, which solves
+ linear programs exactly over BasicRationals.
+*/
+
+#ifndef LINEARPROGRAM
+#define LINEARPROGRAM
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "rational.hh"
+#include "rationalmatrix.hh"
+
+/*
+ LPStatus
+
+ Outcome of solving a linear program.
+*/
+enum class LPStatus { Optimal, Infeasible, Unbounded };
+
+/*
+ BasicLinearProgram Class
+
+ Maximizes c x subject to A x <= b and x >= 0, exactly.  Row i of A gets a
+ slack variable, and a basis is a choice of m of the n + m variables.
+
+ A basis is first found with a dense tableau simplex in doubles, which is
+ fast but may land on a vertex that is slightly infeasible or not quite
+ optimal.  It is then checked, and if need be repaired, by a revised simplex
+ in BasicRationals.  Only structural variables and the rows whose slacks are
+ not basic (the tight rows) make up the core of a basis, so each exact solve
+ is of a square system no bigger than the number of tight rows, found by
+ Bareiss elimination in a BasicRationalMatrix, and the other rows are only
+ substituted into.  The exact simplex pivots by Bland's rule, so it never
+ cycles.  If the warm start is no use, the exact simplex starts over from the
+ slack basis, with a phase that brings in one artificial variable to reach
+ a feasible basis when some b_i is negative.
+
+ The reported solution, duals and objective are exact and are only reported
+ once primal and dual feasibility of the final basis hold exactly.  With a
+ fixed width IntT, overflow_error is thrown if an intermediate does not fit,
+ and BigLinearProgram never overflows.
+*/
+template <typename IntT>
+class BasicLinearProgram {
+public:
+    typedef BasicRational<IntT> Value;
+    typedef BasicRationalMatrix<IntT> Matrix;
+
+private:
+    /******************************
+     MEMBERS
+     ******************************/
+    Matrix m_a;                             // Constraint coefficients
+    std::vector<Value> m_b;                 // Constraint bounds
+    std::vector<Value> m_c;                 // Objective coefficients
+    LPStatus m_status;                      // Outcome of the last solve
+    std::vector<Value> m_x;                 // Optimal solution
+    std::vector<Value> m_y;                 // Optimal duals, one per row
+    Value m_objective;                      // Optimal objective
+    size_t m_floatPivots;                   // Pivots in doubles
+    size_t m_exactPivots;                   // Pivots in Rationals
+
+    /******************************
+     PRIVATE METHODS
+     ******************************/
+    std::vector<bool> floatBasis();         // Warm start basis
+
+public:
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+    BasicLinearProgram(const Matrix& a, const std::vector<Value>& b,
+                       const std::vector<Value>& c);    // max cx, Ax <= b
+
+    /******************************
+     SOLVING
+     ******************************/
+    LPStatus solve(unsigned threads = 0);   // Solves, returning the status
+
+    /******************************
+     ACCESSORS
+     ******************************/
+    LPStatus status() const;                // Outcome of the last solve
+    const std::vector<Value>& solution() const;     // x when optimal
+    const std::vector<Value>& duals() const;        // y when optimal
+    const Value& objective() const;         // c x when optimal
+    size_t floatPivots() const;             // Pivots taken in doubles
+    size_t exactPivots() const;             // Pivots taken in Rationals
+};
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+typedef BasicLinearProgram<int32_t>  LinearProgram;
+typedef BasicLinearProgram<int64_t>  LinearProgram64;
+typedef BasicLinearProgram<int128_t> LinearProgram128;
+typedef BasicLinearProgram<BigInt>   BigLinearProgram;
+
+/* Defined in linearprogram.cc for these four types only. */
+extern template class BasicLinearProgram<int32_t>;
+extern template class BasicLinearProgram<int64_t>;
+extern template class BasicLinearProgram<int128_t>;
+extern template class BasicLinearProgram<BigInt>;
+
+#endif // ifndef LINEARPROGRAM
@@ -0,0 +1,180 @@
+/*
+ parallel.cc
+
+ Contains the implementation of the parallel reductions declared in
+ parallel.hh, instantiated for 32, 64 and 128-bit integers, and of the
+ forEachChunk helper they and other parallel code share.
+*/
+
+#include "parallel.hh"
+#include "accumulator.hh"
+
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/*
+ forEachChunk
+
+ Calls f on every chunk index below chunks, spread over up to threads
+ threads.  Thread t takes a contiguous run of chunks.  An exception thrown by
+ f is kept rather than lost with its thread, and once every thread is done
+ the one from the lowest chunk is rethrown.  With no chunks it does nothing.
+
+ Arguments:     chunks (size_t) - Number of chunks
+                threads (unsigned) - Threads to use, 0 for all there are
+                f (function) - Called once with each chunk index
+
+ Returns:       None.
+
+ Global Impact: Rethrows the first exception thrown by f.
+*/
+void forEachChunk(size_t chunks, unsigned threads,
+                  const function<void(size_t)>& f) {
+    if (chunks == 0)
+        return;
+    if (threads == 0)
+        threads = thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    if (threads > chunks)
+        threads = (unsigned) chunks;
+
+    vector<exception_ptr> errors(chunks);
+    auto run = [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            try {
+                f(c);
+            } catch (...) {
+                errors[c] = current_exception();
+            }
+        }
+    };
+
+    // The calling thread takes the first run itself
+    vector<thread> pool;
+    for (unsigned t = 1; t < threads; t++)
+        pool.push_back(thread(run, chunks * t / threads,
+                              chunks * (t + 1) / threads));
+    run(0, chunks / threads);
+    for (size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+
+    for (size_t c = 0; c < chunks; c++)
+        if (errors[c])
+            rethrow_exception(errors[c]);
+
+    return;
+}
+
+/*
+ treeMerge
+
+ Merges partial results pairwise, neighbours first, until one is left: with
+ four parts, 0 takes 1 and 2 takes 3, then 0 takes 2.  The shape only
+ depends on the number of parts.
+
+ Arguments:     parts (vector<T>&) - Partial results, at least one
+                merge (function) - Merges its second argument into its first
+
+ Returns:       (T&) - parts[0], holding the merged result.
+*/
+template <typename T>
+static T& treeMerge(vector<T>& parts, const function<void(T&, T&)>& merge) {
+    for (size_t step = 1; step < parts.size(); step *= 2)
+        for (size_t i = 0; i + step < parts.size(); i += 2 * step)
+            merge(parts[i], parts[i + step]);
+
+    return parts[0];
+}
+
+/*
+ parallelSum
+
+ Sums an array of BasicRationals exactly across threads.
+
+ Arguments:     terms (Rational*) - Terms to sum
+                n (size_t) - Number of terms
+                threads (unsigned) - Threads to use, 0 for all there are
+
+ Returns:       (Rational) - The sum in simplest form.
+
+ Global Impact: Throws overflow_error if the sum, or a partial sum, does not
+                fit IntT.
+*/
+template <typename IntT>
+BasicRational<IntT> parallelSum(const BasicRational<IntT> *terms, size_t n,
+                                unsigned threads) {
+    typedef BasicRationalAccumulator<IntT> Accumulator;
+    size_t chunks = (n + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+    if (chunks == 0)
+        return BasicRational<IntT>();
+
+    vector<Accumulator> parts(chunks);
+    forEachChunk(chunks, threads, [&](size_t c) {
+        size_t begin = c * PARALLEL_CHUNK;
+        size_t end = begin + PARALLEL_CHUNK < n ? begin + PARALLEL_CHUNK : n;
+        parts[c].addBatch(terms + begin, end - begin);
+    });
+
+    return treeMerge<Accumulator>(parts, [](Accumulator& a, Accumulator& b) {
+        a.merge(b);
+    }).result();
+}
+
+/*
+ parallelProduct
+
+ Multiplies an array of BasicRationals exactly across threads.  Chunk
+ products use operator*=, which cancels across before multiplying and so keeps
+ them as small as they can be.
+
+ Arguments:     terms (Rational*) - Terms to multiply
+                n (size_t) - Number of terms
+                threads (unsigned) - Threads to use, 0 for all there are
+
+ Returns:       (Rational) - The product in simplest form, 1 if n is 0.
+
+ Global Impact: Throws overflow_error if the product, or a partial product,
+                does not fit IntT.
+*/
+template <typename IntT>
+BasicRational<IntT> parallelProduct(const BasicRational<IntT> *terms,
+                                    size_t n, unsigned threads) {
+    typedef BasicRational<IntT> Value;
+    size_t chunks = (n + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+    if (chunks == 0)
+        return Value(1);
+
+    vector<Value> parts(chunks, Value(1));
+    forEachChunk(chunks, threads, [&](size_t c) {
+        size_t begin = c * PARALLEL_CHUNK;
+        size_t end = begin + PARALLEL_CHUNK < n ? begin + PARALLEL_CHUNK : n;
+        for (size_t i = begin; i < end; i++)
+            parts[c] *= terms[i];
+    });
+
+    return treeMerge<Value>(parts, [](Value& a, Value& b) {
+        a *= b;
+    });
+}
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+template Rational parallelSum(const Rational *terms, size_t n,
+                              unsigned threads);
+template Rational64 parallelSum(const Rational64 *terms, size_t n,
+                                unsigned threads);
+template Rational128 parallelSum(const Rational128 *terms, size_t n,
+                                 unsigned threads);
+
+template Rational parallelProduct(const Rational *terms, size_t n,
+                                  unsigned threads);
+template Rational64 parallelProduct(const Rational64 *terms, size_t n,
+                                    unsigned threads);
+template Rational128 parallelProduct(const Rational128 *terms, size_t n,
+                                     unsigned threads);
@@ -0,0 +1,50 @@
+/*
+ parallel.hh
+
+ Contains exact sums and products of Rational arrays computed across threads,
+ and the helper that spreads chunks of work over them.
+*/
+
+#ifndef PARALLEL
+#define PARALLEL
+
+#include <stddef.h>
+#include <functional>
+#include "rational.hh"
+
+/* Terms per chunk.  Arrays are always split into chunks of this size,
+   whatever the number of threads, so that results and the overflow_errors
+   thrown along the way don't depend on it. */
+const size_t PARALLEL_CHUNK = (size_t) 1 << 16;
+
+/*
+ forEachChunk
+
+ Calls f once with each chunk index below chunks, on up to threads threads,
+ or as many as the hardware has if threads is 0.  Each thread takes a
+ contiguous run of chunks.  Once all are done, the exception thrown for the
+ lowest chunk, if any, is rethrown.
+*/
+void forEachChunk(size_t chunks, unsigned threads,
+                  const std::function<void(size_t)>& f);
+
+/*
+ parallelSum, parallelProduct
+
+ Sum or multiply n BasicRationals exactly using up to threads threads, or as
+ many as the hardware has if threads is 0.  Each chunk of PARALLEL_CHUNK
+ terms is summed into a BasicRationalAccumulator, or multiplied together, by
+ one of the threads, and the chunk results are then merged pairwise in a
+ fixed binary tree so that the operands of each merge stay about the same
+ size.  overflow_error is thrown if a chunk result or a merge does not fit
+ IntT; if several chunks fail, the error of the first is the one thrown.
+*/
+template <typename IntT>
+BasicRational<IntT> parallelSum(const BasicRational<IntT> *terms, size_t n,
+                                unsigned threads = 0);
+
+template <typename IntT>
+BasicRational<IntT> parallelProduct(const BasicRational<IntT> *terms,
+                                    size_t n, unsigned threads = 0);
+
+#endif // ifndef PARALLEL
@@ -1,9 +1,11 @@
 /*
  rational.cc
 
- Contains the implementation of the Rational class defined in rational.hh.
- This allows the user to use the Rational class in lieu of double or float to
- represent rational numbers.
+ Contains the conversions from double and the stream output of the
+ BasicRational class template defined in rational.hh, whose constexpr members
+ are defined in the header.  This allows the user to use the Rational class
+ in lieu of double or float to represent rational numbers.  The template is
+ instantiated here for 32, 64 and 128-bit integers and for BigInt.
 
  Revisions:
     09 Apr 2017 - Tim Menninger: Created
@@ -12,475 +14,393 @@
 #include "rational.hh"
 #include "common.hh"
 
-using namespace std;
-
-/*
- simplify
-
- Simplifies the Rational values so that m_num/m_denom is in simplest form.
-
- Arguments:     None.
-
- Returns:       None.
-
- Global Impact: Updates m_num and m_denom
-*/
-void Rational::simplify() {
-    // Get GCD of numerator and denominator to divide through
-    int gcd = GCD(m_num, m_denom);
-
-    // New values are in simplest form after dividing out GCD
-    m_num   /= gcd;
-    m_denom /= gcd;
+#include <cmath>
+#include <stdexcept>
 
-    // Ensure that the denominator is positive
-    m_num *= sign(m_denom);
-    m_denom *= sign(m_denom);
-
-    return;
-}
-
-/******************************
- CONSTRUCTORS
- ******************************/
- Rational::Rational(int n, int d) : m_num(n), m_denom(d) {
-     // Can't have a zero in the denominator of a rational number
-     if (d == 0)
-     throw invalid_argument("Denominator must be nonzero.");
-
-     // Simplify values
-     simplify();
-
-     return;
- }
-Rational::Rational(int n) : m_num(n), m_denom(1) {}
-Rational::Rational() : m_num(0), m_denom(1) {}
-
-/******************************
- DESTRUCTOR
- ******************************/
-Rational::~Rational() {}
+using namespace std;
 
 /******************************
- ARITHMETIC
+ CONVERSION FROM DOUBLE
  ******************************/
 /*
- reciprocal
+ splitDouble
 
- Returns the reciprocal of the Rational values
+ Splits a finite double into m * 2^e exactly, with m odd or 0.
 
- Arguments:     None.
-
- Returns:       None.
+ Arguments:     x (double) - Value to split, whose sign is ignored
+                m (uint64_t&) - Set to the odd mantissa, below 2^53
+                e (int&) - Set to the exponent
 
- Global Impact: None.
+ Returns:       (bool) - False if x is NaN or infinite.
 */
-Rational Rational::reciprocal() {
-    return Rational(m_denom, m_num);
+static bool splitDouble(double x, uint64_t& m, int& e) {
+    if (!isfinite(x))
+        return false;
+
+    int exp = 0;
+    m = (uint64_t) ldexp(frexp(fabs(x), &exp), 53);
+    e = exp - 53;
+    if (m == 0) {
+        e = 0;
+        return true;
+    }
+    int zeros = ctz(m);
+    m >>= zeros;
+    e += zeros;
+
+    return true;
 }
 
-/******************************
- ACCESSORS
- ******************************/
 /*
- denom
+ pow2
 
- Returns the denominator of this Rational instance.
+ Computes 2^s as a BigInt.
 
- Arguments:     None.
+ Arguments:     s (int) - Nonnegative exponent
 
- Returns:       m_denom (int) - The denominator.
-
- Global Impact: None.
+ Returns:       (BigInt) - 2^s.
 */
-int Rational::denom() {
-    return m_denom;
-}
+static BigInt pow2(int s) {
+    BigInt out(1);
+    for (; s >= 62; s -= 62)
+        out *= BigInt((int64_t) 1 << 62);
 
-/*
- num
-
- Returns the numerator of this Rational instance.
-
- Arguments:     None.
-
- Returns:       m_num (int) - The numerator.
-
- Global Impact: None.
-*/
-int Rational::num() {
-    return m_num;
+    return out * BigInt((int64_t) 1 << s);
 }
 
-/******************************
- OPERATORS
- ******************************/
 /*
- unary negation
-
- Returns the unary negation of this Rational instance by returning -1 *
- numerator / denominator
+ toBigInt, toInt128
 
- Arguments:     None.
-
- Returns:       (Rational) - Unary negation of this Rational instance.
-
- Global Impact: None.
+ Convert nonnegative 128-bit integers to and from BigInt.
 */
-const Rational Rational::operator-() {
-    // Do unary negation for numerator and denominator
-    return Rational(-1 * m_num, m_denom);
+static BigInt toBigInt(int128_t v) {
+    BigInt two32((int64_t) 1 << 32);
+    return BigInt((int64_t) (v >> 64)) * two32 * two32 +
+           BigInt((int64_t) ((uint64_t) v >> 32)) * two32 +
+           BigInt((int64_t) ((uint64_t) v & 0xFFFFFFFF));
 }
 
-/*
- Add
-
- Returns the sum of this Rational instance and the argued one.
-
- Arguments:     r (Rational&) - Added to this Rational instance.
-
- Returns:       (Rational) - Sum of this Rational and argued one.
-
- Global Impact: None.
-*/
-const Rational Rational::operator+(const Rational& r) {
-    // Put fractions in common denominator, which we can do by multiplying
-    // each by denominator/denominator of the other
-    int d = this->m_denom * r.m_denom;
-    int n = this->m_num * r.m_denom +
-               r.m_num * this->m_denom;
-
-    return Rational(n, d);
+static int128_t toInt128(const BigInt& b) {
+    BigInt two64 = BigInt((int64_t) 1 << 32) * BigInt((int64_t) 1 << 32);
+    int128_t hi = (int64_t) (b / two64);
+    uint64_t lo = (uint64_t) (int64_t) (b % two64);
+    return (hi << 64) | lo;
 }
 
 /*
- Subtract
-
- Returns the difference of this Rational instance and the argued one.  This
- works by adding the negative of the argument.
+ pastBound
 
- Arguments:     r (Rational&) - Subtracted from this Rational instance.
-
- Returns:       (Rational) - Difference of this Rational and argued one.
-
- Global Impact: None.
+ Returns true if a * b is more than room, without dividing and without
+ overflowing.
 */
-const Rational Rational::operator-(const Rational& r) {
-    // Add the negative
-    Rational out = *this + ((Rational) r * Rational(-1));
-    out.simplify();
-
-    return out;
+template <typename T>
+static inline bool pastBound(T a, T b, T room) {
+    T product = 0;
+    return __builtin_mul_overflow(a, b, &product) || product > room;
 }
 
-/*
- Divide
-
- Returns the quotient of this Rational instance and the argued one.  This works
- by multiplying by the reciprocal of the argument.
-
- Arguments:     r (Rational&) - This Rational instance divided by r
-
- Returns:       (Rational) - Quotient of this Rational and argued one.
-
- Global Impact: None.
-*/
-const Rational Rational::operator/(const Rational& r) {
-    // Multiply by reciprocal
-    Rational out = *this * ((Rational) r).reciprocal();
-    out.simplify();
-
-    return out;
+static inline bool pastBound(const BigInt& a, const BigInt& b,
+                             const BigInt& room) {
+    return a * b > room;
 }
 
 /*
- Multiply
-
- Returns the product of this Rational instance and the argued one.
-
- Arguments:     r (Rational&) - Multiplied by this Rational instance.
-
- Returns:       (Rational) - Product of this Rational and argued one.
+ bestApproximation
+
+ Finds the fraction closest to n/d among those with a denominator of at most
+ maxDenom and, if bounded, a numerator of at most maxNum.  The convergents of
+ the continued fraction of n/d are taken until the next would pass a bound,
+ which is O(log maxDenom) steps.  With h/k and h'/k' the last two
+ convergents, the best fraction is then either h/k or the semiconvergent
+
+    (h' + j*h) / (k' + j*k)     with j as large as the bounds allow
+
+ The semiconvergent is closer exactly when t < 2j + k'/k, where t is the
+ complete quotient whose integer part a was too large to take (Khinchin,
+ Continued Fractions, theorem 15).  Since j < a, that only needs the
+ remainder of t compared when 2j = a.  Ties go to h/k, whose denominator is
+ smaller.
+
+ Arguments:     n (T) - Nonnegative numerator
+                d (T) - Positive denominator
+                maxNum (T&) - Largest numerator, if bounded
+                maxDenom (T&) - Largest denominator, positive
+                bounded (bool) - True if numerators are bounded by maxNum
+                num (T&) - Set to the numerator found
+                den (T&) - Set to the denominator found
 
- Global Impact: This instance overwritten with result.
+ Returns:       None.
 */
-const Rational Rational::operator*(const Rational& r) {
-    // Multiply numerators with each other and then denominators
-    int n = this->m_num * r.m_num;
-    int d = this->m_denom * r.m_denom;
-
-    return Rational(n, d);
-}
-
-/*
- Add
+template <typename T>
+static void bestApproximation(T n, T d, const T& maxNum, const T& maxDenom,
+                              bool bounded, T& num, T& den) {
+    T p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+    for (;;) {
+        T a = n / d;
+        T r = n - a * d;
+
+        // Bounds are only checked once there is a convergent to fall back on
+        if (q1 != 0 && (pastBound(a, q1, maxDenom - q0) ||
+                        (bounded && pastBound(a, p1, maxNum - p0)))) {
+            T j = (maxDenom - q0) / q1;
+            if (bounded && p1 != 0 && (maxNum - p0) / p1 < j)
+                j = (maxNum - p0) / p1;
+
+            if (j + j > a || (j + j == a && compareCross(r, d, q0, q1) < 0)) {
+                num = p0 + j * p1;
+                den = q0 + j * q1;
+            } else {
+                num = p1;
+                den = q1;
+            }
+            return;
+        }
+
+        T p2 = p0 + a * p1, q2 = q0 + a * q1;
+        p0 = p1;
+        q0 = q1;
+        p1 = p2;
+        q1 = q2;
+        if (r == 0)
+            break;
+        n = d;
+        d = r;
+    }
+
+    num = p1;
+    den = q1;
 
- Returns the sum of this Rational instance and the argued one and saves the
- value in the instance.
-
- Arguments:     r (Rational&) - Added to this Rational instance.
-
- Returns:       (Rational) - Sum of this Rational and argued one.
-
- Global Impact: This instance overwritten with result.
-*/
-const Rational& Rational::operator+=(const Rational& r) {
-    // Add and then store in this instance
-    *this = *this + r;
-    return *this;
+    return;
 }
 
 /*
- Subtract
+ approximateDyadic
 
- Returns the difference of this Rational instance and the argued one.  This
- works by adding the negative of the argument.  It saves the result in this
- instance.
+ Finds the magnitude of the best approximation of m * 2^e.  The continued
+ fraction runs on 64-bit integers when 2^-e fits them, which is so for most
+ doubles, and otherwise on 128-bit integers or BigInts.
 
- Arguments:     r (Rational&) - Subtracted from this Rational instance.
+ Arguments:     m (uint64_t) - Odd mantissa
+                e (int) - Exponent
+                maxDenom (IntT) - Largest denominator, positive
+                num (IntT&) - Set to the numerator magnitude
+                den (IntT&) - Set to the denominator
 
- Returns:       (Rational) - Difference of this Rational and argued one.
+ Returns:       None.
 
- Global Impact: This instance overwritten with result.
+ Global Impact: Throws overflow_error if the integer part of m * 2^e does
+                not fit IntT.
 */
-const Rational& Rational::operator-=(const Rational& r) {
-    // Subtract and store result in this instance
-    *this = *this - r;
-    return *this;
-}
-
-/*
- Divide
-
- Returns the quotient of this Rational instance and the argued one.  This works
- by multiplying by the reciprocal of the argument.  The result is stored in
- this instance.
+template <typename IntT>
+static void approximateDyadic(uint64_t m, int e, IntT maxDenom, IntT& num,
+                              IntT& den) {
+    const IntT maxNum = RationalTraits<IntT>::max();
+    int s = -e;
+    int128_t whole = e > 126 - 53 ? -1 : e >= 0 ? (int128_t) m << e
+                   : s < 64 ? (int128_t) (m >> s) : 0;
+    if (whole < 0 || whole > (int128_t) maxNum)
+        throw overflow_error("Rational does not fit its integer type.");
+
+    if (s <= 0) {
+        num = (IntT) whole;
+        den = 1;
+    } else if (s <= 62 && sizeof(IntT) <= sizeof(int64_t)) {
+        int64_t n = 0, d = 0;
+        bestApproximation<int64_t>((int64_t) m, (int64_t) 1 << s,
+                                   (int64_t) maxNum, (int64_t) maxDenom,
+                                   true, n, d);
+        num = (IntT) n;
+        den = (IntT) d;
+    } else if (s <= 126) {
+        int128_t n = 0, d = 0;
+        bestApproximation<int128_t>((int128_t) m, (int128_t) 1 << s, maxNum,
+                                    maxDenom, true, n, d);
+        num = (IntT) n;
+        den = (IntT) d;
+    } else if (sizeof(IntT) <= sizeof(int64_t)) {
+        // Below 2^-73 and nearer 0 than to 1/maxDenom
+        num = 0;
+        den = 1;
+    } else {
+        // Any numerator found is below 2^54, so the bound can be dropped
+        BigInt n, d;
+        bestApproximation<BigInt>(BigInt((int64_t) m), pow2(s), BigInt(),
+                                  toBigInt(maxDenom), false, n, d);
+        num = (IntT) (int64_t) n;
+        den = (IntT) toInt128(d);
+    }
 
- Arguments:     r (Rational&) - This Rational instance divided by r
-
- Returns:       (Rational) - Quotient of this Rational and argued one.
-
- Global Impact: None.
-*/
-const Rational& Rational::operator/=(const Rational& r) {
-    // Divide then return
-    *this = *this / r;
-    return *this;
+    return;
 }
 
-/*
- Multiply
-
- Returns the product of this Rational instance and the argued one.  Then the
- result is stored in this instance.
-
- Arguments:     r (Rational&) - Multiplied by this Rational instance.
-
- Returns:       (Rational) - Product of this Rational and argued one.
+static void approximateDyadic(uint64_t m, int e, BigInt maxDenom, BigInt& num,
+                              BigInt& den) {
+    if (e >= 0) {
+        num = BigInt((int64_t) m) * pow2(e);
+        den = 1;
+        return;
+    }
+    bestApproximation<BigInt>(BigInt((int64_t) m), pow2(-e), BigInt(),
+                              maxDenom, false, num, den);
 
- Global Impact: This instance overwritten with result.
-*/
-const Rational& Rational::operator*=(const Rational& r) {
-    // Multiply then return
-    *this = *this * r;
-    return *this;
+    return;
 }
 
 /*
- Pre Increment
+ exactDyadic
 
- Increments the Rational instance, overwriting it, then returns the incremented
- Rational.
+ Converts m * 2^e to a numerator and denominator, which are in simplest form
+ since m is odd.
 
- Arguments:     None.
+ Arguments:     m (uint64_t) - Odd mantissa
+                e (int) - Exponent
+                num (IntT&) - Set to the numerator magnitude
+                den (IntT&) - Set to the denominator
 
- Returns:       (Rational) - Incremented version of rational
+ Returns:       None.
 
- Global Impact: This instance overwritten with result.
+ Global Impact: Throws overflow_error if either does not fit IntT.
 */
-const Rational& Rational::operator++() {
-    // Add one then return
-    *this = *this + Rational(1);
-    return *this;
-}
-
-/*
- Pre Decrement
+template <typename IntT>
+static void exactDyadic(uint64_t m, int e, IntT& num, IntT& den) {
+    const int128_t maxNum = RationalTraits<IntT>::max();
+    const int bits = 8 * sizeof(IntT) - 1;
+    if (e >= 0 ? e > 126 - 53 || ((int128_t) m << e) > maxNum
+               : -e >= bits || (int128_t) m > maxNum)
+        throw overflow_error("Rational does not fit its integer type.");
 
- Increments the Rational instance, overwriting it, then returns the decremented
- Rational.
+    num = (IntT) (e >= 0 ? (int128_t) m << e : (int128_t) m);
+    den = (IntT) (e >= 0 ? 1 : (int128_t) 1 << -e);
 
- Arguments:     None.
-
- Returns:       (Rational) - Decremented version of rational
-
- Global Impact: This instance overwritten with result.
-*/
-const Rational& Rational::operator--() {
-    // Subtract one then return
-    *this = *this + Rational(-1);
-    return *this;
+    return;
 }
 
-/*
- Post Increment
-
- Increments the Rational instance, overwriting it, then returns the original
- Rational.
-
- Arguments:     None.
-
- Returns:       (Rational) - Original version of rational
+static void exactDyadic(uint64_t m, int e, BigInt& num, BigInt& den) {
+    num = BigInt((int64_t) m);
+    den = 1;
+    if (e >= 0)
+        num *= pow2(e);
+    else
+        den = pow2(-e);
 
- Global Impact: This instance overwritten with result.
-*/
-const Rational Rational::operator++(int) {
-    // Store the original version that will be returned
-    Rational out = *this;
-
-    // Increment the instance
-    ++*this;
-
-    return out;
+    return;
 }
 
 /*
- Post Decrement
+ approximate
 
- Decrements the Rational instance, overwriting it, then returns the original
- Rational.
+ Returns the BasicRational closest to x whose denominator is at most
+ maxDenom, and whose numerator fits IntT.  Of two equally close, the one
+ with the smaller denominator is returned.
 
- Arguments:     None.
+ Arguments:     x (double) - Value to approximate
+                maxDenom (IntT) - Largest denominator allowed, positive
 
- Returns:       (Rational) - Original version of rational
+ Returns:       (Rational) - The best approximation of x.
 
- Global Impact: This instance overwritten with result.
+ Global Impact: Throws invalid_argument if x is not finite or maxDenom is not
+                positive, and overflow_error if the integer part of x does
+                not fit IntT.
 */
-const Rational Rational::operator--(int) {
-    // Store the original version that will be returned
-    Rational out = *this;
-
-    // Decrement the instance
-    --*this;
+template <typename IntT>
+BasicRational<IntT> BasicRational<IntT>::approximate(double x,
+                                                     IntT maxDenom) {
+    BasicRational out;
+    approximate(&x, 1, maxDenom, &out);
 
     return out;
 }
 
-/******************************
- COMPARATORS
- ******************************/
 /*
- Less than operator
-
- Returns true if this Rational instance is less than the argued one.
+ approximate
 
- Arguments:     r (Rational) - Instance this is compared to
-
- Returns:       (bool) - True if this is less than r
-*/
-const bool Rational::operator<(Rational& r) {
-    return (double) *this < (double) r;
-}
-
-/*
- Greater than operator
+ Finds the best approximation of each of an array of doubles, as the single
+ value version does.
 
- Returns true if this Rational instance is greater than the argued one.
+ Arguments:     x (double*) - Values to approximate
+                n (size_t) - Number of values
+                maxDenom (IntT) - Largest denominator allowed, positive
+                out (Rational*) - Where the approximations are stored
 
- Arguments:     r (Rational) - Instance this is compared to
+ Returns:       None.
 
- Returns:       (bool) - True if this is greater than r
+ Global Impact: Throws like the single value version.  The values before the
+                one that threw have already been stored.
 */
-const bool Rational::operator>(Rational& r) {
-    return (double) *this > (double) r;
-}
-
-/*
- Less than or equal to operator
-
- Returns true if this Rational instance is less than or equal to the argued
- one.
+template <typename IntT>
+void BasicRational<IntT>::approximate(const double *x, size_t n,
+                                      IntT maxDenom, BasicRational *out) {
+    if (!(maxDenom >= 1))
+        throw invalid_argument("Denominator bound must be positive.");
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t m = 0;
+        int e = 0;
+        if (!splitDouble(x[i], m, e))
+            throw invalid_argument("Only finite values are rational.");
+
+        IntT num = 0, den = 1;
+        approximateDyadic(m, e, maxDenom, num, den);
+        out[i].narrow(x[i] < 0 ? -(Wide) num : (Wide) num, den);
+    }
 
- Arguments:     r (Rational) - Instance this is compared to
-
- Returns:       (bool) - True if this is less than or equal to r
-*/
-const bool Rational::operator<=(Rational& r) {
-    return (double) *this <= (double) r;
+    return;
 }
 
 /*
- Greater than or equal to operator
-
- Returns true if this Rational instance is greater than or equal to the argued
- one.
-
- Arguments:     r (Rational) - Instance this is compared to
+ fromDoubleExact
 
- Returns:       (bool) - True if this is greater than or equal to r
-*/
-const bool Rational::operator>=(Rational& r) {
-    return (double) *this >= (double) r;
-}
+ Returns the BasicRational equal to x, whose denominator is a power of two.
 
-/*
- Equal to operator
+ Arguments:     x (double) - Value to convert
 
- Returns true if this Rational instance is equal to the argued one.
+ Returns:       (Rational) - Exactly x.
 
- Arguments:     r (Rational) - Instance this is compared to
-
- Returns:       (bool) - True if this is equal to r
+ Global Impact: Throws invalid_argument if x is not finite and overflow_error
+                if x does not fit IntT exactly.
 */
-const bool Rational::operator==(Rational& r) {
-    return (double) *this == (double) r;
-}
+template <typename IntT>
+BasicRational<IntT> BasicRational<IntT>::fromDoubleExact(double x) {
+    uint64_t m = 0;
+    int e = 0;
+    if (!splitDouble(x, m, e))
+        throw invalid_argument("Only finite values are rational.");
+
+    IntT num = 0, den = 1;
+    exactDyadic(m, e, num, den);
+    BasicRational out;
+    out.narrow(x < 0 ? -(Wide) num : (Wide) num, den);
 
-/*
- Not equal to operator
-
- Returns true if this Rational instance is not equal to the argued one.
-
- Arguments:     r (Rational) - Instance this is compared to
-
- Returns:       (bool) - True if this is not equal to r
-*/
-const bool Rational::operator!=(Rational& r) {
-    return (double) *this != (double) r;
+    return out;
 }
 
 /******************************
- IMPLICIT CASTING
+ STREAM OUTPUT
  ******************************/
-/*
- float implicit converter
-
- Converts the Rational into a float.
-
- Arguments:     None.
-
- Returns:       (float) - The Rational as a float.
-*/
-const Rational::operator float() {
-    return (float) m_num / m_denom;
-}
 
 /*
- double implicit converter
+ writeInt
 
- Converts the Rational into a double.
+ Writes an integer onto ostream.  ostream has no operator for 128-bit
+ integers, so native integers are formatted by the writeInt of common.hh
+ and written at once.  BigInt has its own operator.
 
- Arguments:     None.
+ Arguments:     out (ostream&) - Stream to write to
+                n (T) - Integer to write
 
- Returns:       (double) - The Rational as a double.
+ Returns:       None.
 */
-const Rational::operator double() {
-    return (double) m_num / m_denom;
+template <typename T>
+static void writeInt(ostream& out, T n) {
+    char digits[41];
+    char *end = digits + sizeof(digits);
+    char *p = writeInt(end, n);
+    out.write(p, end - p);
 }
 
-/******************************
- STREAM OUTPUT
- ******************************/
+static void writeInt(ostream& out, const BigInt& n) {
+    out << n;
+}
 
 /*
  ostream operator
@@ -492,14 +412,30 @@ const Rational::operator double() {
 
  Returns:       (ostream) - The ostream that the Rational is output onto
 */
-ostream& operator<<(ostream& out, const Rational& r) {
+template <typename IntT>
+ostream& operator<<(ostream& out, const BasicRational<IntT>& r) {
     // Get the numerator and denominator for easier accessing
-    int n = r.m_num;
-    int d = r.m_denom;
+    IntT n = r.num();
+    IntT d = r.denom();
     // Put the numerator on the ostream. Only put the denominator if it != 1
-    out << n;
-    if (d != 1)
-        out << "/" << d;
+    writeInt(out, n);
+    if (d != 1) {
+        out << "/";
+        writeInt(out, d);
+    }
 
     return out;
 }
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+template class BasicRational<int32_t>;
+template class BasicRational<int64_t>;
+template class BasicRational<int128_t>;
+template class BasicRational<BigInt>;
+
+template ostream& operator<<(ostream& out, const BasicRational<int32_t>& r);
+template ostream& operator<<(ostream& out, const BasicRational<int64_t>& r);
+template ostream& operator<<(ostream& out, const BasicRational<int128_t>& r);
+template ostream& operator<<(ostream& out, const BasicRational<BigInt>& r);
@@ -1,7 +1,8 @@
 /*
  rational.hh
 
- Contains the Rational class definition.
+ Contains the BasicRational class template definition and the Rational,
+ Rational64, Rational128 and BigRational types built from it.
 
  Revisions:
     09 Apr 2017 - Tim Menninger: Created
@@ -10,89 +11,1183 @@
 #ifndef RATIONAL
 #define RATIONAL
 
+#include <functional>
 #include <iostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include "common.hh"
+#include "bigint.hh"
 
 /*
- Rational Class
+ RationalTraits
+
+ Describes each integer type a BasicRational can be built on: the wider type
+ that intermediate products are computed in, whether every product of two
+ values fits in it (WIDER), and whether a wide value fits back in the type.
+ The 128-bit backend has nothing wider, so its intermediates are 128 bits too
+ and every operation on them is checked for overflow.  BigInt is its own wide
+ type and fits everything.
+*/
+template <typename IntT>
+struct RationalTraits;
+
+template <>
+struct RationalTraits<int32_t> {
+    typedef int64_t Wide;
+    static const bool WIDER = true;
+    static constexpr int32_t min() { return INT32_MIN; }
+    static constexpr int32_t max() { return INT32_MAX; }
+    static constexpr bool fits(int64_t x) { return x >= min() && x <= max(); }
+};
+
+template <>
+struct RationalTraits<int64_t> {
+    typedef int128_t Wide;
+    static const bool WIDER = true;
+    static constexpr int64_t min() { return INT64_MIN; }
+    static constexpr int64_t max() { return INT64_MAX; }
+    static constexpr bool fits(int128_t x) { return x >= min() && x <= max(); }
+};
+
+template <>
+struct RationalTraits<int128_t> {
+    typedef int128_t Wide;
+    static const bool WIDER = false;
+    static constexpr int128_t min() { return -max() - 1; }
+    static constexpr int128_t max() {
+        return (int128_t) (((uint128_t) 1 << 127) - 1);
+    }
+    static constexpr bool fits(int128_t) { return true; }
+};
+
+template <>
+struct RationalTraits<BigInt> {
+    typedef BigInt Wide;
+    static const bool WIDER = false;
+    static bool fits(const BigInt&) { return true; }
+};
+
+/*
+ wideOperand
+
+ Converts a built in integer operand to the wide type of a BasicRational,
+ in which the arithmetic with it is done.  Every standard integer fits the
+ wide type of all but the 32-bit backend, where only unsigned values past
+ INT64_MAX do not.  BigInts are built from 30-bit pieces when the operand
+ does not fit an int64_t.
+
+ Arguments:     n (I) - Integer operand
+                out (W*) - Set to n
+
+ Returns:       (bool) - False if n does not fit W, which leaves out unset.
+*/
+template <typename I, typename W>
+constexpr bool wideOperand(I n, W *out) {
+    return !__builtin_add_overflow(n, 0, out);
+}
+
+template <typename I>
+inline bool wideOperand(I n, BigInt *out) {
+    int64_t small = 0;
+    if (!__builtin_add_overflow(n, 0, &small)) {
+        *out = BigInt(small);
+        return true;
+    }
+
+    typedef typename std::make_unsigned<I>::type U;
+    U mag = n < 0 ? 0 - (U) n : (U) n;
+    BigInt place(1);
+    *out = BigInt();
+    for (; mag != 0; mag >>= 30) {
+        *out += BigInt((int64_t) (mag & 0x3FFFFFFF)) * place;
+        place *= BigInt((int64_t) 1 << 30);
+    }
+    if (n < 0)
+        *out = -*out;
+    return true;
+}
+
+/*
+ BasicRational Class
 
  Emulates rational numbers, their representation and common arithmetic that
- can be done to them.
+ can be done to them.  The numerator and denominator are IntT.  Arithmetic is
+ done in the wider type of RationalTraits<IntT> and reduced before it is
+ narrowed back, so a result only fails if its simplest form does not fit IntT.
+ When it does not, overflow_error is thrown.
+
+ Every value is kept in canonical form: the numerator and denominator are
+ coprime, the denominator is positive and 0 is 0/1.  Every constructor and
+ operator keeps it so, so equal values have equal parts, which is what
+ operator== and hash() rely on.
 */
-class Rational {
+template <typename IntT>
+class BasicRational {
+public:
+    typedef typename RationalTraits<IntT>::Wide Wide;
+
 private:
     /******************************
      MEMBERS
      ******************************/
-    int m_num;                              // Numerator
-    int m_denom;                            // Denominator
+    IntT m_num;                             // Numerator
+    IntT m_denom;                           // Denominator
 
     /******************************
      PRIVATE METHODS
      ******************************/
-    void simplify();                        // Simplifies the fraction
+    constexpr void simplify(Wide n, Wide d);   // Stores n/d in simplest form
+    constexpr void narrow(Wide n, Wide d);     // Stores n/d, already simplest
+    constexpr void sum(IntT a, IntT b, IntT c, IntT d,
+                       bool subtract);     // Stores a/b + c/d or a/b - c/d
+
+    // Integer operands, taken in the wide type, which need no GCD to add
+    // and one to multiply
+    template <typename I>
+    using IfInteger = typename std::enable_if<std::is_integral<I>::value &&
+                                              !std::is_same<I, bool>::value,
+                                              int>::type;
+    template <typename I>
+    constexpr BasicRational sumInt(I n, bool negate,
+                                   bool subtract) const;   // +-this +- n
+    template <typename I>
+    constexpr BasicRational mulInt(I n) const;             // this * n
+    template <typename I>
+    constexpr BasicRational divInt(I n,
+                                   bool invert) const;     // this / n, n / this
+    template <typename I>
+    constexpr int compareInt(I n) const;                   // -1, 0 or 1
+
+    // These build values from wide or already reduced parts directly
+    template <typename T> friend class BasicLazyRational;
+    template <typename T> friend class BasicRationalAccumulator;
+    template <typename T> friend class BasicRationalPolynomial;
+    template <typename T> friend class BasicRationalInterval;
+    template <typename T> friend struct RationalChars;
+    friend class SafeRational;
 
 public:
     /******************************
      CONSTRUCTORS
      ******************************/
-    Rational();                             // Initializes to 0/1
-    Rational(int n);                        // Initializes to n/1
-    Rational(int n, int d);                 // Initializes to n/d
+    constexpr BasicRational();              // Initializes to 0/1
+    constexpr BasicRational(IntT n);        // Initializes to n/1
+    constexpr BasicRational(IntT n, IntT d);    // Initializes to n/d
 
     /******************************
      DESTRUCTOR
      ******************************/
-    ~Rational();                            // Does nothing
+    ~BasicRational() = default;             // Does nothing
 
     /******************************
      ACCESSORS
      ******************************/
-    int denom();                            // Returns denominator
-    int num();                              // Returns numerator
+    constexpr IntT denom() const;           // Returns denominator
+    constexpr IntT num() const;             // Returns numerator
 
     /******************************
      ARITHMETIC
      ******************************/
-    Rational reciprocal();                  // Returns the reciprocal
+    constexpr BasicRational reciprocal() const; // Returns the reciprocal
 
     /******************************
      OPERATORS
      ******************************/
-    const Rational operator-();                   // Unary negation
-    const Rational operator+(const Rational& r);  // Add
-    const Rational operator-(const Rational& r);  // Subtract
-    const Rational operator/(const Rational& r);  // Divide
-    const Rational operator*(const Rational& r);  // Multiply
-    const Rational& operator+=(const Rational& r);// Add
-    const Rational& operator-=(const Rational& r);// Subtract
-    const Rational& operator/=(const Rational& r);// Divide
-    const Rational& operator*=(const Rational& r);// Multiply
-
-    const Rational& operator++();                 // Pre increment
-    const Rational& operator--();                 // Pre decrement
-    const Rational operator++(int);               // Post increment
-    const Rational operator--(int);               // Post decrement
+    constexpr const BasicRational operator-() const;    // Unary negation
+    constexpr const BasicRational operator+(
+        const BasicRational& r) const;                  // Add
+    constexpr const BasicRational operator-(
+        const BasicRational& r) const;                  // Subtract
+    constexpr const BasicRational operator/(
+        const BasicRational& r) const;                  // Divide
+    constexpr const BasicRational operator*(
+        const BasicRational& r) const;                  // Multiply
+    constexpr const BasicRational& operator+=(const BasicRational& r); // Add
+    constexpr const BasicRational& operator-=(const BasicRational& r); // Sub
+    constexpr const BasicRational& operator/=(const BasicRational& r); // Div
+    constexpr const BasicRational& operator*=(const BasicRational& r); // Mul
+
+    // Built in integer operands on either side are exact matches, so they
+    // need no temporary BasicRational and aren't ambiguous with double
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr const BasicRational operator+(const BasicRational& r,
+                                                   I n) {
+        return r.sumInt(n, false, false);
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr const BasicRational operator+(I n,
+                                                   const BasicRational& r) {
+        return r.sumInt(n, false, false);
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr const BasicRational operator-(const BasicRational& r,
+                                                   I n) {
+        return r.sumInt(n, false, true);
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr const BasicRational operator-(I n,
+                                                   const BasicRational& r) {
+        return r.sumInt(n, true, false);
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr const BasicRational operator*(const BasicRational& r,
+                                                   I n) {
+        return r.mulInt(n);
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr const BasicRational operator*(I n,
+                                                   const BasicRational& r) {
+        return r.mulInt(n);
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr const BasicRational operator/(const BasicRational& r,
+                                                   I n) {
+        return r.divInt(n, false);
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr const BasicRational operator/(I n,
+                                                   const BasicRational& r) {
+        return r.divInt(n, true);
+    }
+    template <typename I, IfInteger<I> = 0>
+    constexpr const BasicRational& operator+=(I n) {
+        return *this = sumInt(n, false, false);
+    }
+    template <typename I, IfInteger<I> = 0>
+    constexpr const BasicRational& operator-=(I n) {
+        return *this = sumInt(n, false, true);
+    }
+    template <typename I, IfInteger<I> = 0>
+    constexpr const BasicRational& operator*=(I n) {
+        return *this = mulInt(n);
+    }
+    template <typename I, IfInteger<I> = 0>
+    constexpr const BasicRational& operator/=(I n) {
+        return *this = divInt(n, false);
+    }
+
+    constexpr const BasicRational& operator++();       // Pre increment
+    constexpr const BasicRational& operator--();       // Pre decrement
+    constexpr const BasicRational operator++(int);     // Post increment
+    constexpr const BasicRational operator--(int);     // Post decrement
 
     /******************************
      COMPARATORS
      ******************************/
-    const bool operator<(Rational& r);            // Less than
-    const bool operator>(Rational& r);            // Greater than
-    const bool operator<=(Rational& r);           // Less than or equal to
-    const bool operator>=(Rational& r);           // Greater than or equal to
-    const bool operator==(Rational& r);           // Equal to
-    const bool operator!=(Rational& r);           // Not equal to
+    constexpr int compare(const BasicRational& r) const;     // -1, 0 or 1
+    constexpr bool operator<(const BasicRational& r) const;  // Less than
+    constexpr bool operator>(const BasicRational& r) const;  // Greater than
+    constexpr bool operator<=(const BasicRational& r) const; // Less or equal
+    constexpr bool operator>=(const BasicRational& r) const; // Greater or eq
+    constexpr bool operator==(const BasicRational& r) const; // Equal to
+    constexpr bool operator!=(const BasicRational& r) const; // Not equal to
+
+    // Against built in integers, where canonical values equal an integer
+    // only with a denominator of 1
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr bool operator==(const BasicRational& r, I n) {
+        return r.m_denom == 1 && r.compareInt(n) == 0;
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr bool operator==(I n, const BasicRational& r) {
+        return r == n;
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr bool operator!=(const BasicRational& r, I n) {
+        return !(r == n);
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr bool operator!=(I n, const BasicRational& r) {
+        return !(r == n);
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr bool operator<(const BasicRational& r, I n) {
+        return r.compareInt(n) < 0;
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr bool operator<(I n, const BasicRational& r) {
+        return r.compareInt(n) > 0;
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr bool operator>(const BasicRational& r, I n) {
+        return r.compareInt(n) > 0;
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr bool operator>(I n, const BasicRational& r) {
+        return r.compareInt(n) < 0;
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr bool operator<=(const BasicRational& r, I n) {
+        return r.compareInt(n) <= 0;
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr bool operator<=(I n, const BasicRational& r) {
+        return r.compareInt(n) >= 0;
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr bool operator>=(const BasicRational& r, I n) {
+        return r.compareInt(n) >= 0;
+    }
+    template <typename I, IfInteger<I> = 0>
+    friend constexpr bool operator>=(I n, const BasicRational& r) {
+        return r.compareInt(n) <= 0;
+    }
+
+    /******************************
+     HASHING
+     ******************************/
+    constexpr size_t hash() const;          // Hash of the canonical form
 
     /******************************
      IMPLICIT CASTING
      ******************************/
-    const operator float();                       // Convert to float
-    const operator double();                      // Convert to double
+    constexpr operator float() const;                  // Convert to float
+    constexpr operator double() const;                 // Convert to double
 
     /******************************
-     STREAM OUTPUT
+     CONVERSION FROM DOUBLE
      ******************************/
-    friend std::ostream& operator<<(std::ostream& out, const Rational& val);
+    static BasicRational approximate(double x,
+                                     IntT maxDenom);   // Closest n/d
+    static void approximate(const double *x, size_t n, IntT maxDenom,
+                            BasicRational *out);       // Closest n/d each
+    static BasicRational fromDoubleExact(double x);    // Exactly x
+};
+
+/*
+ The members are defined here rather than in rational.cc so that they are
+ constexpr: ratio tables can be built by the compiler, and a division by zero
+ or an overflow in one is a compile error rather than an exception at
+ startup.  BigInt is not a literal type, so BigRationals are never constant.
+*/
+
+/*
+ simplify
+
+ Stores n/d in simplest form, with a positive denominator.  n and d are in the
+ wide type so that results of arithmetic can be reduced before narrowing.
+
+ Arguments:     n (Wide) - Numerator
+                d (Wide) - Denominator
+
+ Returns:       None.
+
+ Global Impact: Updates m_num and m_denom.  Throws invalid_argument if d is 0
+                and overflow_error if the reduced fraction does not fit IntT.
+*/
+template <typename IntT>
+constexpr void BasicRational<IntT>::simplify(Wide n, Wide d) {
+    // Can't have a zero in the denominator of a rational number
+    if (d == 0)
+        throw std::invalid_argument("Denominator must be nonzero.");
+
+    // Get GCD of numerator and denominator to divide through
+    Wide gcd = GCD(n, d);
+
+    // New values are in simplest form after dividing out GCD
+    n /= gcd;
+    d /= gcd;
+
+    // Ensure that the denominator is positive
+    if (d < 0) {
+        n = checkedSub((Wide) 0, n);
+        d = checkedSub((Wide) 0, d);
+    }
+
+    narrow(n, d);
+
+    return;
+}
+
+/*
+ narrow
+
+ Stores n/d, which must already be in simplest form with a positive
+ denominator.  The arithmetic operators reduce as they go and so skip the GCD
+ in simplify.
+
+ Arguments:     n (Wide) - Numerator
+                d (Wide) - Positive denominator
+
+ Returns:       None.
+
+ Global Impact: Updates m_num and m_denom.  Throws overflow_error if the
+                fraction does not fit IntT.
+*/
+template <typename IntT>
+constexpr void BasicRational<IntT>::narrow(Wide n, Wide d) {
+    // Narrow back, which only fails if the simplest form doesn't fit
+    if (!RationalTraits<IntT>::fits(n) || !RationalTraits<IntT>::fits(d))
+        throw std::overflow_error("Rational does not fit its integer type.");
+    m_num   = (IntT) n;
+    m_denom = (IntT) d;
+
+    return;
+}
+
+/*
+ sum
+
+ Stores a/b + c/d, or a/b - c/d if subtract is set, where both fractions are
+ in simplest form with positive denominators.  With g = gcd(b, d) the sum is
+
+    t / (b/g * d/g * g)    where t = a * d/g + c * b/g
+
+ and any common factor of t and the denominator divides g (Knuth, TAOCP vol.
+ 2, 4.5.1).  So only gcd(t, g) is needed, which is trivial when g is 1, the
+ common case for random denominators.
+
+ Arguments:     a (IntT) - Numerator of the left operand
+                b (IntT) - Denominator of the left operand
+                c (IntT) - Numerator of the right operand
+                d (IntT) - Denominator of the right operand
+                subtract (bool) - True to subtract rather than add
+
+ Returns:       None.
+
+ Global Impact: Updates m_num and m_denom.  Throws overflow_error if the sum
+                does not fit IntT.
+*/
+template <typename IntT>
+constexpr void BasicRational<IntT>::sum(IntT a, IntT b, IntT c, IntT d,
+                                        bool subtract) {
+    IntT g = GCD(b, d);
+    Wide l = checkedMul((Wide) a, (Wide) (d / g));
+    Wide r = checkedMul((Wide) c, (Wide) (b / g));
+    Wide t = subtract ? checkedSub(l, r) : checkedAdd(l, r);
+
+    if (g == 1) {
+        narrow(t, checkedMul((Wide) b, (Wide) d));
+        return;
+    }
+
+    Wide g2 = GCD(t, (Wide) g);
+    narrow(t / g2, checkedMul((Wide) (b / g), (Wide) d / g2));
+
+    return;
+}
+
+/*
+ sumInt
+
+ Adds an integer to this value or its negation.  With this as a/b the result
+ is (+-a +- n*b) / b, taken in the wide type, and any common factor of the
+ numerator and b would also divide a, so it is already in simplest form and
+ no GCD is needed.
+
+ Arguments:     n (I) - Integer operand
+                negate (bool) - True to negate this value first
+                subtract (bool) - True to subtract n rather than add it
+
+ Returns:       (BasicRational) - +-this +- n
+
+ Global Impact: Throws overflow_error if the result does not fit IntT.
+*/
+template <typename IntT>
+template <typename I>
+constexpr BasicRational<IntT> BasicRational<IntT>::sumInt(I n, bool negate,
+                                                          bool subtract) const {
+    // An operand past the wide type is past any sum that fits IntT
+    Wide w = 0;
+    if (!wideOperand(n, &w))
+        throw std::overflow_error("Rational does not fit its integer type.");
+
+    Wide a = negate ? checkedSub((Wide) 0, (Wide) m_num) : (Wide) m_num;
+    Wide nb = checkedMul(w, (Wide) m_denom);
+
+    BasicRational out;
+    out.narrow(subtract ? checkedSub(a, nb) : checkedAdd(a, nb), m_denom);
+    return out;
+}
+
+/*
+ mulInt
+
+ Multiplies this value, a/b, by an integer in the wide type.  a and b are
+ coprime, so only the common factor of n and b has to be cancelled, and one
+ GCD does it.
+
+ Arguments:     n (I) - Integer operand
+
+ Returns:       (BasicRational) - this * n
+
+ Global Impact: Throws overflow_error if the result does not fit IntT.
+*/
+template <typename IntT>
+template <typename I>
+constexpr BasicRational<IntT> BasicRational<IntT>::mulInt(I n) const {
+    BasicRational out;
+    if (m_num == 0)
+        return out;
+
+    // Only a 32-bit value times more than INT64_MAX misses the wide type
+    Wide w = 0;
+    if (!wideOperand(n, &w))
+        throw std::overflow_error("Rational does not fit its integer type.");
+    if (w == 0)
+        return out;
+
+    Wide g = GCD(w, (Wide) m_denom);
+    out.narrow(checkedMul((Wide) m_num, w / g), (Wide) m_denom / g);
+    return out;
+}
+
+/*
+ divInt
+
+ Divides this value, a/b, by an integer, or an integer by it, in the wide
+ type.  As in mulInt only the common factor of n and a has to be cancelled,
+ and then the sign is moved to the numerator.
+
+ Arguments:     n (I) - Integer operand
+                invert (bool) - True for n / this rather than this / n
+
+ Returns:       (BasicRational) - this / n, or n / this if invert is set
+
+ Global Impact: Throws invalid_argument when dividing by zero and
+                overflow_error if the result does not fit IntT.
+*/
+template <typename IntT>
+template <typename I>
+constexpr BasicRational<IntT> BasicRational<IntT>::divInt(I n,
+                                                          bool invert) const {
+    Wide w = 0;
+    bool fits = wideOperand(n, &w);
+    if (invert ? m_num == 0 : fits && w == 0)
+        throw std::invalid_argument("Denominator must be nonzero.");
+
+    BasicRational out;
+    if (m_num == 0)
+        return out;
+    if (!fits)
+        throw std::overflow_error("Rational does not fit its integer type.");
+    if (w == 0)
+        return out;
+
+    // Cancel, then put this' denominator on the other side
+    Wide g = GCD(w, (Wide) m_num);
+    Wide num = invert ? checkedMul(w / g, (Wide) m_denom)
+                      : (Wide) m_num / g;
+    Wide den = invert ? (Wide) m_num / g
+                      : checkedMul((Wide) m_denom, w / g);
+    if (den < 0) {
+        num = checkedSub((Wide) 0, num);
+        den = checkedSub((Wide) 0, den);
+    }
+
+    out.narrow(num, den);
+    return out;
+}
+
+/*
+ compareInt
+
+ Compares with n/1 in the wide type, which compareCross does without
+ multiplying unless the signs agree.  It never throws: an operand the wide
+ type does not hold is a positive integer past every value of IntT.
+
+ Arguments:     n (I) - Integer operand
+
+ Returns:       (int) - -1, 0 or 1 as this is less than, equal to or greater
+                        than n.
+*/
+template <typename IntT>
+template <typename I>
+constexpr int BasicRational<IntT>::compareInt(I n) const {
+    Wide w = 0;
+    if (!wideOperand(n, &w))
+        return -1;
+    return compareCross((Wide) m_num, (Wide) m_denom, w, (Wide) 1);
+}
+
+/******************************
+ CONSTRUCTORS
+ ******************************/
+template <typename IntT>
+constexpr BasicRational<IntT>::BasicRational(IntT n, IntT d)
+    : m_num(0), m_denom(1) {
+    // Simplify values, which also rejects a zero denominator
+    simplify(n, d);
+
+    return;
+}
+template <typename IntT>
+constexpr BasicRational<IntT>::BasicRational(IntT n) : m_num(n), m_denom(1) {}
+template <typename IntT>
+constexpr BasicRational<IntT>::BasicRational() : m_num(0), m_denom(1) {}
+
+/******************************
+ ARITHMETIC
+ ******************************/
+/*
+ reciprocal
+
+ Returns the reciprocal of the Rational values
+
+ Arguments:     None.
+
+ Returns:       None.
+
+ Global Impact: None.
+*/
+template <typename IntT>
+constexpr BasicRational<IntT> BasicRational<IntT>::reciprocal() const {
+    // Can't have a zero in the denominator of a rational number
+    if (m_num == 0)
+        throw std::invalid_argument("Denominator must be nonzero.");
+
+    // Already in simplest form, so only the sign moves
+    BasicRational out;
+    if (m_num < 0)
+        out.narrow(checkedSub((Wide) 0, (Wide) m_denom),
+                   checkedSub((Wide) 0, (Wide) m_num));
+    else
+        out.narrow(m_denom, m_num);
+
+    return out;
+}
+
+/******************************
+ ACCESSORS
+ ******************************/
+/*
+ denom
+
+ Returns the denominator of this Rational instance.
+
+ Arguments:     None.
+
+ Returns:       m_denom (IntT) - The denominator.
+
+ Global Impact: None.
+*/
+template <typename IntT>
+constexpr IntT BasicRational<IntT>::denom() const {
+    return m_denom;
+}
+
+/*
+ num
+
+ Returns the numerator of this Rational instance.
+
+ Arguments:     None.
+
+ Returns:       m_num (IntT) - The numerator.
+
+ Global Impact: None.
+*/
+template <typename IntT>
+constexpr IntT BasicRational<IntT>::num() const {
+    return m_num;
+}
+
+/******************************
+ OPERATORS
+ ******************************/
+/*
+ unary negation
+
+ Returns the unary negation of this Rational instance by returning -1 *
+ numerator / denominator
+
+ Arguments:     None.
+
+ Returns:       (Rational) - Unary negation of this Rational instance.
+
+ Global Impact: None.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT> BasicRational<IntT>::operator-() const {
+    // Do unary negation in the wide type, since -min() doesn't fit IntT
+    BasicRational out;
+    out.narrow(checkedSub((Wide) 0, (Wide) m_num), m_denom);
+
+    return out;
+}
+
+/*
+ Add
+
+ Returns the sum of this Rational instance and the argued one.
+
+ Arguments:     r (Rational&) - Added to this Rational instance.
+
+ Returns:       (Rational) - Sum of this Rational and argued one.
+
+ Global Impact: None.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT> BasicRational<IntT>::operator+(
+    const BasicRational<IntT>& r) const {
+    // Put fractions in common denominator, reducing as we go
+    BasicRational out;
+    out.sum(this->m_num, this->m_denom, r.m_num, r.m_denom, false);
+
+    return out;
+}
+
+/*
+ Subtract
+
+ Returns the difference of this Rational instance and the argued one.  This
+ works by adding the negative of the argument.
+
+ Arguments:     r (Rational&) - Subtracted from this Rational instance.
+
+ Returns:       (Rational) - Difference of this Rational and argued one.
+
+ Global Impact: None.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT> BasicRational<IntT>::operator-(
+    const BasicRational<IntT>& r) const {
+    // Same as adding, but subtracting the scaled numerators
+    BasicRational out;
+    out.sum(this->m_num, this->m_denom, r.m_num, r.m_denom, true);
+
+    return out;
+}
+
+/*
+ Divide
+
+ Returns the quotient of this Rational instance and the argued one.  This works
+ by multiplying by the reciprocal of the argument.
+
+ Arguments:     r (Rational&) - This Rational instance divided by r
+
+ Returns:       (Rational) - Quotient of this Rational and argued one.
+
+ Global Impact: None.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT> BasicRational<IntT>::operator/(
+    const BasicRational<IntT>& r) const {
+    // Can't divide by zero
+    if (r.m_num == 0)
+        throw std::invalid_argument("Denominator must be nonzero.");
+    if (this->m_num == 0)
+        return BasicRational();
+
+    // Multiply by the reciprocal, cancelling across before multiplying
+    IntT g1 = GCD(this->m_num, r.m_num);
+    IntT g2 = GCD(this->m_denom, r.m_denom);
+    Wide n = checkedMul((Wide) (this->m_num / g1), (Wide) (r.m_denom / g2));
+    Wide d = checkedMul((Wide) (this->m_denom / g2), (Wide) (r.m_num / g1));
+
+    // Ensure that the denominator is positive
+    if (d < 0) {
+        n = checkedSub((Wide) 0, n);
+        d = checkedSub((Wide) 0, d);
+    }
+
+    BasicRational out;
+    out.narrow(n, d);
+
+    return out;
+}
+
+/*
+ Multiply
+
+ Returns the product of this Rational instance and the argued one.
+
+ Arguments:     r (Rational&) - Multiplied by this Rational instance.
+
+ Returns:       (Rational) - Product of this Rational and argued one.
+
+ Global Impact: This instance overwritten with result.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT> BasicRational<IntT>::operator*(
+    const BasicRational<IntT>& r) const {
+    if (this->m_num == 0 || r.m_num == 0)
+        return BasicRational();
+
+    // Cancel each numerator against the other denominator first, so that the
+    // products are already in simplest form
+    IntT g1 = GCD(this->m_num, r.m_denom);
+    IntT g2 = GCD(r.m_num, this->m_denom);
+    Wide n = checkedMul((Wide) (this->m_num / g1), (Wide) (r.m_num / g2));
+    Wide d = checkedMul((Wide) (this->m_denom / g2), (Wide) (r.m_denom / g1));
+
+    BasicRational out;
+    out.narrow(n, d);
+
+    return out;
+}
+
+/*
+ Add
+
+ Returns the sum of this Rational instance and the argued one and saves the
+ value in the instance.
+
+ Arguments:     r (Rational&) - Added to this Rational instance.
+
+ Returns:       (Rational) - Sum of this Rational and argued one.
+
+ Global Impact: This instance overwritten with result.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT>& BasicRational<IntT>::operator+=(
+    const BasicRational<IntT>& r) {
+    // Add and then store in this instance
+    *this = *this + r;
+    return *this;
+}
+
+/*
+ Subtract
+
+ Returns the difference of this Rational instance and the argued one.  This
+ works by adding the negative of the argument.  It saves the result in this
+ instance.
+
+ Arguments:     r (Rational&) - Subtracted from this Rational instance.
+
+ Returns:       (Rational) - Difference of this Rational and argued one.
+
+ Global Impact: This instance overwritten with result.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT>& BasicRational<IntT>::operator-=(
+    const BasicRational<IntT>& r) {
+    // Subtract and store result in this instance
+    *this = *this - r;
+    return *this;
+}
+
+/*
+ Divide
+
+ Returns the quotient of this Rational instance and the argued one.  This works
+ by multiplying by the reciprocal of the argument.  The result is stored in
+ this instance.
+
+ Arguments:     r (Rational&) - This Rational instance divided by r
+
+ Returns:       (Rational) - Quotient of this Rational and argued one.
+
+ Global Impact: None.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT>& BasicRational<IntT>::operator/=(
+    const BasicRational<IntT>& r) {
+    // Divide then return
+    *this = *this / r;
+    return *this;
+}
+
+/*
+ Multiply
+
+ Returns the product of this Rational instance and the argued one.  Then the
+ result is stored in this instance.
+
+ Arguments:     r (Rational&) - Multiplied by this Rational instance.
+
+ Returns:       (Rational) - Product of this Rational and argued one.
+
+ Global Impact: This instance overwritten with result.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT>& BasicRational<IntT>::operator*=(
+    const BasicRational<IntT>& r) {
+    // Multiply then return
+    *this = *this * r;
+    return *this;
+}
+
+/*
+ Pre Increment
+
+ Increments the Rational instance, overwriting it, then returns the incremented
+ Rational.
+
+ Arguments:     None.
+
+ Returns:       (Rational) - Incremented version of rational
+
+ Global Impact: This instance overwritten with result.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT>& BasicRational<IntT>::operator++() {
+    // Adding an integer keeps the fraction reduced, so no GCD is needed
+    *this = sumInt(1, false, false);
+    return *this;
+}
+
+/*
+ Pre Decrement
+
+ Increments the Rational instance, overwriting it, then returns the decremented
+ Rational.
+
+ Arguments:     None.
+
+ Returns:       (Rational) - Decremented version of rational
+
+ Global Impact: This instance overwritten with result.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT>& BasicRational<IntT>::operator--() {
+    // Subtracting an integer keeps the fraction reduced too
+    *this = sumInt(1, false, true);
+    return *this;
+}
+
+/*
+ Post Increment
+
+ Increments the Rational instance, overwriting it, then returns the original
+ Rational.
+
+ Arguments:     None.
+
+ Returns:       (Rational) - Original version of rational
+
+ Global Impact: This instance overwritten with result.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT> BasicRational<IntT>::operator++(int) {
+    // Store the original version that will be returned
+    BasicRational out = *this;
+
+    // Increment the instance
+    ++*this;
+
+    return out;
+}
+
+/*
+ Post Decrement
+
+ Decrements the Rational instance, overwriting it, then returns the original
+ Rational.
+
+ Arguments:     None.
+
+ Returns:       (Rational) - Original version of rational
+
+ Global Impact: This instance overwritten with result.
+*/
+template <typename IntT>
+constexpr const BasicRational<IntT> BasicRational<IntT>::operator--(int) {
+    // Store the original version that will be returned
+    BasicRational out = *this;
+
+    // Decrement the instance
+    --*this;
+
+    return out;
+}
+
+/******************************
+ COMPARATORS
+ ******************************/
+/*
+ compare
+
+ Compares this Rational instance with the argued one exactly.  a/b and c/d
+ compare as the cross products a*d and c*b.  When the wide type holds any
+ such product they are simply taken there, which costs less than branching
+ on the signs first.  Otherwise compareCross decides opposite signs and
+ equal denominators without multiplying, and never overflows.
+
+ Arguments:     r (Rational&) - Instance this is compared to
+
+ Returns:       (int) - -1, 0 or 1 as this is less than, equal to or greater
+                        than r.
+*/
+template <typename IntT>
+constexpr int BasicRational<IntT>::compare(const BasicRational<IntT>& r) const {
+    if (RationalTraits<IntT>::WIDER) {
+        Wide ad = (Wide) m_num * (Wide) r.m_denom;
+        Wide cb = (Wide) r.m_num * (Wide) m_denom;
+        return (cb < ad) - (ad < cb);
+    }
+
+    return compareCross(m_num, m_denom, r.m_num, r.m_denom);
+}
+
+/*
+ Less than operator
+
+ Returns true if this Rational instance is less than the argued one.
+
+ Arguments:     r (Rational&) - Instance this is compared to
+
+ Returns:       (bool) - True if this is less than r
+*/
+template <typename IntT>
+constexpr bool BasicRational<IntT>::operator<(
+    const BasicRational<IntT>& r) const {
+    return compare(r) < 0;
+}
+
+/*
+ Greater than operator
+
+ Returns true if this Rational instance is greater than the argued one.
+
+ Arguments:     r (Rational&) - Instance this is compared to
+
+ Returns:       (bool) - True if this is greater than r
+*/
+template <typename IntT>
+constexpr bool BasicRational<IntT>::operator>(
+    const BasicRational<IntT>& r) const {
+    return compare(r) > 0;
+}
+
+/*
+ Less than or equal to operator
+
+ Returns true if this Rational instance is less than or equal to the argued
+ one.
+
+ Arguments:     r (Rational&) - Instance this is compared to
+
+ Returns:       (bool) - True if this is less than or equal to r
+*/
+template <typename IntT>
+constexpr bool BasicRational<IntT>::operator<=(
+    const BasicRational<IntT>& r) const {
+    return compare(r) <= 0;
+}
+
+/*
+ Greater than or equal to operator
+
+ Returns true if this Rational instance is greater than or equal to the argued
+ one.
+
+ Arguments:     r (Rational&) - Instance this is compared to
+
+ Returns:       (bool) - True if this is greater than or equal to r
+*/
+template <typename IntT>
+constexpr bool BasicRational<IntT>::operator>=(
+    const BasicRational<IntT>& r) const {
+    return compare(r) >= 0;
+}
+
+/*
+ Equal to operator
+
+ Returns true if this Rational instance is equal to the argued one.
+
+ Arguments:     r (Rational&) - Instance this is compared to
+
+ Returns:       (bool) - True if this is equal to r
+*/
+template <typename IntT>
+constexpr bool BasicRational<IntT>::operator==(
+    const BasicRational<IntT>& r) const {
+    // Both are in simplest form, so equal values have equal parts
+    return m_num == r.m_num && m_denom == r.m_denom;
+}
+
+/*
+ Not equal to operator
+
+ Returns true if this Rational instance is not equal to the argued one.
+
+ Arguments:     r (Rational&) - Instance this is compared to
+
+ Returns:       (bool) - True if this is not equal to r
+*/
+template <typename IntT>
+constexpr bool BasicRational<IntT>::operator!=(
+    const BasicRational<IntT>& r) const {
+    return !(*this == r);
+}
+
+/******************************
+ HASHING
+ ******************************/
+/*
+ hash
+
+ Hashes the canonical form.  The folded denominator is mixed, xored into the
+ folded numerator and mixed again with mix64, so every bit of both parts
+ reaches every bit of the hash.  Parts fold to themselves while they fit in
+ an int64_t, so equal values hash the same whatever their IntT.
+
+ Arguments:     None.
+
+ Returns:       (size_t) - The hash.
+*/
+template <typename IntT>
+constexpr size_t BasicRational<IntT>::hash() const {
+    return (size_t) mix64(foldInt(m_num) ^ mix64(foldInt(m_denom)));
+}
+
+/******************************
+ IMPLICIT CASTING
+ ******************************/
+/*
+ float implicit converter
+
+ Converts the Rational into a float.
+
+ Arguments:     None.
+
+ Returns:       (float) - The Rational as a float.
+*/
+template <typename IntT>
+constexpr BasicRational<IntT>::operator float() const {
+    return (float) ratioToDouble(m_num, m_denom);
+}
+
+/*
+ double implicit converter
+
+ Converts the Rational into a double.
+
+ Arguments:     None.
+
+ Returns:       (double) - The Rational as a double.
+*/
+template <typename IntT>
+constexpr BasicRational<IntT>::operator double() const {
+    return ratioToDouble(m_num, m_denom);
+}
+
+/******************************
+ STREAM OUTPUT
+ ******************************/
+template <typename IntT>
+std::ostream& operator<<(std::ostream& out, const BasicRational<IntT>& val);
+
+/******************************
+ HASHING
+ ******************************/
+/* So that BasicRationals can key std::unordered_map and other hash tables. */
+namespace std {
+template <typename IntT>
+struct hash<BasicRational<IntT> > {
+    size_t operator()(const BasicRational<IntT>& r) const {
+        return r.hash();
+    }
 };
+}
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+typedef BasicRational<int32_t>  Rational;      // The original int Rational
+typedef BasicRational<int64_t>  Rational64;
+typedef BasicRational<int128_t> Rational128;
+typedef BasicRational<BigInt>   BigRational;   // Never overflows
+
+/* Instantiated in rational.cc for these four types. */
+extern template class BasicRational<int32_t>;
+extern template class BasicRational<int64_t>;
+extern template class BasicRational<int128_t>;
+extern template class BasicRational<BigInt>;
 
 #endif // ifndef RATIONAL
@@ -0,0 +1,575 @@
+/*
+ rationalarray.cc
+
+ Contains the implementation of the RationalArray class defined in
+ rationalarray.hh.  The AVX2 kernels are compiled for AVX2 with a target
+ attribute, so the rest of the library builds for any x86-64, and are only
+ called when the CPU reports AVX2 at run time.
+*/
+
+#include "rationalarray.hh"
+
+#include <immintrin.h>
+#include <stdexcept>
+
+using namespace std;
+
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+/* Batch operations, as passed between the kernels. */
+enum BatchOp { ADD, SUB, MUL, DIV };
+
+/******************************
+ SCALAR KERNELS
+ ******************************/
+/*
+ scalarOp
+
+ Computes elements begin to end of a op b with Rational's operators, which
+ also throw what they throw.  Each output element is only written after its
+ inputs are read, so the output may be an input.
+
+ Arguments:     op (int) - ADD, SUB, MUL or DIV
+                an, ad (int32_t*) - Numerators and denominators of a
+                bn, bd (int32_t*) - Numerators and denominators of b
+                on, od (int32_t*) - Numerators and denominators of the result
+                begin (size_t) - First element
+                end (size_t) - One past the last element
+
+ Returns:       None.
+*/
+static void scalarOp(int op, const int32_t *an, const int32_t *ad,
+                     const int32_t *bn, const int32_t *bd,
+                     int32_t *on, int32_t *od, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        Rational a(an[i], ad[i]), b(bn[i], bd[i]), r;
+        switch (op) {
+        case ADD: r = a + b; break;
+        case SUB: r = a - b; break;
+        case MUL: r = a * b; break;
+        default:  r = a / b; break;
+        }
+        on[i] = r.num();
+        od[i] = r.denom();
+    }
+
+    return;
+}
+
+/******************************
+ AVX2 KERNELS
+ ******************************/
+/*
+ ctz8
+
+ Counts the trailing zero bits of eight 32-bit lanes.  The lowest set bit is
+ isolated and converted to float, whose exponent is then its index.  Lanes
+ that are 0 give a count above 31, which shifts them to 0 again.
+
+ Arguments:     x (__m256i) - Eight unsigned values
+
+ Returns:       (__m256i) - Eight trailing zero counts.
+*/
+TARGET_AVX2
+static inline __m256i ctz8(__m256i x) {
+    __m256i low = _mm256_and_si256(x, _mm256_sub_epi32(_mm256_setzero_si256(),
+                                                       x));
+    __m256i bits = _mm256_castps_si256(_mm256_cvtepi32_ps(low));
+    __m256i e = _mm256_and_si256(_mm256_srli_epi32(bits, 23),
+                                 _mm256_set1_epi32(0xFF));
+    return _mm256_sub_epi32(e, _mm256_set1_epi32(127));
+}
+
+/*
+ gcd8
+
+ Computes the GCDs of eight pairs of unsigned 32-bit lanes with the binary
+ GCD algorithm, as binaryGCD does for one pair.  Lanes that finish early are
+ held by a mask until all have.
+
+ Arguments:     x (__m256i) - Eight unsigned values
+                y (__m256i) - Eight nonzero unsigned values
+
+ Returns:       (__m256i) - Eight greatest common divisors.
+*/
+TARGET_AVX2
+static inline __m256i gcd8(__m256i x, __m256i y) {
+    __m256i zero = _mm256_setzero_si256();
+
+    // gcd(0, y) is gcd(y, y)
+    x = _mm256_blendv_epi8(x, y, _mm256_cmpeq_epi32(x, zero));
+    __m256i shift = ctz8(_mm256_or_si256(x, y));
+    x = _mm256_srlv_epi32(x, ctz8(x));
+    while (!_mm256_testz_si256(y, y)) {
+        y = _mm256_srlv_epi32(y, ctz8(y));
+        __m256i done = _mm256_cmpeq_epi32(y, zero);
+        __m256i lo = _mm256_min_epu32(x, y);
+        __m256i hi = _mm256_max_epu32(x, y);
+        x = _mm256_blendv_epi8(lo, x, done);
+        y = _mm256_andnot_si256(done, _mm256_sub_epi32(hi, lo));
+    }
+
+    return _mm256_sllv_epi32(x, shift);
+}
+
+/* The low or high four 32-bit lanes of x as doubles. */
+TARGET_AVX2
+static inline __m256d lowHalf(__m256i x) {
+    return _mm256_cvtepi32_pd(_mm256_castsi256_si128(x));
+}
+TARGET_AVX2
+static inline __m256d highHalf(__m256i x) {
+    return _mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1));
+}
+
+/* Quotients x / y that are known to be integers below 2^31 in magnitude,
+   given inv = 1 / y.  The product is within far less than 1/2 of the
+   quotient, so rounding it gives the quotient exactly, for the cost of a
+   multiply where a divide would cost several. */
+TARGET_AVX2
+static inline __m256d quotient(__m256d x, __m256d inv) {
+    return _mm256_round_pd(_mm256_mul_pd(x, inv),
+                           _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+/* True if every lane of x is an integer in the range of int32_t.  Products
+   in that range are exact in a double. */
+TARGET_AVX2
+static inline bool fitsInt(__m256d x) {
+    __m256d in = _mm256_and_pd(
+        _mm256_cmp_pd(x, _mm256_set1_pd(-2147483648.0), _CMP_GE_OQ),
+        _mm256_cmp_pd(x, _mm256_set1_pd(2147483647.0), _CMP_LE_OQ));
+    return _mm256_movemask_pd(in) == 0xF;
+}
+
+/* Eight int32_t lanes from two halves of integral doubles. */
+TARGET_AVX2
+static inline __m256i join(__m256d lo, __m256d hi) {
+    return _mm256_set_m128i(_mm256_cvttpd_epi32(hi), _mm256_cvttpd_epi32(lo));
+}
+
+/*
+ mulBlock
+
+ Multiplies eight pairs of fractions in simplest form, cancelling each
+ numerator against the other denominator first as Rational's operator* does.
+ The quotients of the cancelling divisions are exact in doubles, and so are
+ the products whenever they fit int32_t.
+
+ Arguments:     an, ad (__m256i) - Numerators and denominators of a
+                bn, bd (__m256i) - Numerators and denominators of b
+                on, od (__m256i&) - Set to the products
+
+ Returns:       (bool) - False if a product does not fit int32_t, in which
+                         case nothing is set.
+*/
+TARGET_AVX2
+static bool mulBlock(__m256i an, __m256i ad, __m256i bn, __m256i bd,
+                     __m256i& on, __m256i& od) {
+    __m256i g1 = gcd8(_mm256_abs_epi32(an), bd);
+    __m256i g2 = gcd8(_mm256_abs_epi32(bn), ad);
+
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d i1lo = _mm256_div_pd(one, lowHalf(g1));
+    __m256d i1hi = _mm256_div_pd(one, highHalf(g1));
+    __m256d i2lo = _mm256_div_pd(one, lowHalf(g2));
+    __m256d i2hi = _mm256_div_pd(one, highHalf(g2));
+
+    __m256d nlo = _mm256_mul_pd(quotient(lowHalf(an), i1lo),
+                                quotient(lowHalf(bn), i2lo));
+    __m256d nhi = _mm256_mul_pd(quotient(highHalf(an), i1hi),
+                                quotient(highHalf(bn), i2hi));
+    __m256d dlo = _mm256_mul_pd(quotient(lowHalf(ad), i2lo),
+                                quotient(lowHalf(bd), i1lo));
+    __m256d dhi = _mm256_mul_pd(quotient(highHalf(ad), i2hi),
+                                quotient(highHalf(bd), i1hi));
+    if (!fitsInt(nlo) || !fitsInt(nhi) || !fitsInt(dlo) || !fitsInt(dhi))
+        return false;
+
+    on = join(nlo, nhi);
+    od = join(dlo, dhi);
+    return true;
+}
+
+/*
+ sumHalf
+
+ First half of adding or subtracting four pairs of fractions a/b and c/d as
+ Rational's sum does: with g = gcd(b, d), the sum is t / (b/g * d/g2) where
+ t = a * d/g + c * b/g and g2 = gcd(t, g).  This computes t, exactly while
+ |a| d/g + |c| b/g < 2^52, and t mod g, from which g2 is then found.
+
+ Arguments:     a, b, c, d (__m256d) - Four of each operand's parts
+                g (__m256d) - Four of gcd(b, d)
+                subtract (bool) - True to subtract rather than add
+                t (__m256d&) - Set to t
+                r (__m256d&) - Set to |t| mod g
+
+ Returns:       (bool) - False if t might not be exact.
+*/
+TARGET_AVX2
+static inline bool sumHalf(__m256d a, __m256d b, __m256d c, __m256d d,
+                           __m256d g, bool subtract, __m256d& t, __m256d& r) {
+    __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d inv = _mm256_div_pd(_mm256_set1_pd(1.0), g);
+    __m256d l = _mm256_mul_pd(a, quotient(d, inv));
+    __m256d m = _mm256_mul_pd(c, quotient(b, inv));
+    __m256d bound = _mm256_add_pd(_mm256_andnot_pd(sign, l),
+                                  _mm256_andnot_pd(sign, m));
+    __m256d limit = _mm256_set1_pd(4503599627370496.0);     // 2^52
+    if (_mm256_movemask_pd(_mm256_cmp_pd(bound, limit, _CMP_LT_OQ)) != 0xF)
+        return false;
+
+    t = subtract ? _mm256_sub_pd(l, m) : _mm256_add_pd(l, m);
+
+    // The floored quotient may be off by one, which the remainder corrects
+    __m256d at = _mm256_andnot_pd(sign, t);
+    __m256d q = _mm256_floor_pd(_mm256_mul_pd(at, inv));
+    r = _mm256_sub_pd(at, _mm256_mul_pd(q, g));
+    r = _mm256_add_pd(r, _mm256_and_pd(
+        _mm256_cmp_pd(r, _mm256_setzero_pd(), _CMP_LT_OQ), g));
+    r = _mm256_sub_pd(r, _mm256_and_pd(_mm256_cmp_pd(r, g, _CMP_GE_OQ), g));
+    return true;
+}
+
+/*
+ sumBlock
+
+ Adds or subtracts eight pairs of fractions in simplest form, as described
+ for sumHalf.
+
+ Arguments:     an, ad (__m256i) - Numerators and denominators of a
+                bn, bd (__m256i) - Numerators and denominators of b
+                subtract (bool) - True to subtract rather than add
+                on, od (__m256i&) - Set to the results
+
+ Returns:       (bool) - False if a result does not fit int32_t or might not
+                         be exact, in which case nothing is set.
+*/
+TARGET_AVX2
+static bool sumBlock(__m256i an, __m256i ad, __m256i bn, __m256i bd,
+                     bool subtract, __m256i& on, __m256i& od) {
+    __m256i g = gcd8(ad, bd);
+
+    __m256d tlo, thi, rlo, rhi;
+    if (!sumHalf(lowHalf(an), lowHalf(ad), lowHalf(bn), lowHalf(bd),
+                 lowHalf(g), subtract, tlo, rlo) ||
+        !sumHalf(highHalf(an), highHalf(ad), highHalf(bn), highHalf(bd),
+                 highHalf(g), subtract, thi, rhi))
+        return false;
+
+    __m256i g2 = gcd8(join(rlo, rhi), g);
+
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d ilo = _mm256_div_pd(one, lowHalf(g));
+    __m256d ihi = _mm256_div_pd(one, highHalf(g));
+    __m256d i2lo = _mm256_div_pd(one, lowHalf(g2));
+    __m256d i2hi = _mm256_div_pd(one, highHalf(g2));
+
+    // Quotients of t are only exact when they fit, which fitsInt checks
+    __m256d nlo = quotient(tlo, i2lo);
+    __m256d nhi = quotient(thi, i2hi);
+    __m256d dlo = _mm256_mul_pd(quotient(lowHalf(ad), ilo),
+                                quotient(lowHalf(bd), i2lo));
+    __m256d dhi = _mm256_mul_pd(quotient(highHalf(ad), ihi),
+                                quotient(highHalf(bd), i2hi));
+    if (!fitsInt(nlo) || !fitsInt(nhi) || !fitsInt(dlo) || !fitsInt(dhi))
+        return false;
+
+    on = join(nlo, nhi);
+    od = join(dlo, dhi);
+    return true;
+}
+
+/*
+ avx2Op
+
+ Computes a op b eight elements at a time.  Blocks the vector code can't do
+ exactly are redone by scalarOp.
+
+ Arguments:     as for scalarOp, with n (size_t) the number of elements
+
+ Returns:       (size_t) - Number of elements done, a multiple of eight.
+*/
+TARGET_AVX2
+static size_t avx2Op(int op, const int32_t *an, const int32_t *ad,
+                     const int32_t *bn, const int32_t *bd,
+                     int32_t *on, int32_t *od, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (an + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (ad + i));
+        __m256i c = _mm256_loadu_si256((const __m256i *) (bn + i));
+        __m256i d = _mm256_loadu_si256((const __m256i *) (bd + i));
+        __m256i num, denom;
+
+        bool ok;
+        if (op == MUL)
+            ok = mulBlock(a, b, c, d, num, denom);
+        else if (op == DIV) {
+            // Multiply by the reciprocal, unless a divisor is 0 or has no
+            // positive int denominator
+            __m256i bad = _mm256_or_si256(
+                _mm256_cmpeq_epi32(c, _mm256_setzero_si256()),
+                _mm256_cmpeq_epi32(c, _mm256_set1_epi32(INT32_MIN)));
+            ok = _mm256_testz_si256(bad, bad) &&
+                 mulBlock(a, b, _mm256_sign_epi32(d, c),
+                          _mm256_abs_epi32(c), num, denom);
+        }
+        else
+            ok = sumBlock(a, b, c, d, op == SUB, num, denom);
+
+        if (ok) {
+            _mm256_storeu_si256((__m256i *) (on + i), num);
+            _mm256_storeu_si256((__m256i *) (od + i), denom);
+        }
+        else
+            scalarOp(op, an, ad, bn, bd, on, od, i, i + 8);
+    }
+
+    return i;
+}
+
+/*
+ avx2Compare
+
+ Compares eight pairs of fractions at a time by their 64-bit cross products.
+
+ Arguments:     an, ad, bn, bd (int32_t*) - Parts of a and b
+                out (int*) - Set to -1, 0 or 1 per element
+                n (size_t) - Number of elements
+
+ Returns:       (size_t) - Number of elements done, a multiple of eight.
+*/
+TARGET_AVX2
+static size_t avx2Compare(const int32_t *an, const int32_t *ad,
+                          const int32_t *bn, const int32_t *bd,
+                          int *out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (an + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (ad + i));
+        __m256i c = _mm256_loadu_si256((const __m256i *) (bn + i));
+        __m256i d = _mm256_loadu_si256((const __m256i *) (bd + i));
+
+        // mul_epi32 multiplies the even lanes, so the odd ones are shifted
+        // down for a second pass
+        __m256i ad0 = _mm256_mul_epi32(a, d), cb0 = _mm256_mul_epi32(c, b);
+        __m256i ad1 = _mm256_mul_epi32(_mm256_srli_epi64(a, 32),
+                                       _mm256_srli_epi64(d, 32));
+        __m256i cb1 = _mm256_mul_epi32(_mm256_srli_epi64(c, 32),
+                                       _mm256_srli_epi64(b, 32));
+        __m256i r0 = _mm256_sub_epi64(_mm256_cmpgt_epi64(cb0, ad0),
+                                      _mm256_cmpgt_epi64(ad0, cb0));
+        __m256i r1 = _mm256_sub_epi64(_mm256_cmpgt_epi64(cb1, ad1),
+                                      _mm256_cmpgt_epi64(ad1, cb1));
+        __m256i r = _mm256_blend_epi32(r0, _mm256_slli_epi64(r1, 32), 0xAA);
+        _mm256_storeu_si256((__m256i *) (out + i), r);
+    }
+
+    return i;
+}
+
+/******************************
+ CONSTRUCTORS
+ ******************************/
+RationalArray::RationalArray() {}
+RationalArray::RationalArray(size_t n) : m_num(n, 0), m_denom(n, 1) {}
+RationalArray::RationalArray(const vector<Rational>& values) {
+    for (size_t i = 0; i < values.size(); i++)
+        append(values[i]);
+}
+
+/******************************
+ ACCESSORS
+ ******************************/
+/*
+ size
+
+ Returns the number of elements.
+
+ Arguments:     None.
+
+ Returns:       (size_t) - Number of elements.
+*/
+size_t RationalArray::size() const {
+    return m_num.size();
+}
+
+/*
+ get
+
+ Returns an element as a Rational.
+
+ Arguments:     i (size_t) - Index of the element
+
+ Returns:       (Rational) - Element i.
+
+ Global Impact: Throws out_of_range if i is not below size().
+*/
+Rational RationalArray::get(size_t i) const {
+    return Rational(m_num.at(i), m_denom.at(i));
+}
+
+/*
+ set
+
+ Sets an element to a Rational.
+
+ Arguments:     i (size_t) - Index of the element
+                r (Rational&) - Value to store
+
+ Returns:       None.
+
+ Global Impact: Throws out_of_range if i is not below size().
+*/
+void RationalArray::set(size_t i, const Rational& r) {
+    m_num.at(i) = r.num();
+    m_denom.at(i) = r.denom();
+
+    return;
+}
+
+/*
+ append
+
+ Adds a Rational after the last element.
+
+ Arguments:     r (Rational&) - Value to add
+
+ Returns:       None.
+*/
+void RationalArray::append(const Rational& r) {
+    m_num.push_back(r.num());
+    m_denom.push_back(r.denom());
+
+    return;
+}
+
+/*
+ nums, denoms
+
+ Return the numerator or denominator array, size() elements long.
+
+ Arguments:     None.
+
+ Returns:       (int32_t*) - The array.
+*/
+const int32_t *RationalArray::nums() const {
+    return m_num.data();
+}
+const int32_t *RationalArray::denoms() const {
+    return m_denom.data();
+}
+
+/******************************
+ BATCH ARITHMETIC
+ ******************************/
+/*
+ apply
+
+ Stores a op b elementwise in this array, eight elements at a time with AVX2
+ when the CPU has it.
+
+ Arguments:     op (int) - ADD, SUB, MUL or DIV
+                a (RationalArray&) - Left operands
+                b (RationalArray&) - Right operands, as many as a
+
+ Returns:       None.
+
+ Global Impact: Resizes this array to a's size and overwrites it.  Throws
+                invalid_argument if the sizes differ or a divisor is 0, and
+                overflow_error if a result does not fit int.
+*/
+void RationalArray::apply(int op, const RationalArray& a,
+                          const RationalArray& b) {
+    if (a.size() != b.size())
+        throw invalid_argument("RationalArray sizes differ.");
+
+    // This may be a or b, which resizing to their size leaves alone
+    size_t n = a.size();
+    m_num.resize(n);
+    m_denom.resize(n);
+
+    size_t done = 0;
+    if (vectorized())
+        done = avx2Op(op, a.m_num.data(), a.m_denom.data(), b.m_num.data(),
+                      b.m_denom.data(), m_num.data(), m_denom.data(), n);
+    scalarOp(op, a.m_num.data(), a.m_denom.data(), b.m_num.data(),
+             b.m_denom.data(), m_num.data(), m_denom.data(), done, n);
+
+    return;
+}
+
+/*
+ add, sub, mul, div
+
+ Store the elementwise sum, difference, product or quotient of a and b in
+ this array.
+
+ Arguments:     a (RationalArray&) - Left operands
+                b (RationalArray&) - Right operands, as many as a
+
+ Returns:       None.
+
+ Global Impact: As for apply.
+*/
+void RationalArray::add(const RationalArray& a, const RationalArray& b) {
+    apply(ADD, a, b);
+}
+void RationalArray::sub(const RationalArray& a, const RationalArray& b) {
+    apply(SUB, a, b);
+}
+void RationalArray::mul(const RationalArray& a, const RationalArray& b) {
+    apply(MUL, a, b);
+}
+void RationalArray::div(const RationalArray& a, const RationalArray& b) {
+    apply(DIV, a, b);
+}
+
+/*
+ compare
+
+ Compares a and b elementwise, exactly.
+
+ Arguments:     a (RationalArray&) - Left operands
+                b (RationalArray&) - Right operands, as many as a
+                out (int*) - Array of size() ints, set to -1, 0 or 1 as each
+                             element of a is less than, equal to or greater
+                             than that of b
+
+ Returns:       None.
+
+ Global Impact: Throws invalid_argument if the sizes differ.
+*/
+void RationalArray::compare(const RationalArray& a, const RationalArray& b,
+                            int *out) {
+    if (a.size() != b.size())
+        throw invalid_argument("RationalArray sizes differ.");
+
+    size_t n = a.size(), i = 0;
+    const int32_t *an = a.nums(), *ad = a.denoms();
+    const int32_t *bn = b.nums(), *bd = b.denoms();
+    if (vectorized())
+        i = avx2Compare(an, ad, bn, bd, out, n);
+    for (; i < n; i++) {
+        int64_t l = (int64_t) an[i] * bd[i], r = (int64_t) bn[i] * ad[i];
+        out[i] = (r < l) - (l < r);
+    }
+
+    return;
+}
+
+/*
+ vectorized
+
+ Returns whether the batch operations use AVX2 on this CPU.
+
+ Arguments:     None.
+
+ Returns:       (bool) - True if the CPU has AVX2.
+*/
+bool RationalArray::vectorized() {
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
@@ -0,0 +1,77 @@
+/*
+ rationalarray.hh
+
+ Contains the RationalArray class definition, an array of Rationals stored as
+ separate numerator and denominator arrays for batch arithmetic.
+*/
+
+#ifndef RATIONALARRAY
+#define RATIONALARRAY
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "rational.hh"
+
+/*
+ RationalArray Class
+
+ Holds int Rationals as one array of numerators and one of denominators,
+ each fraction in simplest form with a positive denominator like a Rational.
+ The batch operations work on every element at once: on CPUs with AVX2 eight
+ elements at a time, with the cancelling GCDs taken by a vectorized binary
+ GCD, and elsewhere one element at a time with Rational's operators.  Any
+ block of eight that the vector code can't finish exactly, because a result
+ overflows or a divisor is 0, is redone with Rational's operators, so results
+ and exceptions are the same either way.  When an exception is thrown, the
+ elements before the one that threw have already been stored.
+
+ The result array of a batch operation may be one of its operands.
+*/
+class RationalArray {
+private:
+    /******************************
+     MEMBERS
+     ******************************/
+    std::vector<int32_t> m_num;             // Numerators
+    std::vector<int32_t> m_denom;           // Positive denominators
+
+    /******************************
+     PRIVATE METHODS
+     ******************************/
+    void apply(int op, const RationalArray& a,
+               const RationalArray& b);     // Stores a op b elementwise
+
+public:
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+    RationalArray();                        // Initializes to no elements
+    explicit RationalArray(size_t n);       // Initializes to n zeros
+    RationalArray(const std::vector<Rational>& values);    // Copies values
+
+    /******************************
+     ACCESSORS
+     ******************************/
+    size_t size() const;                    // Number of elements
+    Rational get(size_t i) const;           // Element i
+    void set(size_t i, const Rational& r);  // Sets element i
+    void append(const Rational& r);         // Adds an element at the end
+    const int32_t *nums() const;            // Numerator array
+    const int32_t *denoms() const;          // Denominator array
+
+    /******************************
+     BATCH ARITHMETIC
+     ******************************/
+    void add(const RationalArray& a, const RationalArray& b);   // a + b
+    void sub(const RationalArray& a, const RationalArray& b);   // a - b
+    void mul(const RationalArray& a, const RationalArray& b);   // a * b
+    void div(const RationalArray& a, const RationalArray& b);   // a / b
+
+    static void compare(const RationalArray& a, const RationalArray& b,
+                        int *out);          // -1, 0 or 1 per element
+
+    static bool vectorized();               // True if AVX2 is used
+};
+
+#endif // ifndef RATIONALARRAY
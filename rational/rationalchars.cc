@@ -0,0 +1,404 @@
+/*
+ rationalchars.cc
+
+ Contains the implementation of fromChars, toChars and the
+ BasicRationalReader class template declared in rationalchars.hh, all
+ instantiated for 32, 64 and 128-bit integers.
+*/
+
+#include "rationalchars.hh"
+#include "common.hh"
+
+#include <stdexcept>
+#include <string.h>
+#include <string>
+
+using namespace std;
+
+/*
+ RationalChars
+
+ Stores parsed values, which are already reduced, without the GCD of the
+ BasicRational constructor.  It is a friend of BasicRational.
+*/
+template <typename IntT>
+struct RationalChars {
+    typedef typename RationalTraits<IntT>::Wide Wide;
+
+    static void store(BasicRational<IntT>& r, Wide n, Wide d) {
+        r.narrow(n, d);
+    }
+};
+
+/*
+ readDigits
+
+ Reads a run of decimal digits, appending them to a value.  Once the value
+ would overflow, overflow is set and the rest of the digits are skipped.
+
+ Arguments:     p (char*) - First character to read
+                last (char*) - End of the characters
+                value (U&) - Value the digits are appended to
+                overflow (bool&) - Set if value overflows
+
+ Returns:       (char*) - The first character that is not a digit.
+*/
+template <typename U>
+static const char *readDigits(const char *p, const char *last, U& value,
+                              bool& overflow) {
+    for (; p != last && (unsigned) (*p - '0') < 10; p++) {
+        if (overflow ||
+            __builtin_mul_overflow(value, (U) 10, &value) ||
+            __builtin_add_overflow(value, (U) (*p - '0'), &value))
+            overflow = true;
+    }
+
+    return p;
+}
+
+/*
+ readDecimals
+
+ Reads the digits after a decimal point, appending them to the numerator and
+ multiplying the denominator by ten for each.  Zeros are only appended once a
+ nonzero digit follows them, so trailing zeros never overflow.
+
+ Arguments:     p (char*) - First character after the point
+                last (char*) - End of the characters
+                num (U&) - Numerator the digits are appended to
+                den (U&) - Denominator, a power of ten
+                overflow (bool&) - Set if num or den overflows
+
+ Returns:       (char*) - The first character that is not a digit.
+*/
+template <typename U>
+static const char *readDecimals(const char *p, const char *last, U& num,
+                                U& den, bool& overflow) {
+    size_t zeros = 0;
+    for (; p != last && (unsigned) (*p - '0') < 10; p++) {
+        if (*p == '0') {
+            zeros++;
+            continue;
+        }
+        for (; !overflow && zeros > 0; zeros--)
+            overflow = __builtin_mul_overflow(num, (U) 10, &num) ||
+                       __builtin_mul_overflow(den, (U) 10, &den);
+        if (overflow ||
+            __builtin_mul_overflow(num, (U) 10, &num) ||
+            __builtin_add_overflow(num, (U) (*p - '0'), &num) ||
+            __builtin_mul_overflow(den, (U) 10, &den))
+            overflow = true;
+    }
+
+    return p;
+}
+
+/*
+ scanParts
+
+ Matches the pattern fromChars accepts after any '-' and reads its numerator
+ and denominator magnitudes.
+
+ Arguments:     p (char*) - First character after any sign
+                last (char*) - End of the characters
+                num (U&) - Set to the numerator magnitude
+                den (U&) - Set to the denominator
+                overflow (bool&) - Set if either does not fit U
+
+ Returns:       (char*) - The end of the match, or NULL if nothing matches.
+*/
+template <typename U>
+static const char *scanParts(const char *p, const char *last, U& num, U& den,
+                             bool& overflow) {
+    num = 0;
+    den = 1;
+    const char *digits = p;
+    p = readDigits(p, last, num, overflow);
+    bool whole = p != digits;
+
+    if (whole && p != last && *p == '/') {
+        // A '/' not followed by digits is not part of the match
+        U d = 0;
+        const char *end = readDigits(p + 1, last, d, overflow);
+        if (end != p + 1) {
+            p = end;
+            den = d;
+        }
+    } else if (p != last && *p == '.') {
+        const char *end = readDecimals(p + 1, last, num, den, overflow);
+        if (!whole && end == p + 1)
+            return NULL;
+        p = end;
+    } else if (!whole) {
+        return NULL;
+    }
+
+    return p;
+}
+
+/*
+ fromChars
+
+ Parses a BasicRational from the start of a character range.  The digits are
+ read into 64 bits, or into the unsigned wide type when they don't fit there,
+ then reduced and narrowed.
+
+ Arguments:     first (char*) - First character to parse
+                last (char*) - End of the characters
+                value (Rational&) - Set to the value parsed
+
+ Returns:       (FromCharsResult) - End of the match and the error, if any.
+
+ Global Impact: Sets value on success.
+*/
+template <typename IntT>
+FromCharsResult fromChars(const char *first, const char *last,
+                          BasicRational<IntT>& value) {
+    typedef typename RationalTraits<IntT>::Wide Wide;
+    typedef typename UnsignedOf<Wide>::type U;
+    const FromCharsResult invalid = { first, errc::invalid_argument };
+
+    bool negative = first != last && *first == '-';
+    const char *digits = first + negative;
+
+    // Nearly every field fits 64 bits, where the digits are read fastest
+    U num, den;
+    uint64_t num64, den64;
+    bool overflow = false;
+    const char *p = scanParts(digits, last, num64, den64, overflow);
+    if (overflow && sizeof(U) > sizeof(uint64_t)) {
+        overflow = false;
+        p = scanParts(digits, last, num, den, overflow);
+    } else {
+        num = num64;
+        den = den64;
+    }
+    if (p == NULL)
+        return invalid;
+
+    const FromCharsResult outOfRange = { p, errc::result_out_of_range };
+    if (overflow)
+        return outOfRange;
+    if (den == 0)
+        return invalid;
+
+    // Bring the magnitudes into the signed wide type, where the most negative
+    // value has no positive counterpart
+    const U wideMax = (U) -1 >> 1;
+    if (num > wideMax + negative || den > wideMax)
+        return outOfRange;
+    Wide n = negative ? (Wide) (0 - num) : (Wide) num;
+    Wide d = (Wide) den;
+
+    Wide g = GCD(n, d);
+    if (g != 1) {
+        n /= g;
+        d /= g;
+    }
+    if (!RationalTraits<IntT>::fits(n) || !RationalTraits<IntT>::fits(d))
+        return outOfRange;
+
+    RationalChars<IntT>::store(value, n, d);
+    FromCharsResult out = { p, errc() };
+    return out;
+}
+
+/*
+ toChars
+
+ Writes a BasicRational into a character range.  It is formatted backwards
+ into a local buffer and then copied, so the range is only written when it is
+ long enough.
+
+ Arguments:     first (char*) - First character to write
+                last (char*) - End of the range
+                value (Rational&) - Value to write
+
+ Returns:       (ToCharsResult) - End of what was written and the error, if
+                                  any.
+*/
+template <typename IntT>
+ToCharsResult toChars(char *first, char *last,
+                      const BasicRational<IntT>& value) {
+    char buf[RATIONAL_CHARS_MAX];
+    char *end = buf + sizeof(buf);
+    char *p = end;
+    if (value.denom() != 1) {
+        p = writeInt(p, value.denom());
+        *--p = '/';
+    }
+    p = writeInt(p, value.num());
+
+    size_t len = end - p;
+    if ((size_t) (last - first) < len) {
+        ToCharsResult out = { last, errc::value_too_large };
+        return out;
+    }
+    memcpy(first, p, len);
+    ToCharsResult out = { first + len, errc() };
+    return out;
+}
+
+/*
+ isSeparator
+
+ Returns true for the characters between fields: commas, spaces, tabs and
+ line breaks.
+*/
+static inline bool isSeparator(char c) {
+    return c == ',' || c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/*
+ refill
+
+ Moves the characters not parsed yet to the front of the buffer and reads
+ more after them.
+
+ Arguments:     None.
+
+ Returns:       (bool) - False if the stream had nothing more.
+
+ Global Impact: Updates m_buf, m_pos and m_end.  Throws invalid_argument if
+                the buffer is full of one field.
+*/
+template <typename IntT>
+bool BasicRationalReader<IntT>::refill() {
+    if (m_pos == 0 && m_end == BUFFER_SIZE)
+        throw invalid_argument("Field " + to_string(m_fields + 1) +
+                               " is too long.");
+
+    memmove(m_buf.data(), m_buf.data() + m_pos, m_end - m_pos);
+    m_end -= m_pos;
+    m_pos = 0;
+
+    m_in.read(m_buf.data() + m_end, BUFFER_SIZE - m_end);
+    size_t got = (size_t) m_in.gcount();
+    m_end += got;
+
+    return got > 0;
+}
+
+/******************************
+ CONSTRUCTORS
+ ******************************/
+template <typename IntT>
+BasicRationalReader<IntT>::BasicRationalReader(istream& in)
+    : m_in(in), m_buf(BUFFER_SIZE), m_pos(0), m_end(0), m_fields(0) {}
+
+/******************************
+ PARSING
+ ******************************/
+/*
+ next
+
+ Parses the next field of the stream.
+
+ Arguments:     r (Rational&) - Set to the value of the field
+
+ Returns:       (bool) - False if there are no more fields.
+
+ Global Impact: Reads from the stream.  Throws invalid_argument if the field
+                is malformed and overflow_error if it does not fit IntT, in
+                which case r is unchanged.
+*/
+template <typename IntT>
+bool BasicRationalReader<IntT>::next(Value& r) {
+    // Skip to the start of the field, with FIELD_MARGIN characters buffered
+    // after it where the stream has them so that fields are rarely cut off
+    for (;;) {
+        while (m_pos < m_end && isSeparator(m_buf[m_pos]))
+            m_pos++;
+        if (m_end - m_pos >= FIELD_MARGIN || !refill())
+            break;
+    }
+    if (m_pos == m_end)
+        return false;
+
+    // Parse in place into a copy, since a malformed field may start with a
+    // valid one, and read more if it runs to the end of the buffer.  refill
+    // moves the field to the front even when it reads nothing, so what was
+    // parsed is kept as a length from m_pos rather than a pointer.
+    Value v;
+    FromCharsResult res;
+    size_t len;
+    bool atEnd;
+    for (;;) {
+        const char *first = m_buf.data() + m_pos;
+        const char *last = m_buf.data() + m_end;
+        res = fromChars(first, last, v);
+        len = res.ptr - first;
+        atEnd = res.ptr == last;
+        if (!atEnd || !refill())
+            break;
+    }
+
+    m_fields++;
+    if (res.ec == errc::result_out_of_range)
+        throw overflow_error("Field " + to_string(m_fields) +
+                             " does not fit the Rational's integer type.");
+    if (res.ec != errc() || (!atEnd && !isSeparator(m_buf[m_pos + len])))
+        throw invalid_argument("Field " + to_string(m_fields) +
+                               " is not a rational number.");
+    m_pos += len;
+    r = v;
+
+    return true;
+}
+
+/*
+ read
+
+ Parses up to n fields into an array.
+
+ Arguments:     out (Rational*) - Where the values are stored
+                n (size_t) - Most fields to parse
+
+ Returns:       (size_t) - Number of fields parsed, less than n only at the
+                           end of the stream.
+
+ Global Impact: Reads from the stream.  Throws like next.
+*/
+template <typename IntT>
+size_t BasicRationalReader<IntT>::read(Value *out, size_t n) {
+    size_t i = 0;
+    while (i < n && next(out[i]))
+        i++;
+
+    return i;
+}
+
+/*
+ fields
+
+ Returns the number of fields parsed so far.
+
+ Arguments:     None.
+
+ Returns:       (size_t) - Fields parsed, including one that threw.
+*/
+template <typename IntT>
+size_t BasicRationalReader<IntT>::fields() const {
+    return m_fields;
+}
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+template FromCharsResult fromChars(const char *first, const char *last,
+                                   Rational& value);
+template FromCharsResult fromChars(const char *first, const char *last,
+                                   Rational64& value);
+template FromCharsResult fromChars(const char *first, const char *last,
+                                   Rational128& value);
+
+template ToCharsResult toChars(char *first, char *last,
+                               const Rational& value);
+template ToCharsResult toChars(char *first, char *last,
+                               const Rational64& value);
+template ToCharsResult toChars(char *first, char *last,
+                               const Rational128& value);
+
+template class BasicRationalReader<int32_t>;
+template class BasicRationalReader<int64_t>;
+template class BasicRationalReader<int128_t>;
@@ -0,0 +1,134 @@
+/*
+ rationalchars.hh
+
+ Contains fromChars and toChars, which parse and format BasicRationals in
+ caller buffers without allocating, and the BasicRationalReader class
+ template, which parses streams of them in bulk.
+*/
+
+#ifndef RATIONALCHARS
+#define RATIONALCHARS
+
+#include <stddef.h>
+#include <stdint.h>
+#include <iostream>
+#include <system_error>
+#include <vector>
+#include "rational.hh"
+
+/*
+ FromCharsResult, ToCharsResult
+
+ What fromChars and toChars return, as std::from_chars and std::to_chars do:
+ the first character not parsed or the end of what was written, and an error
+ code that is errc() on success.
+*/
+struct FromCharsResult {
+    const char *ptr;
+    std::errc ec;
+};
+
+struct ToCharsResult {
+    char *ptr;
+    std::errc ec;
+};
+
+/*
+ fromChars
+
+ Parses a BasicRational from the start of [first, last).  Accepted are an
+ optional '-' followed by an integer ("-12"), a fraction ("-123/456") or a
+ decimal ("1.25", ".5" or "3."), which is read exactly.  No whitespace is
+ skipped.  The value is reduced before it is narrowed, so "4/8" parses even
+ where 4 * 2^31 would not fit, and trailing zeros of decimals cost nothing.
+
+ On success value is set and ec is errc().  If nothing matches, or the
+ denominator is 0, ec is errc::invalid_argument and ptr is first.  If the
+ value does not fit IntT, ec is errc::result_out_of_range and ptr is past the
+ matched characters.  value is only changed on success.
+*/
+template <typename IntT>
+FromCharsResult fromChars(const char *first, const char *last,
+                          BasicRational<IntT>& value);
+
+/*
+ toChars
+
+ Writes a BasicRational into [first, last) as operator<< would, "n" or
+ "n/d", without a terminating NUL.  If it does not fit, ec is
+ errc::value_too_large, ptr is last and the buffer contents are unspecified.
+*/
+template <typename IntT>
+ToCharsResult toChars(char *first, char *last,
+                      const BasicRational<IntT>& value);
+
+/* Longest text toChars writes for a BasicRational<IntT>. */
+const size_t RATIONAL_CHARS_MAX = 2 * 40 + 2;
+
+/*
+ BasicRationalReader Class
+
+ Parses BasicRationals from a stream in bulk.  Fields are separated by any
+ run of commas, spaces, tabs and line breaks, and each must be exactly what
+ fromChars accepts.  The stream is read BUFFER_SIZE characters at a time
+ into a buffer allocated once, and fields are parsed in place with fromChars,
+ so no memory is allocated per field and each is only looked at once.  A
+ field may straddle two reads.
+
+ A malformed field throws invalid_argument and a field that does not fit IntT
+ throws overflow_error, both naming the field's position in the stream.  The
+ reader does not move past a field that throws.
+*/
+template <typename IntT>
+class BasicRationalReader {
+public:
+    typedef BasicRational<IntT> Value;
+
+    /* Characters read from the stream at a time, and the longest field. */
+    static const size_t BUFFER_SIZE = (size_t) 1 << 16;
+
+private:
+    /* Characters kept buffered past the start of a field when possible. */
+    static const size_t FIELD_MARGIN = 128;
+
+    /******************************
+     MEMBERS
+     ******************************/
+    std::istream& m_in;                     // Stream parsed
+    std::vector<char> m_buf;                // Characters read so far
+    size_t m_pos;                           // First character not parsed
+    size_t m_end;                           // End of the characters read
+    size_t m_fields;                        // Fields parsed so far
+
+    /******************************
+     PRIVATE METHODS
+     ******************************/
+    bool refill();                          // Reads more, false at the end
+
+public:
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+    explicit BasicRationalReader(std::istream& in);    // Reads from in
+
+    /******************************
+     PARSING
+     ******************************/
+    bool next(Value& r);                    // Parses a field, false at end
+    size_t read(Value *out, size_t n);      // Parses up to n fields
+    size_t fields() const;                  // Fields parsed so far
+};
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+typedef BasicRationalReader<int32_t>  RationalReader;
+typedef BasicRationalReader<int64_t>  RationalReader64;
+typedef BasicRationalReader<int128_t> RationalReader128;
+
+/* Defined in rationalchars.cc for these three types only. */
+extern template class BasicRationalReader<int32_t>;
+extern template class BasicRationalReader<int64_t>;
+extern template class BasicRationalReader<int128_t>;
+
+#endif // ifndef RATIONALCHARS
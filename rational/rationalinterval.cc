@@ -0,0 +1,651 @@
+/*
+ rationalinterval.cc
+
+ Contains the implementation of the BasicRationalInterval class template
+ defined in rationalinterval.hh.  The template is instantiated here for 32,
+ 64 and 128-bit integers and for BigInt.
+*/
+
+#include "rationalinterval.hh"
+#include "common.hh"
+
+#include <stdexcept>
+
+using namespace std;
+
+/*
+ Magnitude
+
+ Gives the type the magnitudes of wide integers are rounded in, which is the
+ unsigned type of the same width for the built in types so that the most
+ negative value has one, and converts to it and back.
+*/
+template <typename W>
+struct Magnitude {
+    typedef typename UnsignedOf<W>::type type;
+
+    static type of(W w) { return w < 0 ? 0 - (type) w : (type) w; }
+    static W toWide(type m, bool negative) {
+        return (W) (negative ? 0 - m : m);
+    }
+};
+
+template <>
+struct Magnitude<BigInt> {
+    typedef BigInt type;
+
+    static BigInt of(const BigInt& w) { return w.sign() < 0 ? -w : w; }
+    static BigInt toWide(const BigInt& m, bool negative) {
+        return negative ? -m : m;
+    }
+};
+
+/*
+ fareyNeighbours
+
+ Finds the fractions nearest n/d from below and from above whose
+ denominators are at most maxDenom.  These are the last convergent of the
+ continued fraction of n/d whose denominator is at most maxDenom, and the
+ largest semiconvergent between it and the convergent before it,
+
+    (p' + k*p) / (q' + k*q)     with k = (maxDenom - q') / q
+
+ which lie on opposite sides of n/d and are neighbours in the Farey
+ sequence of order maxDenom, as in the search of bestApproximation in
+ rational.cc.  Convergents alternate sides starting from below, so which is
+ which follows from how many were taken.  Both are in simplest form, and
+ both are n/d itself, reduced, if its denominator is small enough.  n and d
+ need not be reduced, and no numerator found exceeds n.
+
+ Arguments:     n (M) - Nonnegative numerator
+                d (M) - Denominator, more than maxDenom
+                maxDenom (M) - Largest denominator, positive
+                lowN (M&) - Set to the numerator of the one below
+                lowD (M&) - Set to the denominator of the one below
+                highN (M&) - Set to the numerator of the one above
+                highD (M&) - Set to the denominator of the one above
+
+ Returns:       None.
+*/
+template <typename M>
+static void fareyNeighbours(M n, M d, const M& maxDenom, M& lowN, M& lowD,
+                            M& highN, M& highD) {
+    M p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+    bool below = false;
+    for (;;) {
+        M a = n / d;
+        if (q1 != 0 && a > (maxDenom - q0) / q1)
+            break;
+
+        M p2 = p0 + a * p1, q2 = q0 + a * q1;
+        p0 = p1;
+        q0 = q1;
+        p1 = p2;
+        q1 = q2;
+        below = !below;
+
+        M r = n - a * d;
+        if (r == 0) {
+            lowN = highN = p1;
+            lowD = highD = q1;
+            return;
+        }
+        n = d;
+        d = r;
+    }
+
+    M k = (maxDenom - q0) / q1;
+    M sn = p0 + k * p1, sd = q0 + k * q1;
+    lowN = below ? p1 : sn;
+    lowD = below ? q1 : sd;
+    highN = below ? sn : p1;
+    highD = below ? sd : q1;
+
+    return;
+}
+
+/*
+ nonnegative, nonpositive
+
+ Return whether a BasicRational is at least or at most 0 from the sign of
+ its numerator.
+*/
+template <typename IntT>
+static bool nonnegative(const BasicRational<IntT>& x) {
+    return !(x.num() < IntT(0));
+}
+
+template <typename IntT>
+static bool nonpositive(const BasicRational<IntT>& x) {
+    return !(IntT(0) < x.num());
+}
+
+/******************************
+ PRIVATE METHODS
+ ******************************/
+
+/*
+ sum
+
+ Adds or subtracts two endpoints.  Where the wide type holds any cross
+ product it is a/b + c/d = (a*d + c*b) / (b*d) there, with no GCD.
+ Otherwise it is the sum of the BasicRationals.
+
+ Arguments:     x (Rational&) - Left endpoint
+                y (Rational&) - Right endpoint
+                subtract (bool) - True for x - y rather than x + y
+
+ Returns:       (Bound) - The sum or difference, not reduced.
+
+ Global Impact: Throws overflow_error if the wide type does not hold it and
+                it does not fit IntT.
+*/
+template <typename IntT>
+typename BasicRationalInterval<IntT>::Bound
+BasicRationalInterval<IntT>::sum(const Value& x, const Value& y,
+                                 bool subtract) {
+    if (RationalTraits<IntT>::WIDER) {
+        Wide l = (Wide) x.num() * (Wide) y.denom();
+        Wide r = (Wide) y.num() * (Wide) x.denom();
+        Bound out = { subtract ? l - r : l + r,
+                      (Wide) x.denom() * (Wide) y.denom() };
+        return out;
+    }
+
+    Value v = subtract ? x - y : x + y;
+    Bound out = { v.num(), v.denom() };
+    return out;
+}
+
+/*
+ product
+
+ Multiplies two endpoints, in the wide type with no GCD where it holds the
+ product and as BasicRationals otherwise.
+
+ Arguments:     x (Rational&) - Left endpoint
+                y (Rational&) - Right endpoint
+
+ Returns:       (Bound) - The product, not reduced.
+
+ Global Impact: Throws overflow_error if the wide type does not hold it and
+                it does not fit IntT.
+*/
+template <typename IntT>
+typename BasicRationalInterval<IntT>::Bound
+BasicRationalInterval<IntT>::product(const Value& x, const Value& y) {
+    if (RationalTraits<IntT>::WIDER) {
+        Bound out = { (Wide) x.num() * (Wide) y.num(),
+                      (Wide) x.denom() * (Wide) y.denom() };
+        return out;
+    }
+
+    Value v = x * y;
+    Bound out = { v.num(), v.denom() };
+    return out;
+}
+
+/*
+ rounded
+
+ Narrows an endpoint.  Exact intervals, and endpoints whose denominators are
+ already small enough, are kept exactly, reduced if they were taken in the
+ wide type; those taken as BasicRationals are reduced already.  Otherwise the
+ endpoint is rounded to its Farey neighbour on the outward side, which for a
+ negative endpoint is the other neighbour of its magnitude.
+
+ Arguments:     b (Bound&) - Endpoint to narrow
+                up (bool) - True to round up, false to round down
+
+ Returns:       (Rational) - The endpoint narrowed.
+
+ Global Impact: Throws overflow_error if it does not fit IntT.
+*/
+template <typename IntT>
+BasicRational<IntT> BasicRationalInterval<IntT>::rounded(const Bound& b,
+                                                         bool up) const {
+    Value out;
+    if (m_maxDenom == IntT(0) || !((Wide) m_maxDenom < b.d)) {
+        if (RationalTraits<IntT>::WIDER)
+            out.simplify(b.n, b.d);
+        else
+            out.narrow(b.n, b.d);
+        return out;
+    }
+
+    typedef Magnitude<Wide> M;
+    typename M::type lowN, lowD, highN, highD;
+    bool negative = b.n < Wide(0);
+    fareyNeighbours(M::of(b.n), M::of(b.d), M::of((Wide) m_maxDenom),
+                    lowN, lowD, highN, highD);
+
+    bool high = up != negative;
+    out.narrow(M::toWide(high ? highN : lowN, negative),
+               M::toWide(high ? highD : lowD, false));
+    return out;
+}
+
+/*
+ result
+
+ Builds the result of an operation with r from its endpoints, bounded by
+ the larger maximum denominator of this and r, where 0 means none.
+
+ Arguments:     r (Interval&) - Other operand
+                lo (Bound&) - Lower endpoint
+                hi (Bound&) - Upper endpoint
+
+ Returns:       (Interval) - [lo, hi], rounded outward if bounded.
+
+ Global Impact: Throws overflow_error if an endpoint does not fit IntT.
+*/
+template <typename IntT>
+BasicRationalInterval<IntT> BasicRationalInterval<IntT>::result(
+    const BasicRationalInterval& r, const Bound& lo, const Bound& hi) const {
+    BasicRationalInterval out;
+    out.m_maxDenom = m_maxDenom;
+    if (m_maxDenom == IntT(0) ||
+        (!(r.m_maxDenom == IntT(0)) && m_maxDenom < r.m_maxDenom))
+        out.m_maxDenom = r.m_maxDenom;
+
+    out.m_lo = out.rounded(lo, false);
+    out.m_hi = out.rounded(hi, true);
+    return out;
+}
+
+/******************************
+ CONSTRUCTORS
+ ******************************/
+
+/*
+ BasicRationalInterval constructor
+
+ Initializes the exact interval [0, 0].
+
+ Arguments:     None
+
+ Returns:       None
+*/
+template <typename IntT>
+BasicRationalInterval<IntT>::BasicRationalInterval()
+    : m_lo(), m_hi(), m_maxDenom(0) {}
+
+/*
+ BasicRationalInterval constructor
+
+ Initializes the exact interval [x, x] holding only x.
+
+ Arguments:     x (Rational&) - The value
+
+ Returns:       None
+*/
+template <typename IntT>
+BasicRationalInterval<IntT>::BasicRationalInterval(const Value& x)
+    : m_lo(x), m_hi(x), m_maxDenom(0) {}
+
+/*
+ BasicRationalInterval constructor
+
+ Initializes the interval [lo, hi].  If maxDenom is positive, the interval
+ and every result computed from it keep denominators of at most maxDenom,
+ and lo and hi are rounded outward to such right away.
+
+ Arguments:     lo (Rational&) - Lower endpoint
+                hi (Rational&) - Upper endpoint, at least lo
+                maxDenom (IntT) - Largest denominator, or 0 for exact
+
+ Returns:       None
+
+ Global Impact: Throws invalid_argument if hi is less than lo or maxDenom is
+                negative.
+*/
+template <typename IntT>
+BasicRationalInterval<IntT>::BasicRationalInterval(const Value& lo,
+                                                   const Value& hi,
+                                                   IntT maxDenom)
+    : m_maxDenom(maxDenom) {
+    if (maxDenom < IntT(0))
+        throw invalid_argument("Maximum denominator must be nonnegative.");
+    if (hi < lo)
+        throw invalid_argument("Interval endpoints are out of order.");
+
+    Bound l = { lo.num(), lo.denom() }, h = { hi.num(), hi.denom() };
+    m_lo = rounded(l, false);
+    m_hi = rounded(h, true);
+}
+
+/******************************
+ ACCESSORS
+ ******************************/
+
+/*
+ lower, upper
+
+ Return the endpoints of the interval.
+*/
+template <typename IntT>
+const BasicRational<IntT>& BasicRationalInterval<IntT>::lower() const {
+    return m_lo;
+}
+
+template <typename IntT>
+const BasicRational<IntT>& BasicRationalInterval<IntT>::upper() const {
+    return m_hi;
+}
+
+/*
+ maxDenom
+
+ Returns the largest denominator the endpoints are rounded to, or 0 if they
+ are exact.
+*/
+template <typename IntT>
+IntT BasicRationalInterval<IntT>::maxDenom() const {
+    return m_maxDenom;
+}
+
+/*
+ width
+
+ Returns hi - lo, exactly.
+
+ Arguments:     None
+
+ Returns:       (Rational) - The width of the interval.
+
+ Global Impact: Throws overflow_error if it does not fit IntT.
+*/
+template <typename IntT>
+BasicRational<IntT> BasicRationalInterval<IntT>::width() const {
+    return m_hi - m_lo;
+}
+
+/*
+ midpoint
+
+ Returns (lo + hi) / 2, exactly.
+
+ Arguments:     None
+
+ Returns:       (Rational) - The midpoint of the interval.
+
+ Global Impact: Throws overflow_error if it does not fit IntT.
+*/
+template <typename IntT>
+BasicRational<IntT> BasicRationalInterval<IntT>::midpoint() const {
+    return (m_lo + m_hi) / Value(2);
+}
+
+/******************************
+ QUERIES
+ ******************************/
+
+/*
+ contains
+
+ Returns whether x is in the interval.
+*/
+template <typename IntT>
+bool BasicRationalInterval<IntT>::contains(const Value& x) const {
+    return !(x < m_lo) && !(m_hi < x);
+}
+
+/*
+ contains
+
+ Returns whether every value of r is in the interval.
+*/
+template <typename IntT>
+bool BasicRationalInterval<IntT>::contains(
+    const BasicRationalInterval& r) const {
+    return !(r.m_lo < m_lo) && !(m_hi < r.m_hi);
+}
+
+/*
+ containsZero
+
+ Returns whether 0 is in the interval, which a divisor must not be.
+*/
+template <typename IntT>
+bool BasicRationalInterval<IntT>::containsZero() const {
+    return nonpositive(m_lo) && nonnegative(m_hi);
+}
+
+/*
+ overlaps
+
+ Returns whether the interval and r have a value in common.
+*/
+template <typename IntT>
+bool BasicRationalInterval<IntT>::overlaps(
+    const BasicRationalInterval& r) const {
+    return !(r.m_hi < m_lo) && !(m_hi < r.m_lo);
+}
+
+/*
+ certainlyLess
+
+ Returns whether every value of the interval is less than every value of r,
+ which is how comparisons of bounded quantities are decided exactly.
+*/
+template <typename IntT>
+bool BasicRationalInterval<IntT>::certainlyLess(
+    const BasicRationalInterval& r) const {
+    return m_hi < r.m_lo;
+}
+
+/******************************
+ OPERATORS
+ ******************************/
+
+/*
+ Negation operator
+
+ Returns [-hi, -lo], which needs no rounding.
+
+ Arguments:     None
+
+ Returns:       (Interval) - The negated interval.
+*/
+template <typename IntT>
+const BasicRationalInterval<IntT>
+BasicRationalInterval<IntT>::operator-() const {
+    BasicRationalInterval out(*this);
+    out.m_lo = -m_hi;
+    out.m_hi = -m_lo;
+    return out;
+}
+
+/*
+ Addition operator
+
+ Returns [lo + r.lo, hi + r.hi].
+
+ Arguments:     r (Interval&) - Interval to add
+
+ Returns:       (Interval) - The sum.
+
+ Global Impact: Throws overflow_error if an endpoint does not fit IntT.
+*/
+template <typename IntT>
+const BasicRationalInterval<IntT> BasicRationalInterval<IntT>::operator+(
+    const BasicRationalInterval& r) const {
+    return result(r, sum(m_lo, r.m_lo, false), sum(m_hi, r.m_hi, false));
+}
+
+/*
+ Subtraction operator
+
+ Returns [lo - r.hi, hi - r.lo].
+
+ Arguments:     r (Interval&) - Interval to subtract
+
+ Returns:       (Interval) - The difference.
+
+ Global Impact: Throws overflow_error if an endpoint does not fit IntT.
+*/
+template <typename IntT>
+const BasicRationalInterval<IntT> BasicRationalInterval<IntT>::operator-(
+    const BasicRationalInterval& r) const {
+    return result(r, sum(m_lo, r.m_hi, true), sum(m_hi, r.m_lo, true));
+}
+
+/*
+ Multiplication operator
+
+ Returns the smallest interval holding every product.  Which endpoints give
+ its ends follows from the signs of the operands, so two products are taken
+ in all but the case where both contain zero, which needs four and two
+ comparisons.
+
+ Arguments:     r (Interval&) - Interval to multiply by
+
+ Returns:       (Interval) - The product.
+
+ Global Impact: Throws overflow_error if an endpoint does not fit IntT.
+*/
+template <typename IntT>
+const BasicRationalInterval<IntT> BasicRationalInterval<IntT>::operator*(
+    const BasicRationalInterval& r) const {
+    const Value &a = m_lo, &b = m_hi, &c = r.m_lo, &d = r.m_hi;
+    if (nonnegative(a)) {
+        if (nonnegative(c))
+            return result(r, product(a, c), product(b, d));
+        if (nonpositive(d))
+            return result(r, product(b, c), product(a, d));
+        return result(r, product(b, c), product(b, d));
+    }
+    if (nonpositive(b)) {
+        if (nonnegative(c))
+            return result(r, product(a, d), product(b, c));
+        if (nonpositive(d))
+            return result(r, product(b, d), product(a, c));
+        return result(r, product(a, d), product(a, c));
+    }
+    if (nonnegative(c))
+        return result(r, product(a, d), product(b, d));
+    if (nonpositive(d))
+        return result(r, product(b, c), product(a, c));
+
+    // Both contain zero, so the ends are the extreme products of each sign
+    Bound ad = product(a, d), bc = product(b, c);
+    Bound ac = product(a, c), bd = product(b, d);
+    return result(r, compareCross(ad.n, ad.d, bc.n, bc.d) < 0 ? ad : bc,
+                  compareCross(ac.n, ac.d, bd.n, bd.d) > 0 ? ac : bd);
+}
+
+/*
+ Division operator
+
+ Returns the product with [1/r.hi, 1/r.lo], the reciprocals of r, which are
+ exact.
+
+ Arguments:     r (Interval&) - Interval to divide by
+
+ Returns:       (Interval) - The quotient.
+
+ Global Impact: Throws invalid_argument if r contains zero and
+                overflow_error if an endpoint does not fit IntT.
+*/
+template <typename IntT>
+const BasicRationalInterval<IntT> BasicRationalInterval<IntT>::operator/(
+    const BasicRationalInterval& r) const {
+    if (r.containsZero())
+        throw invalid_argument("Interval divisor contains zero.");
+
+    BasicRationalInterval inverse(r);
+    inverse.m_lo = Value(1) / r.m_hi;
+    inverse.m_hi = Value(1) / r.m_lo;
+    return *this * inverse;
+}
+
+/*
+ Compound assignment operators
+
+ Store the result of the operation with r in this interval.
+
+ Arguments:     r (Interval&) - Right operand
+
+ Returns:       (Interval&) - This interval.
+
+ Global Impact: Throw as the operators do, leaving this unchanged.
+*/
+template <typename IntT>
+BasicRationalInterval<IntT>& BasicRationalInterval<IntT>::operator+=(
+    const BasicRationalInterval& r) {
+    *this = *this + r;
+    return *this;
+}
+
+template <typename IntT>
+BasicRationalInterval<IntT>& BasicRationalInterval<IntT>::operator-=(
+    const BasicRationalInterval& r) {
+    *this = *this - r;
+    return *this;
+}
+
+template <typename IntT>
+BasicRationalInterval<IntT>& BasicRationalInterval<IntT>::operator*=(
+    const BasicRationalInterval& r) {
+    *this = *this * r;
+    return *this;
+}
+
+template <typename IntT>
+BasicRationalInterval<IntT>& BasicRationalInterval<IntT>::operator/=(
+    const BasicRationalInterval& r) {
+    *this = *this / r;
+    return *this;
+}
+
+/*
+ Equality operators
+
+ Compare the endpoints.  Intervals with the same endpoints are equal whether
+ or not they are bounded.
+*/
+template <typename IntT>
+bool BasicRationalInterval<IntT>::operator==(
+    const BasicRationalInterval& r) const {
+    return m_lo == r.m_lo && m_hi == r.m_hi;
+}
+
+template <typename IntT>
+bool BasicRationalInterval<IntT>::operator!=(
+    const BasicRationalInterval& r) const {
+    return !(*this == r);
+}
+
+/*
+ square
+
+ Returns the squares of the values in the interval, which unlike the
+ product of the interval with itself never goes below zero: [-1, 2] squares
+ to [0, 4] rather than [-2, 4].
+
+ Arguments:     None
+
+ Returns:       (Interval) - The squares.
+
+ Global Impact: Throws overflow_error if an endpoint does not fit IntT.
+*/
+template <typename IntT>
+BasicRationalInterval<IntT> BasicRationalInterval<IntT>::square() const {
+    Bound lo2 = product(m_lo, m_lo), hi2 = product(m_hi, m_hi);
+    if (nonnegative(m_lo))
+        return result(*this, lo2, hi2);
+    if (nonpositive(m_hi))
+        return result(*this, hi2, lo2);
+
+    Bound zero = { Wide(0), Wide(1) };
+    return result(*this, zero,
+                  compareCross(lo2.n, lo2.d, hi2.n, hi2.d) > 0 ? lo2 : hi2);
+}
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+template class BasicRationalInterval<int32_t>;
+template class BasicRationalInterval<int64_t>;
+template class BasicRationalInterval<int128_t>;
+template class BasicRationalInterval<BigInt>;
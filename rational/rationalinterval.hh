@@ -0,0 +1,130 @@
+/*
+ rationalinterval.hh
+
+ Contains the BasicRationalInterval class template definition, a closed
+ interval with BasicRational endpoints for bounding computations exactly.
+*/
+
+#ifndef RATIONALINTERVAL
+#define RATIONALINTERVAL
+
+#include <stdint.h>
+#include "rational.hh"
+
+/*
+ BasicRationalInterval Class
+
+ Holds a closed interval [lo, hi] of BasicRationals.  The result of each
+ operation contains every result of the operation on values in the
+ operands, and the endpoints are compared exactly.  Each endpoint of a sum
+ or product is one sum or product of two operand endpoints, taken in the
+ wide type of RationalTraits<IntT> without reducing.  Products choose which
+ endpoints they need by the signs of the operands, so only two are taken
+ unless both operands contain zero.
+
+ By default the endpoints are exact, so their denominators grow as they do
+ for BasicRationals, until an operation overflows.  An interval given a
+ maximum denominator instead rounds its endpoints outward to the nearest
+ fractions whose denominators are at most that: lo down and hi up.  Those
+ are the neighbours of the exact endpoint in the Farey sequence of that
+ order, found from the continued fraction of the unreduced wide endpoint in
+ O(log maxDenom) steps, so nothing is narrowed before it is rounded.  Long
+ computations then keep small endpoints at the cost of a little width.  The
+ result of an operation is bounded by the larger maximum of its operands,
+ where an exact interval has none of its own.
+*/
+template <typename IntT>
+class BasicRationalInterval {
+public:
+    typedef BasicRational<IntT> Value;
+    typedef typename RationalTraits<IntT>::Wide Wide;
+
+private:
+    /* An endpoint in the wide type, not reduced, with a positive d. */
+    struct Bound {
+        Wide n;
+        Wide d;
+    };
+
+    /******************************
+     MEMBERS
+     ******************************/
+    Value m_lo;                             // Lower endpoint
+    Value m_hi;                             // Upper endpoint, m_lo <= m_hi
+    IntT m_maxDenom;                        // Largest denominator, 0 if exact
+
+    /******************************
+     PRIVATE METHODS
+     ******************************/
+    static Bound sum(const Value& x, const Value& y,
+                     bool subtract);        // x + y or x - y
+    static Bound product(const Value& x, const Value& y);   // x * y
+    Value rounded(const Bound& b, bool up) const;   // Outward, if bounded
+    BasicRationalInterval result(const BasicRationalInterval& r,
+                                 const Bound& lo,
+                                 const Bound& hi) const;    // [lo, hi]
+
+public:
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+    BasicRationalInterval();                // [0, 0]
+    BasicRationalInterval(const Value& x);  // [x, x]
+    BasicRationalInterval(const Value& lo, const Value& hi,
+                          IntT maxDenom = 0);       // [lo, hi], rounded out
+
+    /******************************
+     ACCESSORS
+     ******************************/
+    const Value& lower() const;             // Lower endpoint
+    const Value& upper() const;             // Upper endpoint
+    IntT maxDenom() const;                  // 0 if the endpoints are exact
+    Value width() const;                    // hi - lo
+    Value midpoint() const;                 // (lo + hi) / 2
+
+    /******************************
+     QUERIES
+     ******************************/
+    bool contains(const Value& x) const;    // lo <= x <= hi
+    bool contains(const BasicRationalInterval& r) const;    // r in this
+    bool containsZero() const;              // lo <= 0 <= hi
+    bool overlaps(const BasicRationalInterval& r) const;    // Share a value
+    bool certainlyLess(const BasicRationalInterval& r) const;   // hi < r.lo
+
+    /******************************
+     OPERATORS
+     ******************************/
+    const BasicRationalInterval operator-() const;          // Negate
+    const BasicRationalInterval operator+(
+        const BasicRationalInterval& r) const;              // Add
+    const BasicRationalInterval operator-(
+        const BasicRationalInterval& r) const;              // Subtract
+    const BasicRationalInterval operator*(
+        const BasicRationalInterval& r) const;              // Multiply
+    const BasicRationalInterval operator/(
+        const BasicRationalInterval& r) const;              // Divide
+    BasicRationalInterval& operator+=(const BasicRationalInterval& r);
+    BasicRationalInterval& operator-=(const BasicRationalInterval& r);
+    BasicRationalInterval& operator*=(const BasicRationalInterval& r);
+    BasicRationalInterval& operator/=(const BasicRationalInterval& r);
+    bool operator==(const BasicRationalInterval& r) const;  // Same endpoints
+    bool operator!=(const BasicRationalInterval& r) const;  // Not the same
+
+    BasicRationalInterval square() const;   // Squares of the values, >= 0
+};
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+typedef BasicRationalInterval<int32_t>  RationalInterval;
+typedef BasicRationalInterval<int64_t>  RationalInterval64;
+typedef BasicRationalInterval<int128_t> RationalInterval128;
+typedef BasicRationalInterval<BigInt>   BigRationalInterval;
+
+/* Defined in rationalinterval.cc for these four types only. */
+extern template class BasicRationalInterval<int32_t>;
+extern template class BasicRationalInterval<int64_t>;
+extern template class BasicRationalInterval<int128_t>;
+extern template class BasicRationalInterval<BigInt>;
+
+#endif // ifndef RATIONALINTERVAL
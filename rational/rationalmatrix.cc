@@ -0,0 +1,441 @@
+/*
+ rationalmatrix.cc
+
+ Contains the implementation of the BasicRationalMatrix class template
+ defined in rationalmatrix.hh.  The template is instantiated here for 32, 64
+ and 128-bit integers and for BigInt.
+*/
+
+#include "rationalmatrix.hh"
+#include "parallel.hh"
+#include "common.hh"
+
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+/* Row updates are only spread over threads past this many entries. */
+static const size_t PARALLEL_ENTRIES = 4096;
+
+/*
+ narrowEntry
+
+ Narrows a wide intermediate back to an entry.
+
+ Arguments:     w (Wide) - Value to narrow
+
+ Returns:       (IntT) - The same value.
+
+ Global Impact: Throws overflow_error if it does not fit IntT.
+*/
+template <typename IntT, typename Wide>
+static IntT narrowEntry(const Wide& w) {
+    if (!RationalTraits<IntT>::fits(w))
+        throw overflow_error("Matrix entry does not fit its integer type.");
+    return (IntT) w;
+}
+
+/*
+ bareissStep
+
+ Computes (a * p - f * b) / prev, which divides exactly in Bareiss
+ elimination.  The products are taken in the wide type.
+
+ Arguments:     a (IntT) - Entry being updated
+                p (IntT) - Pivot
+                f (IntT) - Entry of the updated row in the pivot column
+                b (IntT) - Entry of the pivot row in a's column
+                prev (IntT) - Previous pivot, nonzero
+
+ Returns:       (IntT) - The updated entry.
+
+ Global Impact: Throws overflow_error if it or an intermediate does not fit.
+*/
+template <typename IntT>
+static IntT bareissStep(const IntT& a, const IntT& p, const IntT& f,
+                        const IntT& b, const IntT& prev) {
+    typedef typename RationalTraits<IntT>::Wide Wide;
+    Wide t = checkedSub(checkedMul((Wide) a, (Wide) p),
+                        checkedMul((Wide) f, (Wide) b));
+    return narrowEntry<IntT>(t / (Wide) prev);
+}
+
+/*
+ chunksFor
+
+ Picks how many chunks of rows to split work over, one per thread when there
+ is enough of it to be worth starting threads for.
+
+ Arguments:     rows (size_t) - Rows to update
+                entries (size_t) - Entries updated per row
+                threads (unsigned) - Threads to use, 0 for all there are
+
+ Returns:       (size_t) - Number of chunks, at least 1.
+*/
+static size_t chunksFor(size_t rows, size_t entries, unsigned threads) {
+    if (threads == 0)
+        threads = thread::hardware_concurrency();
+    if (threads <= 1 || rows * entries < PARALLEL_ENTRIES)
+        return 1;
+
+    return rows < threads ? rows : threads;
+}
+
+/*
+ eliminate
+
+ Brings integer rows to row echelon form by Bareiss elimination on their
+ first cols columns, swapping rows to find nonzero pivots and skipping
+ columns that have none.  After the step on pivot p, every entry below and
+ to the right is a minor of the original rows, so dividing by the previous
+ pivot is exact.  The rows below each pivot are updated in parallel.
+
+ Arguments:     a (vector<IntT>&) - Rows of width entries each
+                rows (size_t) - Number of rows
+                cols (size_t) - Columns to eliminate
+                width (size_t) - Entries per row, at least cols
+                threads (unsigned) - Threads to use, 0 for all there are
+                swaps (size_t&) - Set to the number of row swaps made
+
+ Returns:       (size_t) - The rank, the number of pivots found.
+
+ Global Impact: Updates a.  Throws overflow_error if an entry does not fit.
+*/
+template <typename IntT>
+static size_t eliminate(vector<IntT>& a, size_t rows, size_t cols,
+                        size_t width, unsigned threads, size_t& swaps) {
+    IntT prev = 1;
+    size_t r = 0;
+    swaps = 0;
+    for (size_t c = 0; c < cols && r < rows; c++) {
+        size_t p = r;
+        while (p < rows && a[p * width + c] == 0)
+            p++;
+        if (p == rows)
+            continue;
+        if (p != r) {
+            for (size_t j = c; j < width; j++)
+                swap(a[p * width + j], a[r * width + j]);
+            swaps++;
+        }
+
+        const IntT pivot = a[r * width + c];
+        const IntT *pivotRow = &a[r * width];
+        size_t below = rows - r - 1;
+        size_t chunks = chunksFor(below, width - c, threads);
+        forEachChunk(chunks, threads, [&](size_t k) {
+            for (size_t i = r + 1 + below * k / chunks;
+                 i < r + 1 + below * (k + 1) / chunks; i++) {
+                IntT *row = &a[i * width];
+                const IntT f = row[c];
+                for (size_t j = c + 1; j < width; j++)
+                    row[j] = bareissStep(row[j], pivot, f, pivotRow[j], prev);
+                row[c] = 0;
+            }
+        });
+
+        prev = pivot;
+        r++;
+    }
+
+    return r;
+}
+
+/*
+ scaled
+
+ Returns the rows of this matrix, with those of rhs appended if it is given,
+ each multiplied by the LCM of its denominators so that all are integers.
+
+ Arguments:     rhs (Matrix*) - Columns to append, or NULL
+                scales (vector<IntT>*) - Set to each row's factor, or NULL
+
+ Returns:       (vector<IntT>) - The integer rows.
+
+ Global Impact: Throws overflow_error if a scaled entry does not fit IntT.
+*/
+template <typename IntT>
+vector<IntT> BasicRationalMatrix<IntT>::scaled(
+    const BasicRationalMatrix *rhs, vector<IntT> *scales) const {
+    size_t extra = rhs == NULL ? 0 : rhs->m_cols;
+    size_t width = m_cols + extra;
+    vector<IntT> out(m_rows * width);
+    if (scales != NULL)
+        scales->assign(m_rows, 1);
+
+    for (size_t i = 0; i < m_rows; i++) {
+        const Value *left = &m_data[i * m_cols];
+        const Value *right = extra == 0 ? NULL : &rhs->m_data[i * extra];
+
+        IntT lcm = 1;
+        for (size_t j = 0; j < width; j++) {
+            IntT d = j < m_cols ? left[j].denom() : right[j - m_cols].denom();
+            lcm = checkedMul(lcm / GCD(lcm, d), d);
+        }
+        for (size_t j = 0; j < width; j++) {
+            const Value& v = j < m_cols ? left[j] : right[j - m_cols];
+            out[i * width + j] = checkedMul(v.num(), lcm / v.denom());
+        }
+        if (scales != NULL)
+            (*scales)[i] = lcm;
+    }
+
+    return out;
+}
+
+/******************************
+ CONSTRUCTORS
+ ******************************/
+template <typename IntT>
+BasicRationalMatrix<IntT>::BasicRationalMatrix() : m_rows(0), m_cols(0) {}
+
+template <typename IntT>
+BasicRationalMatrix<IntT>::BasicRationalMatrix(size_t rows, size_t cols)
+    : m_rows(rows), m_cols(cols), m_data(rows * cols) {}
+
+/*
+ identity
+
+ Returns the n x n identity matrix.
+
+ Arguments:     n (size_t) - Number of rows and columns
+
+ Returns:       (Matrix) - The identity.
+*/
+template <typename IntT>
+BasicRationalMatrix<IntT> BasicRationalMatrix<IntT>::identity(size_t n) {
+    BasicRationalMatrix out(n, n);
+    for (size_t i = 0; i < n; i++)
+        out.m_data[i * n + i] = Value(1);
+
+    return out;
+}
+
+/******************************
+ ACCESSORS
+ ******************************/
+template <typename IntT>
+size_t BasicRationalMatrix<IntT>::rows() const {
+    return m_rows;
+}
+
+template <typename IntT>
+size_t BasicRationalMatrix<IntT>::cols() const {
+    return m_cols;
+}
+
+/*
+ get, set
+
+ Return or set the entry at row i and column j.
+
+ Global Impact: Throw out_of_range if there is no such entry.
+*/
+template <typename IntT>
+const typename BasicRationalMatrix<IntT>::Value&
+BasicRationalMatrix<IntT>::get(size_t i, size_t j) const {
+    if (i >= m_rows || j >= m_cols)
+        throw out_of_range("Matrix index out of range.");
+    return m_data[i * m_cols + j];
+}
+
+template <typename IntT>
+void BasicRationalMatrix<IntT>::set(size_t i, size_t j, const Value& r) {
+    if (i >= m_rows || j >= m_cols)
+        throw out_of_range("Matrix index out of range.");
+    m_data[i * m_cols + j] = r;
+
+    return;
+}
+
+/******************************
+ OPERATORS
+ ******************************/
+/*
+ Multiply
+
+ Returns the matrix product of this matrix and the argued one.
+
+ Arguments:     b (Matrix&) - Right operand, with as many rows as this has
+                              columns
+
+ Returns:       (Matrix) - The product.
+
+ Global Impact: Throws invalid_argument if the sizes don't match and
+                overflow_error if an entry does not fit IntT.
+*/
+template <typename IntT>
+const BasicRationalMatrix<IntT> BasicRationalMatrix<IntT>::operator*(
+    const BasicRationalMatrix& b) const {
+    if (m_cols != b.m_rows)
+        throw invalid_argument("Matrix sizes don't match.");
+
+    BasicRationalMatrix out(m_rows, b.m_cols);
+    for (size_t i = 0; i < m_rows; i++)
+        for (size_t k = 0; k < m_cols; k++) {
+            const Value& aik = m_data[i * m_cols + k];
+            if (aik == Value())
+                continue;
+            const Value *bk = &b.m_data[k * b.m_cols];
+            Value *outi = &out.m_data[i * b.m_cols];
+            for (size_t j = 0; j < b.m_cols; j++)
+                outi[j] += aik * bk[j];
+        }
+
+    return out;
+}
+
+template <typename IntT>
+bool BasicRationalMatrix<IntT>::operator==(
+    const BasicRationalMatrix& b) const {
+    return m_rows == b.m_rows && m_cols == b.m_cols && m_data == b.m_data;
+}
+
+template <typename IntT>
+bool BasicRationalMatrix<IntT>::operator!=(
+    const BasicRationalMatrix& b) const {
+    return !(*this == b);
+}
+
+/******************************
+ LINEAR ALGEBRA
+ ******************************/
+/*
+ determinant
+
+ Returns the determinant.  The last Bareiss pivot is the determinant of the
+ scaled rows, which is divided by the row factors to undo the scaling.
+
+ Arguments:     threads (unsigned) - Threads to use, 0 for all there are
+
+ Returns:       (Rational) - The determinant, 1 for a 0 x 0 matrix.
+
+ Global Impact: Throws invalid_argument if the matrix is not square and
+                overflow_error if an intermediate does not fit IntT.
+*/
+template <typename IntT>
+typename BasicRationalMatrix<IntT>::Value
+BasicRationalMatrix<IntT>::determinant(unsigned threads) const {
+    if (m_rows != m_cols)
+        throw invalid_argument("Determinant of a non-square matrix.");
+    if (m_rows == 0)
+        return Value(1);
+
+    vector<IntT> scales;
+    vector<IntT> a = scaled(NULL, &scales);
+    size_t swaps = 0;
+    if (eliminate(a, m_rows, m_cols, m_cols, threads, swaps) < m_rows)
+        return Value();
+
+    Value det(a[m_rows * m_cols - 1]);
+    if (swaps % 2)
+        det = -det;
+    for (size_t i = 0; i < m_rows; i++)
+        det /= Value(scales[i]);
+
+    return det;
+}
+
+/*
+ rank
+
+ Returns the rank, the number of pivots of the row echelon form.
+
+ Arguments:     threads (unsigned) - Threads to use, 0 for all there are
+
+ Returns:       (size_t) - The rank.
+
+ Global Impact: Throws overflow_error if an intermediate does not fit IntT.
+*/
+template <typename IntT>
+size_t BasicRationalMatrix<IntT>::rank(unsigned threads) const {
+    vector<IntT> a = scaled(NULL, NULL);
+    size_t swaps = 0;
+    return eliminate(a, m_rows, m_cols, m_cols, threads, swaps);
+}
+
+/*
+ inverse
+
+ Returns the inverse, the solution of AX = I.
+
+ Arguments:     threads (unsigned) - Threads to use, 0 for all there are
+
+ Returns:       (Matrix) - The inverse.
+
+ Global Impact: Throws invalid_argument if the matrix is not square or is
+                singular, and overflow_error if an intermediate does not fit
+                IntT.
+*/
+template <typename IntT>
+BasicRationalMatrix<IntT> BasicRationalMatrix<IntT>::inverse(
+    unsigned threads) const {
+    return solve(identity(m_rows), threads);
+}
+
+/*
+ solve
+
+ Returns X with AX = B.  [A|B] is eliminated, leaving A upper triangular with
+ its last pivot D the determinant of the scaled A.  By Cramer's rule D * X is
+ integral, so each of its entries is found by back substitution
+
+    D * x_i = (D * b_i - sum of a_ij * (D * x_j) over j > i) / a_ii
+
+ where every division is exact, and only the final x_i = (D * x_i) / D is
+ reduced.  The columns of B are solved in parallel.
+
+ Arguments:     b (Matrix&) - Right hand sides, with as many rows as A
+                threads (unsigned) - Threads to use, 0 for all there are
+
+ Returns:       (Matrix) - The solution, with as many columns as B.
+
+ Global Impact: Throws invalid_argument if A is not square, is singular or
+                doesn't match B, and overflow_error if an intermediate does
+                not fit IntT.
+*/
+template <typename IntT>
+BasicRationalMatrix<IntT> BasicRationalMatrix<IntT>::solve(
+    const BasicRationalMatrix& b, unsigned threads) const {
+    typedef typename RationalTraits<IntT>::Wide Wide;
+    if (m_rows != m_cols || b.m_rows != m_rows)
+        throw invalid_argument("Matrix sizes don't match.");
+
+    size_t n = m_rows, width = n + b.m_cols;
+    vector<IntT> a = scaled(&b, NULL);
+    size_t swaps = 0;
+    if (eliminate(a, n, n, width, threads, swaps) < n)
+        throw invalid_argument("Matrix is singular.");
+
+    BasicRationalMatrix out(n, b.m_cols);
+    if (n == 0)
+        return out;
+
+    const IntT det = a[(n - 1) * width + n - 1];
+    size_t chunks = chunksFor(b.m_cols, n * n, threads);
+    forEachChunk(chunks, threads, [&](size_t k) {
+        vector<IntT> x(n);
+        for (size_t t = b.m_cols * k / chunks;
+             t < b.m_cols * (k + 1) / chunks; t++) {
+            for (size_t i = n; i-- > 0;) {
+                const IntT *row = &a[i * width];
+                Wide s = checkedMul((Wide) det, (Wide) row[n + t]);
+                for (size_t j = i + 1; j < n; j++)
+                    s = checkedSub(s, checkedMul((Wide) row[j], (Wide) x[j]));
+                x[i] = narrowEntry<IntT>(s / (Wide) row[i]);
+                out.m_data[i * b.m_cols + t] = Value(x[i], det);
+            }
+        }
+    });
+
+    return out;
+}
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+template class BasicRationalMatrix<int32_t>;
+template class BasicRationalMatrix<int64_t>;
+template class BasicRationalMatrix<int128_t>;
+template class BasicRationalMatrix<BigInt>;
@@ -0,0 +1,101 @@
+/*
+ rationalmatrix.hh
+
+ Contains the BasicRationalMatrix class template definition, a dense matrix
+ of BasicRationals with exact determinants, ranks, inverses and solutions of
+ linear systems.
+*/
+
+#ifndef RATIONALMATRIX
+#define RATIONALMATRIX
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "rational.hh"
+
+/*
+ BasicRationalMatrix Class
+
+ Holds a rows x cols matrix of BasicRationals, row by row.  Determinants,
+ ranks, inverses and solutions are exact.  They are found by Bareiss'
+ fraction-free Gaussian elimination: each row is scaled to integers by the
+ LCM of its denominators, and elimination then stays in integers, dividing
+ each 2x2 cross product exactly by the previous pivot.  So every entry is a
+ minor of the scaled matrix, which keeps entries as small as they can be
+ without a GCD per operation.  Solutions are found by fraction-free back
+ substitution and reduced once at the end.
+
+ The rows below each pivot are updated in parallel by up to threads threads,
+ or as many as the hardware has if threads is 0.  With a fixed width IntT,
+ overflow_error is thrown if an intermediate entry does not fit, and
+ BigRationalMatrix never overflows.
+*/
+template <typename IntT>
+class BasicRationalMatrix {
+public:
+    typedef BasicRational<IntT> Value;
+
+private:
+    /******************************
+     MEMBERS
+     ******************************/
+    size_t m_rows;                          // Number of rows
+    size_t m_cols;                          // Number of columns
+    std::vector<Value> m_data;              // Entries, row by row
+
+    /******************************
+     PRIVATE METHODS
+     ******************************/
+    std::vector<IntT> scaled(const BasicRationalMatrix *rhs,
+                             std::vector<IntT> *scales) const;  // [A|B]
+
+public:
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+    BasicRationalMatrix();                  // Initializes to 0 x 0
+    BasicRationalMatrix(size_t rows, size_t cols);  // Initializes to zeros
+    static BasicRationalMatrix identity(size_t n);  // n x n identity
+
+    /******************************
+     ACCESSORS
+     ******************************/
+    size_t rows() const;                    // Number of rows
+    size_t cols() const;                    // Number of columns
+    const Value& get(size_t i, size_t j) const;     // Entry at row i, col j
+    void set(size_t i, size_t j, const Value& r);   // Sets that entry
+
+    /******************************
+     OPERATORS
+     ******************************/
+    const BasicRationalMatrix operator*(
+        const BasicRationalMatrix& b) const;        // Matrix product
+    bool operator==(const BasicRationalMatrix& b) const;    // Equal to
+    bool operator!=(const BasicRationalMatrix& b) const;    // Not equal to
+
+    /******************************
+     LINEAR ALGEBRA
+     ******************************/
+    Value determinant(unsigned threads = 0) const;  // Of a square matrix
+    size_t rank(unsigned threads = 0) const;        // Independent rows
+    BasicRationalMatrix inverse(unsigned threads = 0) const;
+    BasicRationalMatrix solve(const BasicRationalMatrix& b,
+                              unsigned threads = 0) const;  // X of AX = B
+};
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+typedef BasicRationalMatrix<int32_t>  RationalMatrix;
+typedef BasicRationalMatrix<int64_t>  RationalMatrix64;
+typedef BasicRationalMatrix<int128_t> RationalMatrix128;
+typedef BasicRationalMatrix<BigInt>   BigRationalMatrix;
+
+/* Defined in rationalmatrix.cc for these four types only. */
+extern template class BasicRationalMatrix<int32_t>;
+extern template class BasicRationalMatrix<int64_t>;
+extern template class BasicRationalMatrix<int128_t>;
+extern template class BasicRationalMatrix<BigInt>;
+
+#endif // ifndef RATIONALMATRIX
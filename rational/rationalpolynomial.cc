@@ -0,0 +1,762 @@
+/*
+ rationalpolynomial.cc
+
+ Contains the implementation of the BasicRationalPolynomial class template
+ defined in rationalpolynomial.hh.  The template is instantiated here for 32,
+ 64 and 128-bit integers and for BigInt.
+*/
+
+#include "rationalpolynomial.hh"
+#include "parallel.hh"
+#include "common.hh"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+/* Points evaluated per chunk of a batch. */
+static const size_t EVALUATE_CHUNK = 256;
+
+/*
+ tryAdd, trySub, tryMul
+
+ Add, subtract or multiply two wide integers into out, as checkedAdd and the
+ others do, but report overflow rather than throwing, so that a fast path
+ can give up cheaply.  BigInts never overflow.
+
+ Arguments:     a (W) - Left operand
+                b (W) - Right operand
+                out (W*) - Where the result goes, which may alias a or b
+
+ Returns:       (bool) - False if the result does not fit W.
+*/
+template <typename W>
+static bool tryAdd(const W& a, const W& b, W *out) {
+    return !__builtin_add_overflow(a, b, out);
+}
+
+template <typename W>
+static bool trySub(const W& a, const W& b, W *out) {
+    return !__builtin_sub_overflow(a, b, out);
+}
+
+template <typename W>
+static bool tryMul(const W& a, const W& b, W *out) {
+    return !__builtin_mul_overflow(a, b, out);
+}
+
+static bool tryAdd(const BigInt& a, const BigInt& b, BigInt *out) {
+    *out = a + b;
+    return true;
+}
+
+static bool trySub(const BigInt& a, const BigInt& b, BigInt *out) {
+    *out = a - b;
+    return true;
+}
+
+static bool tryMul(const BigInt& a, const BigInt& b, BigInt *out) {
+    *out = a * b;
+    return true;
+}
+
+/*
+ schoolbook
+
+ Adds the product of a and b to out, one coefficient pair at a time.
+
+ Arguments:     a (W*) - First operand, na coefficients
+                na (size_t) - Length of a
+                b (W*) - Second operand, nb coefficients
+                nb (size_t) - Length of b
+                out (W*) - At least na + nb - 1 coefficients to add into
+
+ Returns:       (bool) - False if a coefficient overflows W.
+
+ Global Impact: Updates out, which is left partly updated on overflow.
+*/
+template <typename W>
+static bool schoolbook(const W *a, size_t na, const W *b, size_t nb, W *out) {
+    W t = 0;
+    for (size_t i = 0; i < na; i++) {
+        if (a[i] == 0)
+            continue;
+        for (size_t j = 0; j < nb; j++)
+            if (!tryMul(a[i], b[j], &t) || !tryAdd(out[i + j], t, &out[i + j]))
+                return false;
+    }
+    return true;
+}
+
+/*
+ karatsuba
+
+ Adds the product of a and b, both of n coefficients, to out.  With each
+ split into a low half of h coefficients and a high half,
+
+    a b = z0 + (z1 - z0 - z2) x^h + z2 x^2h
+
+ where z0 = a0 b0, z2 = a1 b1 and z1 = (a0 + a1)(b0 + b1), so three half
+ size products are taken rather than four.  Operands of KARATSUBA_COEFFS
+ coefficients or fewer are multiplied by schoolbook.
+
+ Arguments:     a (W*) - First operand
+                b (W*) - Second operand
+                n (size_t) - Length of each
+                out (W*) - At least 2n - 1 coefficients to add into
+
+ Returns:       (bool) - False if a coefficient overflows W.
+
+ Global Impact: Updates out, which is left partly updated on overflow.
+*/
+template <typename W>
+static bool karatsuba(const W *a, const W *b, size_t n, W *out) {
+    if (n <= KARATSUBA_COEFFS)
+        return schoolbook(a, n, b, n, out);
+
+    size_t h = n / 2, m = n - h;
+    vector<W> z0(2 * h - 1, W(0)), z1(2 * m - 1, W(0)), z2(2 * m - 1, W(0));
+    vector<W> sa(a + h, a + n), sb(b + h, b + n);
+    for (size_t i = 0; i < h; i++)
+        if (!tryAdd(sa[i], a[i], &sa[i]) || !tryAdd(sb[i], b[i], &sb[i]))
+            return false;
+
+    if (!karatsuba(a, b, h, &z0[0]) || !karatsuba(a + h, b + h, m, &z2[0]) ||
+        !karatsuba(&sa[0], &sb[0], m, &z1[0]))
+        return false;
+
+    for (size_t i = 0; i < z1.size(); i++)
+        if ((i < z0.size() && !trySub(z1[i], z0[i], &z1[i])) ||
+            !trySub(z1[i], z2[i], &z1[i]))
+            return false;
+
+    for (size_t i = 0; i < z0.size(); i++)
+        if (!tryAdd(out[i], z0[i], &out[i]))
+            return false;
+    for (size_t i = 0; i < z1.size(); i++)
+        if (!tryAdd(out[h + i], z1[i], &out[h + i]) ||
+            !tryAdd(out[2 * h + i], z2[i], &out[2 * h + i]))
+            return false;
+    return true;
+}
+
+/*
+ convolve
+
+ Adds the product of a and b to out.  Karatsuba wants operands of equal
+ length, so the longer one is cut into blocks as long as the shorter, the
+ last padded with zeros, and each block product is added in at its offset.
+
+ Arguments:     a (W*) - First operand, na coefficients
+                na (size_t) - Length of a
+                b (W*) - Second operand, nb coefficients
+                nb (size_t) - Length of b
+                out (W*) - At least na + nb - 1 coefficients to add into
+
+ Returns:       (bool) - False if a coefficient overflows W.
+
+ Global Impact: Updates out, which is left partly updated on overflow.
+*/
+template <typename W>
+static bool convolve(const W *a, size_t na, const W *b, size_t nb, W *out) {
+    if (na < nb)
+        return convolve(b, nb, a, na, out);
+    if (nb <= KARATSUBA_COEFFS)
+        return schoolbook(a, na, b, nb, out);
+
+    vector<W> block(nb), prod(2 * nb - 1);
+    for (size_t i = 0; i < na; i += nb) {
+        size_t len = min(nb, na - i);
+        fill(block.begin(), block.end(), W(0));
+        copy(a + i, a + i + len, block.begin());
+        fill(prod.begin(), prod.end(), W(0));
+        if (!karatsuba(&block[0], b, nb, &prod[0]))
+            return false;
+        for (size_t j = 0; j < len + nb - 1; j++)
+            if (!tryAdd(out[i + j], prod[j], &out[i + j]))
+                return false;
+    }
+    return true;
+}
+
+/*
+ variations
+
+ Counts the sign changes along a Sturm sequence at x, skipping zeros.
+
+ Arguments:     seq (vector<Polynomial>&) - Sturm sequence
+                x (Value&) - Point to count them at
+
+ Returns:       (size_t) - Number of sign changes.
+*/
+template <typename P, typename V>
+static size_t variations(const vector<P>& seq, const V& x) {
+    size_t count = 0;
+    int last = 0;
+    for (size_t i = 0; i < seq.size(); i++) {
+        int s = sign(seq[i](x));
+        if (s != 0) {
+            count += last != 0 && s != last;
+            last = s;
+        }
+    }
+    return count;
+}
+
+/******************************
+ PRIVATE METHODS
+ ******************************/
+
+/*
+ trim
+
+ Drops zero leading coefficients, then finds the LCM of the denominators
+ and the coefficients scaled by it.  If either does not fit the wide type,
+ the scaled form is left empty with a scale of 0 and only the slow paths
+ are used.
+
+ Arguments:     None.
+
+ Returns:       None.
+
+ Global Impact: Updates m_coeffs, m_scaled and m_scale.
+*/
+template <typename IntT>
+void BasicRationalPolynomial<IntT>::trim() {
+    while (!m_coeffs.empty() && m_coeffs.back() == 0)
+        m_coeffs.pop_back();
+
+    m_scale = 1;
+    m_scaled.clear();
+    for (size_t i = 0; i < m_coeffs.size(); i++) {
+        Wide d = (Wide) m_coeffs[i].denom();
+        if (!tryMul(m_scale / GCD(m_scale, d), d, &m_scale)) {
+            m_scale = 0;
+            return;
+        }
+    }
+
+    m_scaled.resize(m_coeffs.size());
+    for (size_t i = 0; i < m_coeffs.size(); i++) {
+        Wide d = (Wide) m_coeffs[i].denom();
+        if (!tryMul((Wide) m_coeffs[i].num(), m_scale / d, &m_scaled[i])) {
+            m_scale = 0;
+            m_scaled.clear();
+            return;
+        }
+    }
+
+    return;
+}
+
+/*
+ hornerScaled
+
+ Evaluates at x = u/v by Horner's rule on the scaled coefficients a_i,
+ keeping the numerator sum of a_i u^i v^(n-i) and the power of v apart so
+ that nothing is reduced until the end.  Integer points skip the powers.
+
+ Arguments:     x (Value&) - Point to evaluate at
+                out (Value*) - Where the value goes
+
+ Returns:       (bool) - False if an intermediate overflows the wide type,
+                         in which case out is not changed.
+
+ Global Impact: Throws overflow_error if the reduced value does not fit
+                IntT, which it then cannot by any route.
+*/
+template <typename IntT>
+bool BasicRationalPolynomial<IntT>::hornerScaled(const Value& x,
+                                                 Value *out) const {
+    if (m_scale == 0)
+        return false;
+
+    const Wide u = (Wide) x.num(), v = (Wide) x.denom();
+    const bool integral = v == 1;
+    size_t n = m_scaled.size();
+    Wide s = m_scaled[n - 1], pw = 1, t = 0;
+    for (size_t i = n - 1; i-- > 0;) {
+        if (!tryMul(s, u, &s))
+            return false;
+        if (integral) {
+            if (!tryAdd(s, m_scaled[i], &s))
+                return false;
+        }
+        else if (!tryMul(pw, v, &pw) || !tryMul(m_scaled[i], pw, &t) ||
+                 !tryAdd(s, t, &s))
+            return false;
+    }
+
+    Wide den = 0;
+    if (!tryMul(m_scale, pw, &den))
+        return false;
+    out->simplify(s, den);
+    return true;
+}
+
+/* Horner's rule on the coefficients themselves, reducing every step. */
+template <typename IntT>
+typename BasicRationalPolynomial<IntT>::Value
+BasicRationalPolynomial<IntT>::hornerReduced(const Value& x) const {
+    Value r = m_coeffs.back();
+    for (size_t i = m_coeffs.size() - 1; i-- > 0;)
+        r = r * x + m_coeffs[i];
+    return r;
+}
+
+template <typename IntT>
+int BasicRationalPolynomial<IntT>::signAt(const Value& x) const {
+    return sign(evaluate(x));
+}
+
+template <typename IntT>
+BasicRationalPolynomial<IntT> BasicRationalPolynomial<IntT>::scaled(
+    const Value& c) const {
+    vector<Value> out(m_coeffs);
+    for (size_t i = 0; i < out.size(); i++)
+        out[i] *= c;
+    return BasicRationalPolynomial(out);
+}
+
+/******************************
+ CONSTRUCTORS
+ ******************************/
+template <typename IntT>
+BasicRationalPolynomial<IntT>::BasicRationalPolynomial() : m_scale(1) {}
+
+template <typename IntT>
+BasicRationalPolynomial<IntT>::BasicRationalPolynomial(const Value& c)
+    : m_coeffs(1, c) {
+    trim();
+}
+
+template <typename IntT>
+BasicRationalPolynomial<IntT>::BasicRationalPolynomial(
+    const vector<Value>& coeffs) : m_coeffs(coeffs) {
+    trim();
+}
+
+/*
+ monomial
+
+ Returns c x^k.
+
+ Arguments:     c (Value&) - Coefficient
+                k (size_t) - Power of x
+
+ Returns:       (Polynomial) - The monomial, or zero if c is.
+*/
+template <typename IntT>
+BasicRationalPolynomial<IntT> BasicRationalPolynomial<IntT>::monomial(
+    const Value& c, size_t k) {
+    vector<Value> coeffs(k + 1);
+    coeffs[k] = c;
+    return BasicRationalPolynomial(coeffs);
+}
+
+/******************************
+ ACCESSORS
+ ******************************/
+template <typename IntT>
+int BasicRationalPolynomial<IntT>::degree() const {
+    return (int) m_coeffs.size() - 1;
+}
+
+template <typename IntT>
+const vector<typename BasicRationalPolynomial<IntT>::Value>&
+BasicRationalPolynomial<IntT>::coefficients() const {
+    return m_coeffs;
+}
+
+template <typename IntT>
+typename BasicRationalPolynomial<IntT>::Value
+BasicRationalPolynomial<IntT>::coefficient(size_t i) const {
+    return i < m_coeffs.size() ? m_coeffs[i] : Value();
+}
+
+template <typename IntT>
+typename BasicRationalPolynomial<IntT>::Value
+BasicRationalPolynomial<IntT>::leading() const {
+    return m_coeffs.empty() ? Value() : m_coeffs.back();
+}
+
+/******************************
+ EVALUATION
+ ******************************/
+
+/*
+ evaluate
+
+ Returns the value at x, by Horner's rule on the scaled coefficients if
+ nothing overflows the wide type, and on the coefficients otherwise.
+
+ Arguments:     x (Value&) - Point to evaluate at
+
+ Returns:       (Value) - The exact value.
+
+ Global Impact: Throws overflow_error if the value, or a reduced
+                intermediate of the slow path, does not fit IntT.
+*/
+template <typename IntT>
+typename BasicRationalPolynomial<IntT>::Value
+BasicRationalPolynomial<IntT>::evaluate(const Value& x) const {
+    Value out;
+    if (m_coeffs.empty() || hornerScaled(x, &out))
+        return out;
+    return hornerReduced(x);
+}
+
+template <typename IntT>
+typename BasicRationalPolynomial<IntT>::Value
+BasicRationalPolynomial<IntT>::operator()(const Value& x) const {
+    return evaluate(x);
+}
+
+/*
+ evaluate
+
+ Returns the values at each of xs, evaluating chunks of EVALUATE_CHUNK
+ points on up to threads threads, or as many as the hardware has if threads
+ is 0.
+
+ Arguments:     xs (vector<Value>&) - Points to evaluate at
+                threads (unsigned) - Threads to use, 0 for all there are
+
+ Returns:       (vector<Value>) - The value at each point, in order.
+
+ Global Impact: Throws overflow_error as evaluating at the first point that
+                fails would.
+*/
+template <typename IntT>
+vector<typename BasicRationalPolynomial<IntT>::Value>
+BasicRationalPolynomial<IntT>::evaluate(const vector<Value>& xs,
+                                        unsigned threads) const {
+    vector<Value> out(xs.size());
+    if (xs.empty())
+        return out;
+
+    size_t chunks = (xs.size() + EVALUATE_CHUNK - 1) / EVALUATE_CHUNK;
+    forEachChunk(chunks, threads, [&](size_t k) {
+        size_t end = min(xs.size(), (k + 1) * EVALUATE_CHUNK);
+        for (size_t i = k * EVALUATE_CHUNK; i < end; i++)
+            out[i] = evaluate(xs[i]);
+    });
+    return out;
+}
+
+/******************************
+ OPERATORS
+ ******************************/
+template <typename IntT>
+const BasicRationalPolynomial<IntT>
+BasicRationalPolynomial<IntT>::operator-() const {
+    return scaled(Value(-1));
+}
+
+template <typename IntT>
+const BasicRationalPolynomial<IntT> BasicRationalPolynomial<IntT>::operator+(
+    const BasicRationalPolynomial& p) const {
+    vector<Value> out(max(m_coeffs.size(), p.m_coeffs.size()));
+    for (size_t i = 0; i < out.size(); i++)
+        out[i] = coefficient(i) + p.coefficient(i);
+    return BasicRationalPolynomial(out);
+}
+
+template <typename IntT>
+const BasicRationalPolynomial<IntT> BasicRationalPolynomial<IntT>::operator-(
+    const BasicRationalPolynomial& p) const {
+    vector<Value> out(max(m_coeffs.size(), p.m_coeffs.size()));
+    for (size_t i = 0; i < out.size(); i++)
+        out[i] = coefficient(i) - p.coefficient(i);
+    return BasicRationalPolynomial(out);
+}
+
+/*
+ Multiply
+
+ Returns the product.  The scaled coefficients are convolved in the wide
+ type, by Karatsuba for long operands, and each coefficient of the product
+ is divided by the product of the scales and reduced once.  If the scaled
+ form of either operand or of the product overflows, the coefficients are
+ multiplied pairwise as BasicRationals instead.
+
+ Arguments:     p (Polynomial&) - Right operand
+
+ Returns:       (Polynomial) - The product.
+
+ Global Impact: Throws overflow_error if a coefficient does not fit IntT.
+*/
+template <typename IntT>
+const BasicRationalPolynomial<IntT> BasicRationalPolynomial<IntT>::operator*(
+    const BasicRationalPolynomial& p) const {
+    if (m_coeffs.empty() || p.m_coeffs.empty())
+        return BasicRationalPolynomial();
+
+    size_t n = m_coeffs.size() + p.m_coeffs.size() - 1;
+    vector<Value> out(n);
+
+    vector<Wide> conv(n, Wide(0));
+    Wide den = 0;
+    if (m_scale != 0 && p.m_scale != 0 && tryMul(m_scale, p.m_scale, &den) &&
+        convolve(&m_scaled[0], m_scaled.size(), &p.m_scaled[0],
+                 p.m_scaled.size(), &conv[0])) {
+        for (size_t i = 0; i < n; i++)
+            out[i].simplify(conv[i], den);
+        return BasicRationalPolynomial(out);
+    }
+
+    for (size_t i = 0; i < m_coeffs.size(); i++)
+        for (size_t j = 0; j < p.m_coeffs.size(); j++)
+            out[i + j] += m_coeffs[i] * p.m_coeffs[j];
+    return BasicRationalPolynomial(out);
+}
+
+/*
+ divide
+
+ Long division, leaving this = q d + r with r of lower degree than d.
+
+ Arguments:     d (Polynomial&) - Divisor, nonzero
+                q (Polynomial*) - Where the quotient goes, or NULL
+                r (Polynomial*) - Where the remainder goes, or NULL
+
+ Returns:       None.
+
+ Global Impact: Throws invalid_argument if d is zero and overflow_error if a
+                coefficient does not fit IntT.
+*/
+template <typename IntT>
+void BasicRationalPolynomial<IntT>::divide(const BasicRationalPolynomial& d,
+                                           BasicRationalPolynomial *q,
+                                           BasicRationalPolynomial *r) const {
+    if (d.m_coeffs.empty())
+        throw invalid_argument("Division by the zero polynomial.");
+
+    size_t nd = d.m_coeffs.size();
+    vector<Value> rem(m_coeffs);
+    vector<Value> quot(rem.size() >= nd ? rem.size() - nd + 1 : 0);
+    for (size_t k = quot.size(); k-- > 0;) {
+        Value c = rem[k + nd - 1] / d.m_coeffs[nd - 1];
+        quot[k] = c;
+        if (c == 0)
+            continue;
+        for (size_t j = 0; j < nd; j++)
+            rem[k + j] -= c * d.m_coeffs[j];
+    }
+
+    rem.resize(min(rem.size(), nd - 1));
+    if (q)
+        *q = BasicRationalPolynomial(quot);
+    if (r)
+        *r = BasicRationalPolynomial(rem);
+
+    return;
+}
+
+template <typename IntT>
+const BasicRationalPolynomial<IntT> BasicRationalPolynomial<IntT>::operator/(
+    const BasicRationalPolynomial& p) const {
+    BasicRationalPolynomial q;
+    divide(p, &q, NULL);
+    return q;
+}
+
+template <typename IntT>
+const BasicRationalPolynomial<IntT> BasicRationalPolynomial<IntT>::operator%(
+    const BasicRationalPolynomial& p) const {
+    BasicRationalPolynomial r;
+    divide(p, NULL, &r);
+    return r;
+}
+
+template <typename IntT>
+bool BasicRationalPolynomial<IntT>::operator==(
+    const BasicRationalPolynomial& p) const {
+    return m_coeffs == p.m_coeffs;
+}
+
+template <typename IntT>
+bool BasicRationalPolynomial<IntT>::operator!=(
+    const BasicRationalPolynomial& p) const {
+    return !(*this == p);
+}
+
+/******************************
+ CALCULUS AND ROOTS
+ ******************************/
+template <typename IntT>
+BasicRationalPolynomial<IntT>
+BasicRationalPolynomial<IntT>::derivative() const {
+    vector<Value> out(m_coeffs.empty() ? 0 : m_coeffs.size() - 1);
+    for (size_t i = 0; i < out.size(); i++)
+        out[i] = m_coeffs[i + 1] * (i + 1);
+    return BasicRationalPolynomial(out);
+}
+
+/*
+ gcd
+
+ Returns the monic greatest common divisor by Euclid's algorithm, making
+ each remainder monic so that coefficients stay small.
+
+ Arguments:     a (Polynomial&) - First polynomial
+                b (Polynomial&) - Second polynomial
+
+ Returns:       (Polynomial) - Their monic GCD, or zero if both are zero.
+
+ Global Impact: Throws overflow_error if a coefficient does not fit IntT.
+*/
+template <typename IntT>
+BasicRationalPolynomial<IntT> BasicRationalPolynomial<IntT>::gcd(
+    const BasicRationalPolynomial& a, const BasicRationalPolynomial& b) {
+    BasicRationalPolynomial x(a), y(b);
+    while (!y.m_coeffs.empty()) {
+        BasicRationalPolynomial r = x % y;
+        x = y.scaled(1 / y.leading());
+        y = r;
+    }
+    return x.m_coeffs.empty() ? x : x.scaled(1 / x.leading());
+}
+
+/* Divides out the repeated factors, those shared with the derivative. */
+template <typename IntT>
+BasicRationalPolynomial<IntT>
+BasicRationalPolynomial<IntT>::squareFree() const {
+    if (degree() <= 0)
+        return *this;
+    return *this / gcd(*this, derivative());
+}
+
+/*
+ sturm
+
+ Returns the Sturm sequence p, p', -rem(p, p'), ... down to the last nonzero
+ remainder.  Each entry after p' is scaled by a positive constant so that
+ its leading coefficient is 1 or -1, which keeps coefficients small without
+ changing any sign.
+
+ Arguments:     None.
+
+ Returns:       (vector<Polynomial>) - The sequence, empty for zero.
+
+ Global Impact: Throws overflow_error if a coefficient does not fit IntT.
+*/
+template <typename IntT>
+vector<BasicRationalPolynomial<IntT>>
+BasicRationalPolynomial<IntT>::sturm() const {
+    vector<BasicRationalPolynomial> seq;
+    if (m_coeffs.empty())
+        return seq;
+
+    seq.push_back(*this);
+    BasicRationalPolynomial next = derivative();
+    while (!next.m_coeffs.empty()) {
+        Value lead = next.leading();
+        seq.push_back(next.scaled(1 / (lead < 0 ? -lead : lead)));
+        next = -(seq[seq.size() - 2] % seq.back());
+    }
+    return seq;
+}
+
+/*
+ countRoots
+
+ Counts the distinct real roots in (a, b] by Sturm's theorem, as the drop in
+ sign changes of the Sturm sequence of the square free part from a to b.
+
+ Arguments:     a (Value&) - Lower end, excluded
+                b (Value&) - Upper end, included
+
+ Returns:       (size_t) - Number of distinct roots, 0 if b <= a.
+
+ Global Impact: Throws invalid_argument for the zero polynomial, which has
+                every root, and overflow_error if a coefficient or value does
+                not fit IntT.
+*/
+template <typename IntT>
+size_t BasicRationalPolynomial<IntT>::countRoots(const Value& a,
+                                                 const Value& b) const {
+    if (m_coeffs.empty())
+        throw invalid_argument("The zero polynomial has every root.");
+    if (b <= a)
+        return 0;
+
+    vector<BasicRationalPolynomial> seq = squareFree().sturm();
+    return variations(seq, a) - variations(seq, b);
+}
+
+/*
+ isolateRoots
+
+ Isolates the distinct real roots.  They all lie in (-B, B] where B is an
+ integer above the Cauchy bound 1 + max |c_i / c_n|, and that interval is
+ bisected at midpoints until Sturm's theorem finds exactly one root in each
+ piece.  A root that a midpoint lands on exactly is returned as [m, m].
+
+ Arguments:     None.
+
+ Returns:       (vector<pair<Value, Value>>) - In increasing order, for each
+                root either an interval (lo, hi] holding it and no other, or
+                lo == hi, the root itself.
+
+ Global Impact: Throws invalid_argument for the zero polynomial and
+                overflow_error if a coefficient or value does not fit IntT.
+*/
+template <typename IntT>
+vector<pair<typename BasicRationalPolynomial<IntT>::Value,
+            typename BasicRationalPolynomial<IntT>::Value>>
+BasicRationalPolynomial<IntT>::isolateRoots() const {
+    if (m_coeffs.empty())
+        throw invalid_argument("The zero polynomial has every root.");
+
+    vector<pair<Value, Value>> out;
+    BasicRationalPolynomial q = squareFree();
+    if (q.degree() <= 0)
+        return out;
+
+    Value most;
+    for (size_t i = 0; i + 1 < q.m_coeffs.size(); i++) {
+        Value c = q.m_coeffs[i] / q.leading();
+        most = max(most, c < 0 ? -c : c);
+    }
+    Value bound(most.num() / most.denom() + IntT(2));
+
+    // Pieces still holding several roots, with their sign changes, taken
+    // lowest first so that roots come out in order
+    struct Piece {
+        Value lo, hi;
+        size_t vlo, vhi;
+    };
+    vector<BasicRationalPolynomial> seq = q.sturm();
+    vector<Piece> stack(1, Piece{ -bound, bound, variations(seq, -bound),
+                                  variations(seq, bound) });
+    while (!stack.empty()) {
+        Piece p = stack.back();
+        stack.pop_back();
+        size_t count = p.vlo - p.vhi;
+        if (count == 0)
+            continue;
+        if (count == 1) {
+            if (q.signAt(p.hi) == 0)
+                out.push_back(make_pair(p.hi, p.hi));
+            else
+                out.push_back(make_pair(p.lo, p.hi));
+            continue;
+        }
+
+        Value mid = (p.lo + p.hi) / 2;
+        size_t vmid = variations(seq, mid);
+        stack.push_back(Piece{ mid, p.hi, vmid, p.vhi });
+        stack.push_back(Piece{ p.lo, mid, p.vlo, vmid });
+    }
+    return out;
+}
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+template class BasicRationalPolynomial<int32_t>;
+template class BasicRationalPolynomial<int64_t>;
+template class BasicRationalPolynomial<int128_t>;
+template class BasicRationalPolynomial<BigInt>;
@@ -0,0 +1,141 @@
+/*
+ rationalpolynomial.hh
+
+ Contains the BasicRationalPolynomial class template definition, a
+ polynomial in one variable with BasicRational coefficients.
+*/
+
+#ifndef RATIONALPOLYNOMIAL
+#define RATIONALPOLYNOMIAL
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include "rational.hh"
+
+/*
+ BasicRationalPolynomial Class
+
+ Holds the coefficients of a polynomial, constant term first, with no zero
+ leading coefficient, so the zero polynomial has none and degree -1.
+
+ Alongside the coefficients it keeps them scaled to integers by the LCM of
+ their denominators.  Evaluating at x = u/v is then Horner's rule on those
+ integers in the wide type of RationalTraits<IntT>,
+
+    s = s * u + a_i * v^(n-i)
+
+ which needs no GCD and no temporary BasicRationals, and the result is
+ reduced once at the end.  If an intermediate overflows the wide type, the
+ point is evaluated again by Horner's rule on BasicRationals, reducing as it
+ goes, which throws overflow_error only if a reduced intermediate does not
+ fit IntT.  Products are likewise convolutions of the scaled integers,
+ schoolbook for short operands and Karatsuba past KARATSUBA_COEFFS
+ coefficients, reduced once per coefficient at the end.
+
+ The real roots are isolated exactly with the Sturm sequence of the square
+ free part, by bisecting from a bound on the roots until each interval holds
+ exactly one.
+*/
+template <typename IntT>
+class BasicRationalPolynomial {
+public:
+    typedef BasicRational<IntT> Value;
+    typedef typename RationalTraits<IntT>::Wide Wide;
+
+private:
+    /******************************
+     MEMBERS
+     ******************************/
+    std::vector<Value> m_coeffs;            // Coefficients, constant first
+    std::vector<Wide> m_scaled;             // Them times m_scale
+    Wide m_scale;                           // LCM of their denominators
+
+    /******************************
+     PRIVATE METHODS
+     ******************************/
+    void trim();                            // Drops zeros, rescales
+    bool hornerScaled(const Value& x, Value *out) const;    // False on overflow
+    Value hornerReduced(const Value& x) const;      // Horner on Values
+    int signAt(const Value& x) const;       // Sign of the value at x
+    BasicRationalPolynomial scaled(const Value& c) const;   // c times this
+
+public:
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+    BasicRationalPolynomial();              // Zero polynomial
+    BasicRationalPolynomial(const Value& c);        // Constant c
+    BasicRationalPolynomial(
+        const std::vector<Value>& coeffs);  // Constant term first
+    static BasicRationalPolynomial monomial(const Value& c,
+                                            size_t k);      // c x^k
+
+    /******************************
+     ACCESSORS
+     ******************************/
+    int degree() const;                     // -1 for the zero polynomial
+    const std::vector<Value>& coefficients() const;     // Constant first
+    Value coefficient(size_t i) const;      // Of x^i, 0 past the degree
+    Value leading() const;                  // 0 for the zero polynomial
+
+    /******************************
+     EVALUATION
+     ******************************/
+    Value evaluate(const Value& x) const;   // Value at x
+    Value operator()(const Value& x) const; // Value at x
+    std::vector<Value> evaluate(const std::vector<Value>& xs,
+                                unsigned threads = 0) const;    // At each
+
+    /******************************
+     OPERATORS
+     ******************************/
+    const BasicRationalPolynomial operator-() const;        // Negate
+    const BasicRationalPolynomial operator+(
+        const BasicRationalPolynomial& p) const;            // Add
+    const BasicRationalPolynomial operator-(
+        const BasicRationalPolynomial& p) const;            // Subtract
+    const BasicRationalPolynomial operator*(
+        const BasicRationalPolynomial& p) const;            // Multiply
+    const BasicRationalPolynomial operator/(
+        const BasicRationalPolynomial& p) const;            // Quotient
+    const BasicRationalPolynomial operator%(
+        const BasicRationalPolynomial& p) const;            // Remainder
+    bool operator==(const BasicRationalPolynomial& p) const;    // Equal to
+    bool operator!=(const BasicRationalPolynomial& p) const;    // Not equal
+
+    void divide(const BasicRationalPolynomial& d, BasicRationalPolynomial *q,
+                BasicRationalPolynomial *r) const;  // this = q d + r
+
+    /******************************
+     CALCULUS AND ROOTS
+     ******************************/
+    BasicRationalPolynomial derivative() const;     // d/dx
+    static BasicRationalPolynomial gcd(const BasicRationalPolynomial& a,
+                                       const BasicRationalPolynomial& b);
+    BasicRationalPolynomial squareFree() const;     // Same roots, once each
+    std::vector<BasicRationalPolynomial> sturm() const;     // Sturm sequence
+    size_t countRoots(const Value& a,
+                      const Value& b) const;        // Distinct roots in (a, b]
+    std::vector<std::pair<Value, Value>> isolateRoots() const;  // Real roots
+};
+
+/* Products of operands with more coefficients than this use Karatsuba. */
+const size_t KARATSUBA_COEFFS = 32;
+
+/******************************
+ INSTANTIATIONS
+ ******************************/
+typedef BasicRationalPolynomial<int32_t>  RationalPolynomial;
+typedef BasicRationalPolynomial<int64_t>  RationalPolynomial64;
+typedef BasicRationalPolynomial<int128_t> RationalPolynomial128;
+typedef BasicRationalPolynomial<BigInt>   BigRationalPolynomial;
+
+/* Defined in rationalpolynomial.cc for these four types only. */
+extern template class BasicRationalPolynomial<int32_t>;
+extern template class BasicRationalPolynomial<int64_t>;
+extern template class BasicRationalPolynomial<int128_t>;
+extern template class BasicRationalPolynomial<BigInt>;
+
+#endif // ifndef RATIONALPOLYNOMIAL
@@ -0,0 +1,249 @@
+/*
+ saferational.cc
+
+ Contains the promoted paths of the SafeRational class defined in
+ saferational.hh, which are taken once a value no longer fits in 64 bits.
+*/
+
+#include "saferational.hh"
+
+using namespace std;
+
+/******************************
+ CONSTRUCTORS
+ ******************************/
+/*
+ SafeRational
+
+ Initializes to n/d in simplest form, with a positive denominator.
+
+ Arguments:     n (int64_t) - Numerator
+                d (int64_t) - Denominator
+
+ Returns:       None.
+
+ Global Impact: Throws invalid_argument if d is 0.
+*/
+SafeRational::SafeRational(int64_t n, int64_t d) : m_num(0), m_denom(1) {
+    if (d == 0)
+        throw invalid_argument("Denominator must be nonzero.");
+
+    // Negating INT64_MIN overflows, so it is reduced as a BigRational
+    if (n == INT64_MIN || d == INT64_MIN) {
+        assign(BigRational(n, d));
+        return;
+    }
+
+    int64_t g = GCD(n, d);
+    if (d < 0)
+        g = -g;
+    m_num = n / g;
+    m_denom = d / g;
+}
+
+/*
+ SafeRational
+
+ Initializes to a BigRational, inline if it fits.
+
+ Arguments:     r (BigRational&) - Value to copy
+
+ Returns:       None.
+
+ Global Impact: None.
+*/
+SafeRational::SafeRational(const BigRational& r) : m_num(0), m_denom(1) {
+    assign(r);
+}
+
+/******************************
+ PRIVATE METHODS
+ ******************************/
+/*
+ assign
+
+ Stores a BigRational, inline if its numerator and denominator fit in
+ int64_ts and the numerator is not INT64_MIN, and promoted otherwise.
+
+ Arguments:     r (BigRational&) - Value to store
+
+ Returns:       None.
+
+ Global Impact: Updates the value, freeing or allocating the promoted copy.
+*/
+void SafeRational::assign(const BigRational& r) {
+    BigInt n = r.num(), d = r.denom();
+    if (n.isSmall() && d.isSmall() && (int64_t) n != INT64_MIN) {
+        m_num = (int64_t) n;
+        m_denom = (int64_t) d;
+        m_big.reset();
+    }
+    else if (m_big) {
+        if (m_big.get() != &r)
+            *m_big = r;
+    }
+    else {
+        m_big.reset(new BigRational(r));
+    }
+}
+
+/*
+ toBigInt
+
+ Converts a 128-bit integer of magnitude below 2^127 to a BigInt.
+*/
+static BigInt toBigInt(int128_t v) {
+    uint128_t mag = v < 0 ? -(uint128_t) v : (uint128_t) v;
+    if (mag >> 63 == 0)
+        return BigInt((int64_t) v);
+
+    BigInt two32((int64_t) 1 << 32);
+    BigInt out = (BigInt((int64_t) (mag >> 64)) * two32 +
+                  BigInt((int64_t) ((uint64_t) mag >> 32))) * two32 +
+                 BigInt((int64_t) ((uint64_t) mag & 0xFFFFFFFF));
+    return v < 0 ? -out : out;
+}
+
+/*
+ apply
+
+ Applies an operation in place.
+
+ Arguments:     a (R&) - Left operand, overwritten with the result
+                b (R&) - Right operand
+                op (char) - One of '+', '-', '*' and '/'
+
+ Returns:       None.
+
+ Global Impact: Throws invalid_argument when dividing by 0.
+*/
+template <typename R>
+static void apply(R& a, const R& b, char op) {
+    switch (op) {
+    case '+':   a += b; break;
+    case '-':   a -= b; break;
+    case '*':   a *= b; break;
+    default:    a /= b; break;
+    }
+}
+
+/*
+ promotedOp
+
+ Redoes an operation that overflowed int64_ts, or that has a promoted
+ operand, and stores the result.  Products and sums of two inline values
+ always fit in Rational128, so those are redone there and only promoted if
+ the result is too big for int64_ts.  Anything else is done as BigRationals,
+ in place when this is promoted already.
+
+ Arguments:     r (SafeRational&) - Right operand
+                op (char) - One of '+', '-', '*' and '/'
+
+ Returns:       None.
+
+ Global Impact: Updates the value.  Throws invalid_argument when dividing
+                by 0.
+*/
+void SafeRational::promotedOp(const SafeRational& r, char op) {
+    if (!m_big && !r.m_big) {
+        Rational128 a, b;
+        a.narrow(m_num, m_denom);
+        b.narrow(r.m_num, r.m_denom);
+        apply(a, b, op);
+
+        int128_t n = a.num(), d = a.denom();
+        if (n > INT64_MIN && n <= INT64_MAX && d <= INT64_MAX) {
+            m_num = (int64_t) n;
+            m_denom = (int64_t) d;
+        }
+        else {
+            BigRational out;
+            out.narrow(toBigInt(n), toBigInt(d));
+            m_big.reset(new BigRational(out));
+        }
+        return;
+    }
+
+    if (!m_big) {
+        BigRational a = toBig();
+        apply(a, *r.m_big, op);
+        assign(a);
+    }
+    else {
+        if (r.m_big)
+            apply(*m_big, *r.m_big, op);
+        else
+            apply(*m_big, r.toBig(), op);
+        assign(*m_big);
+    }
+}
+
+/*
+ promotedCompare
+
+ Compares with r as BigRationals, for when either is promoted.
+
+ Arguments:     r (SafeRational&) - Value to compare to
+
+ Returns:       (int) - -1, 0 or 1 as this is less than, equal to or greater
+                        than r.
+
+ Global Impact: None.
+*/
+int SafeRational::promotedCompare(const SafeRational& r) const {
+    return toBig().compare(r.toBig());
+}
+
+/******************************
+ ACCESSORS
+ ******************************/
+BigInt SafeRational::num() const {
+    return m_big ? m_big->num() : BigInt(m_num);
+}
+
+BigInt SafeRational::denom() const {
+    return m_big ? m_big->denom() : BigInt(m_denom);
+}
+
+/*
+ toBig
+
+ Returns the value as a BigRational.  Inline values are already in simplest
+ form, so they are stored without reducing again.
+*/
+BigRational SafeRational::toBig() const {
+    if (m_big)
+        return *m_big;
+    BigRational out;
+    out.narrow(BigInt(m_num), BigInt(m_denom));
+    return out;
+}
+
+/******************************
+ EXPLICIT CASTING
+ ******************************/
+SafeRational::operator double() const {
+    return m_big ? (double) *m_big : ratioToDouble(m_num, m_denom);
+}
+
+/******************************
+ STREAM OUTPUT
+ ******************************/
+/*
+ ostream operator
+
+ Outputs the SafeRational as Rationals are output, "n" or "n/d".
+
+ Arguments:     os (ostream&) - Stream to output onto
+                r (SafeRational&) - Value to output
+
+ Returns:       (ostream) - The ostream that the SafeRational is output onto
+*/
+ostream& operator<<(ostream& os, const SafeRational& r) {
+    if (r.promoted())
+        return os << r.toBig();
+    os << r.num();
+    if (r.denom() != BigInt(1))
+        os << "/" << r.denom();
+    return os;
+}
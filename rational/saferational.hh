@@ -0,0 +1,324 @@
+/*
+ saferational.hh
+
+ Contains the SafeRational class definition, a rational number that runs on
+ 64-bit integers until they overflow and on BigInts after.
+*/
+
+#ifndef SAFERATIONAL
+#define SAFERATIONAL
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <stdint.h>
+#include "common.hh"
+#include "rational.hh"
+
+/*
+ SafeRational Class
+
+ Emulates rational numbers that never overflow.  Values whose numerator and
+ denominator fit in an int64_t are kept inline, and their arithmetic is done
+ on int64_ts with __builtin_mul_overflow and __builtin_add_overflow, with no
+ wider intermediates.  When one of those overflows the operation is redone in
+ Rational128, which is always exact for two inline operands, and only a
+ result that does not fit in int64_ts is kept promoted, as a BigRational on
+ the heap.  Operations with a promoted operand are done as BigRationals, and
+ whenever a result fits in int64_ts again it is demoted back inline.  So
+ values that stay small pay about what Rational64 does, and values that grow
+ stay exact at BigRational speed.
+
+ A numerator of INT64_MIN is kept promoted so that inline values can always
+ be negated.  The inline fast paths are defined in this header so that they
+ inline, and the promoted paths, which allocate anyway, in saferational.cc.
+*/
+class SafeRational {
+private:
+    /******************************
+     MEMBERS
+     ******************************/
+    int64_t m_num;                          // Numerator when inline
+    int64_t m_denom;                        // Denominator when inline
+    std::unique_ptr<BigRational> m_big;     // Value when promoted, else NULL
+
+    /******************************
+     PRIVATE METHODS
+     ******************************/
+    bool addInline(int64_t c, int64_t d, bool subtract);   // False on overflow
+    bool mulInline(int64_t c, int64_t d);   // False on overflow
+    void assign(const BigRational& r);      // Stores r, demoting if it fits
+    void promotedOp(const SafeRational& r, char op);    // Op when overflowing
+    int promotedCompare(const SafeRational& r) const;   // Compare as them
+
+public:
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+    SafeRational();                         // Initializes to 0/1
+    SafeRational(int64_t n);                // Initializes to n/1
+    SafeRational(int64_t n, int64_t d);     // Initializes to n/d
+    SafeRational(const BigRational& r);     // Initializes to r
+    SafeRational(const SafeRational& r);    // Copies r
+    SafeRational(SafeRational&& r) = default;           // Takes over r
+
+    SafeRational& operator=(const SafeRational& r);     // Copies r
+    SafeRational& operator=(SafeRational&& r) = default;    // Takes over r
+
+    /******************************
+     ACCESSORS
+     ******************************/
+    bool promoted() const;                  // True if kept as a BigRational
+    BigInt num() const;                     // Returns numerator
+    BigInt denom() const;                   // Returns denominator
+    BigRational toBig() const;              // Returns the value
+
+    /******************************
+     OPERATORS
+     ******************************/
+    const SafeRational operator-() const;   // Unary negation
+    const SafeRational operator+(const SafeRational& r) const;  // Add
+    const SafeRational operator-(const SafeRational& r) const;  // Subtract
+    const SafeRational operator*(const SafeRational& r) const;  // Multiply
+    const SafeRational operator/(const SafeRational& r) const;  // Divide
+    SafeRational& operator+=(const SafeRational& r);    // Add
+    SafeRational& operator-=(const SafeRational& r);    // Subtract
+    SafeRational& operator*=(const SafeRational& r);    // Multiply
+    SafeRational& operator/=(const SafeRational& r);    // Divide
+
+    /******************************
+     COMPARATORS
+     ******************************/
+    int compare(const SafeRational& r) const;       // -1, 0 or 1
+    bool operator<(const SafeRational& r) const;    // Less than
+    bool operator>(const SafeRational& r) const;    // Greater than
+    bool operator<=(const SafeRational& r) const;   // Less or equal
+    bool operator>=(const SafeRational& r) const;   // Greater or equal
+    bool operator==(const SafeRational& r) const;   // Equal to
+    bool operator!=(const SafeRational& r) const;   // Not equal to
+
+    /******************************
+     HASHING
+     ******************************/
+    size_t hash() const;                    // Same as the BigRational's
+
+    /******************************
+     EXPLICIT CASTING
+     ******************************/
+    explicit operator double() const;       // Nearest double
+};
+
+std::ostream& operator<<(std::ostream& os, const SafeRational& r);
+
+/* So that SafeRationals can key std::unordered_map and other hash tables. */
+namespace std {
+template <>
+struct hash<SafeRational> {
+    size_t operator()(const SafeRational& r) const {
+        return r.hash();
+    }
+};
+}
+
+/******************************
+ INLINE FAST PATHS
+ ******************************/
+inline SafeRational::SafeRational() : m_num(0), m_denom(1) {}
+
+inline SafeRational::SafeRational(int64_t n) : m_num(n), m_denom(1) {
+    if (n == INT64_MIN)
+        assign(BigRational(n));
+}
+
+inline SafeRational::SafeRational(const SafeRational& r)
+    : m_num(r.m_num), m_denom(r.m_denom),
+      m_big(r.m_big ? new BigRational(*r.m_big) : NULL) {}
+
+inline SafeRational& SafeRational::operator=(const SafeRational& r) {
+    m_num = r.m_num;
+    m_denom = r.m_denom;
+    m_big.reset(r.m_big ? new BigRational(*r.m_big) : NULL);
+    return *this;
+}
+
+inline bool SafeRational::promoted() const {
+    return m_big != NULL;
+}
+
+/*
+ addInline
+
+ Adds c/d to, or subtracts it from, the inline value as BasicRational's sum
+ does, but in int64_ts, giving up if anything overflows.
+
+ Arguments:     c (int64_t) - Numerator, not INT64_MIN
+                d (int64_t) - Positive denominator
+                subtract (bool) - True to subtract rather than add
+
+ Returns:       (bool) - True if the result was stored, false if it overflows
+                         and nothing was changed.
+
+ Global Impact: Updates m_num and m_denom on success.
+*/
+inline bool SafeRational::addInline(int64_t c, int64_t d, bool subtract) {
+    int64_t a = m_num, b = m_denom, g = 1;
+    if (b != 1 || d != 1)
+        g = GCD(b, d);
+
+    int64_t l = 0, r = 0, t = 0, den = 0;
+    if (__builtin_mul_overflow(a, d / g, &l) ||
+        __builtin_mul_overflow(c, b / g, &r) ||
+        (subtract ? __builtin_sub_overflow(l, r, &t)
+                  : __builtin_add_overflow(l, r, &t)) ||
+        __builtin_mul_overflow(b / g, d, &den) || t == INT64_MIN)
+        return false;
+
+    if (g != 1) {
+        int64_t g2 = GCD(t, g);
+        t /= g2;
+        den /= g2;
+    }
+    m_num = t;
+    m_denom = den;
+    return true;
+}
+
+/*
+ mulInline
+
+ Multiplies the inline value by c/d, cancelling across first as
+ BasicRational does, in int64_ts, giving up if anything overflows.
+
+ Arguments:     c (int64_t) - Numerator, not INT64_MIN
+                d (int64_t) - Positive denominator
+
+ Returns:       (bool) - True if the result was stored, false if it overflows
+                         and nothing was changed.
+
+ Global Impact: Updates m_num and m_denom on success.
+*/
+inline bool SafeRational::mulInline(int64_t c, int64_t d) {
+    if (m_num == 0 || c == 0) {
+        m_num = 0;
+        m_denom = 1;
+        return true;
+    }
+
+    int64_t g1 = GCD(m_num, d), g2 = GCD(c, m_denom);
+    int64_t n = 0, den = 0;
+    if (__builtin_mul_overflow(m_num / g1, c / g2, &n) ||
+        __builtin_mul_overflow(m_denom / g2, d / g1, &den) || n == INT64_MIN)
+        return false;
+
+    m_num = n;
+    m_denom = den;
+    return true;
+}
+
+inline const SafeRational SafeRational::operator-() const {
+    if (m_big)
+        return SafeRational(-*m_big);
+    SafeRational out;
+    out.m_num = -m_num;
+    out.m_denom = m_denom;
+    return out;
+}
+
+inline SafeRational& SafeRational::operator+=(const SafeRational& r) {
+    if (m_big || r.m_big || !addInline(r.m_num, r.m_denom, false))
+        promotedOp(r, '+');
+    return *this;
+}
+
+inline SafeRational& SafeRational::operator-=(const SafeRational& r) {
+    if (m_big || r.m_big || !addInline(r.m_num, r.m_denom, true))
+        promotedOp(r, '-');
+    return *this;
+}
+
+inline SafeRational& SafeRational::operator*=(const SafeRational& r) {
+    if (m_big || r.m_big || !mulInline(r.m_num, r.m_denom))
+        promotedOp(r, '*');
+    return *this;
+}
+
+inline SafeRational& SafeRational::operator/=(const SafeRational& r) {
+    if (m_big || r.m_big)
+        promotedOp(r, '/');
+    else if (r.m_num == 0)
+        throw std::invalid_argument("Denominator must be nonzero.");
+    else if (!(r.m_num < 0 ? mulInline(-r.m_denom, -r.m_num)
+                           : mulInline(r.m_denom, r.m_num)))
+        promotedOp(r, '/');
+    return *this;
+}
+
+inline const SafeRational SafeRational::operator+(
+    const SafeRational& r) const {
+    SafeRational out(*this);
+    return out += r;
+}
+
+inline const SafeRational SafeRational::operator-(
+    const SafeRational& r) const {
+    SafeRational out(*this);
+    return out -= r;
+}
+
+inline const SafeRational SafeRational::operator*(
+    const SafeRational& r) const {
+    SafeRational out(*this);
+    return out *= r;
+}
+
+inline const SafeRational SafeRational::operator/(
+    const SafeRational& r) const {
+    SafeRational out(*this);
+    return out /= r;
+}
+
+inline int SafeRational::compare(const SafeRational& r) const {
+    if (m_big || r.m_big)
+        return promotedCompare(r);
+    int128_t ad = (int128_t) m_num * r.m_denom;
+    int128_t cb = (int128_t) r.m_num * m_denom;
+    return (cb < ad) - (ad < cb);
+}
+
+inline bool SafeRational::operator<(const SafeRational& r) const {
+    return compare(r) < 0;
+}
+
+inline bool SafeRational::operator>(const SafeRational& r) const {
+    return compare(r) > 0;
+}
+
+inline bool SafeRational::operator<=(const SafeRational& r) const {
+    return compare(r) <= 0;
+}
+
+inline bool SafeRational::operator>=(const SafeRational& r) const {
+    return compare(r) >= 0;
+}
+
+inline bool SafeRational::operator==(const SafeRational& r) const {
+    // Values are demoted whenever they fit, so a promoted value never equals
+    // an inline one
+    if (m_big || r.m_big)
+        return m_big && r.m_big && *m_big == *r.m_big;
+    return m_num == r.m_num && m_denom == r.m_denom;
+}
+
+inline bool SafeRational::operator!=(const SafeRational& r) const {
+    return !(*this == r);
+}
+
+/* Inline parts fold to themselves, so this is what BigRational::hash gives
+   for the same value. */
+inline size_t SafeRational::hash() const {
+    if (m_big)
+        return m_big->hash();
+    return (size_t) mix64(foldInt(m_num) ^ mix64(foldInt(m_denom)));
+}
+
+#endif // ifndef SAFERATIONAL
@@ -1,7 +1,23 @@
 #include "testbase.hh"
 #include "rational.hh"
-
+#include "lazyrational.hh"
+#include "accumulator.hh"
+#include "parallel.hh"
+#include "rationalarray.hh"
+#include "rationalchars.hh"
+#include "decimalexpansion.hh"
+#include "rationalmatrix.hh"
+#include "linearprogram.hh"
+#include "rationalpolynomial.hh"
+#include "rationalinterval.hh"
+#include "saferational.hh"
+
+#include <algorithm>
+#include <cmath>
 #include <sstream>
+#include <string.h>
+#include <unordered_set>
+#include <vector>
 
 using namespace std;
 
@@ -402,6 +418,2278 @@ void test_stream_output(TestContext &ctx) {
     ctx.result();
 }
 
+void test_integer_widths(TestContext &ctx) {
+    bool pass = false;
+
+    ctx.DESC("Intermediate products are widened before reducing");
+
+    // 65536 * 65537 overflows 32 bits, but the product reduces to 1.
+    Rational r = Rational(65536, 65537) * Rational(65537, 65536);
+    ctx.CHECK(r.num() == 1 && r.denom() == 1);
+
+    r = Rational(INT32_MAX, 2) + Rational(INT32_MAX, 2);
+    ctx.CHECK(r.num() == INT32_MAX && r.denom() == 1);
+
+    ctx.result();
+
+    ctx.DESC("Results that don't fit the integer type throw");
+
+    pass = false;
+    try {
+        r = Rational(1, 65536) + Rational(1, 65537);
+        pass = false;
+    }
+    catch (overflow_error &oe) {
+        pass = true;
+    }
+    catch (...) {
+        pass = false;
+    }
+    ctx.CHECK(pass);
+
+    pass = false;
+    try {
+        r = -Rational(INT32_MIN);
+        pass = false;
+    }
+    catch (overflow_error &oe) {
+        pass = true;
+    }
+    catch (...) {
+        pass = false;
+    }
+    ctx.CHECK(pass);
+
+    ctx.result();
+
+    ctx.DESC("Rational64 holds results that overflow Rational");
+
+    Rational64 r64 = Rational64(1, 65536) + Rational64(1, 65537);
+    ctx.CHECK(r64.num() == 131073 && r64.denom() == 4295032832LL);
+    r64 = Rational64(INT64_MAX, 3) * Rational64(3, INT64_MAX);
+    ctx.CHECK(r64.num() == 1 && r64.denom() == 1);
+
+    ctx.result();
+
+    ctx.DESC("Rational128 arithmetic and stream output");
+
+    Rational128 r128 = Rational128(INT64_MAX) * Rational128(INT64_MAX);
+    r128 += Rational128(1, 2);
+    ctx.CHECK(r128.denom() == 2);
+    ctx.CHECK(r128.num() == (int128_t) INT64_MAX * INT64_MAX * 2 + 1);
+
+    stringstream sstream;
+    sstream << -r128;
+    ctx.CHECK(sstream.str() ==
+              "-170141183460469231694793815568465002499/2");
+
+    pass = false;
+    try {
+        r128 = r128 * r128;
+        pass = false;
+    }
+    catch (overflow_error &oe) {
+        pass = true;
+    }
+    catch (...) {
+        pass = false;
+    }
+    ctx.CHECK(pass);
+
+    ctx.result();
+}
+
+void test_big(TestContext &ctx) {
+    bool pass = false;
+    stringstream sstream;
+
+    ctx.DESC("BigInt arithmetic past 64 bits");
+
+    BigInt fact(1);
+    for (int k = 2; k <= 60; k++)
+        fact *= BigInt(k);
+    ctx.CHECK(fact.toString() == "832098711274139014427634118322336438075417"
+                                 "2606361245952449277696409600000000000000");
+    for (int k = 60; k >= 2; k--)
+        fact /= BigInt(k);
+    ctx.CHECK(fact == BigInt(1) && fact.isSmall());
+
+    BigInt p(BigInt(1) * BigInt(INT64_MAX));
+    p = p * p * p;
+    ctx.CHECK(!p.isSmall() && p % BigInt(INT64_MAX) == BigInt(0));
+    ctx.CHECK(GCD(p, BigInt(INT64_MAX) * BigInt(6)) == BigInt(INT64_MAX));
+    ctx.CHECK(-p < BigInt(INT64_MIN) && BigInt(INT64_MIN) < p);
+
+    ctx.result();
+
+    ctx.DESC("BigInt Karatsuba products divide back exactly");
+
+    // 1000 digit operands are well past the Karatsuba threshold.
+    string digits;
+    for (int i = 0; i < 1000; i++)
+        digits += (char) ('1' + i % 9);
+    BigInt a(digits), b("-" + digits.substr(0, 700));
+    BigInt prod = a * b;
+    ctx.CHECK(prod / b == a && prod % b == BigInt(0));
+    ctx.CHECK((prod - BigInt(12345)) % a == BigInt(-12345));
+    ctx.CHECK(BigInt(prod.toString()) == prod);
+
+    ctx.result();
+
+    ctx.DESC("BigInt parsing rejects non-digits");
+
+    pass = false;
+    try {
+        BigInt bad("12a4");
+        pass = false;
+    }
+    catch (invalid_argument &ia) {
+        pass = true;
+    }
+    catch (...) {
+        pass = false;
+    }
+    ctx.CHECK(pass);
+
+    ctx.result();
+
+    ctx.DESC("BigRational sums exactly where Rational128 overflows");
+
+    BigRational h;
+    for (int k = 1; k <= 100; k++)
+        h += BigRational(1, k);
+    sstream << h;
+    ctx.CHECK(sstream.str() == "14466636279520351160221518043104131447711/"
+                               "2788815009188499086581352357412492142272");
+    ctx.CHECK(epsilon_equals((double) h, 5.187377517639621));
+
+    pass = false;
+    try {
+        Rational128 h128;
+        for (int k = 1; k <= 100; k++)
+            h128 += Rational128(1, k);
+        pass = false;
+    }
+    catch (overflow_error &oe) {
+        pass = true;
+    }
+    catch (...) {
+        pass = false;
+    }
+    ctx.CHECK(pass);
+
+    ctx.result();
+
+    ctx.DESC("BigRational operators match Rational");
+
+    BigRational r = BigRational(2, 3) * BigRational(9, 4);
+    r -= BigRational(1, 2);
+    ctx.CHECK(r.num() == BigInt(1) && r.denom() == BigInt(1));
+    r = BigRational(3, 5) / BigRational(-6, 7);
+    ctx.CHECK(r.num() == BigInt(-7) && r.denom() == BigInt(10));
+    r = r.reciprocal();
+    ctx.CHECK(r.num() == BigInt(-10) && r.denom() == BigInt(7));
+    ctx.CHECK(epsilon_equals((double) BigRational(BigInt(digits), BigInt(
+        digits.substr(0, 999))), 10.0, 0.1));
+
+    pass = false;
+    try {
+        r = r / BigRational();
+        pass = false;
+    }
+    catch (invalid_argument &ia) {
+        pass = true;
+    }
+    catch (...) {
+        pass = false;
+    }
+    ctx.CHECK(pass);
+
+    ctx.result();
+}
+
+void test_reduction(TestContext &ctx) {
+    const int NUMPAIRS = 20000;
+
+    ctx.DESC("Reduced arithmetic matches reducing the naive result");
+
+    // The operators cancel before multiplying and only take GCDs of
+    // denominators when adding, so check them against Rational64, which
+    // reduces the naive cross products, on operands with shared factors.
+    srand(654321L);
+    for (int i = 0; i < NUMPAIRS; i++) {
+        int a = (rand() % 2001 - 1000) * (1 + rand() % 12);
+        int b = (1 + rand() % 1000) * (1 + rand() % 12);
+        int c = (rand() % 2001 - 1000) * (1 + rand() % 12);
+        int d = (1 + rand() % 1000) * (1 + rand() % 12);
+        Rational x(a, b), y(c, d);
+        int64_t n = x.num(), m = x.denom(), p = y.num(), q = y.denom();
+
+        Rational r = x + y;
+        Rational64 e(n * q + p * m, m * q);
+        ctx.CHECK(r.num() == e.num() && r.denom() == e.denom());
+
+        r = x - y;
+        e = Rational64(n * q - p * m, m * q);
+        ctx.CHECK(r.num() == e.num() && r.denom() == e.denom());
+
+        r = x * y;
+        e = Rational64(n * p, m * q);
+        ctx.CHECK(r.num() == e.num() && r.denom() == e.denom());
+
+        if (p != 0) {
+            r = x / y;
+            e = Rational64(n * q, m * p);
+            ctx.CHECK(r.num() == e.num() && r.denom() == e.denom());
+        }
+    }
+
+    ctx.result();
+
+    ctx.DESC("Binary GCD of 32, 64 and 128-bit values");
+
+    ctx.CHECK(GCD(0, 0) == 0 && GCD(0, -12) == 12 && GCD(-18, 0) == 18);
+    ctx.CHECK(GCD(-48, 180) == 12 && GCD(17, 5) == 1);
+    ctx.CHECK(GCD((int64_t) 1 << 40, (int64_t) 3 << 38) == (int64_t) 1 << 38);
+    int128_t big = (int128_t) 1000000007 * 998244353 * 1000000009;
+    ctx.CHECK(GCD(big * 6, big * 10) == big * 2);
+
+    ctx.result();
+}
+
+
+void test_comparisons(TestContext &ctx) {
+    const int NUMPAIRS = 20000;
+
+    ctx.DESC("Comparisons are exact where doubles round");
+
+    // These differ by about 1e-38 and convert to the same double
+    Rational64 a(INT64_MAX - 1, INT64_MAX), b(INT64_MAX - 2, INT64_MAX - 1);
+    ctx.CHECK((double) a == (double) b);
+    ctx.CHECK(b < a && a > b && b <= a && a >= b && a != b);
+    ctx.CHECK(!(a < b) && !(b > a) && !(a == b));
+    ctx.CHECK(a.compare(b) == 1 && b.compare(a) == -1 && a.compare(a) == 0);
+
+    Rational c(INT32_MAX - 1, INT32_MAX), d(INT32_MAX, INT32_MAX - 1);
+    ctx.CHECK(c < Rational(1) && Rational(1) < d && c < d && -d < -c);
+
+    ctx.result();
+
+    ctx.DESC("Comparison fast paths");
+
+    ctx.CHECK(Rational(-1, 1000) < Rational(0));
+    ctx.CHECK(Rational(0) < Rational(1, 7));
+    ctx.CHECK(Rational(-5, 3) < Rational(1, 3));
+    ctx.CHECK(Rational(2, 3) > Rational(1, 3));
+    ctx.CHECK(Rational128(-1, 3) < Rational128(1, 5));
+    ctx.CHECK(Rational128(-2, 7) < Rational128(-1, 7));
+    ctx.CHECK(BigRational(-1, 3) < BigRational(0));
+    ctx.CHECK(BigRational(0) == BigRational());
+    ctx.CHECK(BigRational(2, 9) > BigRational(1, 9));
+
+    ctx.result();
+
+    ctx.DESC("128-bit comparisons whose cross products overflow");
+
+    // Numerators and denominators near 2^124 overflow 128-bit cross
+    // products, so these compare by continued fractions and are checked
+    // against BigRational
+    srand(123456L);
+    for (int i = 0; i < NUMPAIRS; i++) {
+        int64_t v[8];
+        for (int j = 0; j < 8; j++)
+            v[j] = 1 + (int64_t) ((((uint64_t) rand() << 42) ^
+                                   ((uint64_t) rand() << 21) ^ rand()) >> 2);
+        if (i % 2)
+            v[0] = -v[0];
+        if (i % 3 == 0)
+            v[4] = -v[4];
+        // Some pairs share a numerator or a denominator
+        if (i % 5 == 0)
+            v[6] = v[2], v[7] = v[3];
+        if (i % 7 == 0)
+            v[4] = v[0], v[5] = v[1];
+
+        Rational128 x((int128_t) v[0] * v[1], (int128_t) v[2] * v[3]);
+        Rational128 y((int128_t) v[4] * v[5], (int128_t) v[6] * v[7]);
+        BigInt n = v[0], m = v[2], p = v[4], q = v[6];
+        BigRational bx(n * v[1], m * v[3]), by(p * v[5], q * v[7]);
+        ctx.CHECK(x.compare(y) == bx.compare(by));
+        ctx.CHECK(y.compare(x) == -bx.compare(by));
+        ctx.CHECK((x < y) == (bx < by) && (x == y) == (bx == by));
+    }
+
+    int128_t max = RationalTraits<int128_t>::max();
+    Rational128 big(max, 3), less(max - 1, 3);
+    ctx.CHECK(less < big && big > less);
+    ctx.CHECK(Rational128(1, max) < Rational128(1, max - 1));
+
+    ctx.result();
+
+    ctx.DESC("Sorting rationals matches sorting their cross products");
+
+    vector<Rational> v;
+    for (int i = 0; i < 1000; i++)
+        v.push_back(Rational(rand() % 2001 - 1000, 1 + rand() % 1000));
+    sort(v.begin(), v.end());
+    bool sorted = true;
+    for (size_t i = 1; i < v.size(); i++)
+        sorted = sorted && (int64_t) v[i - 1].num() * v[i].denom() <=
+                           (int64_t) v[i].num() * v[i - 1].denom();
+    ctx.CHECK(sorted);
+
+    ctx.result();
+}
+
+
+void test_lazy(TestContext &ctx) {
+    const int NUMCHAINS = 2000;
+
+    ctx.DESC("LazyRational constructors, accessors and output");
+
+    LazyRational64 a(6, -4), b(3), c;
+    ctx.CHECK(a.num() == -3 && a.denom() == 2);
+    ctx.CHECK(b.num() == 3 && b.denom() == 1 && c.num() == 0);
+    ctx.CHECK(LazyRational(Rational(10, 4)).denom() == 2);
+    ctx.CHECK(LazyRational(INT32_MIN, -2).num() == -(INT32_MIN / 2));
+    ctx.CHECK(LazyRational(4, 6).normalized() == Rational(2, 3));
+    ctx.CHECK((double) LazyRational(3, 4) == 0.75);
+
+    ostringstream out;
+    out << LazyRational128(10, 4) << " " << LazyRational(8, -4);
+    ctx.CHECK(out.str() == "5/2 -2");
+
+    bool threw = false;
+    try {
+        LazyRational(1, 0);
+    } catch (invalid_argument &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    threw = false;
+    try {
+        a / LazyRational64();
+    } catch (invalid_argument &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    ctx.result();
+
+    ctx.DESC("LazyRational chains match Rational chains");
+
+    // Mixed chains over small operands, each checked against the same chain
+    // on Rational64 once it is done
+    srand(13579L);
+    for (int i = 0; i < NUMCHAINS; i++) {
+        LazyRational64 lazy(1);
+        Rational64 eager(1);
+        for (int j = 0; j < 12; j++) {
+            int64_t n = rand() % 41 - 20, d = 1 + rand() % 20;
+            switch (rand() % 4) {
+            case 0: lazy += LazyRational64(n, d); eager += Rational64(n, d);
+                    break;
+            case 1: lazy -= LazyRational64(n, d); eager -= Rational64(n, d);
+                    break;
+            case 2: lazy *= LazyRational64(n, d); eager *= Rational64(n, d);
+                    break;
+            default:
+                if (n != 0) {
+                    lazy /= LazyRational64(n, d);
+                    eager /= Rational64(n, d);
+                }
+            }
+        }
+        ctx.CHECK(lazy.normalized() == eager);
+    }
+
+    LazyRational x(1, 3), y(1, 6);
+    ctx.CHECK(x + y == LazyRational(1, 2) && x - y == y);
+    ctx.CHECK(x * y == LazyRational(1, 18) && x / y == LazyRational(2));
+    ctx.CHECK(-x == LazyRational(-1, 3) && y < x && x > y && x != y);
+    ctx.CHECK(x <= x && x >= x && x.compare(y) == 1);
+
+    ctx.result();
+
+    ctx.DESC("LazyRational reduces when it would overflow");
+
+    // The unreduced denominator of this telescoping sum overflows long
+    // before its reduced value does: 1/(k(k+1)) sums to n/(n+1)
+    LazyRational sum;
+    for (int k = 1; k <= 40000; k++)
+        sum += LazyRational(1, k * (k + 1));
+    ctx.CHECK(sum.num() == 40000 && sum.denom() == 40001);
+
+    LazyRational128 prod(1);
+    for (int k = 1; k <= 200; k++)
+        prod *= LazyRational128(k + 1, k);
+    ctx.CHECK(prod == LazyRational128(201));
+
+    LazyRational neg(INT32_MIN, 2);
+    ctx.CHECK(-neg == LazyRational(-(INT32_MIN / 2)));
+
+    threw = false;
+    try {
+        LazyRational big(INT32_MAX);
+        big += LazyRational(1);
+    } catch (overflow_error &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    ctx.result();
+}
+
+
+void test_accumulator(TestContext &ctx) {
+    const int NUMTERMS = 20000;
+
+    ctx.DESC("RationalAccumulator sums match operator+=");
+
+    // Ledger style amounts over a few denominators, and terms over the 1260
+    // divisors of 2^6 3^4 5^2 7^2 11 13, which force groups to be folded
+    // while the total stays over a denominator that fits
+    srand(24680L);
+    const int64_t primes[6] = { 2, 3, 5, 7, 11, 13 };
+    const int powers[6] = { 6, 4, 2, 2, 1, 1 };
+    const int denoms[6] = { 1, 2, 4, 100, 1000, 3 };
+    RationalAccumulator64 ledger, spread;
+    Rational64 ledgerSum, spreadSum;
+    vector<Rational64> terms;
+    for (int i = 0; i < NUMTERMS; i++) {
+        Rational64 t(rand() % 200001 - 100000, denoms[rand() % 6]);
+        int64_t d = 1;
+        for (int p = 0; p < 6; p++)
+            for (int e = rand() % (powers[p] + 1); e > 0; e--)
+                d *= primes[p];
+        Rational64 u(rand() % 2001 - 1000, d);
+        ledger.add(t);
+        ledgerSum += t;
+        spread.add(u);
+        spreadSum += u;
+        terms.push_back(t);
+    }
+    // Terms reduce over the divisors of 1000, or over 3
+    ctx.CHECK(ledger.result() == ledgerSum && ledger.groups() <= 17);
+    ctx.CHECK(spread.result() == spreadSum);
+    ctx.CHECK(spread.groups() <= RationalAccumulator64::MAX_GROUPS);
+
+    RationalAccumulator64 batch;
+    batch.addBatch(terms.data(), terms.size());
+    ctx.CHECK(batch.result() == ledgerSum);
+
+    RationalAccumulator empty;
+    ctx.CHECK(empty.result() == Rational() && empty.groups() == 0);
+
+    ctx.result();
+
+    ctx.DESC("RationalAccumulator merges partial sums");
+
+    RationalAccumulator64 parts[4];
+    for (size_t i = 0; i < terms.size(); i++)
+        parts[i % 4].add(terms[i]);
+    parts[0].merge(parts[1]);
+    parts[2].merge(parts[3]);
+    parts[0].merge(parts[2]);
+    ctx.CHECK(parts[0].result() == ledgerSum);
+
+    Rational64 part = parts[1].result(), twice = part + part;
+    parts[1].merge(parts[1]);
+    ctx.CHECK(parts[1].result() == twice);
+    parts[1].merge(spread);
+    ctx.CHECK(parts[1].result() == twice + spreadSum);
+
+    RationalAccumulator small;
+    small.add(Rational(1, 3));
+    small.merge(small);
+    ctx.CHECK(small.result() == Rational(2, 3));
+    small.clear();
+    ctx.CHECK(small.result() == Rational() && small.groups() == 0);
+
+    ctx.result();
+
+    ctx.DESC("RationalAccumulator numerator sums may exceed the integer type");
+
+    // The numerator sum overflows int, but its reduced total fits
+    RationalAccumulator acc;
+    for (int i = 0; i < 3; i++)
+        acc.add(Rational(INT32_MAX, 3));
+    ctx.CHECK(acc.result() == Rational(INT32_MAX));
+
+    RationalAccumulator128 wide;
+    int128_t max = RationalTraits<int128_t>::max();
+    wide.add(Rational128(max - 1, 7));
+    wide.add(Rational128(max - 1, 7));
+    wide.add(Rational128(-(max - 1), 7));
+    ctx.CHECK(wide.result() == Rational128(max - 1, 7));
+
+    bool threw = false;
+    try {
+        RationalAccumulator over;
+        over.add(Rational(INT32_MAX));
+        over.add(Rational(1));
+        over.result();
+    } catch (overflow_error &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    ctx.result();
+}
+
+
+void test_parallel(TestContext &ctx) {
+    const size_t NUMTERMS = 5 * PARALLEL_CHUNK + 1234;
+    const unsigned THREADS[5] = { 1, 2, 3, 4, 8 };
+
+    ctx.DESC("Parallel sums and products match sequential ones");
+
+    srand(97531L);
+    const int denoms[5] = { 1, 3, 8, 100, 360 };
+    vector<Rational64> terms, ratios;
+    for (size_t i = 0; i < NUMTERMS; i++) {
+        terms.push_back(Rational64(rand() % 20001 - 10000,
+                                   denoms[rand() % 5]));
+        // (k + 1)/k telescopes to NUMTERMS + 1
+        ratios.push_back(Rational64(i + 2, i + 1));
+    }
+
+    RationalAccumulator64 acc;
+    acc.addBatch(terms.data(), terms.size());
+    Rational64 sum = acc.result();
+    for (int t = 0; t < 5; t++) {
+        ctx.CHECK(parallelSum(terms.data(), terms.size(), THREADS[t]) == sum);
+        ctx.CHECK(parallelProduct(ratios.data(), ratios.size(), THREADS[t]) ==
+                  Rational64(NUMTERMS + 1));
+    }
+    ctx.CHECK(parallelSum(terms.data(), terms.size()) == sum);
+    ctx.CHECK(parallelSum(terms.data(), 10, 4) ==
+              parallelSum(terms.data(), 10, 1));
+    ctx.CHECK(parallelSum(terms.data(), 0) == Rational64());
+    ctx.CHECK(parallelProduct(terms.data(), 0) == Rational64(1));
+
+    ctx.result();
+
+    ctx.DESC("Parallel overflow doesn't depend on the number of threads");
+
+    // Doubling every term overflows int within each chunk
+    vector<Rational> doubles(3 * PARALLEL_CHUNK, Rational(2));
+    for (int t = 0; t < 5; t++) {
+        bool threw = false;
+        try {
+            parallelProduct(doubles.data(), doubles.size(), THREADS[t]);
+        } catch (overflow_error &) {
+            threw = true;
+        }
+        ctx.CHECK(threw);
+    }
+
+    ctx.result();
+}
+
+
+void test_rational_array(TestContext &ctx) {
+    const int NUMPAIRS = 40000;
+
+    ctx.DESC("RationalArray batch operations match Rational's");
+
+    // Operands of every size from 1 to 31 bits, so that some blocks of eight
+    // fit and some fall back.  Pairs whose result overflows are left out,
+    // so each batch runs through.
+    srand(86420L);
+    for (int op = 0; op < 4; op++) {
+        RationalArray a, b;
+        vector<Rational> expect;
+        for (int i = 0; i < NUMPAIRS; i++) {
+            uint32_t bits[4];
+            for (int j = 0; j < 4; j++)
+                bits[j] = ((uint32_t) rand() << 16 ^ rand()) >> (rand() % 31);
+            int32_t n = (int32_t) bits[0], d = 1 + (int32_t) (bits[1] >> 1);
+            int32_t m = (int32_t) bits[2], e = 1 + (int32_t) (bits[3] >> 1);
+            if (i % 7 == 0)
+                e = d;
+            if (i % 11 == 0)
+                n = 0;
+            if (i % 13 == 0)
+                n = INT32_MIN;
+            Rational x(n, d), y(rand() % 2 ? m : -m, e), r;
+            try {
+                switch (op) {
+                case 0: r = x + y; break;
+                case 1: r = x - y; break;
+                case 2: r = x * y; break;
+                default: r = x / y; break;
+                }
+            } catch (exception &) {
+                continue;
+            }
+            a.append(x);
+            b.append(y);
+            expect.push_back(r);
+        }
+
+        RationalArray out;
+        switch (op) {
+        case 0: out.add(a, b); break;
+        case 1: out.sub(a, b); break;
+        case 2: out.mul(a, b); break;
+        default: out.div(a, b); break;
+        }
+        bool same = out.size() == expect.size();
+        for (size_t i = 0; same && i < expect.size(); i++)
+            same = out.get(i) == expect[i];
+        ctx.CHECK(same);
+        ctx.CHECK(expect.size() > NUMPAIRS / 4);
+
+        // Comparisons
+        vector<int> cmp(a.size());
+        RationalArray::compare(a, b, cmp.data());
+        same = true;
+        for (size_t i = 0; same && i < a.size(); i++)
+            same = cmp[i] == a.get(i).compare(b.get(i));
+        ctx.CHECK(same);
+    }
+
+    ctx.result();
+
+    ctx.DESC("RationalArray results may overwrite an operand");
+
+    vector<Rational> values;
+    for (int i = 1; i <= 20; i++)
+        values.push_back(Rational(i, i + 1));
+    RationalArray a(values), b(values);
+    a.mul(a, b);
+    a.div(a, b);
+    a.add(a, a);
+    a.sub(a, b);
+    bool same = a.size() == values.size();
+    for (size_t i = 0; same && i < values.size(); i++)
+        same = a.get(i) == values[i];
+    ctx.CHECK(same);
+    ctx.CHECK(RationalArray(3).get(2) == Rational() && a.nums()[0] == 1);
+
+    ctx.result();
+
+    ctx.DESC("RationalArray batch operations throw as Rational's do");
+
+    RationalArray big(values), zero(values.size());
+    big.set(13, Rational(INT32_MAX));
+    bool threw = false;
+    try {
+        big.add(big, big);
+    } catch (overflow_error &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    threw = false;
+    try {
+        big.div(big, zero);
+    } catch (invalid_argument &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    threw = false;
+    try {
+        big.add(big, RationalArray(3));
+    } catch (invalid_argument &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    threw = false;
+    try {
+        big.get(values.size());
+    } catch (out_of_range &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    ctx.result();
+}
+
+
+/* A table of the first harmonic numbers, built by the compiler. */
+struct HarmonicTable {
+    Rational64 h[16];
+};
+
+constexpr HarmonicTable harmonicTable() {
+    HarmonicTable t;
+    for (int i = 1; i < 16; i++)
+        t.h[i] = t.h[i - 1] + Rational64(1, i);
+    return t;
+}
+
+void test_constexpr(TestContext &ctx) {
+    ctx.DESC("Rational arithmetic in constant expressions");
+
+    constexpr Rational a(6, -8), b(1, 6);
+    static_assert(a.num() == -3 && a.denom() == 4, "constructor reduces");
+    static_assert((a + b).num() == -7 && (a + b).denom() == 12, "+");
+    static_assert(a - b == Rational(-11, 12), "-");
+    static_assert(a * b == Rational(-1, 8), "*");
+    static_assert(a / b == Rational(-9, 2), "/");
+    static_assert(-a == Rational(3, 4) && a.reciprocal() == Rational(-4, 3),
+                  "negation and reciprocal");
+    static_assert(a < b && b > a && a <= a && b >= a && a != b, "compare");
+    static_assert(Rational128(1, 3).compare(Rational128(2, 7)) == 1,
+                  "128-bit compare");
+    static_assert(GCD(84, -36) == 12 && GCD((int128_t) 0, (int128_t) 5) == 5,
+                  "GCD");
+    static_assert((double) Rational(1, 4) == 0.25, "double");
+    ctx.CHECK(a + b == Rational(-7, 12) && a / b == Rational(-9, 2));
+
+    ctx.result();
+
+    ctx.DESC("Ratio tables built at compile time");
+
+    constexpr HarmonicTable table = harmonicTable();
+    static_assert(table.h[4] == Rational64(25, 12), "H4");
+    static_assert(table.h[15] == Rational64(1195757, 360360), "H15");
+
+    Rational64 h;
+    for (int i = 1; i < 16; i++) {
+        h += Rational64(1, i);
+        ctx.CHECK(table.h[i] == h);
+    }
+
+    ctx.result();
+}
+
+
+/* Parses all of s with fromChars, checking that it is consumed. */
+template <typename R>
+bool parses(const string& s, R& r) {
+    FromCharsResult res = fromChars(s.data(), s.data() + s.size(), r);
+    return res.ec == errc() && res.ptr == s.data() + s.size();
+}
+
+/* Formats r with toChars. */
+template <typename R>
+string formatted(const R& r) {
+    char buf[RATIONAL_CHARS_MAX];
+    ToCharsResult res = toChars(buf, buf + sizeof(buf), r);
+    return string(buf, res.ptr);
+}
+
+void test_chars(TestContext &ctx) {
+    const int NUMVALUES = 20000;
+
+    ctx.DESC("fromChars parses fractions, integers and decimals");
+
+    Rational r;
+    ctx.CHECK(parses("-123/456", r) && r == Rational(-41, 152));
+    ctx.CHECK(parses("42", r) && r == Rational(42));
+    ctx.CHECK(parses("-0", r) && r == Rational(0));
+    ctx.CHECK(parses("1.25", r) && r == Rational(5, 4));
+    ctx.CHECK(parses("-.5", r) && r == Rational(-1, 2));
+    ctx.CHECK(parses("3.", r) && r == Rational(3));
+    ctx.CHECK(parses("0.1000000000000000000000000000000", r) &&
+              r == Rational(1, 10));
+    ctx.CHECK(parses("-2147483648", r) && r.num() == INT32_MIN);
+    ctx.CHECK(parses("4294967296/8589934592", r) && r == Rational(1, 2));
+
+    Rational128 big;
+    ctx.CHECK(parses("-170141183460469231731687303715884105728", big));
+    ctx.CHECK(big.num() == RationalTraits<int128_t>::min());
+
+    ctx.result();
+
+    ctx.DESC("fromChars reports errors like std::from_chars");
+
+    const char *bad[] = { "", "-", "/3", "+3", ".", "-.", "x1" };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        r = Rational(7);
+        const char *s = bad[i];
+        FromCharsResult res = fromChars(s, s + strlen(s), r);
+        ctx.CHECK(res.ec == errc::invalid_argument && res.ptr == s);
+        ctx.CHECK(r == Rational(7));
+    }
+
+    const char *zero = "1/0";
+    FromCharsResult res = fromChars(zero, zero + 3, r);
+    ctx.CHECK(res.ec == errc::invalid_argument && res.ptr == zero);
+
+    const char *partial = "3/x";
+    res = fromChars(partial, partial + 3, r);
+    ctx.CHECK(res.ec == errc() && res.ptr == partial + 1 && r == Rational(3));
+
+    const char *wide = "2147483648/3,";
+    res = fromChars(wide, wide + 13, r);
+    ctx.CHECK(res.ec == errc::result_out_of_range && res.ptr == wide + 12);
+    ctx.CHECK(r == Rational(3));
+
+    const char *huge = "99999999999999999999999999999999999999999";
+    res = fromChars(huge, huge + strlen(huge), big);
+    ctx.CHECK(res.ec == errc::result_out_of_range);
+
+    ctx.result();
+
+    ctx.DESC("toChars formats like operator<< and round trips");
+
+    srand(24680L);
+    for (int i = 0; i < NUMVALUES; i++) {
+        Rational64 a(((int64_t) rand() << 32 ^ rand()) - RAND_MAX,
+                     1 + rand() % (i % 2 ? 1 : 100000));
+        ostringstream ss;
+        ss << a;
+        Rational64 b;
+        ctx.CHECK(formatted(a) == ss.str());
+        ctx.CHECK(parses(formatted(a), b) && b == a);
+    }
+    Rational128 least(RationalTraits<int128_t>::min(),
+                      RationalTraits<int128_t>::max());
+    ostringstream ss;
+    ss << least;
+    ctx.CHECK(formatted(least) == ss.str());
+
+    char small[4];
+    ToCharsResult out = toChars(small, small + 4, Rational(-1, 7));
+    ctx.CHECK(out.ec == errc() && string(small, out.ptr) == "-1/7");
+    out = toChars(small, small + 4, Rational(100, 7));
+    ctx.CHECK(out.ec == errc::value_too_large && out.ptr == small + 4);
+
+    ctx.result();
+
+    ctx.DESC("RationalReader parses streams across buffer boundaries");
+
+    // Enough fields to fill several buffers, so that some straddle reads
+    string text;
+    vector<Rational> expected;
+    srand(13579L);
+    while (text.size() < 3 * RationalReader::BUFFER_SIZE) {
+        Rational v(rand() % 200001 - 100000, 1 + rand() % 1000);
+        expected.push_back(v);
+        text += formatted(v) + (rand() % 8 ? "," : ",\r\n");
+    }
+    text += " 1.5 \t-2 ";
+    expected.push_back(Rational(3, 2));
+    expected.push_back(Rational(-2));
+
+    istringstream in(text);
+    RationalReader reader(in);
+    vector<Rational> got(expected.size() + 1);
+    ctx.CHECK(reader.read(got.data(), got.size()) == expected.size());
+    got.pop_back();
+    ctx.CHECK(got == expected && reader.fields() == expected.size());
+    ctx.CHECK(!reader.next(r));
+
+    // A last field longer than the margin kept buffered ends the stream
+    istringstream longLast("1," + string(150, '0') + "7");
+    RationalReader lastReader(longLast);
+    ctx.CHECK(lastReader.next(r) && r == Rational(1));
+    ctx.CHECK(lastReader.next(r) && r == Rational(7));
+    ctx.CHECK(!lastReader.next(r) && !lastReader.next(r));
+    ctx.CHECK(lastReader.fields() == 2);
+
+    ctx.result();
+
+    ctx.DESC("RationalReader throws on malformed and overflowing fields");
+
+    istringstream malformed("1/2, 3/4x, 5");
+    RationalReader badReader(malformed);
+    ctx.CHECK(badReader.next(r) && r == Rational(1, 2));
+    bool threw = false;
+    try {
+        badReader.next(r);
+    } catch (invalid_argument &e) {
+        threw = true;
+    }
+    ctx.CHECK(threw && r == Rational(1, 2) && badReader.fields() == 2);
+
+    istringstream overflowing("1/3 4294967296");
+    RationalReader overReader(overflowing);
+    ctx.CHECK(overReader.next(r));
+    threw = false;
+    try {
+        overReader.next(r);
+    } catch (overflow_error &e) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    ctx.result();
+}
+
+
+/* The fraction with denominator at most maxDenom closest to x, found by
+   trying every denominator and measuring distances exactly. */
+BigRational bruteApproximation(double x, int maxDenom) {
+    BigRational exact = BigRational::fromDoubleExact(x);
+    BigRational best, bestDist;
+    for (int q = 1; q <= maxDenom; q++) {
+        int64_t p = (int64_t) floor(x * q);
+        for (int64_t c = p - 1; c <= p + 1; c++) {
+            BigRational r(c, q);
+            BigRational dist = exact > r ? exact - r : r - exact;
+            if (q == 1 && c == p - 1) {
+                best = r;
+                bestDist = dist;
+            } else if (dist < bestDist) {
+                best = r;
+                bestDist = dist;
+            }
+        }
+    }
+    return best;
+}
+
+/* The text of a rational, to compare values of different widths. */
+template <typename R>
+string text(const R& r) {
+    ostringstream ss;
+    ss << r;
+    return ss.str();
+}
+
+void test_approximate(TestContext &ctx) {
+    const int NUMVALUES = 300;
+    const int NUMBRUTE = 100;
+
+    ctx.DESC("approximate finds the best bounded fraction");
+
+    ctx.CHECK(Rational::approximate(M_PI, 10) == Rational(22, 7));
+    ctx.CHECK(Rational::approximate(M_PI, 100) == Rational(311, 99));
+    ctx.CHECK(Rational::approximate(M_PI, 1000) == Rational(355, 113));
+    ctx.CHECK(Rational::approximate(-M_PI, 1000) == Rational(-355, 113));
+    ctx.CHECK(Rational::approximate(1.0 / 3, 1000000) == Rational(1, 3));
+    ctx.CHECK(Rational::approximate(0.0, 7) == Rational(0));
+    ctx.CHECK(Rational::approximate(42.0, 7) == Rational(42));
+    ctx.CHECK(Rational64::approximate(0.1, INT64_MAX) ==
+              Rational64::fromDoubleExact(0.1));
+
+    srand(97531L);
+    for (int i = 0; i < NUMBRUTE; i++) {
+        double x = (rand() - RAND_MAX / 2) / (double) (RAND_MAX / 20);
+        int maxDenom = 1 + rand() % 300;
+        ctx.CHECK(text(Rational::approximate(x, maxDenom)) ==
+                  text(bruteApproximation(x, maxDenom)));
+    }
+
+    ctx.result();
+
+    ctx.DESC("approximate agrees across integer widths");
+
+    // Wide exponents take the 128-bit and BigInt continued fractions
+    for (int i = 0; i < NUMVALUES; i++) {
+        double x = ldexp(rand() - RAND_MAX / 2.0, -(rand() % 300));
+        int64_t maxDenom = 1 + ((int64_t) rand() << (rand() % 32));
+        int128_t maxDenom128 = (int128_t) maxDenom << (rand() % 64);
+        BigInt bigDenom = BigInt(maxDenom128 >> 64) * BigInt(1LL << 32) *
+                          BigInt(1LL << 32) + BigInt((int64_t) (uint32_t)
+                          (maxDenom128 >> 32)) * BigInt(1LL << 32) +
+                          BigInt((int64_t) (uint32_t) maxDenom128);
+        ctx.CHECK(text(Rational64::approximate(x, maxDenom)) ==
+                  text(BigRational::approximate(x, BigInt(maxDenom))));
+        ctx.CHECK(text(Rational128::approximate(x, maxDenom128)) ==
+                  text(BigRational::approximate(x, bigDenom)));
+    }
+
+    vector<double> xs;
+    for (int i = 0; i < NUMVALUES; i++)
+        xs.push_back((rand() - RAND_MAX / 2) / (double) RAND_MAX);
+    vector<Rational> batch(xs.size());
+    Rational::approximate(xs.data(), xs.size(), 1000, batch.data());
+    for (size_t i = 0; i < xs.size(); i++)
+        ctx.CHECK(batch[i] == Rational::approximate(xs[i], 1000));
+
+    ctx.result();
+
+    ctx.DESC("fromDoubleExact converts exactly");
+
+    ctx.CHECK(Rational::fromDoubleExact(0.75) == Rational(3, 4));
+    ctx.CHECK(Rational::fromDoubleExact(-0.0) == Rational(0));
+    ctx.CHECK(Rational::fromDoubleExact(-1e9) == Rational(-1000000000));
+    ctx.CHECK(Rational64::fromDoubleExact(0.1) ==
+              Rational64(3602879701896397LL, 36028797018963968LL));
+    ctx.CHECK((double) BigRational::fromDoubleExact(1e300) == 1e300);
+    ctx.CHECK((double) BigRational::fromDoubleExact(5e-324) == 5e-324);
+    ctx.CHECK((double) Rational128::fromDoubleExact(1e-20) == 1e-20);
+
+    ctx.result();
+
+    ctx.DESC("Conversions from double throw on bad input");
+
+    int threw = 0;
+    try { Rational::fromDoubleExact(0.1); }
+    catch (overflow_error &e) { threw++; }
+    try { Rational::fromDoubleExact(NAN); }
+    catch (invalid_argument &e) { threw++; }
+    try { Rational::approximate(3e9, 10); }
+    catch (overflow_error &e) { threw++; }
+    try { Rational::approximate(INFINITY, 10); }
+    catch (invalid_argument &e) { threw++; }
+    try { Rational::approximate(0.5, 0); }
+    catch (invalid_argument &e) { threw++; }
+    ctx.CHECK(threw == 5);
+
+    ctx.result();
+}
+
+
+/* Determinant by Gaussian elimination with BigRational row operations. */
+BigRational gaussDeterminant(vector<vector<BigRational> > a) {
+    size_t n = a.size();
+    BigRational det(1);
+    for (size_t c = 0; c < n; c++) {
+        size_t p = c;
+        while (p < n && a[p][c] == BigRational())
+            p++;
+        if (p == n)
+            return BigRational();
+        if (p != c) {
+            swap(a[p], a[c]);
+            det = -det;
+        }
+        det *= a[c][c];
+        for (size_t i = c + 1; i < n; i++) {
+            BigRational f = a[i][c] / a[c][c];
+            for (size_t j = c; j < n; j++)
+                a[i][j] -= f * a[c][j];
+        }
+    }
+    return det;
+}
+
+/* Random n x m matrix of fractions with small parts. */
+BigRationalMatrix randomMatrix(size_t n, size_t m) {
+    BigRationalMatrix a(n, m);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < m; j++)
+            a.set(i, j, BigRational(rand() % 19 - 9, 1 + rand() % 6));
+    return a;
+}
+
+void test_matrix(TestContext &ctx) {
+    const int NUMMATRICES = 20;
+
+    ctx.DESC("Determinants and inverses of Hilbert matrices");
+
+    // H_ij = 1 / (i + j + 1) has det H_5 = 1 / 266716800000 and an
+    // inverse of integers
+    RationalMatrix64 h(5, 5);
+    for (size_t i = 0; i < 5; i++)
+        for (size_t j = 0; j < 5; j++)
+            h.set(i, j, Rational64(1, i + j + 1));
+    ctx.CHECK(h.determinant() == Rational64(1, 266716800000LL));
+    RationalMatrix64 hinv = h.inverse();
+    ctx.CHECK(h * hinv == RationalMatrix64::identity(5));
+    ctx.CHECK(hinv.get(3, 3) == Rational64(179200));
+    ctx.CHECK(hinv.get(0, 4) == Rational64(630));
+
+    BigRationalMatrix big(12, 12);
+    for (size_t i = 0; i < 12; i++)
+        for (size_t j = 0; j < 12; j++)
+            big.set(i, j, BigRational(1, i + j + 1));
+    ctx.CHECK(big * big.inverse() == BigRationalMatrix::identity(12));
+
+    ctx.result();
+
+    ctx.DESC("Determinants match Gaussian elimination");
+
+    srand(86420L);
+    for (int t = 0; t < NUMMATRICES; t++) {
+        size_t n = 1 + t % 8;
+        BigRationalMatrix a = randomMatrix(n, n);
+        vector<vector<BigRational> > rows(n, vector<BigRational>(n));
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                rows[i][j] = a.get(i, j);
+        ctx.CHECK(a.determinant() == gaussDeterminant(rows));
+    }
+
+    RationalMatrix swapped(2, 2);
+    swapped.set(0, 1, Rational(2));
+    swapped.set(1, 0, Rational(3, 4));
+    ctx.CHECK(swapped.determinant() == Rational(-3, 2));
+    ctx.CHECK(RationalMatrix().determinant() == Rational(1));
+
+    ctx.result();
+
+    ctx.DESC("Rank counts independent rows");
+
+    RationalMatrix r(3, 5);
+    for (size_t j = 0; j < 5; j++) {
+        r.set(0, j, Rational(j + 1, 2));
+        r.set(2, j, Rational(3 * (int) j + 3, 4));
+    }
+    ctx.CHECK(r.rank() == 1);
+    r.set(1, 3, Rational(1));
+    ctx.CHECK(r.rank() == 2);
+    ctx.CHECK(RationalMatrix(4, 4).rank() == 0);
+    ctx.CHECK(RationalMatrix::identity(6).rank() == 6);
+
+    ctx.result();
+
+    ctx.DESC("solve finds exact solutions on any number of threads");
+
+    for (int t = 0; t < NUMMATRICES; t++) {
+        size_t n = 2 + t % 10;
+        BigRationalMatrix a = randomMatrix(n, n), b = randomMatrix(n, 3);
+        if (a.determinant() == BigRational())
+            continue;
+        BigRationalMatrix x = a.solve(b, 1);
+        ctx.CHECK(a * x == b);
+        ctx.CHECK(a.solve(b, 4) == x);
+    }
+
+    // Large enough that the row updates are split across threads
+    BigRationalMatrix large = randomMatrix(72, 72);
+    ctx.CHECK(large.determinant(4) == large.determinant(1));
+    ctx.CHECK(large.rank(3) == large.rank(1));
+
+    ctx.result();
+
+    ctx.DESC("Matrix errors throw");
+
+    int threw = 0;
+    RationalMatrix singular(2, 2);
+    singular.set(0, 0, Rational(1));
+    singular.set(1, 0, Rational(2));
+    try { singular.inverse(); }
+    catch (invalid_argument &e) { threw++; }
+    try { RationalMatrix(2, 3).determinant(); }
+    catch (invalid_argument &e) { threw++; }
+    try { RationalMatrix(2, 2).solve(RationalMatrix(3, 1)); }
+    catch (invalid_argument &e) { threw++; }
+    try { singular.get(2, 0); }
+    catch (out_of_range &e) { threw++; }
+
+    // The entries of the 10 x 10 Hilbert matrix scaled to integers
+    // overflow 32 bits
+    RationalMatrix h32(10, 10);
+    for (size_t i = 0; i < 10; i++)
+        for (size_t j = 0; j < 10; j++)
+            h32.set(i, j, Rational(1, i + j + 1));
+    try { h32.determinant(); }
+    catch (overflow_error &e) { threw++; }
+    ctx.CHECK(threw == 5);
+
+    ctx.result();
+}
+
+
+/* Builds a matrix from rows of integers over a common denominator. */
+template <typename Matrix>
+Matrix lpMatrix(size_t m, size_t n, const int *entries, int denom = 1) {
+    Matrix a(m, n);
+    for (size_t i = 0; i < m; i++)
+        for (size_t j = 0; j < n; j++)
+            a.set(i, j, typename Matrix::Value(entries[i * n + j], denom));
+    return a;
+}
+
+/* Checks x and y certify each other: both feasible with equal objectives. */
+bool lpCertified(const BigRationalMatrix &a, const vector<BigRational> &b,
+                 const vector<BigRational> &c, const BigLinearProgram &lp) {
+    const vector<BigRational> &x = lp.solution(), &y = lp.duals();
+    BigRational cx, by;
+    for (size_t i = 0; i < a.rows(); i++) {
+        BigRational ax;
+        for (size_t j = 0; j < a.cols(); j++)
+            ax += a.get(i, j) * x[j];
+        if (ax > b[i] || y[i] < BigRational())
+            return false;
+        by += b[i] * y[i];
+    }
+    for (size_t j = 0; j < a.cols(); j++) {
+        BigRational aty;
+        for (size_t i = 0; i < a.rows(); i++)
+            aty += a.get(i, j) * y[i];
+        if (aty < c[j] || x[j] < BigRational())
+            return false;
+        cx += c[j] * x[j];
+    }
+    return cx == by && cx == lp.objective();
+}
+
+void test_linear_program(TestContext &ctx) {
+    const int NUMPROGRAMS = 40;
+
+    ctx.DESC("Linear programs with known optima");
+
+    // max 3x + 5y with x <= 4, 2y <= 12, 3x + 2y <= 18
+    const int a1[] = { 1, 0, 0, 2, 3, 2 };
+    LinearProgram lp1(lpMatrix<RationalMatrix>(3, 2, a1),
+                      { Rational(4), Rational(12), Rational(18) },
+                      { Rational(3), Rational(5) });
+    ctx.CHECK(lp1.solve() == LPStatus::Optimal);
+    ctx.CHECK(lp1.objective() == Rational(36));
+    ctx.CHECK(lp1.solution() == vector<Rational>({ Rational(2), Rational(6) }));
+    ctx.CHECK(lp1.duals() ==
+              vector<Rational>({ Rational(), Rational(3, 2), Rational(1) }));
+
+    // max -x - 2y with x + y >= 2, which the slack basis doesn't satisfy
+    const int a2[] = { -1, -1, 1, 0, 0, 1 };
+    LinearProgram64 lp2(lpMatrix<RationalMatrix64>(3, 2, a2),
+                        { Rational64(-2), Rational64(5), Rational64(5) },
+                        { Rational64(-1), Rational64(-2) });
+    ctx.CHECK(lp2.solve() == LPStatus::Optimal);
+    ctx.CHECK(lp2.objective() == Rational64(-2));
+    ctx.CHECK(lp2.solution()[0] == Rational64(2));
+
+    // Beale's example, on which Dantzig's rule cycles without a tolerance
+    const int a3[] = { 25, -6000, -4, 900, 50, -9000, -2, 300, 0, 0, 100, 0 };
+    LinearProgram64 lp3(lpMatrix<RationalMatrix64>(3, 4, a3, 100),
+                        { Rational64(), Rational64(), Rational64(1) },
+                        { Rational64(3, 4), Rational64(-150), Rational64(1, 50),
+                          Rational64(-6) });
+    ctx.CHECK(lp3.solve() == LPStatus::Optimal);
+    ctx.CHECK(lp3.objective() == Rational64(1, 20));
+
+    ctx.result();
+
+    ctx.DESC("Infeasible and unbounded programs are recognized");
+
+    const int a4[] = { 1, 1, -1, -1 };
+    LinearProgram lp4(lpMatrix<RationalMatrix>(2, 2, a4),
+                      { Rational(1), Rational(-3) },
+                      { Rational(1), Rational(1) });
+    ctx.CHECK(lp4.solve() == LPStatus::Infeasible);
+    ctx.CHECK(lp4.solution().empty());
+
+    const int a5[] = { -1, 1 };
+    LinearProgram lp5(lpMatrix<RationalMatrix>(1, 2, a5), { Rational(1) },
+                      { Rational(1), Rational() });
+    ctx.CHECK(lp5.solve() == LPStatus::Unbounded);
+
+    LinearProgram lp6(RationalMatrix(0, 1), {}, { Rational(-1) });
+    ctx.CHECK(lp6.solve() == LPStatus::Optimal);
+    ctx.CHECK(lp6.objective() == Rational());
+
+    ctx.result();
+
+    ctx.DESC("Bounds doubles can't tell apart are honored exactly");
+
+    // 1 + 2e-20 <= x <= 1 + 1e-20 has no solution, but in doubles both
+    // bounds are 1
+    BigInt e20 = 1;
+    for (int i = 0; i < 20; i++)
+        e20 *= 10;
+    BigRational lo(e20 + 2, e20), hi(e20 + 1, e20);
+    const int a7[] = { -1, 1 };
+    BigLinearProgram lp7(lpMatrix<BigRationalMatrix>(2, 1, a7), { -lo, hi },
+                         { BigRational(1) });
+    ctx.CHECK(lp7.solve() == LPStatus::Infeasible);
+
+    BigLinearProgram lp8(lpMatrix<BigRationalMatrix>(2, 1, a7), { -hi, lo },
+                         { BigRational(1) });
+    ctx.CHECK(lp8.solve() == LPStatus::Optimal);
+    ctx.CHECK(lp8.objective() == lo);
+
+    ctx.result();
+
+    ctx.DESC("Random programs are optimal with matching duals");
+
+    srand(97531L);
+    int optimal = 0;
+    for (int t = 0; t < NUMPROGRAMS; t++) {
+        size_t m = 1 + rand() % 12, n = 1 + rand() % 12;
+        BigRationalMatrix a(m, n);
+        vector<BigRational> b(m), c(n);
+        for (size_t i = 0; i < m; i++) {
+            for (size_t j = 0; j < n; j++)
+                if (rand() % 3)
+                    a.set(i, j, BigRational(rand() % 21 - 5, 1 + rand() % 4));
+            b[i] = BigRational(rand() % 40 - 8, 1 + rand() % 3);
+        }
+        for (size_t j = 0; j < n; j++)
+            c[j] = BigRational(rand() % 11 - 3, 1 + rand() % 5);
+
+        BigLinearProgram lp(a, b, c);
+        LPStatus status = lp.solve(1);
+        if (status == LPStatus::Optimal) {
+            optimal++;
+            ctx.CHECK(lpCertified(a, b, c, lp));
+        }
+
+        BigLinearProgram threaded(a, b, c);
+        ctx.CHECK(threaded.solve(4) == status);
+        ctx.CHECK(threaded.solution() == lp.solution());
+    }
+    ctx.CHECK(optimal > NUMPROGRAMS / 4);
+
+    ctx.result();
+
+    ctx.DESC("Linear program errors throw");
+
+    int threw = 0;
+    try { LinearProgram lp(RationalMatrix(2, 2), { Rational() }, {}); }
+    catch (invalid_argument &e) { threw++; }
+    ctx.CHECK(threw == 1);
+
+    ctx.result();
+}
+
+
+void test_safe_rational(TestContext &ctx) {
+    const int NUMPAIRS = 20000;
+    const int NUMCHAINS = 2000;
+
+    ctx.DESC("SafeRational matches Rational64 without promoting");
+
+    srand(13579L);
+    for (int i = 0; i < NUMPAIRS; i++) {
+        int64_t a = rand() % 20001 - 10000, b = 1 + rand() % 10000;
+        int64_t c = rand() % 20001 - 10000, d = 1 + rand() % 10000;
+        SafeRational x(a, b), y(c, d);
+        Rational64 u(a, b), v(c, d);
+        ctx.CHECK(x + y == SafeRational((u + v).num(), (u + v).denom()));
+        ctx.CHECK(x - y == SafeRational((u - v).num(), (u - v).denom()));
+        ctx.CHECK(x * y == SafeRational((u * v).num(), (u * v).denom()));
+        if (c != 0)
+            ctx.CHECK(x / y ==
+                      SafeRational((u / v).num(), (u / v).denom()));
+        ctx.CHECK(x.compare(y) == u.compare(v));
+        ctx.CHECK(!(x * y).promoted());
+    }
+
+    ctx.result();
+
+    ctx.DESC("SafeRational promotes on overflow and demotes after");
+
+    SafeRational big(INT64_MAX);
+    ctx.CHECK(!big.promoted());
+    big += SafeRational(1);
+    ctx.CHECK(big.promoted());
+    ctx.CHECK(big.toBig() == BigRational(INT64_MAX) + BigRational(1));
+    ctx.CHECK(big > SafeRational(INT64_MAX));
+    big -= SafeRational(2);
+    ctx.CHECK(!big.promoted());
+    ctx.CHECK(big == SafeRational(INT64_MAX - 1));
+
+    SafeRational p(1, 3);
+    for (int i = 0; i < 4; i++)
+        p *= SafeRational(1, 1 << 30);
+    ctx.CHECK(p.promoted());
+    ctx.CHECK(p.denom() == BigInt(3) * BigInt((int64_t) 1 << 60) *
+                           BigInt((int64_t) 1 << 60));
+    for (int i = 0; i < 4; i++)
+        p /= SafeRational(1, 1 << 30);
+    ctx.CHECK(!p.promoted());
+    ctx.CHECK(p == SafeRational(1, 3));
+
+    // INT64_MIN is kept promoted so that inline values negate safely
+    SafeRational low(INT64_MIN);
+    ctx.CHECK(low.promoted());
+    ctx.CHECK(-low == SafeRational(INT64_MAX) + SafeRational(1));
+    ctx.CHECK(-SafeRational(INT64_MAX) > low);
+    ctx.CHECK(SafeRational(INT64_MIN, -2) == SafeRational((int64_t) 1 << 62));
+    ctx.CHECK(!SafeRational(INT64_MIN, -2).promoted());
+
+    ctx.result();
+
+    ctx.DESC("SafeRational chains stay exact across promotions");
+
+    bool exact = true;
+    for (int t = 0; t < NUMCHAINS; t++) {
+        SafeRational x(rand() % 1001 - 500, 1 + rand() % 1000);
+        BigRational ref = x.toBig();
+        for (int i = 0; i < 12; i++) {
+            int64_t n = (int64_t) rand() * rand() - (int64_t) RAND_MAX;
+            int64_t d = 1 + (int64_t) rand() * (rand() % 64);
+            SafeRational y(n, d);
+            BigRational z = y.toBig();
+            switch (rand() % 4) {
+            case 0:     x += y; ref += z; break;
+            case 1:     x -= y; ref -= z; break;
+            case 2:     x *= y; ref *= z; break;
+            default:
+                if (n != 0) {
+                    x /= y;
+                    ref /= z;
+                }
+            }
+            bool fits = ref.num().isSmall() && ref.denom().isSmall() &&
+                        ref.num() != BigInt(INT64_MIN);
+            exact &= x.toBig() == ref && x.promoted() == !fits;
+        }
+        ctx.CHECK((double) x == (double) ref);
+    }
+    ctx.CHECK(exact);
+
+    ctx.result();
+
+    ctx.DESC("SafeRational errors throw");
+
+    int threw = 0;
+    try { SafeRational(1, 0); }
+    catch (invalid_argument &e) { threw++; }
+    try { SafeRational(1) / SafeRational(); }
+    catch (invalid_argument &e) { threw++; }
+    try { SafeRational(INT64_MIN) / SafeRational(); }
+    catch (invalid_argument &e) { threw++; }
+    ctx.CHECK(threw == 3);
+
+    ostringstream os;
+    os << SafeRational(-6, 4) << " " << SafeRational(INT64_MIN) << " "
+       << SafeRational(5);
+    ctx.CHECK(os.str() == "-3/2 -9223372036854775808 5");
+
+    ctx.result();
+}
+
+
+void test_hash(TestContext &ctx) {
+    const int NUMVALUES = 200000;
+
+    ctx.DESC("Rationals are kept in canonical form");
+
+    ctx.CHECK(Rational(2, -4).num() == -1 && Rational(2, -4).denom() == 2);
+    ctx.CHECK(Rational(0, -5).num() == 0 && Rational(0, -5).denom() == 1);
+    Rational half(1, 2);
+    ctx.CHECK((half + half).denom() == 1 && (half - half).denom() == 1);
+    ctx.CHECK((Rational(3, 4) * Rational(4, 3)).num() == 1);
+    ctx.CHECK((Rational(-3, 4) / Rational(-3, 8)).num() == 2);
+    ctx.CHECK(BigRational(BigInt(6), BigInt(-4)).denom() == BigInt(2));
+
+    ctx.result();
+
+    ctx.DESC("Equal values hash the same");
+
+    constexpr size_t h = Rational(2, 4).hash();
+    ctx.CHECK(h == Rational(1, 2).hash());
+    ctx.CHECK(h == hash<Rational>()(Rational(-3, -6)));
+    ctx.CHECK(h == Rational64(1, 2).hash());
+    ctx.CHECK(h == Rational128(1, 2).hash());
+    ctx.CHECK(h == BigRational(1, 2).hash());
+    ctx.CHECK(h == hash<SafeRational>()(SafeRational(5, 10)));
+    ctx.CHECK(Rational(1, 2).hash() != Rational(-1, 2).hash());
+    ctx.CHECK(Rational(1, 2).hash() != Rational(2, 1).hash());
+
+    // Promoted SafeRationals hash as the BigRational they hold
+    SafeRational s(INT64_MAX);
+    s *= SafeRational(3);
+    BigRational b = BigRational(INT64_MAX) * BigRational(3);
+    ctx.CHECK(s.promoted() && s.hash() == b.hash());
+    ctx.CHECK(b.hash() != (b + BigRational(1)).hash());
+    ctx.CHECK(b.hash() != (-b).hash());
+
+    ctx.result();
+
+    ctx.DESC("Hashes of nearby fractions spread over all bits");
+
+    // Every reduced n/d with |n|, d <= 200 has a distinct hash, and each
+    // 12-bit slice of the hashes fills its buckets evenly
+    vector<size_t> hashes;
+    for (int n = -200; n <= 200; n++)
+        for (int d = 1; d <= 200; d++)
+            if (GCD(n, d) == 1)
+                hashes.push_back(Rational(n, d).hash());
+    vector<size_t> sorted(hashes);
+    sort(sorted.begin(), sorted.end());
+    ctx.CHECK(adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+
+    double mean = hashes.size() / 4096.0;
+    for (int shift = 0; shift <= 52; shift += 13) {
+        vector<int> buckets(4096);
+        for (size_t i = 0; i < hashes.size(); i++)
+            buckets[(hashes[i] >> shift) & 4095]++;
+        double chi2 = 0;
+        for (int i = 0; i < 4096; i++)
+            chi2 += (buckets[i] - mean) * (buckets[i] - mean) / mean;
+        ctx.CHECK(chi2 < 4096 + 6 * sqrt(2 * 4096.0));
+    }
+
+    ctx.result();
+
+    ctx.DESC("Rationals key hash sets");
+
+    srand(24680L);
+    vector<Rational64> values;
+    for (int i = 0; i < NUMVALUES; i++)
+        values.push_back(Rational64(rand() % 401 - 200, 1 + rand() % 200));
+    unordered_set<Rational64> distinct(values.begin(), values.end());
+    sort(values.begin(), values.end());
+    size_t unique = std::unique(values.begin(), values.end()) - values.begin();
+    ctx.CHECK(distinct.size() == unique);
+    for (size_t i = 0; i < unique; i++)
+        ctx.CHECK(distinct.count(values[i]) == 1);
+
+    unordered_set<BigRational> bigs;
+    for (size_t i = 0; i < unique; i++)
+        bigs.insert(BigRational(values[i].num(), values[i].denom()));
+    ctx.CHECK(bigs.size() == unique);
+    ctx.CHECK(bigs.count(BigRational(1, 3)) == 1);
+
+    ctx.result();
+}
+
+
+/* Checks every integer operator on r and n against the same operation with
+   n as an R, which are done the general way. */
+template <typename R>
+bool agreesWithInt(const R& r, int n) {
+    R rn(n);
+    bool ok = r + n == r + rn && n + r == rn + r &&
+              r - n == r - rn && n - r == rn - r &&
+              r * n == r * rn && n * r == rn * r &&
+              (r < n) == (r < rn) && (n < r) == (rn < r) &&
+              (r <= n) == (r <= rn) && (n >= r) == (rn >= r) &&
+              (r == n) == (r == rn) && (n != r) == (rn != r);
+    if (n != 0)
+        ok = ok && r / n == r / rn;
+    if (r != 0)
+        ok = ok && n / r == rn / r;
+
+    R c(r);
+    c += n;
+    c -= 2 * n;
+    c *= n;
+    ok = ok && c == (r - rn) * rn;
+    return ok;
+}
+
+void test_int_operands(TestContext &ctx) {
+    const int NUMVALUES = 20000;
+
+    ctx.DESC("Integers work on either side of a Rational");
+
+    Rational half(1, 2);
+    ctx.CHECK(2 * half == 1 && half * 2 == Rational(1));
+    ctx.CHECK(1 - half == half && half + 1 == Rational(3, 2));
+    ctx.CHECK(3 / half == 6 && half / 3 == Rational(1, 6));
+    ctx.CHECK(-2 / Rational(-4, 3) == Rational(3, 2));
+    ctx.CHECK(Rational(3, 4) / -6 == Rational(-1, 8));
+    ctx.CHECK(Rational(4, 9) * 6 == Rational(8, 3));
+    ctx.CHECK(half < 1 && 0 < half && half > -1 && 1 >= half);
+    ctx.CHECK(Rational(4, 2) == 2 && 2 == Rational(4, 2) && half != 0);
+    ctx.CHECK(half * 0 == 0 && 0 / half == 0);
+    ctx.CHECK(BigRational(1, 3) * 3 == 1 && 1 - BigRational(1, 3) > 0);
+    ctx.CHECK(Rational64(5, 7) * 7L == 5 && Rational128(5, 7) - 1 < 0);
+
+    constexpr Rational c = 3 * Rational(1, 6) + 1;
+    static_assert(c == Rational(3, 2), "Integer operands are constexpr");
+    ctx.CHECK(c > 1);
+
+    Rational r(5, 3);
+    r += 1;
+    r *= 3;
+    r -= 2;
+    r /= 4;
+    ctx.CHECK(r == Rational(3, 2));
+    ctx.CHECK(++r == Rational(5, 2) && --r == half + 1);
+    ctx.CHECK((r++).denom() == 2 && r == Rational(5, 2));
+    ctx.CHECK(r-- == Rational(5, 2) && r.num() == 3);
+
+    ctx.result();
+
+    ctx.DESC("Integer operands agree with Rational operands");
+
+    srand(13579L);
+    bool ok = true;
+    for (int i = 0; i < NUMVALUES; i++) {
+        int a = rand() % 20001 - 10000, b = 1 + rand() % 10000;
+        int n = rand() % 201 - 100;
+        ok = ok && agreesWithInt(Rational(a, b), n) &&
+             agreesWithInt(Rational64(a, b), n) &&
+             agreesWithInt(Rational128(a, b), n) &&
+             agreesWithInt(BigRational(a, b), n);
+    }
+    ctx.CHECK(ok);
+
+    ctx.result();
+
+    ctx.DESC("Integer operands throw on overflow and division by zero");
+
+    bool threw = false;
+    try {
+        Rational(INT32_MAX) + 1;
+    } catch (overflow_error &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    threw = false;
+    try {
+        Rational(1, 3) * (INT64_C(1) << 40);
+    } catch (overflow_error &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    threw = false;
+    try {
+        Rational64 max(INT64_MAX);
+        ++max;
+    } catch (overflow_error &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    threw = false;
+    try {
+        Rational(1, 3) / 0;
+    } catch (invalid_argument &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    threw = false;
+    try {
+        1 / Rational(0);
+    } catch (invalid_argument &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    // Extremes that fit still come out exact
+    ctx.CHECK(Rational(INT32_MIN) / INT32_MIN == 1);
+    ctx.CHECK(INT32_MIN / Rational(INT32_MIN, 3) == 3);
+    ctx.CHECK(Rational(INT32_MAX - 1, INT32_MAX) - 1 ==
+              Rational(-1, INT32_MAX));
+    ctx.CHECK(Rational(INT32_MIN + 1) - 1 == INT32_MIN);
+
+    ctx.result();
+
+    ctx.DESC("Integer operands wider than the Rational's type are exact");
+
+    // Results that fit are exact whatever the width of the operand
+    ctx.CHECK(Rational(INT32_MIN) + INT64_C(4000000000) == 1852516352);
+    ctx.CHECK(INT64_C(4000000000) - Rational(INT32_MAX) == 1852516353);
+    ctx.CHECK(Rational(1, 1 << 20) * (INT64_C(1) << 40) == 1 << 20);
+    ctx.CHECK((INT64_C(1) << 40) / Rational(1 << 30) == 1 << 10);
+    ctx.CHECK(Rational(1 << 30) / (INT64_C(1) << 40) ==
+              Rational(1, 1 << 10));
+    ctx.CHECK(Rational(0) * UINT64_MAX == 0 && Rational(0) / UINT64_MAX == 0);
+    ctx.CHECK(Rational64(1, 3) * UINT64_MAX == INT64_C(6148914691236517205));
+    ctx.CHECK(BigRational(1, 3) * UINT64_MAX ==
+              BigRational(6148914691236517205LL));
+    Rational w(INT32_MIN);
+    w += INT64_C(4000000000);
+    w -= INT64_C(3000000000);
+    ctx.CHECK(w == -1147483648);
+    Rational q(3, 1 << 30);
+    q *= INT64_C(1) << 32;
+    q /= INT64_C(6000000000);
+    ctx.CHECK(q == Rational(1, 500000000));
+
+    // Comparisons never throw, however wide the operand
+    ctx.CHECK(Rational(1, 2) < (INT64_C(1) << 40));
+    ctx.CHECK(!(Rational(5) == INT64_C(4000000000)));
+    ctx.CHECK(Rational(5) != INT64_C(4000000000));
+    ctx.CHECK(Rational(INT32_MIN) > INT64_MIN && UINT64_MAX > Rational(7));
+    ctx.CHECK(Rational(INT32_MAX) <= UINT64_MAX && INT64_MIN <= Rational(0));
+    ctx.CHECK(Rational64(INT64_MAX) < UINT64_MAX);
+    ctx.CHECK(BigRational(1, 2) < UINT64_MAX && UINT64_MAX >= BigRational(3));
+    ctx.CHECK(Rational64(-1) == -1 && Rational(-1) != UINT64_MAX);
+
+    ctx.result();
+}
+
+
+/* A polynomial of the given degree with random small fractions for
+   coefficients. */
+template <typename P>
+P randomPolynomial(size_t degree) {
+    typedef typename P::Value V;
+    vector<V> c;
+    for (size_t i = 0; i <= degree; i++)
+        c.push_back(V(rand() % 41 - 20, 1 + rand() % 12));
+    if (c.back() == 0)
+        c.back() = V(1);
+    return P(c);
+}
+
+/* A BigRationalPolynomial with integer coefficients, constant term first. */
+BigRationalPolynomial bigPoly(const vector<int>& c) {
+    vector<BigRational> coeffs;
+    for (size_t i = 0; i < c.size(); i++)
+        coeffs.push_back(BigRational(c[i]));
+    return BigRationalPolynomial(coeffs);
+}
+
+/* Horner's rule on the coefficients, reducing every step. */
+template <typename P>
+typename P::Value naiveEvaluate(const P& p, const typename P::Value& x) {
+    typename P::Value r;
+    for (size_t i = p.coefficients().size(); i-- > 0;)
+        r = r * x + p.coefficients()[i];
+    return r;
+}
+
+/* Product of the coefficients pairwise. */
+template <typename P>
+P naiveProduct(const P& a, const P& b) {
+    vector<typename P::Value> c(a.coefficients().size() +
+                                b.coefficients().size());
+    for (size_t i = 0; i < a.coefficients().size(); i++)
+        for (size_t j = 0; j < b.coefficients().size(); j++)
+            c[i + j] += a.coefficients()[i] * b.coefficients()[j];
+    return P(c);
+}
+
+/* Evaluation, products and division agree with the naive versions. */
+template <typename P>
+bool polynomialsAgree(size_t degree, int maxNum, int maxDenom) {
+    typedef typename P::Value V;
+    P a = randomPolynomial<P>(degree), b = randomPolynomial<P>(degree / 2);
+    bool ok = a * b == naiveProduct(a, b) && b * a == a * b;
+    for (int i = 0; i < 20; i++) {
+        V x(rand() % (2 * maxNum + 1) - maxNum, 1 + rand() % maxDenom);
+        ok = ok && a(x) == naiveEvaluate(a, x);
+    }
+
+    P q, r;
+    a.divide(b, &q, &r);
+    return ok && q * b + r == a && r.degree() < b.degree() &&
+           q == a / b && r == a % b;
+}
+
+void test_polynomial(TestContext &ctx) {
+    const int NUMPOLYS = 20;
+    const size_t NUMPOINTS = 2000;
+
+    typedef BigRationalPolynomial BP;
+    typedef BigRational BR;
+
+    ctx.DESC("Polynomials are trimmed and evaluated exactly");
+
+    RationalPolynomial p(vector<Rational>{ -2, 0, 1, 0 });     // x^2 - 2
+    ctx.CHECK(p.degree() == 2 && p.leading() == 1);
+    ctx.CHECK(p.coefficient(0) == -2 && p.coefficient(7) == 0);
+    ctx.CHECK(p(Rational(3, 2)) == Rational(1, 4));
+    ctx.CHECK(p.evaluate(Rational(-7)) == Rational(47));
+    ctx.CHECK(RationalPolynomial().degree() == -1);
+    ctx.CHECK(RationalPolynomial(Rational(0)).degree() == -1);
+    ctx.CHECK(RationalPolynomial().evaluate(Rational(5)) == 0);
+    ctx.CHECK(RationalPolynomial::monomial(Rational(3), 4)(Rational(1, 2)) ==
+              Rational(3, 16));
+    ctx.CHECK(p.derivative() == RationalPolynomial::monomial(Rational(2), 1));
+    ctx.CHECK(RationalPolynomial(Rational(5)).derivative().degree() == -1);
+
+    // Past what int64 Horner sums hold, the reduced path still gets values
+    // that fit
+    RationalPolynomial64 c(vector<Rational64>{ 0, 0, 0, 0, 0, 0, 1 });
+    Rational64 x(1LL << 10, (1LL << 10) + 1);
+    ctx.CHECK(c(x) == naiveEvaluate(c, x));
+    ctx.CHECK(c(Rational64(1, 1LL << 10)) == Rational64(1, 1LL << 60));
+
+    ctx.result();
+
+    ctx.DESC("Polynomial products, quotients and values agree with naive ones");
+
+    srand(97531L);
+    bool ok = true;
+    for (int t = 0; t < NUMPOLYS; t++) {
+        ok = ok && polynomialsAgree<RationalPolynomial64>(4, 20, 10);
+        ok = ok && polynomialsAgree<RationalPolynomial128>(6, 100, 100);
+        ok = ok && polynomialsAgree<BP>(10 + 5 * t, 1000, 1000);
+    }
+    ctx.CHECK(ok);
+
+    // (x + 1)(x - 1) and a Karatsuba sized (1 + x)^100 against binomials
+    BP xp = bigPoly({ 1, 1 }), xm = bigPoly({ -1, 1 });
+    ctx.CHECK(xp * xm == bigPoly({ -1, 0, 1 }));
+    BP pow(BR(1));
+    for (int i = 0; i < 100; i++)
+        pow = pow * xp;
+    BP pow2 = pow * pow;
+    BigInt binom(1);
+    for (int k = 0; k <= 200; k++) {
+        ok = ok && pow2.coefficient(k) == BR(binom);
+        binom = binom * BigInt(200 - k) / BigInt(k + 1);
+    }
+    ctx.CHECK(ok && pow2.degree() == 200);
+
+    bool threw = false;
+    try {
+        p / RationalPolynomial();
+    } catch (invalid_argument &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    ctx.result();
+
+    ctx.DESC("Batch evaluation matches evaluating each point");
+
+    BP big = randomPolynomial<BP>(30);
+    vector<BR> xs;
+    for (size_t i = 0; i < NUMPOINTS; i++)
+        xs.push_back(BR(rand() % 2001 - 1000, 1 + rand() % 1000));
+    vector<BR> one = big.evaluate(xs, 1), four = big.evaluate(xs, 4);
+    ok = one.size() == NUMPOINTS && one == four;
+    for (size_t i = 0; i < NUMPOINTS; i += 97)
+        ok = ok && one[i] == naiveEvaluate(big, xs[i]);
+    ctx.CHECK(ok);
+    ctx.CHECK(big.evaluate(vector<BR>()).empty());
+    ctx.CHECK(RationalPolynomial(Rational(3)).evaluate(vector<Rational>(), 4)
+                  .empty());
+
+    ctx.result();
+
+    ctx.DESC("Sturm sequences count and isolate real roots");
+
+    // (x - 1)^2 (x + 2) has the square free part (x - 1)(x + 2)
+    BP cube = xm * xm * bigPoly({ 2, 1 });
+    ctx.CHECK(BP::gcd(cube, cube.derivative()) == xm);
+    ctx.CHECK(cube.squareFree() == bigPoly({ -2, 1, 1 }));
+    ctx.CHECK(cube.countRoots(BR(-10), BR(10)) == 2);
+    ctx.CHECK(cube.countRoots(BR(-2), BR(1)) == 1);
+    ctx.CHECK(cube.countRoots(BR(-3), BR(-2)) == 1);
+
+    vector<pair<Rational, Rational>> roots = p.isolateRoots();
+    ctx.CHECK(roots.size() == 2);
+    ctx.CHECK(roots.size() == 2 && roots[0].second <= 0 && roots[1].first >= 0);
+    for (size_t i = 0; i < roots.size(); i++)
+        ctx.CHECK(p(roots[i].first) * p(roots[i].second) < 0);
+
+    // x^3 - x has its root 0 on a bisection midpoint
+    RationalPolynomial cubic(vector<Rational>{ 0, -1, 0, 1 });
+    roots = cubic.isolateRoots();
+    ctx.CHECK(roots.size() == 3 && roots[1].first == 0 &&
+              roots[1].second == 0);
+
+    // Roots at k/3 for k in -6..6, with the even ones doubled
+    BP many(BR(1));
+    for (int k = -6; k <= 6; k++) {
+        BP f(vector<BR>{ BR(-k, 3), BR(1) });
+        many = many * (k % 2 == 0 ? f * f : f);
+    }
+    vector<pair<BR, BR>> broots = many.isolateRoots();
+    ok = broots.size() == 13;
+    for (size_t i = 0; ok && i < broots.size(); i++) {
+        BR root((int) i - 6, 3);
+        ok = broots[i].first <= root && root <= broots[i].second &&
+             (broots[i].first == broots[i].second ||
+              broots[i].first < root) &&
+             many.countRoots(broots[i].first, broots[i].second) ==
+                 (broots[i].first == broots[i].second ? 0 : 1);
+    }
+    ctx.CHECK(ok);
+    ctx.CHECK(BP(BR(3)).isolateRoots().empty());
+    ctx.CHECK(bigPoly({ 1, 0, 1 }).countRoots(BR(-100), BR(100)) == 0);
+
+    threw = false;
+    try {
+        BP().isolateRoots();
+    } catch (invalid_argument &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    ctx.result();
+}
+
+
+/* The exact decimal expansion of a rational, as toDecimalChars writes it. */
+template <typename R>
+string decimal(const R& r) {
+    char buf[256];
+    ToCharsResult out = toDecimalChars(buf, buf + sizeof(buf), r);
+    return out.ec == errc() ? string(buf, out.ptr) : "?";
+}
+
+/* A rational rounded as toFixedChars writes it. */
+template <typename R>
+string fixed(const R& r, size_t digits, RoundingMode mode) {
+    char buf[256];
+    ToCharsResult out = toFixedChars(buf, buf + sizeof(buf), r, digits, mode);
+    return out.ec == errc() ? string(buf, out.ptr) : "?";
+}
+
+/* Whether p is x rounded to digits places by mode: within one unit in the
+   last place, on the side the mode requires, and within half a unit for the
+   modes that round to the nearest. */
+bool roundedBy(const Rational128& x, const Rational128& p, size_t digits,
+               RoundingMode mode) {
+    int128_t unit = 1;
+    for (size_t i = 0; i < digits; i++)
+        unit *= 10;
+    Rational128 err = p - x;
+    Rational128 mag = err < 0 ? -err : err;
+    if (mag * Rational128(unit) >= 1)
+        return false;
+
+    bool away = (x < 0 ? p <= x : p >= x);
+    bool toward = (x < 0 ? p >= x : p <= x);
+    switch (mode) {
+    case RoundingMode::Down:        return toward;
+    case RoundingMode::Up:          return away;
+    case RoundingMode::Floor:       return p <= x;
+    case RoundingMode::Ceiling:     return p >= x;
+    default:                        return mag * Rational128(2 * unit) <= 1;
+    }
+}
+
+void test_decimal(TestContext &ctx) {
+    const int NUMVALUES = 3000;
+    const RoundingMode MODES[] = {
+        RoundingMode::Down, RoundingMode::Up, RoundingMode::Floor,
+        RoundingMode::Ceiling, RoundingMode::HalfDown, RoundingMode::HalfUp,
+        RoundingMode::HalfEven
+    };
+
+    ctx.DESC("DecimalExpansion streams digits and finds the period");
+
+    DecimalExpansion seventh(Rational(1, 7));
+    string digits;
+    while (seventh.period() == 0)
+        digits += (char) ('0' + seventh.next());
+    ctx.CHECK(digits == "142857" && seventh.preperiod() == 0);
+    ctx.CHECK(seventh.period() == 6 && !seventh.terminates());
+    ctx.CHECK(seventh.next() == 1 && seventh.period() == 6);
+
+    DecimalExpansion sixth(Rational(-7, 6));
+    ctx.CHECK(sixth.negative() && sixth.integerPart() == -1);
+    ctx.CHECK(sixth.preperiod() == 1 && sixth.next() == 1);
+    ctx.CHECK(sixth.next() == 6 && sixth.period() == 1);
+
+    DecimalExpansion quarter(Rational(-1, 4));
+    ctx.CHECK(quarter.negative() && quarter.integerPart() == 0);
+    ctx.CHECK(quarter.terminates() && quarter.preperiod() == 2);
+    ctx.CHECK(quarter.next() == 2 && quarter.next() == 5 && quarter.done());
+    ctx.CHECK(quarter.next() == 0 && quarter.period() == 0);
+
+    ctx.CHECK(decimal(Rational(1, 7)) == "0.(142857)");
+    ctx.CHECK(decimal(Rational(1, 6)) == "0.1(6)");
+    ctx.CHECK(decimal(Rational(-22, 7)) == "-3.(142857)");
+    ctx.CHECK(decimal(Rational(1, 3)) == "0.(3)");
+    ctx.CHECK(decimal(Rational(7, 12)) == "0.58(3)");
+    ctx.CHECK(decimal(Rational(-5, 4)) == "-1.25");
+    ctx.CHECK(decimal(Rational(3, 1000)) == "0.003");
+    ctx.CHECK(decimal(Rational(5)) == "5");
+    ctx.CHECK(decimal(Rational(0)) == "0");
+    ctx.CHECK(decimal(Rational(INT32_MIN)) == "-2147483648");
+    ctx.CHECK(decimal(Rational(1, 81)) == "0.(012345679)");
+    ctx.CHECK(decimal(Rational64(1, 1LL << 40)).size() == 42);
+
+    // 1/97 has the longest period possible for its denominator
+    DecimalExpansion long97(Rational(1, 97));
+    for (int i = 0; i < 200; i++)
+        long97.next();
+    ctx.CHECK(long97.period() == 96);
+
+    // A period far longer than the buffer is reported, not truncated
+    char small[16];
+    ToCharsResult out = toDecimalChars(small, small + 16,
+                                       Rational(1, 2147483647));
+    ctx.CHECK(out.ec == errc::value_too_large && out.ptr == small + 16);
+
+    ctx.result();
+
+    ctx.DESC("DecimalExpansion digits agree across integer widths");
+
+    // 128-bit values take a different path from the others, so their digits
+    // are checked against 64-bit ones and against BigInt long division
+    srand(97531L);
+    for (int i = 0; i < NUMVALUES; i++) {
+        int64_t n = ((int64_t) rand() << 31 ^ rand()) - RAND_MAX;
+        int64_t range = i % 2 ? 1000 : INT64_MAX / 4;
+        int64_t d = 1 + ((int64_t) rand() << 31 ^ rand()) % range;
+        DecimalExpansion64 a(Rational64(n, d));
+        DecimalExpansion128 b(Rational128(n, d));
+        bool same = a.integerPart() == b.integerPart();
+        for (int k = 0; k < 40; k++)
+            same = same && a.next() == b.next() && a.period() == b.period();
+        ctx.CHECK(same && a.preperiod() == b.preperiod());
+    }
+
+    int128_t hugeDenom = RationalTraits<int128_t>::max() - 2;
+    Rational128 huge(hugeDenom / 3 * 2 + 1, hugeDenom);
+    DecimalExpansion128 e(huge);
+    BigInt rem(text(Rational128(huge.num())));
+    BigInt denom(text(Rational128(huge.denom())));
+    bool same = true;
+    for (int k = 0; k < 200; k++) {
+        rem = rem * BigInt(10);
+        same = same && rem / denom == BigInt(e.next());
+        rem = rem % denom;
+    }
+    ctx.CHECK(same);
+
+    ctx.result();
+
+    ctx.DESC("toFixedChars rounds exactly in every mode");
+
+    // 2/3, -2/3, the tie 1/8 and -1/8 to 2 places in each mode
+    const char *expected[][4] = {
+        { "0.66", "-0.66", "0.12", "-0.12" },       // Down
+        { "0.67", "-0.67", "0.13", "-0.13" },       // Up
+        { "0.66", "-0.67", "0.12", "-0.13" },       // Floor
+        { "0.67", "-0.66", "0.13", "-0.12" },       // Ceiling
+        { "0.67", "-0.67", "0.12", "-0.12" },       // HalfDown
+        { "0.67", "-0.67", "0.13", "-0.13" },       // HalfUp
+        { "0.67", "-0.67", "0.12", "-0.12" },       // HalfEven
+    };
+    const Rational VALUES[] = {
+        Rational(2, 3), Rational(-2, 3), Rational(1, 8), Rational(-1, 8)
+    };
+    for (int m = 0; m < 7; m++) {
+        for (int v = 0; v < 4; v++) {
+            ctx.CHECK(fixed(VALUES[v], 2, MODES[m]) == expected[m][v]);
+            ctx.CHECK(fixed(Rational128(VALUES[v].num(), VALUES[v].denom()),
+                            2, MODES[m]) == expected[m][v]);
+        }
+    }
+
+    ctx.CHECK(fixed(Rational(3, 8), 2, RoundingMode::HalfEven) == "0.38");
+    ctx.CHECK(fixed(Rational(5, 2), 0, RoundingMode::HalfEven) == "2");
+    ctx.CHECK(fixed(Rational(7, 2), 0, RoundingMode::HalfEven) == "4");
+    ctx.CHECK(fixed(Rational(999, 1000), 2, RoundingMode::HalfUp) == "1.00");
+    ctx.CHECK(fixed(Rational128(-19999, 20), 1, RoundingMode::Up) ==
+              "-1000.0");
+    ctx.CHECK(fixed(Rational128(-1, 1000), 2, RoundingMode::Down) == "0.00");
+    ctx.CHECK(fixed(Rational128(-1, 1000), 2, RoundingMode::Floor) ==
+              "-0.01");
+    ctx.CHECK(fixed(Rational(-1, 1000), 0, RoundingMode::HalfEven) == "0");
+    ctx.CHECK(fixed(Rational(1, 3), 30, RoundingMode::Up) ==
+              "0." + string(29, '3') + "4");
+    ctx.CHECK(fixed(Rational(INT32_MAX), 3, RoundingMode::Down) ==
+              "2147483647.000");
+    int128_t most = RationalTraits<int128_t>::max();
+    ctx.CHECK(fixed(Rational128(most, 2), 0, RoundingMode::HalfUp) ==
+              text(Rational128(most / 2 + 1)));
+
+    // One division for small digit counts, streamed digits otherwise, must
+    // agree, and what they write must parse back to a correct rounding
+    srand(86420L);
+    for (int i = 0; i < NUMVALUES; i++) {
+        Rational64 v(((int64_t) rand() << 1 ^ rand()) - RAND_MAX,
+                     1 + rand() % (i % 3 ? 1000000 : 8));
+        Rational128 w(v.num(), v.denom());
+        size_t places = i % 13;
+        RoundingMode mode = MODES[i % 7];
+        string s = fixed(v, places, mode);
+        ctx.CHECK(s == fixed(w, places, mode));
+
+        Rational128 parsed;
+        ctx.CHECK(parses(s, parsed) && roundedBy(w, parsed, places, mode));
+    }
+
+    out = toFixedChars(small, small + 5, Rational(-2, 3), 3,
+                       RoundingMode::HalfEven);
+    ctx.CHECK(out.ec == errc::value_too_large && out.ptr == small + 5);
+    out = toFixedChars(small, small + 4, Rational128(9999, 1000), 2,
+                       RoundingMode::Up);
+    ctx.CHECK(out.ec == errc::value_too_large && out.ptr == small + 4);
+
+    ctx.result();
+
+    ctx.DESC("toFixedColumn right aligns fields of a fixed width");
+
+    const Rational64 column[] = {
+        Rational64(1, 3), Rational64(-22, 7), Rational64(123456, 1),
+        Rational64(-1, 1000), Rational64(5, 8)
+    };
+    char report[5 * 8];
+    size_t overflowed = toFixedColumn(report, 8, column, 5, 2,
+                                      RoundingMode::HalfEven);
+    ctx.CHECK(overflowed == 1);
+    ctx.CHECK(string(report, sizeof(report)) ==
+              "    0.33   -3.14########    0.00    0.62");
+
+    ctx.result();
+}
+
+
+/* A random interval with endpoints of numerators below maxNum and
+   denominators up to maxDenom. */
+template <typename I>
+I randomInterval(int maxNum, int maxDenom, int64_t bound) {
+    typedef typename I::Value V;
+    V a(rand() % (2 * maxNum + 1) - maxNum, 1 + rand() % maxDenom);
+    V b(rand() % (2 * maxNum + 1) - maxNum, 1 + rand() % maxDenom);
+    return a < b ? I(a, b, bound) : I(b, a, bound);
+}
+
+/* A random value in the interval r. */
+template <typename I>
+typename I::Value randomPoint(const I& r) {
+    typedef typename I::Value V;
+    int t = rand() % 9;
+    return r.lower() + r.width() * V(t, 8);
+}
+
+/* The largest fraction at most x with a denominator of at most maxDenom,
+   trying every denominator. */
+Rational64 bruteFloor(const Rational64& x, int64_t maxDenom) {
+    Rational64 best;
+    for (int64_t q = 1; q <= maxDenom; q++) {
+        int64_t n = x.num() * q;
+        int64_t p = n / x.denom() - (n % x.denom() < 0);
+        if (q == 1 || Rational64(p, q) > best)
+            best = Rational64(p, q);
+    }
+    return best;
+}
+
+void test_interval(TestContext &ctx) {
+    const int NUMINTERVALS = 3000;
+    const int64_t BOUND = 1000;
+
+    ctx.DESC("RationalInterval arithmetic is exact");
+
+    RationalInterval a(Rational(1), Rational(2)), b(Rational(3), Rational(4));
+    RationalInterval c(Rational(-1), Rational(2)), d(Rational(-3), Rational(4));
+    ctx.CHECK(a + b == RationalInterval(Rational(4), Rational(6)));
+    ctx.CHECK(a - b == RationalInterval(Rational(-3), Rational(-1)));
+    ctx.CHECK(c * d == RationalInterval(Rational(-6), Rational(8)));
+    ctx.CHECK(-a * b == RationalInterval(Rational(-8), Rational(-3)));
+    ctx.CHECK(a / b == RationalInterval(Rational(1, 4), Rational(2, 3)));
+    ctx.CHECK(c / -b == RationalInterval(Rational(-2, 3), Rational(1, 3)));
+    ctx.CHECK(c * c == RationalInterval(Rational(-2), Rational(4)));
+    ctx.CHECK(c.square() == RationalInterval(Rational(0), Rational(4)));
+    ctx.CHECK((-b).square() == RationalInterval(Rational(9), Rational(16)));
+    ctx.CHECK(a + Rational(1, 2) ==
+              RationalInterval(Rational(3, 2), Rational(5, 2)));
+    ctx.CHECK(c.width() == 3 && c.midpoint() == Rational(1, 2));
+    ctx.CHECK(c.contains(Rational(0)) && c.containsZero() && !a.containsZero());
+    ctx.CHECK(c.contains(a) && !a.contains(c) && a.overlaps(c));
+    ctx.CHECK(a.certainlyLess(b) && !c.certainlyLess(a));
+    ctx.CHECK(a.maxDenom() == 0);
+
+    RationalInterval e = a;
+    e += b;
+    e -= a;
+    e *= c;
+    e /= b;
+    ctx.CHECK(e == (a + b - a) * c / b);
+
+    bool threw = false;
+    try {
+        RationalInterval(Rational(2), Rational(1));
+    } catch (invalid_argument &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    threw = false;
+    try {
+        a / c;
+    } catch (invalid_argument &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    threw = false;
+    try {
+        RationalInterval(Rational(1), Rational(2), -1);
+    } catch (invalid_argument &) {
+        threw = true;
+    }
+    ctx.CHECK(threw);
+
+    ctx.result();
+
+    ctx.DESC("Interval results contain every result of their operands");
+
+    // Exact results are the tightest intervals holding the endpoint results,
+    // and bounded ones contain them
+    srand(11235L);
+    for (int i = 0; i < NUMINTERVALS; i++) {
+        RationalInterval64 x = randomInterval<RationalInterval64>(1000, 100, 0);
+        RationalInterval64 y = randomInterval<RationalInterval64>(1000, 100, 0);
+        RationalInterval64 bx(x.lower(), x.upper(), BOUND);
+        RationalInterval64 by(y.lower(), y.upper(), BOUND);
+        Rational64 p = randomPoint(x), q = randomPoint(y);
+
+        const Rational64 ends[] = {
+            x.lower() * y.lower(), x.lower() * y.upper(),
+            x.upper() * y.lower(), x.upper() * y.upper()
+        };
+        RationalInterval64 product = x * y;
+        ctx.CHECK(product.lower() == *min_element(ends, ends + 4));
+        ctx.CHECK(product.upper() == *max_element(ends, ends + 4));
+        ctx.CHECK(product.contains(p * q) && (bx * by).contains(product));
+
+        RationalInterval64 total = x + y, difference = x - y;
+        ctx.CHECK(total.contains(p + q) && (bx + by).contains(total));
+        ctx.CHECK(difference.contains(p - q) &&
+                  (bx - by).contains(difference));
+        ctx.CHECK(x.square().contains(p * p) &&
+                  bx.square().contains(x.square()));
+        if (!y.containsZero()) {
+            RationalInterval64 quotient = x / y;
+            ctx.CHECK(quotient.contains(p / q) &&
+                      (bx / by).contains(quotient));
+        }
+
+        RationalInterval128 wx(Rational128(x.lower().num(),
+                                           x.lower().denom()));
+        BigRationalInterval bigx(BigRational(x.upper().num(),
+                                             x.upper().denom()));
+        ctx.CHECK(text((wx * wx).lower()) == text(x.lower() * x.lower()));
+        ctx.CHECK(text((bigx + bigx).upper()) == text(x.upper() * 2));
+    }
+
+    ctx.result();
+
+    ctx.DESC("Bounded intervals round outward to the nearest fractions");
+
+    srand(81321L);
+    bool tight = true, small = true;
+    for (int i = 0; i < NUMINTERVALS / 10; i++) {
+        Rational64 x(rand() - RAND_MAX / 2, 1 + rand() % 1000000);
+        int64_t bound = 1 + rand() % 60;
+        RationalInterval64 r(x, x, bound);
+        tight = tight && r.lower() == bruteFloor(x, bound);
+        tight = tight && r.upper() == -bruteFloor(-x, bound);
+        small = small && r.lower().denom() <= bound &&
+                r.upper().denom() <= bound;
+
+        RationalInterval w(Rational((int32_t) x.num(), (int32_t) x.denom()),
+                           Rational((int32_t) x.num(), (int32_t) x.denom()),
+                           (int32_t) bound);
+        RationalInterval128 w128(Rational128(x.num(), x.denom()),
+                                 Rational128(x.num(), x.denom()), bound);
+        BigRationalInterval big(BigRational(x.num(), x.denom()),
+                                BigRational(x.num(), x.denom()),
+                                BigInt(bound));
+        tight = tight && text(w.lower()) == text(r.lower()) &&
+                text(w128.upper()) == text(r.upper()) &&
+                text(big.lower()) == text(r.lower());
+    }
+    ctx.CHECK(tight && small);
+
+    // Values whose denominators are small enough are kept exactly
+    RationalInterval64 third(Rational64(1, 3), Rational64(2, 3), 3);
+    ctx.CHECK(third.lower() == Rational64(1, 3));
+    RationalInterval64 pi(Rational64(314159265, 100000000),
+                          Rational64(314159265, 100000000), 1000);
+    ctx.CHECK(pi.lower() == Rational64(2818, 897) &&
+              pi.upper() == Rational64(355, 113));
+
+    ctx.result();
+
+    ctx.DESC("Bounded intervals keep long iterations from overflowing");
+
+    // y <- y/3 + 1/7 multiplies the exact denominators by 3 every step, so
+    // exact 64-bit intervals overflow where bounded ones carry on
+    RationalInterval64 exact(Rational64(1), Rational64(2));
+    RationalInterval64 bounded(Rational64(1), Rational64(2), (int64_t) 1 << 30);
+    BigRationalInterval reference(BigRational(1), BigRational(2));
+    RationalInterval64 third64(Rational64(1, 3)), seventh(Rational64(1, 7));
+    BigRationalInterval bigThird(BigRational(1, 3));
+    BigRationalInterval bigSeventh(BigRational(1, 7));
+    bool overflowed = false, contained = true;
+    for (int step = 0; step < 1000; step++) {
+        try {
+            exact = exact * third64 + seventh;
+        } catch (overflow_error &) {
+            overflowed = true;
+        }
+        bounded = bounded * third64 + seventh;
+        if (step < 200) {
+            reference = reference * bigThird + bigSeventh;
+            BigRational lo(bounded.lower().num(), bounded.lower().denom());
+            BigRational hi(bounded.upper().num(), bounded.upper().denom());
+            contained = contained && !(reference.lower() < lo) &&
+                        !(hi < reference.upper());
+        }
+    }
+    ctx.CHECK(overflowed && contained);
+    ctx.CHECK(bounded.contains(Rational64(3, 14)));
+    ctx.CHECK(bounded.width() < Rational64(1, 1000000));
+    ctx.CHECK(bounded.upper().denom() <= ((int64_t) 1 << 30));
+
+    ctx.result();
+}
+
 
 /*! This program is a simple test-suite for the Rational class. */
 int main() {
@@ -416,6 +2704,25 @@ int main() {
     test_simple_arithmetic(ctx);
     test_casting(ctx);
     test_stream_output(ctx);
+    test_integer_widths(ctx);
+    test_big(ctx);
+    test_reduction(ctx);
+    test_comparisons(ctx);
+    test_lazy(ctx);
+    test_accumulator(ctx);
+    test_parallel(ctx);
+    test_rational_array(ctx);
+    test_constexpr(ctx);
+    test_chars(ctx);
+    test_approximate(ctx);
+    test_matrix(ctx);
+    test_linear_program(ctx);
+    test_safe_rational(ctx);
+    test_hash(ctx);
+    test_int_operands(ctx);
+    test_polynomial(ctx);
+    test_decimal(ctx);
+    test_interval(ctx);
 
     // Return 0 if everything passed, nonzero if something failed.
     return !ctx.ok();
@@ -0,0 +1,207 @@
+#include "vector.hh"
+#include "sort.hh"
+#include "codec.hh"
+#include "hashmap.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+
+using namespace std;
+
+
+/*===========================================================================
+ * HELPERS
+ */
+
+
+/* Milliseconds taken to run f once. */
+template <typename F>
+double timeMs(F f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    auto stop = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(stop - start).count();
+}
+
+/* Random values of each key type. */
+template <typename T> T randomValue();
+template <> int randomValue<int>() { return rand() - RAND_MAX / 2; }
+template <> uint32_t randomValue<uint32_t>() {
+    return (uint32_t) rand() * 2654435761u;
+}
+template <> float randomValue<float>() {
+    return (float) (rand() - RAND_MAX / 2) / 1024.0f;
+}
+
+void row(const char *name, size_t n, double ms) {
+    cout << setw(24) << left << name << setw(12) << right << n
+         << setw(12) << fixed << setprecision(1) << ms
+         << setw(12) << setprecision(1) << (n / ms / 1000.0) << endl;
+}
+
+
+/*===========================================================================
+ * BENCHMARKS
+ */
+
+
+/* std::sort against radixSort on one thread and on every thread. */
+template <typename T>
+void bench_sort(const char *type, size_t n) {
+    Vector<T> orig;
+    for (size_t i = 0; i < n; i++)
+        orig.push_back(randomValue<T>());
+
+    string name = string(type);
+    Vector<T> v(orig);
+    row((name + " std::sort").c_str(), n,
+        timeMs([&]() { std::sort(v.begin(), v.end()); }));
+
+    Vector<T> v1(orig);
+    row((name + " radix 1 thread").c_str(), n,
+        timeMs([&]() { radixSort(v1, 1); }));
+
+    Vector<T> vn(orig);
+    row((name + " radix all").c_str(), n,
+        timeMs([&]() { radixSort(vn); }));
+}
+
+/* Merging 16 presorted runs against sorting from scratch. */
+void bench_merge(size_t n) {
+    const size_t RUNS = 16;
+    Vector<int> orig;
+    Vector<size_t> starts;
+    for (size_t r = 0; r < RUNS; r++) {
+        starts.push_back(orig.size());
+        size_t lo = orig.size();
+        for (size_t i = 0; i < n / RUNS; i++)
+            orig.push_back(randomValue<int>());
+        std::sort(orig.begin() + lo, orig.end());
+    }
+
+    Vector<int> v(orig);
+    row("int std::sort of runs", orig.size(),
+        timeMs([&]() { std::sort(v.begin(), v.end()); }));
+
+    Vector<int> m(orig);
+    row("int mergeRuns", orig.size(),
+        timeMs([&]() { mergeRuns(m, starts); }));
+}
+
+
+/* Encode and decode throughput of every codec on sorted IDs, reported in MB
+   of raw ints per second along with the compression ratio. */
+void bench_codecs(size_t n) {
+    const Codec codecs[3] = { ZIGZAG_VARINT, DELTA_VARINT, FOR_BITPACK };
+    const char *names[3] = { "zigzag", "delta", "for" };
+
+    Vector<int> ids;
+    int id = 0;
+    for (size_t i = 0; i < n; i++) {
+        id += 1 + rand() % 40;
+        ids.push_back(id);
+    }
+
+    for (int c = 0; c < 3; c++) {
+        Vector<uint8_t> bytes;
+        Vector<int> out;
+        double enc = timeMs([&]() {
+            VectorEncoder(codecs[c]).encode(ids, bytes);
+        });
+        double dec = timeMs([&]() {
+            VectorDecoder(codecs[c]).decode(bytes, out);
+        });
+
+        double mb = n * sizeof(int) / 1e6;
+        cout << setw(10) << left << names[c] << setw(12) << right << n
+             << setw(12) << fixed << setprecision(2)
+             << (double) n * sizeof(int) / bytes.size()
+             << setw(12) << setprecision(0) << mb / enc * 1000
+             << setw(12) << mb / dec * 1000 << endl;
+    }
+}
+
+/* Inserting n random keys, looking each up (plus as many misses) and erasing
+   them again, in FlatHashMap and unordered_map. */
+template <typename M>
+void bench_map(const char *name, const Vector<int> &keys) {
+    size_t n = keys.size();
+    M m;
+    double ins = timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            m[keys[i]] = (int) i;
+    });
+
+    size_t found = 0;
+    double look = timeMs([&]() {
+        for (size_t i = 0; i < n; i++) {
+            found += m.count(keys[i]);
+            found += m.count(~keys[i]);
+        }
+    });
+
+    double era = timeMs([&]() {
+        for (size_t i = 0; i < n; i++)
+            m.erase(keys[i]);
+    });
+
+    cout << setw(16) << left << name << setw(12) << right << n
+         << setw(12) << fixed << setprecision(1) << n / ins / 1000.0
+         << setw(12) << 2 * n / look / 1000.0
+         << setw(12) << n / era / 1000.0
+         << (found >= n ? "" : "  (lookups missed)") << endl;
+}
+
+/* FlatHashMap wrapped to the unordered_map calls bench_map makes. */
+struct FlatMapBench : FlatHashMap<int, int> {
+    size_t count(int key) const { return contains(key); };
+};
+
+
+/*! Times the sorting kernels, codecs and hash maps.  The largest size can be
+    passed as argument. */
+int main(int argc, char **argv) {
+    size_t most = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+
+    srand(654321L);
+
+    cout << "Benchmarking Vector sorting on "
+         << thread::hardware_concurrency() << " hardware threads." << endl
+         << endl;
+    cout << setw(24) << left << "kernel" << setw(12) << right << "n"
+         << setw(12) << "ms" << setw(12) << "Melem/s" << endl;
+
+    for (size_t n = 1000; n <= most; n *= 10) {
+        bench_sort<int>("int", n);
+        bench_sort<uint32_t>("uint32_t", n);
+        bench_sort<float>("float", n);
+        bench_merge(n);
+        cout << endl;
+    }
+
+    cout << setw(10) << left << "codec" << setw(12) << right << "n"
+         << setw(12) << "ratio" << setw(12) << "enc MB/s"
+         << setw(12) << "dec MB/s" << endl;
+    for (size_t n = 1000; n <= most; n *= 10)
+        bench_codecs(n);
+
+    cout << endl << setw(16) << left << "map" << setw(12) << right << "n"
+         << setw(12) << "ins Mop/s" << setw(12) << "find Mop/s"
+         << setw(12) << "erase Mop/s" << endl;
+    for (size_t n = 1000; n <= most; n *= 10) {
+        // Distinct keys, so ~key is always a miss.
+        Vector<int> keys;
+        for (size_t i = 0; i < n; i++)
+            keys.push_back((int) (((uint32_t) i * 2654435761u) >> 1));
+        bench_map<FlatMapBench>("FlatHashMap", keys);
+        bench_map<unordered_map<int, int> >("unordered_map", keys);
+    }
+
+    return 0;
+}
@@ -0,0 +1,384 @@
+/*
+ codec.hh
+
+ Implements streaming encoders and decoders that compress Vector<int> into
+ compact byte streams: zigzag varints, delta coded varints and frame of
+ reference bit-packing.
+*/
+
+#ifndef CODEC
+#define CODEC
+
+#include <stdint.h>
+#include <string.h>
+#include <stdexcept>
+#include "vector.hh"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/******************************************************************************
+
+ CODECS
+
+ ZIGZAG_VARINT  Each value is zigzag mapped (0, -1, 1, -2, ... to 0, 1, 2, 3,
+                ...) so small magnitudes of either sign are small, then written
+                as a little endian base 128 varint of 1 to 5 bytes.
+ DELTA_VARINT   The difference from the previous value (wrapping at 32 bits)
+                is written as a zigzag varint.  Sorted or slowly changing
+                values mostly take a single byte each.
+ FOR_BITPACK    Values are split into blocks of up to 128.  Each block stores
+                its count, a bit width and its minimum, followed by every
+                value minus the minimum packed into that many bits.
+
+ Encoders and decoders keep state between calls, so a stream can be produced
+ and consumed in pieces of any size.
+
+******************************************************************************/
+enum Codec {
+    ZIGZAG_VARINT,
+    DELTA_VARINT,
+    FOR_BITPACK
+};
+
+/* Values per frame of reference block. */
+static const size_t FOR_BLOCK = 128;
+
+/* Longest varint encoding of a 32-bit value. */
+static const size_t VARINT_MAX = 5;
+
+/* Longest block header: count, bit width and the minimum as a varint. */
+static const size_t FOR_HEADER_MAX = 2 + VARINT_MAX;
+
+/* Maps signed values onto unsigned ones, interleaving the signs. */
+static inline uint32_t zigzag(int32_t x) {
+    return ((uint32_t) x << 1) ^ (uint32_t) (x >> 31);
+}
+
+/* Inverse of zigzag. */
+static inline int32_t unzigzag(uint32_t u) {
+    return (int32_t) ((u >> 1) ^ -(u & 1));
+}
+
+/* Writes u as a varint at out, returning the number of bytes written. */
+static inline size_t putVarint(uint8_t *out, uint32_t u) {
+    size_t n = 0;
+    while (u >= 0x80) {
+        out[n++] = (uint8_t) (u | 0x80);
+        u >>= 7;
+    }
+    out[n++] = (uint8_t) u;
+    return n;
+}
+
+/* Reads a varint from in[0..len) into u, returning the number of bytes read,
+   or 0 if the varint is not complete yet. */
+static inline size_t getVarint(const uint8_t *in, size_t len, uint32_t& u) {
+    u = 0;
+    for (size_t n = 0; n < len; n++) {
+        if (n == VARINT_MAX)
+            throw std::invalid_argument("Varint longer than 5 bytes.");
+        u |= (uint32_t) (in[n] & 0x7f) << (7 * n);
+        if (!(in[n] & 0x80))
+            return n + 1;
+    }
+    return 0;
+}
+
+/******************************************************************************
+
+ ENCODER
+
+******************************************************************************/
+class VectorEncoder {
+
+private:
+    Codec codec;            /* Codec used for the stream. */
+    int32_t prev;           /* Last value encoded, for delta coding. */
+
+    /* Packs one frame of reference block of n values at out, returning the
+       number of bytes written. */
+    static size_t packBlock(const int *vals, size_t n, uint8_t *out) {
+        /* The range of the block decides how many bits each value needs. */
+        int32_t lo = vals[0], hi = vals[0];
+        for (size_t i = 1; i < n; i++) {
+            lo = std::min(lo, (int32_t) vals[i]);
+            hi = std::max(hi, (int32_t) vals[i]);
+        }
+        uint32_t range = (uint32_t) hi - (uint32_t) lo;
+        unsigned bits = range == 0 ? 0 : 32 - __builtin_clz(range);
+
+        size_t w = 0;
+        out[w++] = (uint8_t) (n - 1);
+        out[w++] = (uint8_t) bits;
+        w += putVarint(out + w, zigzag(lo));
+
+        /* Pack offsets from the minimum, least significant bits first. */
+        uint64_t acc = 0;
+        unsigned held = 0;
+        for (size_t i = 0; i < n; i++) {
+            acc |= (uint64_t) ((uint32_t) vals[i] - (uint32_t) lo) << held;
+            held += bits;
+            while (held >= 8) {
+                out[w++] = (uint8_t) acc;
+                acc >>= 8;
+                held -= 8;
+            }
+        }
+        if (held > 0)
+            out[w++] = (uint8_t) acc;
+
+        return w;
+    };
+
+public:
+
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+
+    VectorEncoder(Codec codec) : codec(codec), prev(0) {};
+
+
+    /******************************
+     ENCODING
+     ******************************/
+
+    /* Starts a new stream. */
+    void reset() { prev = 0; };
+
+    /* Worst case number of bytes needed to encode n values. */
+    static size_t maxEncodedSize(size_t n) {
+        return n * VARINT_MAX +
+            (n + FOR_BLOCK - 1) / FOR_BLOCK * FOR_HEADER_MAX;
+    };
+
+    /* Appends the encoding of n values to out. */
+    void encode(const int *vals, size_t n, Vector<uint8_t>& out) {
+        size_t start = out.size();
+        out.resize(start + maxEncodedSize(n));
+        uint8_t *dst = out.begin() + start;
+        size_t w = 0;
+
+        switch (codec) {
+        case ZIGZAG_VARINT:
+            for (size_t i = 0; i < n; i++)
+                w += putVarint(dst + w, zigzag(vals[i]));
+            break;
+
+        case DELTA_VARINT:
+            for (size_t i = 0; i < n; i++) {
+                w += putVarint(dst + w,
+                    zigzag((int32_t) ((uint32_t) vals[i] - (uint32_t) prev)));
+                prev = vals[i];
+            }
+            break;
+
+        case FOR_BITPACK:
+            for (size_t i = 0; i < n; i += FOR_BLOCK)
+                w += packBlock(vals + i, std::min(FOR_BLOCK, n - i), dst + w);
+            break;
+        }
+
+        /* Give back whatever the worst case didn't use. */
+        out.resize(start + w);
+    };
+
+    /* Appends the encoding of the argued values to out. */
+    void encode(const Vector<int>& vals, Vector<uint8_t>& out) {
+        encode(vals.size() ? &vals[0] : NULL, vals.size(), out);
+    };
+};
+
+/******************************************************************************
+
+ DECODER
+
+ Decodes as much of its input as forms whole values (or whole blocks for
+ FOR_BITPACK) and reports how many bytes it used.  The caller passes the rest
+ back in once more of the stream has arrived.  Runs of single byte varints are
+ decoded 16 at a time with SSE2 where it is available.
+
+******************************************************************************/
+class VectorDecoder {
+
+private:
+    Codec codec;            /* Codec used for the stream. */
+    int32_t prev;           /* Last value decoded, for delta coding. */
+
+#ifdef __SSE2__
+    /* Decodes 16 single byte varints at in into out.  For delta coding the
+       decoded differences are prefix summed onto prev. */
+    void decode16(const uint8_t *in, int *out, bool delta) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi32(1);
+        __m128i bytes = _mm_loadu_si128((const __m128i *) in);
+        __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+        __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+        __m128i quads[4] = {
+            _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+            _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero)
+        };
+        __m128i carry = _mm_set1_epi32(prev);
+
+        for (int q = 0; q < 4; q++) {
+            /* Undo the zigzag mapping: (u >> 1) ^ -(u & 1) */
+            __m128i u = quads[q];
+            __m128i x = _mm_xor_si128(_mm_srli_epi32(u, 1),
+                _mm_sub_epi32(zero, _mm_and_si128(u, one)));
+
+            if (delta) {
+                /* Prefix sum of the four lanes, plus the running value. */
+                x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+                x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+                x = _mm_add_epi32(x, carry);
+                carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+            }
+            _mm_storeu_si128((__m128i *) (out + 4*q), x);
+        }
+
+        if (delta)
+            prev = out[15];
+    };
+#endif
+
+    /* Decodes varints from in[0..len) to out, returning the number of bytes
+       used and storing the number of values in count. */
+    size_t decodeVarints(const uint8_t *in, size_t len, int *out,
+                         size_t& count) {
+        bool delta = codec == DELTA_VARINT;
+        size_t r = 0;
+        count = 0;
+
+        while (r < len) {
+#ifdef __SSE2__
+            /* Fast path: the next 16 bytes are all complete varints. */
+            if (len - r >= 16 &&
+                _mm_movemask_epi8(_mm_loadu_si128(
+                    (const __m128i *) (in + r))) == 0) {
+                decode16(in + r, out + count, delta);
+                r += 16;
+                count += 16;
+                continue;
+            }
+#endif
+            uint32_t u;
+            size_t used = getVarint(in + r, len - r, u);
+            if (used == 0)
+                break;
+            r += used;
+
+            int32_t x = unzigzag(u);
+            if (delta) {
+                x = (int32_t) ((uint32_t) prev + (uint32_t) x);
+                prev = x;
+            }
+            out[count++] = x;
+        }
+
+        return r;
+    };
+
+    /* Reads the header of the block at in[0..len) into n, bits and lo,
+       returning the size of the whole block, or 0 if it is not complete. */
+    static size_t blockHeader(const uint8_t *in, size_t len, size_t& n,
+                              unsigned& bits, uint32_t& lo) {
+        if (len < 3)
+            return 0;
+        n = (size_t) in[0] + 1;
+        bits = in[1];
+        if (bits > 32)
+            throw std::invalid_argument("Bit width wider than 32.");
+
+        uint32_t zlo;
+        size_t used = getVarint(in + 2, len - 2, zlo);
+        size_t packed = (n * bits + 7) / 8;
+        if (used == 0 || len - 2 - used < packed)
+            return 0;
+        lo = (uint32_t) unzigzag(zlo);
+        return 2 + used + packed;
+    };
+
+    /* Decodes whole frame of reference blocks from in[0..len), appending to
+       out and returning the number of bytes used.  The headers are walked
+       first so out is only resized once. */
+    size_t decodeBlocks(const uint8_t *in, size_t len, Vector<int>& out) {
+        size_t n, total = 0, r = 0, block;
+        unsigned bits;
+        uint32_t lo;
+        while ((block = blockHeader(in + r, len - r, n, bits, lo)) != 0) {
+            total += n;
+            r += block;
+        }
+
+        size_t start = out.size();
+        out.resize(start + total);
+        int *dst = out.begin() + start;
+
+        for (size_t p = 0; p < r; ) {
+            size_t block = blockHeader(in + p, r - p, n, bits, lo);
+            const uint8_t *src = in + p + block - (n * bits + 7) / 8;
+
+            /* Unpack offsets from the minimum. */
+            uint64_t mask = ((uint64_t) 1 << bits) - 1;
+            uint64_t acc = 0;
+            unsigned held = 0;
+            for (size_t i = 0; i < n; i++) {
+                while (held < bits) {
+                    acc |= (uint64_t) *src++ << held;
+                    held += 8;
+                }
+                *dst++ = (int32_t) (lo + (uint32_t) (acc & mask));
+                acc >>= bits;
+                held -= bits;
+            }
+
+            p += block;
+        }
+
+        return r;
+    };
+
+public:
+
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+
+    VectorDecoder(Codec codec) : codec(codec), prev(0) {};
+
+
+    /******************************
+     DECODING
+     ******************************/
+
+    /* Starts a new stream. */
+    void reset() { prev = 0; };
+
+    /* Appends the values encoded in in[0..len) to out, returning the number
+       of bytes used.  Anything after that is an incomplete value or block.
+       Throws invalid_argument on malformed input. */
+    size_t decode(const uint8_t *in, size_t len, Vector<int>& out) {
+        if (codec == FOR_BITPACK)
+            return decodeBlocks(in, len, out);
+
+        /* Every varint takes at least one byte. */
+        size_t start = out.size();
+        out.resize(start + len);
+
+        size_t count;
+        size_t used = decodeVarints(in, len, out.begin() + start, count);
+
+        out.resize(start + count);
+        return used;
+    };
+
+    /* Appends the values encoded in the argued bytes to out, returning the
+       number of bytes used. */
+    size_t decode(const Vector<uint8_t>& in, Vector<int>& out) {
+        return decode(in.size() ? &in[0] : NULL, in.size(), out);
+    };
+};
+
+#endif // ifndef CODEC
@@ -7,26 +7,28 @@
     09 Apr 2017 - Tim Menninger: Created
 */
 
-#ifndef COMMON
-#define COMMON
+#ifndef VECTORCOMMON
+#define VECTORCOMMON
+
+#include <stddef.h>
 
 /*
  smallestPow2
 
  Returns the smallest power of two greater than or equal to the argument.  If
- the argument is 0 or negative, it returns 0.
+ the argument is 0, it returns 0.
 
- Arguments:     n (int) - Value to find smallest power of 2 greater than.
+ Arguments:     n (size_t) - Value to find smallest power of 2 greater than.
 
- Returns:       (int) - Smallest power of 2 greater than argument.
+ Returns:       (size_t) - Smallest power of 2 greater than argument.
 */
-static inline int smallestPow2(int n) {
-    // Return 0 if n is less than or equal to 0
-    if (n <= 0)
+static inline size_t smallestPow2(size_t n) {
+    // Return 0 if n is 0
+    if (n == 0)
         return 0;
 
     // Otherwise find smallest power of 2 greater than argument
-    int out = 1;
+    size_t out = 1;
     // Double until greater than or equal to argument
     while (out < n)
         out <<= 1;
@@ -47,4 +49,4 @@ static inline int smallestPow2(int n) {
 //     return (int) n == n ? n : (int) n + 1;
 // }
 
-#endif // ifndef COMMON
+#endif // ifndef VECTORCOMMON
@@ -0,0 +1,266 @@
+#include "vector.hh"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+using namespace std;
+
+
+/*===========================================================================
+ * DIFFERENTIAL FUZZER
+ *
+ * Applies the same sequence of mutations to a Vector<T> and a std::vector<T>
+ * and checks after every step that they hold the same elements.  The
+ * sequence is read from a byte string, which either comes from libFuzzer
+ * (build with -DLIBFUZZER) or from a seeded random generator in standalone
+ * mode.  Build with -fsanitize=address,undefined so memory errors in the
+ * container abort the run.
+ */
+
+
+/* Hands out the bytes of the fuzzer input.  Once they run out everything
+   reads as zero and done() is true. */
+class ByteSource {
+    const uint8_t *data;                    // fuzzer input
+    size_t len;                             // length of input
+    size_t pos;                             // next byte to read
+
+public:
+    ByteSource(const uint8_t *data, size_t len) :
+        data(data), len(len), pos(0) {}
+
+    bool done() const { return pos >= len; }
+
+    uint8_t byte() { return pos < len ? data[pos++] : 0; }
+
+    /* Returns a value in [0, bound], or 0 if bound is 0. */
+    size_t upTo(size_t bound) {
+        size_t x = byte();
+        x = (x << 8) | byte();
+        return bound == 0 ? 0 : x % (bound + 1);
+    }
+};
+
+
+/* Element values for each type under test. */
+static int targets[16];
+
+template <typename T> T makeValue(ByteSource &src);
+
+template <> int makeValue<int>(ByteSource &src) {
+    return (int) ((uint32_t) src.byte() << 8 | src.byte()) - 1000;
+}
+
+/* Lengths straddle the small string optimization. */
+template <> string makeValue<string>(ByteSource &src) {
+    return string(src.byte() % 40, (char) ('a' + src.byte() % 26));
+}
+
+template <> int *makeValue<int*>(ByteSource &src) {
+    uint8_t b = src.byte();
+    return b % 17 == 16 ? NULL : &targets[b % 17];
+}
+
+template <> bool makeValue<bool>(ByteSource &src) {
+    return src.byte() & 1;
+}
+
+
+/* True if v and ref hold the same elements in the same order. */
+template <typename T>
+bool same(Vector<T> &v, const vector<T> &ref) {
+    if (v.size() != ref.size() || v.capacity() < v.size())
+        return false;
+    for (size_t i = 0; i < ref.size(); i++)
+        if (!(v.at(i) == ref[i]))
+            return false;
+    return true;
+}
+
+
+/* Names of the operations, for reporting. */
+static const char *OPS[] = {
+    "push_back", "push_back (rvalue)", "insert", "erase", "erase range",
+    "resize", "reserve", "shrink_to_fit", "copy", "move", "copy assign",
+    "move assign", "self assign", "clear"
+};
+static const int NUM_OPS = sizeof(OPS) / sizeof(OPS[0]);
+
+/* Growth is capped so a single input cannot allocate without bound. */
+static const size_t MAX_LEN = 300;
+
+
+/* Runs the operations in src against both containers, returning false and
+   reporting the first step at which they disagree. */
+template <typename T>
+bool runOps(ByteSource &src, const char *type) {
+    Vector<T> v;
+    vector<T> ref;
+
+    for (int step = 0; !src.done(); step++) {
+        int op = src.byte() % NUM_OPS;
+        size_t n = ref.size();
+
+        switch (op) {
+        case 0: {
+            T x = makeValue<T>(src);
+            if (n < MAX_LEN) {
+                v.push_back(x);
+                ref.push_back(x);
+            }
+            break;
+        }
+        case 1: {
+            T x = makeValue<T>(src);
+            if (n < MAX_LEN) {
+                T y = x;
+                v.push_back(std::move(y));
+                ref.push_back(x);
+            }
+            break;
+        }
+        case 2: {
+            size_t i = src.upTo(n);
+            T x = makeValue<T>(src);
+            if (n < MAX_LEN) {
+                v.insert(v.begin() + i, x);
+                ref.insert(ref.begin() + i, x);
+            }
+            break;
+        }
+        case 3:
+            if (n > 0) {
+                size_t i = src.upTo(n - 1);
+                v.erase(v.begin() + i);
+                ref.erase(ref.begin() + i);
+            }
+            break;
+        case 4: {
+            size_t i = src.upTo(n);
+            size_t j = i + src.upTo(n - i);
+            v.erase(v.begin() + i, v.begin() + j);
+            ref.erase(ref.begin() + i, ref.begin() + j);
+            break;
+        }
+        case 5: {
+            size_t count = src.upTo(MAX_LEN);
+            v.resize(count);
+            ref.resize(count);
+            break;
+        }
+        case 6:
+            v.reserve(src.upTo(MAX_LEN));
+            break;
+        case 7:
+            v.shrink_to_fit();
+            break;
+        case 8: {
+            Vector<T> c(v);
+            if (!same(c, ref)) {
+                cerr << type << ": copy differs at step " << step << endl;
+                return false;
+            }
+            break;
+        }
+        case 9: {
+            Vector<T> m(std::move(v));
+            if (!same(m, ref)) {
+                cerr << type << ": move differs at step " << step << endl;
+                return false;
+            }
+            v = std::move(m);
+            break;
+        }
+        case 10: {
+            Vector<T> other;
+            other.push_back(makeValue<T>(src));
+            other = v;
+            v = other;
+            break;
+        }
+        case 11: {
+            Vector<T> other;
+            other.push_back(makeValue<T>(src));
+            other = std::move(v);
+            v = std::move(other);
+            break;
+        }
+        case 12: {
+            Vector<T> &alias = v;
+            v = alias;
+            break;
+        }
+        case 13:
+            v.clear();
+            ref.clear();
+            break;
+        }
+
+        if (!same(v, ref)) {
+            cerr << type << ": " << OPS[op] << " differs at step " << step
+                 << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/* Runs one fuzzer input.  The first byte picks the element type. */
+static bool fuzzOne(const uint8_t *data, size_t len) {
+    if (len == 0)
+        return true;
+
+    ByteSource src(data + 1, len - 1);
+    switch (data[0] % 4) {
+    case 0:  return runOps<int>(src, "Vector<int>");
+    case 1:  return runOps<string>(src, "Vector<string>");
+    case 2:  return runOps<int*>(src, "Vector<int*>");
+    default: return runOps<bool>(src, "Vector<bool>");
+    }
+}
+
+
+#ifdef LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t len) {
+    if (!fuzzOne(data, len))
+        abort();
+    return 0;
+}
+
+#else
+
+/*! Standalone driver: fuzzes random inputs.  Takes the number of inputs and
+    the seed as optional arguments. */
+int main(int argc, char **argv) {
+    long runs = argc > 1 ? atol(argv[1]) : 20000;
+    unsigned seed = argc > 2 ? (unsigned) atol(argv[2]) : 654321;
+
+    cout << "Fuzzing Vector against std::vector: " << runs
+         << " inputs, seed " << seed << "." << endl;
+
+    srand(seed);
+    vector<uint8_t> input;
+    for (long r = 0; r < runs; r++) {
+        input.resize(1 + rand() % 2048);
+        for (size_t i = 0; i < input.size(); i++)
+            input[i] = (uint8_t) rand();
+
+        if (!fuzzOne(input.data(), input.size())) {
+            cerr << "Failed on input " << r << " (seed " << seed << ")."
+                 << endl;
+            return 1;
+        }
+    }
+
+    cout << "All inputs matched." << endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,318 @@
+/*
+ hashmap.hh
+
+ Implements FlatHashMap, an open addressing hash table that keeps its keys and
+ values inline in VectorBase storage instead of allocating a node per entry.
+*/
+
+#ifndef HASHMAP
+#define HASHMAP
+
+#include <stdint.h>
+#include <string.h>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include "vector.hh"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/******************************************************************************
+
+ FLAT HASH MAP
+
+ Every slot has a control byte: EMPTY (high bit set) or the low 7 bits of the
+ key's hash (H2).  The rest of the hash (H1) picks the slot the key would like
+ to live in, and collisions are resolved by linear probing.  Lookups compare
+ 16 control bytes at a time against H2 with SSE2, so only slots whose H2
+ matches ever have their keys compared, and a group holding an EMPTY byte
+ ends the probe.
+
+ The first 16 control bytes are cloned past the end of the table so a group
+ can be loaded from any slot without wrapping.  Erasing shifts the following
+ entries of the probe run back into the hole instead of leaving a tombstone,
+ so probe runs never grow from deletions.  Capacity is always a power of two
+ of at least 16, and the table grows once it would be more than 7/8 full.
+
+ Keys and values must be default constructible, since every slot holds a
+ constructed entry.  Inserting and erasing invalidate iterators and pointers
+ into the map.
+
+******************************************************************************/
+template <typename K, typename V, typename Hash = std::hash<K> >
+class FlatHashMap {
+
+public:
+    typedef std::pair<K, V>         value_type;
+    typedef size_t                  size_type;
+
+private:
+    static const uint8_t EMPTY = 0x80;      /* Control byte of a free slot. */
+    static const size_type GROUP = 16;      /* Control bytes probed at once. */
+    static const size_type MIN_CAP = 16;    /* Smallest nonzero capacity. */
+
+    VectorBase<uint8_t> ctrl;       /* cap + GROUP control bytes. */
+    VectorBase<value_type> slots;   /* cap entries. */
+    size_type len;                  /* Number of entries. */
+    size_type cap;                  /* Number of slots, a power of two. */
+    Hash hasher;
+
+    /* Hash of a key with its bits mixed, since std::hash of integers is the
+       identity and the low bits pick the slot. */
+    uint64_t hashOf(const K& key) const {
+        uint64_t h = (uint64_t) hasher(key) * 0x9e3779b97f4a7c15ull;
+        return h ^ (h >> 32);
+    };
+
+    static uint8_t h2(uint64_t h) { return (uint8_t) (h & 0x7f); };
+    size_type home(uint64_t h) const { return (h >> 7) & (cap - 1); };
+
+#ifdef __SSE2__
+    /* Bit i is set if control byte g[i] equals b. */
+    static uint32_t matchByte(const uint8_t *g, uint8_t b) {
+        __m128i x = _mm_loadu_si128((const __m128i *) g);
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8((char) b)));
+    };
+
+    /* Bit i is set if control byte g[i] is EMPTY. */
+    static uint32_t matchEmpty(const uint8_t *g) {
+        return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) g));
+    };
+#else
+    static uint32_t matchByte(const uint8_t *g, uint8_t b) {
+        uint32_t m = 0;
+        for (size_type i = 0; i < GROUP; i++)
+            m |= (uint32_t) (g[i] == b) << i;
+        return m;
+    };
+
+    static uint32_t matchEmpty(const uint8_t *g) {
+        uint32_t m = 0;
+        for (size_type i = 0; i < GROUP; i++)
+            m |= (uint32_t) (g[i] >> 7) << i;
+        return m;
+    };
+#endif
+
+    /* Sets the control byte of slot i, keeping the cloned tail in step. */
+    void setCtrl(size_type i, uint8_t b) {
+        ctrl[i] = b;
+        if (i < GROUP)
+            ctrl[cap + i] = b;
+    };
+
+    /* Index of the slot holding key, or cap if it is not in the map. */
+    size_type findIndex(const K& key, uint64_t h) const {
+        if (cap == 0)
+            return cap;
+
+        size_type pos = home(h);
+        for (;;) {
+            const uint8_t *g = &ctrl[pos];
+            for (uint32_t m = matchByte(g, h2(h)); m != 0; m &= m - 1) {
+                size_type i = (pos + __builtin_ctz(m)) & (cap - 1);
+                if (slots[i].first == key)
+                    return i;
+            }
+            if (matchEmpty(g) != 0)
+                return cap;
+            pos = (pos + GROUP) & (cap - 1);
+        }
+    };
+
+    /* Index of the first free slot at or after the home of hash h. */
+    size_type findFree(uint64_t h) const {
+        size_type pos = home(h);
+        for (;;) {
+            uint32_t m = matchEmpty(&ctrl[pos]);
+            if (m != 0)
+                return (pos + __builtin_ctz(m)) & (cap - 1);
+            pos = (pos + GROUP) & (cap - 1);
+        }
+    };
+
+    /* Moves every entry into a fresh table of new_cap slots. */
+    void rehash(size_type new_cap) {
+        VectorBase<uint8_t> old_ctrl(new_cap + GROUP, new_cap + GROUP);
+        VectorBase<value_type> old_slots(new_cap, new_cap);
+        memset(&old_ctrl[0], EMPTY, new_cap + GROUP);
+        std::swap(ctrl, old_ctrl);
+        std::swap(slots, old_slots);
+        size_type old_cap = cap;
+        cap = new_cap;
+
+        for (size_type i = 0; i < old_cap; i++) {
+            if (old_ctrl[i] & EMPTY)
+                continue;
+            uint64_t h = hashOf(old_slots[i].first);
+            size_type j = findFree(h);
+            setCtrl(j, h2(h));
+            slots[j] = std::move(old_slots[i]);
+        }
+    };
+
+    /* Makes room for one more entry. */
+    void grow() {
+        if (len + 1 > cap / 8 * 7)
+            rehash(cap == 0 ? MIN_CAP : 2 * cap);
+    };
+
+    /* Slot of key, inserting a default value if it is not there yet. */
+    size_type findOrInsert(const K& key, bool& inserted) {
+        uint64_t h = hashOf(key);
+        size_type i = findIndex(key, h);
+        inserted = i == cap;
+        if (inserted) {
+            grow();
+            i = findFree(h);
+            setCtrl(i, h2(h));
+            slots[i].first = key;
+            len++;
+        }
+        return i;
+    };
+
+public:
+
+    /******************************
+     ITERATOR
+     ******************************/
+
+    /* Walks the occupied slots in table order. */
+    class iterator {
+        FlatHashMap *m;
+        size_type i;
+
+        void skip() {
+            while (i < m->cap && (m->ctrl[i] & EMPTY))
+                i++;
+        };
+
+    public:
+        iterator(FlatHashMap *m, size_type i) : m(m), i(i) { skip(); };
+
+        value_type& operator*() { return m->slots[i]; };
+        value_type *operator->() { return &m->slots[i]; };
+        iterator& operator++() { i++; skip(); return *this; };
+        bool operator==(const iterator& it) const { return i == it.i; };
+        bool operator!=(const iterator& it) const { return i != it.i; };
+    };
+
+    iterator begin() { return iterator(this, 0); };
+    iterator end() { return iterator(this, cap); };
+
+
+    /******************************
+     CONSTRUCTORS
+     ******************************/
+
+    FlatHashMap() : len(0), cap(0) {};
+    FlatHashMap(size_type n) : len(0), cap(0) { reserve(n); };
+
+
+    /******************************
+     ACCESSORS
+     ******************************/
+
+    size_type size() const { return len; };
+    size_type capacity() const { return cap; };
+    bool empty() const { return len == 0; };
+
+    /* Pointer to the value of key, or NULL if it is not in the map. */
+    V *find(const K& key) {
+        size_type i = findIndex(key, hashOf(key));
+        return i == cap ? NULL : &slots[i].second;
+    };
+
+    const V *find(const K& key) const {
+        size_type i = findIndex(key, hashOf(key));
+        return i == cap ? NULL : &slots[i].second;
+    };
+
+    bool contains(const K& key) const { return find(key) != NULL; };
+
+    /* Value of key.  Throws out_of_range if it is not in the map. */
+    V& at(const K& key) {
+        V *v = find(key);
+        if (v == NULL)
+            throw std::out_of_range("Key not in map.");
+        return *v;
+    };
+
+    const V& at(const K& key) const {
+        const V *v = find(key);
+        if (v == NULL)
+            throw std::out_of_range("Key not in map.");
+        return *v;
+    };
+
+    /* Value of key, inserting a default value if it is not there yet. */
+    V& operator[](const K& key) {
+        bool inserted;
+        return slots[findOrInsert(key, inserted)].second;
+    };
+
+
+    /******************************
+     MODIFIERS
+     ******************************/
+
+    /* Inserts key with value val unless key is already in the map.  Returns
+       true if it was inserted. */
+    bool insert(const K& key, const V& val) {
+        bool inserted;
+        size_type i = findOrInsert(key, inserted);
+        if (inserted)
+            slots[i].second = val;
+        return inserted;
+    };
+
+    /* Removes key from the map, returning true if it was there.  The entries
+       after it in its probe run move back to close the hole. */
+    bool erase(const K& key) {
+        size_type hole = findIndex(key, hashOf(key));
+        if (hole == cap)
+            return false;
+
+        size_type mask = cap - 1;
+        for (size_type j = (hole + 1) & mask; !(ctrl[j] & EMPTY);
+             j = (j + 1) & mask) {
+            /* The entry at j can fill the hole unless its home lies
+               cyclically in (hole, j]. */
+            size_type want = home(hashOf(slots[j].first));
+            if (((j - want) & mask) >= ((j - hole) & mask)) {
+                slots[hole] = std::move(slots[j]);
+                setCtrl(hole, ctrl[j]);
+                hole = j;
+            }
+        }
+
+        setCtrl(hole, EMPTY);
+        slots[hole] = value_type();
+        len--;
+        return true;
+    };
+
+    /* Removes every entry, keeping the capacity. */
+    void clear() {
+        for (size_type i = 0; i < cap; i++)
+            if (!(ctrl[i] & EMPTY))
+                slots[i] = value_type();
+        if (cap != 0)
+            memset(&ctrl[0], EMPTY, cap + GROUP);
+        len = 0;
+    };
+
+    /* Makes room for n entries without growing. */
+    void reserve(size_type n) {
+        size_type want = smallestPow2(n + n / 7 + 1);
+        if (want < MIN_CAP)
+            want = MIN_CAP;
+        if (want > cap)
+            rehash(want);
+    };
+};
+
+#endif // ifndef HASHMAP
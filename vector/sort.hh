@@ -0,0 +1,356 @@
+/*
+ sort.hh
+
+ Implements sorting kernels for Vectors of integral and floating point keys:
+ a multi-threaded LSD radix sort (optionally carrying a payload alongside the
+ keys) and a branch-free merge of presorted runs.
+*/
+
+#ifndef SORT
+#define SORT
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+#include "vector.hh"
+
+/******************************************************************************
+
+ RADIX KEYS
+
+ Maps each key type onto an unsigned integer of the same width whose unsigned
+ ordering matches the ordering of the original keys.  Radix sort only ever
+ looks at these encoded keys.
+
+******************************************************************************/
+template <typename T, size_t Bytes = sizeof(T),
+          bool Float = std::is_floating_point<T>::value>
+struct RadixKey;
+
+/* Integral keys: flip the sign bit of signed types so negatives come first. */
+template <typename T, size_t Bytes>
+struct RadixKey<T, Bytes, false> {
+    typedef typename std::make_unsigned<T>::type type;
+
+    static type encode(T x) {
+        const type flip = std::is_signed<T>::value ?
+            (type) 1 << (8 * sizeof(T) - 1) : 0;
+        return (type) x ^ flip;
+    };
+};
+
+/* Floating point keys: negatives have every bit flipped (so larger
+   magnitudes sort first), positives only have the sign bit flipped. */
+template <typename T>
+struct RadixKey<T, 4, true> {
+    typedef uint32_t type;
+
+    static type encode(T x) {
+        type u;
+        memcpy(&u, &x, sizeof(u));
+        return u ^ ((type) -(int32_t) (u >> 31) | 0x80000000u);
+    };
+};
+
+template <typename T>
+struct RadixKey<T, 8, true> {
+    typedef uint64_t type;
+
+    static type encode(T x) {
+        type u;
+        memcpy(&u, &x, sizeof(u));
+        return u ^ ((type) -(int64_t) (u >> 63) | 0x8000000000000000ull);
+    };
+};
+
+/******************************************************************************
+
+ RADIX SORT KERNEL
+
+ Sorts raw arrays of keys and (optionally) payloads.  Every pass splits the
+ input into one contiguous chunk per thread.  Each thread counts the digits in
+ its own chunk, the histograms are turned into per-thread output offsets, and
+ then each thread scatters its chunk.  Since thread t's elements for a digit
+ are placed after those of threads 0..t-1, every pass is stable.
+
+******************************************************************************/
+
+/* Below this many elements radix sort loses to introsort. */
+static const size_t RADIX_MIN = 1 << 10;
+
+/* Each thread should have at least this many elements to be worth it. */
+static const size_t RADIX_MIN_PER_THREAD = 1 << 16;
+
+/* Digits are one byte wide. */
+static const unsigned RADIX_BITS = 8;
+static const size_t RADIX_BUCKETS = 1 << RADIX_BITS;
+
+/* Stands in for the payload when only keys are being sorted. */
+struct NoPayload {};
+
+/* Moves a payload element from one buffer to the other. */
+template <typename V>
+static inline void movePayload(V *dst, size_t to, const V *src, size_t from) {
+    dst[to] = src[from];
+}
+static inline void movePayload(NoPayload *, size_t, const NoPayload *,
+                               size_t) {}
+
+/* Allocates an uninitialized scratch buffer like VectorBase does. */
+template <typename T>
+static T *scratchBuffer(size_t n) {
+    T *buf = (T*) malloc(n * sizeof(T));
+    if (n != 0 and !buf) {
+        fprintf(stderr, "ran out of memory");
+        exit(1);
+    }
+    return buf;
+}
+
+/* Allocates the scratch buffer for a payload, if there is one. */
+template <typename V>
+static V *payloadBuffer(V *, size_t n) { return scratchBuffer<V>(n); }
+static inline NoPayload *payloadBuffer(NoPayload *, size_t) { return NULL; }
+
+/* Returns the number of threads to use to sort n elements.  A thread count of
+   zero means use every hardware thread. */
+static inline unsigned sortThreads(size_t n, unsigned threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    /* Don't hand out chunks too small to amortize starting a thread. */
+    size_t most = std::max((size_t) 1, n / RADIX_MIN_PER_THREAD);
+    return (unsigned) std::min((size_t) threads, most);
+}
+
+/* Runs f(t) for every t in [0, threads), on its own thread unless there is
+   only one. */
+template <typename F>
+static void forEachThread(unsigned threads, F f) {
+    if (threads == 1) {
+        f(0);
+        return;
+    }
+
+    std::thread *pool = new std::thread[threads - 1];
+    for (unsigned t = 1; t < threads; t++)
+        pool[t - 1] = std::thread(f, t);
+    f(0);
+    for (unsigned t = 1; t < threads; t++)
+        pool[t - 1].join();
+    delete[] pool;
+}
+
+/* Sorts keys[0..n), permuting vals alongside when it is a real payload. */
+template <typename K, typename V>
+static void radixSortKernel(K *keys, V *vals, size_t n, unsigned threads) {
+    typedef RadixKey<K> Key;
+    const unsigned passes = sizeof(K) * 8 / RADIX_BITS;
+
+    K *keyBuf = scratchBuffer<K>(n);
+    V *valBuf = payloadBuffer(vals, n);
+
+    /* One histogram (and later one set of offsets) per thread. */
+    size_t *counts = new size_t[threads * RADIX_BUCKETS];
+    size_t chunk = (n + threads - 1) / threads;
+
+    K *srcKeys = keys, *dstKeys = keyBuf;
+    V *srcVals = vals, *dstVals = valBuf;
+
+    for (unsigned pass = 0; pass < passes; pass++) {
+        const unsigned shift = pass * RADIX_BITS;
+
+        /* Count the digits in every chunk. */
+        forEachThread(threads, [&](unsigned t) {
+            size_t *count = counts + t * RADIX_BUCKETS;
+            size_t lo = std::min(n, t * chunk), hi = std::min(n, lo + chunk);
+            memset(count, 0, RADIX_BUCKETS * sizeof(size_t));
+            for (size_t i = lo; i < hi; i++)
+                count[(Key::encode(srcKeys[i]) >> shift) & (RADIX_BUCKETS-1)]++;
+        });
+
+        /* Turn counts into output offsets, bucket major then thread.  If one
+           bucket holds everything this digit is constant and the pass can be
+           skipped. */
+        bool trivial = false;
+        size_t offset = 0;
+        for (size_t d = 0; d < RADIX_BUCKETS; d++) {
+            size_t total = 0;
+            for (unsigned t = 0; t < threads; t++) {
+                size_t c = counts[t * RADIX_BUCKETS + d];
+                counts[t * RADIX_BUCKETS + d] = offset + total;
+                total += c;
+            }
+            trivial = trivial || total == n;
+            offset += total;
+        }
+        if (trivial)
+            continue;
+
+        /* Scatter every chunk into place. */
+        forEachThread(threads, [&](unsigned t) {
+            size_t *next = counts + t * RADIX_BUCKETS;
+            size_t lo = std::min(n, t * chunk), hi = std::min(n, lo + chunk);
+            for (size_t i = lo; i < hi; i++) {
+                size_t digit =
+                    (Key::encode(srcKeys[i]) >> shift) & (RADIX_BUCKETS-1);
+                size_t to = next[digit]++;
+                dstKeys[to] = srcKeys[i];
+                movePayload(dstVals, to, srcVals, i);
+            }
+        });
+
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcVals, dstVals);
+    }
+
+    /* An odd number of passes leaves the result in the scratch buffers. */
+    if (srcKeys != keys) {
+        memcpy((void *) keys, (void *) srcKeys, n * sizeof(K));
+        for (size_t i = 0; i < n; i++)
+            movePayload(vals, i, srcVals, i);
+    }
+
+    delete[] counts;
+    free(keyBuf);
+    free(valBuf);
+}
+
+/******************************************************************************
+
+ MERGING
+
+ Merges presorted runs.  The inner loop selects with conditional moves rather
+ than branches, so it does not stall on unpredictable comparisons and the
+ compiler is free to vectorize the tail copies.
+
+******************************************************************************/
+
+/* Merges the sorted ranges a[0..na) and b[0..nb) into out.  Ties are taken
+   from a first, so the merge is stable. */
+template <typename T>
+static void mergeSorted(const T *a, size_t na, const T *b, size_t nb, T *out) {
+    size_t i = 0, j = 0, k = 0;
+
+    while (i < na && j < nb) {
+        T x = a[i], y = b[j];
+        bool takeB = y < x;
+        out[k++] = takeB ? y : x;
+        j += takeB;
+        i += !takeB;
+    }
+
+    /* Only one of these copies anything. */
+    memcpy((void *) (out + k), (void *) (a + i), (na - i) * sizeof(T));
+    k += na - i;
+    memcpy((void *) (out + k), (void *) (b + j), (nb - j) * sizeof(T));
+}
+
+/* Merges the sorted runs of v, which begin at the argued (increasing) offsets
+   with the first at 0, into a single sorted run.  Pairs of runs are merged
+   bottom up, with the merges of each round spread across threads.  A thread
+   count of zero means use every hardware thread. */
+template <typename T>
+void mergeRuns(Vector<T>& v, const Vector<size_t>& starts,
+               unsigned threads = 0) {
+    static_assert(std::is_arithmetic<T>::value,
+                  "mergeRuns sorts arithmetic types only");
+
+    size_t n = v.size();
+    if (starts.size() < 2 || n == 0)
+        return;
+    assert(starts[0] == 0);
+
+    /* Run boundaries, with n tacked onto the end. */
+    Vector<size_t> bounds;
+    for (size_t r = 0; r < starts.size(); r++)
+        bounds.push_back(starts[r]);
+    bounds.push_back(n);
+
+    T *src = v.begin();
+    T *dst = scratchBuffer<T>(n);
+
+    while (bounds.size() > 2) {
+        size_t runs = bounds.size() - 1;
+        size_t pairs = (runs + 1) / 2;
+        unsigned t = std::max(1u,
+            std::min(sortThreads(n, threads), (unsigned) pairs));
+
+        /* Merge run 2p with run 2p+1 for every pair p this thread owns. */
+        forEachThread(t, [&](unsigned id) {
+            for (size_t p = id; p < pairs; p += t) {
+                size_t lo = bounds[2*p];
+                size_t mid = bounds[std::min(2*p + 1, runs)];
+                size_t hi = bounds[std::min(2*p + 2, runs)];
+                mergeSorted(src + lo, mid - lo, src + mid, hi - mid, dst + lo);
+            }
+        });
+
+        /* Every other boundary disappears. */
+        for (size_t p = 0; p < pairs; p++)
+            bounds[p] = bounds[2*p];
+        bounds[pairs] = n;
+        bounds.resize(pairs + 1);
+
+        std::swap(src, dst);
+    }
+
+    /* Make sure the result ends up in v. */
+    if (src != v.begin()) {
+        memcpy((void *) v.begin(), (void *) src, n * sizeof(T));
+        free(src);
+    }
+    else {
+        free(dst);
+    }
+}
+
+/******************************************************************************
+
+ RADIX SORT
+
+ Sorts Vectors of integral and floating point keys.  Small inputs of keys alone
+ fall back to std::sort (introsort).  A thread count of zero means use every
+ hardware thread.  Floating point keys are ordered by value, with -0.0 before
+ 0.0 and NaNs at the ends according to their sign bit.
+
+******************************************************************************/
+
+/* Sorts the argued vector in ascending order. */
+template <typename K>
+void radixSort(Vector<K>& keys, unsigned threads = 0) {
+    static_assert(std::is_arithmetic<K>::value,
+                  "radixSort sorts arithmetic keys only");
+
+    size_t n = keys.size();
+    if (n < RADIX_MIN) {
+        std::sort(keys.begin(), keys.end(), [](K a, K b) {
+            return RadixKey<K>::encode(a) < RadixKey<K>::encode(b);
+        });
+        return;
+    }
+
+    radixSortKernel(keys.begin(), (NoPayload*) NULL, n,
+                    sortThreads(n, threads));
+}
+
+/* Sorts the keys in ascending order, applying the same permutation to the
+   payload.  Elements with equal keys keep their relative order. */
+template <typename K, typename V>
+void radixSort(Vector<K>& keys, Vector<V>& vals, unsigned threads = 0) {
+    static_assert(std::is_arithmetic<K>::value,
+                  "radixSort sorts arithmetic keys only");
+    static_assert(std::is_trivially_copyable<V>::value,
+                  "radixSort payloads must be trivially copyable");
+    assert(keys.size() == vals.size());
+
+    /* No fallback here since introsort is not stable. */
+    size_t n = keys.size();
+    radixSortKernel(keys.begin(), vals.begin(), n, sortThreads(n, threads));
+}
+
+#endif // ifndef SORT
@@ -1,9 +1,16 @@
 #include "testbase.hh"
 #include "vector.hh"
+#include "sort.hh"
+#include "codec.hh"
+#include "hashmap.hh"
 
 #include <algorithm>
+#include <climits>
 #include <cstdlib>
 #include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 
 using namespace std;
@@ -488,7 +495,7 @@ void test_insert_and_erase_with_pointers(TestContext &ctx) {
 
     ctx.CHECK(v.at(0) == insert_val);
     ctx.CHECK(*v.begin() == insert_val);
-    for (size_t i = 0; i < insert_offset - 1; i++) {
+    for (size_t i = 0; i + 1 < insert_offset; i++) {
         ctx.CHECK(v.at(i + 1) == ptrs[i]);
     }
 
@@ -698,7 +705,7 @@ void test_insert_and_erase_with_bools(TestContext &ctx) {
 
     ctx.CHECK(v.at(0) == insert_val);
     ctx.CHECK(*v.begin() == insert_val);
-    for (int i = 0; i < insert_offset - 1; i++) {
+    for (size_t i = 0; i + 1 < insert_offset; i++) {
         ctx.CHECK(v.at(i + 1) == bools[i]);
     }
 
@@ -706,6 +713,395 @@ void test_insert_and_erase_with_bools(TestContext &ctx) {
 }
 
 
+/*===========================================================================
+ * NEW TEST FUNCTIONS 3
+ *
+ * Sizes and indices are size_t, so vectors can grow past 2^32 elements.
+ */
+
+void test_large_sizes(TestContext &ctx) {
+    ctx.DESC("smallestPow2 handles sizes past 2^32");
+
+    const size_t two32 = (size_t) 1 << 32;
+    ctx.CHECK(smallestPow2(0) == 0);
+    ctx.CHECK(smallestPow2(two32) == two32);
+    ctx.CHECK(smallestPow2(two32 + 1) == two32 << 1);
+    ctx.CHECK(smallestPow2((two32 << 20) - 3) == two32 << 20);
+
+    ctx.result();
+
+    ctx.DESC("Vector<bool> indexes bits past 2^32");
+
+    // Index 2^32 + 33 would alias bit 33 if word math were 32 bits wide.
+    const size_t len = two32 + 40;
+    Vector<bool> v;
+    v.resize(len);
+    ctx.CHECK(v.size() == len);
+    ctx.CHECK(v.capacity() >= len);
+    ctx.CHECK(v.end() - v.begin() == (ptrdiff_t) len);
+
+    v[two32 + 33] = true;
+    ctx.CHECK(v.at(two32 + 33) == true);
+    ctx.CHECK(v.at(33) == false);
+    ctx.CHECK(v.at(two32 + 32) == false);
+
+    v.resize(two32 + 34);
+    ctx.CHECK(v.size() == two32 + 34);
+    ctx.CHECK(v.at(two32 + 33) == true);
+    v.resize(two32 + 33);
+    v.resize(len);
+    ctx.CHECK(v.at(two32 + 33) == false);
+
+    ctx.result();
+}
+
+
+/*===========================================================================
+ * NEW TEST FUNCTIONS 4
+ *
+ * Radix sort and run merging.
+ */
+
+/* True if v holds exactly the values of ref once ref is sorted. */
+template <typename T>
+bool matchesSorted(Vector<T> &v, std::vector<T> ref) {
+    std::sort(ref.begin(), ref.end());
+    if (v.size() != ref.size())
+        return false;
+    for (size_t i = 0; i < ref.size(); i++)
+        if (!(v[i] == ref[i]))
+            return false;
+    return true;
+}
+
+void test_radix_sort(TestContext &ctx) {
+    const size_t NUMVALS = 300000;
+
+    ctx.DESC("radixSort() sorts Vector<int> on 1 and 4 threads");
+
+    for (unsigned threads = 1; threads <= 4; threads += 3) {
+        Vector<int> v;
+        std::vector<int> ref;
+        for (size_t i = 0; i < NUMVALS; i++) {
+            int x = rand() - RAND_MAX / 2;
+            v.push_back(x);
+            ref.push_back(x);
+        }
+        radixSort(v, threads);
+        ctx.CHECK(matchesSorted(v, ref));
+    }
+
+    ctx.result();
+
+    ctx.DESC("radixSort() sorts Vector<uint32_t> and Vector<float>");
+
+    Vector<uint32_t> vu;
+    std::vector<uint32_t> refu;
+    Vector<float> vf;
+    std::vector<float> reff;
+    for (size_t i = 0; i < NUMVALS; i++) {
+        uint32_t u = (uint32_t) rand() * 2654435761u;
+        float f = (float) (rand() - RAND_MAX / 2) / 1024.0f;
+        vu.push_back(u);
+        refu.push_back(u);
+        vf.push_back(f);
+        reff.push_back(f);
+    }
+    radixSort(vu, 4);
+    radixSort(vf, 4);
+    ctx.CHECK(matchesSorted(vu, refu));
+    ctx.CHECK(matchesSorted(vf, reff));
+
+    ctx.result();
+
+    ctx.DESC("radixSort() falls back on small inputs");
+
+    Vector<int> small;
+    std::vector<int> refs;
+    for (int i = 0; i < 100; i++) {
+        small.push_back(rand() % 50 - 25);
+        refs.push_back(small[i]);
+    }
+    radixSort(small);
+    ctx.CHECK(matchesSorted(small, refs));
+
+    Vector<int> empty;
+    radixSort(empty);
+    ctx.CHECK(empty.size() == 0);
+
+    ctx.result();
+
+    ctx.DESC("radixSort() of (key, payload) pairs is stable");
+
+    Vector<int> keys;
+    Vector<uint32_t> vals;
+    std::vector<int> refk;
+    for (size_t i = 0; i < NUMVALS; i++) {
+        keys.push_back(rand() % 16 - 8);
+        vals.push_back((uint32_t) i);
+        refk.push_back(keys[i]);
+    }
+    radixSort(keys, vals, 4);
+    ctx.CHECK(matchesSorted(keys, refk));
+    for (size_t i = 0; i < NUMVALS; i++) {
+        ctx.CHECK(refk[vals[i]] == keys[i]);
+        if (i > 0 && keys[i] == keys[i-1])
+            ctx.CHECK(vals[i] > vals[i-1]);
+    }
+
+    ctx.result();
+}
+
+void test_merge_runs(TestContext &ctx) {
+    ctx.DESC("mergeRuns() merges presorted runs");
+
+    const size_t lens[5] = { 1000, 1, 70000, 0, 33333 };
+    Vector<int> v;
+    Vector<size_t> starts;
+    std::vector<int> ref;
+    for (size_t r = 0; r < 5; r++) {
+        starts.push_back(v.size());
+        std::vector<int> run;
+        for (size_t i = 0; i < lens[r]; i++)
+            run.push_back(rand() % 100000);
+        std::sort(run.begin(), run.end());
+        for (size_t i = 0; i < run.size(); i++) {
+            v.push_back(run[i]);
+            ref.push_back(run[i]);
+        }
+    }
+    mergeRuns(v, starts, 2);
+    ctx.CHECK(matchesSorted(v, ref));
+
+    ctx.result();
+}
+
+
+/*===========================================================================
+ * NEW TEST FUNCTIONS 5
+ *
+ * Varint, delta and bit-packing codecs.
+ */
+
+/* Values with every magnitude from 0 to the 32-bit extremes. */
+Vector<int> makeCodecValues(size_t n) {
+    Vector<int> v;
+    v.push_back(0);
+    v.push_back(-1);
+    v.push_back(INT_MAX);
+    v.push_back(INT_MIN);
+    v.push_back(INT_MIN);
+    for (size_t i = v.size(); i < n; i++)
+        v.push_back((rand() - RAND_MAX / 2) >> (rand() % 31));
+    return v;
+}
+
+/* Increasing IDs with small gaps. */
+Vector<int> makeSortedIds(size_t n) {
+    Vector<int> v;
+    int id = 1000000;
+    for (size_t i = 0; i < n; i++) {
+        id += 1 + rand() % 40;
+        v.push_back(id);
+    }
+    return v;
+}
+
+bool sameValues(Vector<int> &a, Vector<int> &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++)
+        if (a[i] != b[i])
+            return false;
+    return true;
+}
+
+void test_codecs(TestContext &ctx) {
+    const Codec codecs[3] = { ZIGZAG_VARINT, DELTA_VARINT, FOR_BITPACK };
+    const size_t NUMVALS = 10000;
+
+    ctx.DESC("Codecs round trip extreme and random values");
+
+    for (int c = 0; c < 3; c++) {
+        Vector<int> v = makeCodecValues(NUMVALS);
+        Vector<uint8_t> bytes;
+        Vector<int> out;
+        VectorEncoder enc(codecs[c]);
+        VectorDecoder dec(codecs[c]);
+
+        enc.encode(v, bytes);
+        ctx.CHECK(dec.decode(bytes, out) == bytes.size());
+        ctx.CHECK(sameValues(v, out));
+    }
+
+    ctx.result();
+
+    ctx.DESC("Codecs encode and decode incrementally");
+
+    for (int c = 0; c < 3; c++) {
+        Vector<int> v = makeSortedIds(NUMVALS);
+        Vector<uint8_t> bytes;
+        VectorEncoder enc(codecs[c]);
+
+        // Encode in uneven chunks.
+        for (size_t i = 0; i < v.size(); ) {
+            size_t n = std::min(v.size() - i, (size_t) (rand() % 300));
+            enc.encode(&v[i], n, bytes);
+            i += n;
+        }
+
+        // Decode as the bytes trickle in, keeping any incomplete tail.
+        Vector<int> out;
+        VectorDecoder dec(codecs[c]);
+        size_t used = 0, avail = 0;
+        while (avail < bytes.size()) {
+            avail = std::min(bytes.size(), avail + 1 + rand() % 50);
+            used += dec.decode(&bytes[used], avail - used, out);
+        }
+        ctx.CHECK(used == bytes.size());
+        ctx.CHECK(sameValues(v, out));
+    }
+
+    ctx.result();
+
+    ctx.DESC("Delta coding shrinks sorted IDs");
+
+    Vector<int> ids = makeSortedIds(NUMVALS);
+    Vector<uint8_t> plain, delta, packed;
+    VectorEncoder(ZIGZAG_VARINT).encode(ids, plain);
+    VectorEncoder(DELTA_VARINT).encode(ids, delta);
+    VectorEncoder(FOR_BITPACK).encode(ids, packed);
+    // Gaps under 64 take one byte each, after the first ID.
+    ctx.CHECK(plain.size() > 3 * NUMVALS);
+    ctx.CHECK(delta.size() < NUMVALS + VARINT_MAX);
+    ctx.CHECK(packed.size() < 2 * NUMVALS);
+
+    ctx.result();
+
+    ctx.DESC("Decoding a malformed varint throws");
+
+    bool pass = false;
+    try {
+        Vector<int> out;
+        const uint8_t bad[6] = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 };
+        VectorDecoder(ZIGZAG_VARINT).decode(bad, 6, out);
+        pass = false;
+    }
+    catch (invalid_argument &ia) {
+        pass = true;
+    }
+    catch (...) {
+        pass = false;
+    }
+    ctx.CHECK(pass);
+
+    ctx.result();
+}
+
+/* Sends every key to the same slot, so every entry shares one probe run. */
+struct CollidingHash {
+    size_t operator()(int) const { return 0; }
+};
+
+/* True if m holds exactly the entries of ref. */
+template <typename M>
+bool sameEntries(M &m, std::unordered_map<int, int> &ref) {
+    if (m.size() != ref.size())
+        return false;
+    for (auto &e : ref) {
+        const int *v = m.find(e.first);
+        if (v == NULL || *v != e.second)
+            return false;
+    }
+    size_t n = 0;
+    for (auto it = m.begin(); it != m.end(); ++it, ++n)
+        if (ref.count(it->first) == 0)
+            return false;
+    return n == ref.size();
+}
+
+void test_flat_hash_map(TestContext &ctx) {
+    const int NUMOPS = 100000;
+
+    ctx.DESC("FlatHashMap matches unordered_map under random operations");
+
+    FlatHashMap<int, int> m;
+    std::unordered_map<int, int> ref;
+    for (int i = 0; i < NUMOPS; i++) {
+        int key = rand() % 5000;
+        switch (rand() % 4) {
+        case 0:
+            ctx.CHECK(m.insert(key, i) == ref.insert({ key, i }).second);
+            break;
+        case 1:
+            m[key] = i;
+            ref[key] = i;
+            break;
+        case 2:
+            ctx.CHECK(m.erase(key) == (ref.erase(key) == 1));
+            break;
+        case 3:
+            ctx.CHECK(m.contains(key) == (ref.count(key) == 1));
+            break;
+        }
+    }
+    ctx.CHECK(sameEntries(m, ref));
+    ctx.CHECK(m.capacity() >= m.size());
+    ctx.CHECK((m.capacity() & (m.capacity() - 1)) == 0);
+
+    ctx.result();
+
+    ctx.DESC("FlatHashMap erases without tombstones in one long probe run");
+
+    FlatHashMap<int, int, CollidingHash> c;
+    std::unordered_map<int, int> cref;
+    for (int i = 0; i < 300; i++) {
+        c[i] = i;
+        cref[i] = i;
+    }
+    for (int i = 0; i < 300; i += 3) {
+        c.erase(i);
+        cref.erase(i);
+    }
+    ctx.CHECK(sameEntries(c, cref));
+    // Refilling reuses the freed slots rather than growing.
+    size_t cap = c.capacity();
+    for (int i = 0; i < 300; i += 3)
+        c[i] = i;
+    ctx.CHECK(c.size() == 300 && c.capacity() == cap);
+
+    ctx.result();
+
+    ctx.DESC("FlatHashMap copies, clears, reserves and checks bounds");
+
+    FlatHashMap<std::string, int> s(1000);
+    size_t reserved = s.capacity();
+    for (int i = 0; i < 1000; i++)
+        s[std::to_string(i)] = i;
+    ctx.CHECK(s.capacity() == reserved);
+
+    FlatHashMap<std::string, int> copy(s);
+    s.clear();
+    ctx.CHECK(s.empty() && !s.contains("7"));
+    ctx.CHECK(copy.size() == 1000 && copy.at("999") == 999);
+
+    bool pass = false;
+    try {
+        copy.at("1000");
+        pass = false;
+    }
+    catch (out_of_range &oor) {
+        pass = true;
+    }
+    catch (...) {
+        pass = false;
+    }
+    ctx.CHECK(pass);
+
+    ctx.result();
+}
+
+
 /*! This program is a simple test-suite for the Rational class. */
 int main() {
 
@@ -727,6 +1123,11 @@ int main() {
     test_bit_accesses(ctx);
     test_size_manipulation_with_bools(ctx);
     test_insert_and_erase_with_bools(ctx);
+    test_large_sizes(ctx);
+    test_radix_sort(ctx);
+    test_merge_runs(ctx);
+    test_codecs(ctx);
+    test_flat_hash_map(ctx);
 
     // Return 0 if everything passed, nonzero if something failed.
     return !ctx.ok();
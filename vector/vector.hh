@@ -11,7 +11,15 @@
 #define VECTOR
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 #include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <assert.h>
 #include <stdint.h>
 #include "common.hh"
@@ -28,40 +36,94 @@ class VectorBase {
 
 private:
     T *arr;                 /* Array of elements of type T */
-    int len;                /* Size of the array */
-    int cap;                /* Capacity of the array */
+    size_t len;             /* Size of the array */
+    size_t cap;             /* Capacity of the array */
 
-    /* Initializes the array pointer */
-    void init() {
-        arr = cap == 0 ? NULL : (T*) malloc(cap * sizeof(T));
-        if (cap != 0 and !arr) {
+    /* Elements that can be copied with memcpy and moved with realloc.  Every
+       slot up to the capacity always holds a constructed element. */
+    static const bool trivial = std::is_trivially_copyable<T>::value;
+
+    /* Allocates space for n elements, exiting if we are out of memory. */
+    static T *allocate(size_t n) {
+        T *out = (T*) malloc(n * sizeof(T));
+        if (n != 0 and !out) {
             fprintf(stderr, "ran out of memory");
             exit(1);
         }
-        for (int i = 0; i < cap; ++i)
-            arr[i] = T();
+        return out;
     };
 
-    /* Re-initializes the array pointer, assuming arr is defined. */
-    void reinit(int new_cap) {
-        /* Don't want this to be called with a zero-argument. */
-        if (new_cap == 0 && arr) delete arr;
+    /* Default constructs elements [from, to) of the array. */
+    void construct(size_t from, size_t to) {
+        for (size_t i = from; i < to; ++i)
+            new (arr + i) T();
+    };
+
+    /* Destroys elements [from, to) of the array. */
+    void destroy(size_t from, size_t to) {
+        if (!trivial)
+            for (size_t i = from; i < to; ++i)
+                arr[i].~T();
+    };
+
+    /* Initializes the array pointer */
+    void init() {
+        arr = cap == 0 ? NULL : allocate(cap);
+        construct(0, cap);
+    };
+
+    /* Re-initializes the array pointer, assuming arr is defined.  The new
+       capacity must hold at least len elements. */
+    void reinit(size_t new_cap) {
+        /* Drop any elements past the new capacity */
+        destroy(new_cap, cap);
+        if (new_cap == 0) {
+            free(arr);
+            arr = NULL;
+        }
         /* Make space for new array size, copying over contents */
-        arr = new_cap == 0 ? NULL : (T*) realloc(arr, new_cap * sizeof(T));
-        if (cap != 0 and !arr) {
-            fprintf(stderr, "ran out of memory");
-            exit(1);
+        else if (trivial) {
+            arr = (T*) realloc((void *) arr, new_cap * sizeof(T));
+            if (!arr) {
+                fprintf(stderr, "ran out of memory");
+                exit(1);
+            }
+        }
+        /* Anything else has to be moved element by element */
+        else {
+            T *next = allocate(new_cap);
+            for (size_t i = 0; i < std::min(cap, new_cap); ++i) {
+                new (next + i) T(std::move(arr[i]));
+                arr[i].~T();
+            }
+            free(arr);
+            arr = next;
         }
         /* Initialize anything new */
-        for (int i = cap; i < new_cap; ++i)
-            arr[i] = T();
-        /* Update capacity */
+        size_t old_cap = cap;
         cap = new_cap;
+        construct(old_cap, new_cap);
+    };
+
+    /* Destroys every element and frees the array. */
+    void release() {
+        destroy(0, cap);
+        free(arr);
+        arr = NULL;
+        len = cap = 0;
+    };
+
+    /* Makes room for one more element at the end. */
+    void grow() {
+        if (len >= cap)
+            reinit(std::max((size_t) 1, cap) << 1);
     };
 
 public:
 
     typedef T* iterator;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
 
 
     /******************************
@@ -69,19 +131,28 @@ public:
      ******************************/
 
     VectorBase() : len(0), cap(0) { init(); };
-    VectorBase(int size) : len(size), cap(smallestPow2(size)) { init(); };
-    VectorBase(int size, int cap) : len(size), cap(cap) { init(); };
+    VectorBase(size_type size) : len(size), cap(smallestPow2(size)) { init(); };
+    VectorBase(size_type size, size_type cap) :
+        len(size), cap(std::max(size, cap)) { init(); };
 
     /* Copy constructor */
     VectorBase(const VectorBase<T>& v) : len(v.size()), cap(v.capacity()) {
-        init();
-        memcpy((void *) arr, (void *) v.arr, cap * sizeof(T));
+        arr = cap == 0 ? NULL : allocate(cap);
+        if (trivial) {
+            if (cap != 0)
+                memcpy((void *) arr, (void *) v.arr, cap * sizeof(T));
+        }
+        else {
+            for (size_t i = 0; i < len; ++i)
+                new (arr + i) T(v.arr[i]);
+            construct(len, cap);
+        }
     };
 
     /* Move constructor */
     VectorBase(VectorBase<T>&& v) {
-        memcpy((void *) this, (void *) &v, sizeof(VectorBase<T>&&));
-        memset((void *) &v, 0, sizeof(VectorBase<T>&&));
+        memcpy((void *) this, (void *) &v, sizeof(VectorBase<T>));
+        memset((void *) &v, 0, sizeof(VectorBase<T>));
     };
 
 
@@ -89,21 +160,18 @@ public:
      DESTRUCTOR
      ******************************/
 
-    ~VectorBase() {
-        if (arr) delete arr;
-        arr = NULL;
-    };
+    ~VectorBase() { release(); };
 
 
     /******************************
      ACCESSORS
      ******************************/
 
-    int size() const { return len; };
-    int capacity() const { return cap; };
+    size_type size() const { return len; };
+    size_type capacity() const { return cap; };
 
     /* Returns the element at the argued index. */
-    T at(int i) { return arr[i]; };
+    T at(size_type i) { return arr[i]; };
 
     /* Returns an iterator at the beginning of the array, pointing to the
        first element. */
@@ -118,25 +186,25 @@ public:
      ******************************/
 
     /* Copy assignment */
-    VectorBase operator=(const VectorBase<T>& v) {
+    VectorBase& operator=(const VectorBase<T>& v) {
         if (this != &v)
             *this = VectorBase(v);
         return *this;
     };
 
     /* Move assignment */
-    VectorBase operator=(const VectorBase<T>&& v) {
+    VectorBase& operator=(VectorBase<T>&& v) {
         if (this != &v) {
-            if (arr) delete arr;
-            memcpy((void *) this, (void *) &v, sizeof(VectorBase<T>&&));
-            memset((void *) &v, 0, sizeof(VectorBase<T>&&));
+            release();
+            memcpy((void *) this, (void *) &v, sizeof(VectorBase<T>));
+            memset((void *) &v, 0, sizeof(VectorBase<T>));
         }
         return *this;
     };
 
     /* Access an element in the array. */
-    T& operator[](int i) { return arr[i]; };
-    const T& operator[](int i) const { return arr[i]; };
+    T& operator[](size_type i) { return arr[i]; };
+    const T& operator[](size_type i) const { return arr[i]; };
 
 
     /******************************
@@ -145,7 +213,7 @@ public:
 
     /* Updates the capacity and allocates space for it.  If the new capacity is
        smaller than the current one, nothing happens. */
-    void reserve(int new_cap) {
+    void reserve(size_type new_cap) {
         /* Only change anything if new cap is larger */
         if (new_cap > cap)
             reinit(new_cap);
@@ -161,13 +229,13 @@ public:
 
     /* Resizes the array.  This initializes anything that was previously within
        size but no longer is. */
-    void resize(int count) {
+    void resize(size_type count) {
         /* If we need more space, we need to reallocate */
         if (count > cap)
             reinit(smallestPow2(count));
 
         /* Now resize, clearing anything that is no longer in use */
-        for (int i = count; i < len; ++i)
+        for (size_type i = count; i < len; ++i)
             arr[i] = T();
 
         /* Update size */
@@ -180,9 +248,14 @@ public:
 
     /* Appends element to the end of the array. */
     void push_back(const T& elem) {
-        /* If we need more space, allocate it. */
-        while (len >= cap)
-            reinit(std::max(1, cap) << 1);
+        /* If we need more space, allocate it.  The element might live in the
+           array, so take a copy before it moves. */
+        if (len >= cap) {
+            T copy(elem);
+            grow();
+            arr[len++] = std::move(copy);
+            return;
+        }
 
         /* Add to the end of the array and increment len */
         arr[len++] = elem;
@@ -191,56 +264,53 @@ public:
     /* Appends element to the end of the array. */
     void push_back(T&& elem) {
         /* If we need more space, allocate it. */
-        while (len >= cap)
-            reinit(std::max(1, cap) << 1);
+        if (len >= cap) {
+            T moved(std::move(elem));
+            grow();
+            arr[len++] = std::move(moved);
+            return;
+        }
 
         /* Add to the end of the array and increment len */
-        arr[len++] = elem;
+        arr[len++] = std::move(elem);
     };
 
     /* Inserts an element at the specified position, pushing everything else
        back. */
     void insert(iterator pos, const T& elem) {
-        /* We might need more space for the new element. */
-        push_back(arr[len-1]);
-
-        /* Insert the element and push everything else back. */
-        iterator it = end()-1;
-        while (--it >= pos)
-            *(it+1) = *it;
-        *pos = elem;
+        insert(pos, T(elem));
     };
 
     /* Inserts an element at the specified position, pushing everything else
        back. */
     void insert(iterator pos, T&& elem) {
-        /* We might need more space for the new element. */
-        push_back(arr[len-1]);
+        /* We might need more space for the new element, which moves the
+           array out from under pos. */
+        difference_type idx = pos - begin();
+        T moved(std::move(elem));
+        grow();
+        len++;
+        pos = begin() + idx;
 
         /* Insert the element and push everything else back. */
-        iterator it = end()-1;
-        while (--it >= pos)
-            *(it+1) = *it;
-        *pos = elem;
+        for (iterator it = end()-1; it > pos; --it)
+            *it = std::move(*(it-1));
+        *pos = std::move(moved);
     };
 
     /* Erases everything from the first point to the element before the last
        point. */
     void erase(iterator first, iterator last) {
-        /* Make sure we have valid pointers. */
-        assert(first);
-        assert(last);
-
         /* Number of elements deleted to help shifting things left. */
-        int numDeleted = (last - first);
+        difference_type numDeleted = (last - first);
         /* Don't erase if they're the same. */
         if (numDeleted == 0)
             return;
 
         /* Shift everything so that we erased the desired parts, and then the
            gibberish is on the end (which we will remove with a resize) */
-        while (first < end()-numDeleted)
-            *first++ = *last++;
+        while (last < end())
+            *first++ = std::move(*last++);
 
         /* Resize according to how many we deleted. */
         resize(len-numDeleted);
@@ -265,6 +335,8 @@ class Vector : public VectorBase<T> {
 public:
 
     typedef VectorBase<T> Base;
+    typedef typename Base::size_type size_type;
+    typedef typename Base::difference_type difference_type;
 
 
     /******************************
@@ -272,14 +344,14 @@ public:
      ******************************/
 
     Vector() : Base::VectorBase() {};
-    Vector(int size) : Base::VectorBase(size) {};
-    Vector(int size, int cap) : Base::VectorBase(size, cap) {};
+    Vector(size_type size) : Base::VectorBase(size) {};
+    Vector(size_type size, size_type cap) : Base::VectorBase(size, cap) {};
 
     /* Copy constructor */
     Vector(const Vector<T>& v) : Base::VectorBase(v) {};
 
     /* Move constructor */
-    Vector(Vector<T>&& v) : Base::VectorBase(v) {};
+    Vector(Vector<T>&& v) : Base::VectorBase(std::move(v)) {};
 
 
     /******************************
@@ -287,18 +359,14 @@ public:
      ******************************/
 
     /* Copy assignment */
-    Vector operator=(const Vector<T>& v) {
-        if (this != &v)
-            *this = Vector(v);
+    Vector& operator=(const Vector<T>& v) {
+        Base::operator=(v);
         return *this;
     };
 
     /* Move assignment */
-    Vector operator=(const Vector<T>&& v) {
-        if (this != &v) {
-            memcpy((void *) this, (void *) &v, sizeof(Vector<T>&&));
-            memset((void *) &v, 0, sizeof(Vector<T>&&));
-        }
+    Vector& operator=(Vector<T>&& v) {
+        Base::operator=(std::move(v));
         return *this;
     };
 };
@@ -315,6 +383,8 @@ class Vector<void*> : public VectorBase<void*> {
 public:
 
     typedef VectorBase<void*> Base;
+    typedef Base::size_type size_type;
+    typedef Base::difference_type difference_type;
 
 
     /******************************
@@ -322,14 +392,14 @@ public:
      ******************************/
 
     Vector() : Base::VectorBase() {};
-    Vector(int size) : Base::VectorBase(size) {};
-    Vector(int size, int cap) : Base::VectorBase(size, cap) {};
+    Vector(size_type size) : Base::VectorBase(size) {};
+    Vector(size_type size, size_type cap) : Base::VectorBase(size, cap) {};
 
     /* Copy constructor */
     Vector(const Vector<void*>& v) : Base::VectorBase(v) {};
 
     /* Move constructor */
-    Vector(Vector<void*>&& v) : Base::VectorBase(v) {};
+    Vector(Vector<void*>&& v) : Base::VectorBase(std::move(v)) {};
 
 
     /******************************
@@ -337,18 +407,14 @@ public:
      ******************************/
 
     /* Copy assignment */
-    Vector operator=(const Vector<void*>& v) {
-        if (this != &v)
-            *this = Vector(v);
+    Vector& operator=(const Vector<void*>& v) {
+        Base::operator=(v);
         return *this;
     };
 
     /* Move assignment */
-    Vector operator=(const Vector<void*>&& v) {
-        if (this != &v) {
-            memcpy((void *) this, (void *) &v, sizeof(Vector<void*>&&));
-            memset((void *) &v, 0, sizeof(Vector<void*>&&));
-        }
+    Vector& operator=(Vector<void*>&& v) {
+        Base::operator=(std::move(v));
         return *this;
     };
 };
@@ -369,6 +435,8 @@ public:
 
     typedef Vector<void*> Base;
     typedef T** iterator;
+    typedef Base::size_type size_type;
+    typedef Base::difference_type difference_type;
 
 
     /******************************
@@ -376,14 +444,14 @@ public:
      ******************************/
 
     Vector() : Base::Vector() { };
-    Vector(int size) : Base::Vector(size) { };
-    Vector(int size, int cap) : Base::Vector(size, cap) { };
+    Vector(size_type size) : Base::Vector(size) { };
+    Vector(size_type size, size_type cap) : Base::Vector(size, cap) { };
 
     /* Copy constructor */
     Vector(const Vector<T*>& v) : Base::Vector(v) { };
 
     /* Move constructor */
-    Vector(Vector<T*>&& v) : Base::Vector(v) { };
+    Vector(Vector<T*>&& v) : Base::Vector(std::move(v)) { };
 
 
     /******************************
@@ -398,11 +466,11 @@ public:
      ACCESSORS
      ******************************/
 
-    int size() const { return Base::size(); };
-    int capacity() const { return Base::capacity(); };
+    size_type size() const { return Base::size(); };
+    size_type capacity() const { return Base::capacity(); };
 
     /* Returns the element at the argued index. */
-    T* at(int i) { return reinterpret_cast<T*>(Base::at(i)); };
+    T* at(size_type i) { return reinterpret_cast<T*>(Base::at(i)); };
 
     /* Returns an iterator at the beginning of the array, pointing to the
        first element. */
@@ -417,21 +485,23 @@ public:
      ******************************/
 
     /* Copy assignment */
-    Vector operator=(const Vector<T*>& v) {
-        return reinterpret_cast<Vector<T*>>(Base::operator=(v));
+    Vector& operator=(const Vector<T*>& v) {
+        Base::operator=(v);
+        return *this;
     };
 
     /* Move assignment */
-    Vector operator=(const Vector<T*>&& v) {
-        return reinterpret_cast<Vector<T*>>(Base::operator=(v));
+    Vector& operator=(Vector<T*>&& v) {
+        Base::operator=(std::move(v));
+        return *this;
     };
 
     /* Access an element in the array. */
-    T*& operator[](int i) {
-        return reinterpret_cast<T*&>(Base::at(i));
+    T*& operator[](size_type i) {
+        return reinterpret_cast<T*&>(Base::operator[](i));
     };
-    const T*& operator[](int i) const {
-        return reinterpret_cast<const T*&>(Base::at(i));
+    T* const& operator[](size_type i) const {
+        return reinterpret_cast<T* const&>(Base::operator[](i));
     };
 
 
@@ -441,7 +511,7 @@ public:
 
     /* Updates the capacity and allocates space for it.  If the new capacity is
        smaller than the current one, nothing happens. */
-    void reserve(int new_cap) { Base::reserve(new_cap); };
+    void reserve(size_type new_cap) { Base::reserve(new_cap); };
 
     /* If the capacity is larger than the size, this updates the capacity to
        be the same as the size, and reallocates the array. */
@@ -449,7 +519,7 @@ public:
 
     /* Resizes the array.  This initializes anything that was previously within
        size but no longer is. */
-    void resize(int count) { Base::resize(count); };
+    void resize(size_type count) { Base::resize(count); };
 
     /* Clears the array, keeping the capacity the same but changing the length
        to zero. */
@@ -499,9 +569,17 @@ private:
     class Bit;              /* For accessing and mutating bits. */
     class Iterator;         /* For iterating over bits. */
 
-    Vector<uint32_t> arr;   /* Each element contains 32 bool values. */
-    int len;                /* Number of bits in vector. */
-    int cap;                /* Capacity of bits. */
+    Vector<uint32_t> arr;   /* Each element contains 32 bool values.  It
+                               always holds exactly as many words as len
+                               needs, and bits past len are kept clear. */
+    size_t len;             /* Number of bits in vector. */
+    size_t cap;             /* Capacity of bits. */
+
+    /* Number of 32-bit words needed to hold the argued number of bits. */
+    static size_t words(size_t bits) { return (bits + 31) / 32; };
+
+    /* Mask selecting the argued bit within the word that holds it. */
+    static uint32_t mask(size_t i) { return (uint32_t) 1 << (i % 32); };
 
     /* Initializes the uint32 vector based on len and cap. */
     void init() {
@@ -510,12 +588,14 @@ private:
             return;
 
         /* Otherwise, we only need one uint32 for every 32 bools. */
-        arr = Vector<uint32_t>(ceil((double) cap/32));
+        arr = Vector<uint32_t>(words(len), words(cap));
     };
 
 public:
 
     typedef Iterator iterator;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
 
 
     /******************************
@@ -523,20 +603,18 @@ public:
      ******************************/
 
     Vector() : len(0), cap(0) { init(); };
-    Vector(int size) : len(size), cap(smallestPow2(size)) { init(); };
-    Vector(int size, int cap) : len(size), cap(cap) { init(); };
+    Vector(size_type size) : len(size), cap(smallestPow2(size)) { init(); };
+    Vector(size_type size, size_type cap) :
+        len(size), cap(std::max(size, cap)) { init(); };
 
     /* Copy constructor */
-    Vector(const Vector<bool>& v) : len(v.size()), cap(v.capacity()) {
-        init();
-        memcpy((void *) &arr, (void *) &v.arr,
-            ceil((double) cap/32) * sizeof(uint32_t));
-    };
+    Vector(const Vector<bool>& v) :
+        arr(v.arr), len(v.size()), cap(v.capacity()) {};
 
     /* Move constructor */
-    Vector(Vector<bool>&& v) {
-        memcpy((void *) this, (void *) &v, sizeof(Vector<bool>&&));
-        memset((void *) &v, 0, sizeof(Vector<bool>&&));
+    Vector(Vector<bool>&& v) :
+        arr(std::move(v.arr)), len(v.len), cap(v.cap) {
+        v.len = v.cap = 0;
     };
 
 
@@ -552,15 +630,15 @@ public:
      ACCESSORS
      ******************************/
 
-    int size() const { return len; };
-    int capacity() const { return cap; };
+    size_type size() const { return len; };
+    size_type capacity() const { return cap; };
 
-    bool at(int i) const {
+    bool at(size_type i) const {
         /* Ensure i is in range since the vector can't do it. */
         if (i >= len)
             throw std::out_of_range("Vector<bool>::at");
 
-        return (bool) (arr[i/32] & (1 << i%32));
+        return (bool) (arr[i/32] & mask(i));
     };
 
     /* Returns an iterator at the beginning of the array, pointing to the
@@ -576,23 +654,28 @@ public:
      ******************************/
 
     /* Copy assignment */
-    Vector operator=(const Vector<bool>& v) {
-        if (this != &v)
-            *this = Vector(v);
+    Vector& operator=(const Vector<bool>& v) {
+        if (this != &v) {
+            arr = v.arr;
+            len = v.len;
+            cap = v.cap;
+        }
         return *this;
     };
 
     /* Move assignment */
-    Vector operator=(const Vector<bool>&& v) {
+    Vector& operator=(Vector<bool>&& v) {
         if (this != &v) {
-            memcpy((void *) this, (void *) &v, sizeof(Vector<bool>&&));
-            memset((void *) &v, 0, sizeof(Vector<bool>&&));
+            arr = std::move(v.arr);
+            len = v.len;
+            cap = v.cap;
+            v.len = v.cap = 0;
         }
         return *this;
     };
 
     /* Mutate element in the array. */
-    Bit operator[](int i) {
+    Bit operator[](size_type i) {
         if (i >= len)
             throw std::out_of_range("Index out of range");
         return Bit(&arr, i);
@@ -605,10 +688,9 @@ public:
 
     /* Updates the capacity and allocates space for it.  If the new capacity is
        smaller than the current one, nothing happens. */
-    void reserve(int new_cap) {
-        for (int i = arr.size(); i < ceil((double) new_cap/32); i++)
-            /* Allocate as many 32-bit values as we need, init to false */
-            arr.push_back(0);
+    void reserve(size_type new_cap) {
+        /* Allocate as many 32-bit values as we need */
+        arr.reserve(words(new_cap));
 
         /* Save the new capacity. */
         cap = std::max(cap, new_cap);
@@ -620,21 +702,21 @@ public:
         /* Change the capacity to equal the size. */
         cap = len;
 
-        /* Remove unused values from the array. */
-        arr.erase(arr.begin() + (int) ceil((double) cap/32), arr.end());
+        /* Release unused values from the array. */
+        arr.shrink_to_fit();
     };
 
     /* Resizes the array.  This initializes anything that was previously within
        size but no longer is. */
-    void resize(int count) {
+    void resize(size_type count) {
         /* Remove any unneeded values in the uint32 array. */
-        arr.resize(ceil((double) count/32));
+        arr.resize(words(count));
 
         /* Initialize everything that was previously in the array.  We do this
            by erasing entire 32-bit values where possible, then iterating over
            bits in the last one, clearing what is unused. */
-        if (count < len)
-            arr[arr.size()-1] &= ~(-1 << count%32);
+        if (count < len && count % 32 != 0)
+            arr[arr.size()-1] &= mask(count) - 1;
 
         /* Update the size. */
         len = count;
@@ -649,32 +731,30 @@ public:
     void push_back(const bool& elem) {
         /* Make space if we need it. */
         while (len >= cap)
-            reserve(std::max(1, cap << 1));
+            reserve(std::max((size_type) 1, cap << 1));
+
+        /* Start a new word if the last one is full. */
+        if (len % 32 == 0)
+            arr.push_back(0);
 
         /* Assign the bit accordingly and update the length. */
-        arr[len/32] |= (elem << len%32);
+        arr[len/32] |= (uint32_t) elem << (len % 32);
         len++;
     };
 
     /* Appends element to the end of the array. */
     void push_back(bool&& elem) {
-        /* Make space if we need it. */
-        while (len >= cap)
-            reserve(std::max(1, cap << 1));
-
-        /* Assign the bit accordingly and update the length. */
-        arr[len/32] |= (elem << len%32);
-        len++;
+        push_back((const bool&) elem);
     };
 
     /* Inserts an element at the specified position, pushing everything else
        back. */
     void insert(iterator pos, const bool elem) {
         /* We might need more space for the new element. */
-        resize(len+1);
+        push_back(false);
 
         /* Insert the element and push everything else back. */
-        iterator it = end();
+        iterator it = end()-1;
         for (; it != pos; it--) {
             *it = *(it-1);
         }
@@ -685,7 +765,7 @@ public:
        point. */
     void erase(iterator first, iterator last) {
         /* Number of elements deleted to help shifting things left. */
-        int numDeleted = (last - first);
+        difference_type numDeleted = (last - first);
 
         /* Don't erase if they're the same. */
         if (numDeleted <= 0)
@@ -693,7 +773,7 @@ public:
 
         /* Shift everything so that we erased the desired parts, and then the
            gibberish is on the end (which we will remove with a resize) */
-        while (first < end()-numDeleted)
+        while (last < end())
             *first++ = *last++;
 
         /* Resize according to how many we deleted. */
@@ -719,68 +799,68 @@ private:
     private:
 
         Vector<uint32_t> *v;/* The integer where we are mutating a bit. */
-        int idx;            /* The index of the bit being mutated. */
+        size_type idx;      /* The index of the bit being mutated. */
 
     public:
 
         /* Constructors */
         Bit() : v(0), idx(0) {};
         Bit(Vector<uint32_t> *v) : v(v), idx(0) {};
-        Bit(Vector<uint32_t> *v, int i) : v(v), idx(i) {};
+        Bit(Vector<uint32_t> *v, size_type i) : v(v), idx(i) {};
 
         /* Destructor */
         ~Bit() {}; /* Vector freed by Vector class */
 
         /* The index to use when setting the value. */
-        void setIndex(int i) { idx = i; };
+        void setIndex(size_type i) { idx = i; };
 
         /* Add to index. */
-        void addToIndex(int offset) { idx += offset; };
+        void addToIndex(difference_type offset) { idx += offset; };
 
         /* This is what eventually gets called on the [] operator in Vector. */
         Bit operator=(const bool&& b) {
             /* Set the i'th bit in the vector to the argued bool. */
-            (*v)[idx/32] &= ~(1 << (idx%32));
-            (*v)[idx/32] |= b << (idx%32);
+            (*v)[idx/32] &= ~mask(idx);
+            (*v)[idx/32] |= (uint32_t) b << (idx%32);
             return *this;
         };
 
         /* This is what eventually gets called on the [] operator in Vector. */
         Bit operator=(const Bit& bit) {
             /* Set the i'th bit in the vector to the argued bool. */
-            bool b = (bool) ((*bit.v)[bit.idx/32] & (1 << (bit.idx%32)));
+            bool b = (bool) ((*bit.v)[bit.idx/32] & mask(bit.idx));
 
             /* Clear that bit then OR in the new one. */
-            (*v)[idx/32] &= ~(1 << (idx%32));
-            (*v)[idx/32] |= b << (idx%32);
+            (*v)[idx/32] &= ~mask(idx);
+            (*v)[idx/32] |= (uint32_t) b << (idx%32);
             return *this;
         };
 
         /* Need an operator that takes a regular boolean. */
         Bit operator=(const bool& b) {
             /* Set the i'th bit in the vector to the argued bool. */
-            (*v)[idx/32] &= ~(1 << (idx%32));
-            (*v)[idx/32] |= b << (idx%32);
+            (*v)[idx/32] &= ~mask(idx);
+            (*v)[idx/32] |= (uint32_t) b << (idx%32);
             return *this;
         }
 
         /* Compare two bits. */
         const bool operator==(Bit& b) {
-            return ((*v)[idx/32] & (1 << idx%32)) ==
-                ((*b.v)[b.idx/32] & (1 << b.idx%32));
+            return (bool) ((*v)[idx/32] & mask(idx)) ==
+                (bool) ((*b.v)[b.idx/32] & mask(b.idx));
         }
         const bool operator!=(Bit& b) {
-            return ((*v)[idx/32] & (1 << idx%32)) !=
-                ((*b.v)[b.idx/32] & (1 << b.idx%32));
+            return (bool) ((*v)[idx/32] & mask(idx)) !=
+                (bool) ((*b.v)[b.idx/32] & mask(b.idx));
         }
 
         /* We define how to interpret Bit as a bool so when the Vector
            is accessed through the [] operator, which returns Bit, we
            can implicitly cast to this boolean value. */
-        const operator bool() {
+        operator bool() const {
             /* For whatever reason, this only works if we store it before
                returning. */
-            bool out = (*v)[idx/32] & (1 << idx%32);
+            bool out = (*v)[idx/32] & mask(idx);
             return out;
         };
     };
@@ -791,21 +871,17 @@ private:
 
     private:
 
-        Bit *bit;           /* Allows us to modify bits using the iterator. */
+        Bit bit;            /* Allows us to modify bits using the iterator. */
 
     public:
 
         /* Constructors */
-        Iterator() : bit(new Bit()) {};
-        Iterator(Vector<uint32_t> *v, int i) : bit(new Bit(v, i)) {};
-        Iterator(const Iterator& it) {
-            memcpy((void *) this, (void *) &it, sizeof(Iterator));
-            this->bit = new Bit();
-            memcpy((void *) this->bit, (void *) it.bit, sizeof(Bit));
-        };
+        Iterator() : bit() {};
+        Iterator(Vector<uint32_t> *v, size_type i) : bit(v, i) {};
+        Iterator(const Iterator& it) : bit(it.bit.v, it.bit.idx) {};
 
         /* Destructor */
-        ~Iterator() { if (bit) delete bit; };
+        ~Iterator() {};
 
         /* Operators */
         /* post increment */
@@ -841,68 +917,61 @@ private:
         };
 
         /* Dereference for reading/writing */
-        Bit& operator* () { return *bit; };
-
-        /* Move assignment */
-        Iterator operator=(const Iterator&& it) {
-            /* Set the i'th bit in the vector to the argued bool. */
-            memcpy((void *) this, (void *) &it, sizeof(Iterator));
-            memset((void *) &it, 0, sizeof(Iterator));
-            return *this;
-        };
+        Bit& operator* () { return bit; };
 
-        /* Copy assignment */
-        Iterator operator=(const Iterator& it) {
-            /* Set the i'th bit in the vector to the argued bool. */
-            *this = Iterator(it);
+        /* Copy assignment.  This repoints the iterator; assigning through
+           the Bit would copy the bit value instead. */
+        Iterator& operator=(const Iterator& it) {
+            bit.v = it.bit.v;
+            bit.idx = it.bit.idx;
             return *this;
         };
         bool operator>(const Iterator& it) {
-            return (bit->idx > it.bit->idx);
+            return (bit.idx > it.bit.idx);
         };
         bool operator<(const Iterator& it) {
-            return (bit->idx < it.bit->idx);
+            return (bit.idx < it.bit.idx);
         };
         bool operator>=(const Iterator& it) {
-            return (bit->idx >= it.bit->idx);
+            return (bit.idx >= it.bit.idx);
         };
         bool operator<=(const Iterator& it) {
-            return (bit->idx <= it.bit->idx);
+            return (bit.idx <= it.bit.idx);
         };
 
         /* Compare two iterators. */
         const bool operator==(const Iterator& it) {
-            return (bit->v == it.bit->v) && (bit->idx == it.bit->idx);
+            return (bit.v == it.bit.v) && (bit.idx == it.bit.idx);
         };
         const bool operator!=(const Iterator& it) {
-            return (bit->v != it.bit->v) || (bit->idx != it.bit->idx);
+            return (bit.v != it.bit.v) || (bit.idx != it.bit.idx);
         };
 
         /* Pointer arithmetic with iterators */
-        Iterator operator-(const int& i) {
+        Iterator operator-(const difference_type& i) {
             Iterator out(*this);
-            out.bit->addToIndex(-i);
+            out.bit.addToIndex(-i);
             return out;
         };
-        const Iterator& operator-=(const int& i) {
-            bit->addToIndex(-i);
+        const Iterator& operator-=(const difference_type& i) {
+            bit.addToIndex(-i);
             return *this;
         };
-        Iterator operator+(const int& i) {
+        Iterator operator+(const difference_type& i) {
             Iterator out = iterator(*this);
-            out.bit->addToIndex(i);
+            out.bit.addToIndex(i);
             return out;
         };
-        const Iterator& operator+=(const int& i) {
-            bit->addToIndex(i);
+        const Iterator& operator+=(const difference_type& i) {
+            bit.addToIndex(i);
             return *this;
         };
 
         /* This allows us to see the difference between two iterators */
-        int operator-(const Iterator& i) {
-            if (i.bit->v != bit->v)
+        difference_type operator-(const Iterator& i) {
+            if (i.bit.v != bit.v)
                 return -1;
-            return bit->idx - i.bit->idx;
+            return (difference_type) (bit.idx - i.bit.idx);
         };
     };
 };